@@ -0,0 +1,305 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+#include "ProjectionRegistry.h"
+#include "Simd.h"
+
+// Error budget check of the fast trig mode (PRECISION_FAST, Engine/FastTrig.h).
+// For every selected input x output pair it runs main() at every pixel center of an output grid twice, with the
+// exact and the fast trig, and reports the worst angle between the directions the two source coordinates stand for,
+// end to end through both projections, and the worst distance between them in pixels of the given source size. The vectorized kernel is measured the same
+// way against its own exact mode. Exits with 1 when any pair is over the budget, so it can gate a release.
+using namespace reprojection;
+
+namespace
+{
+struct Options
+{
+	std::vector< int > inputs;
+	std::vector< int > outputs;
+	int gridWidth    = 2048;
+	int gridHeight   = 1024;
+	int sourceWidth  = 8192;
+	int sourceHeight = 4096;
+	double budget    = 0.05;//!< Source pixels
+	SimdLevel level  = SimdLevel::Scalar;
+};
+
+struct Result
+{
+	int input;
+	int output;
+	double maxRadians      = 0.0;//!< Fragment with fast trig against Fragment with exact trig, see sourceAngle()
+	double maxPixels       = 0.0;//!< Fragment with fast trig against Fragment with exact trig
+	double maxKernelPixels = 0.0;//!< reprojectRow() with fast trig against reprojectRow() with exact trig
+	long long samples      = 0;
+	long long edges        = 0;//!< Left out: transparent in one mode only, or on different cubemap faces
+};
+
+void printUsage()
+{
+	std::printf( "Usage: ReprojectionAccuracy [options]\n"
+				 "  --inputs LIST       %s, comma separated (default: all but mirror-dome)\n"
+				 "  --outputs LIST      %s, comma separated (default: all)\n"
+				 "  --grid WxH          output pixel centers to sample (default: 2048x1024)\n"
+				 "  --source WxH        source size the pixel error is measured in (default: 8192x4096)\n"
+				 "  --budget PX         largest acceptable source pixel error (default: 0.05)\n"
+				 "  --kernel NAME       scalar, avx2 or avx512 kernel to check too (default: the widest this CPU runs)\n",
+				 projectionNameList( true ).c_str(), projectionNameList( false ).c_str() );
+}
+
+// Parses a comma separated list of input ( input true ) or output projections. Returns false on any other name.
+bool parseProjections( const char* list, bool input, std::vector< int >& values )
+{
+	values.clear();
+	std::string rest = list;
+	while( !rest.empty() )
+	{
+		size_t comma     = rest.find( ',' );
+		std::string item = rest.substr( 0, comma );
+		rest             = comma == std::string::npos ? std::string() : rest.substr( comma + 1 );
+		int value        = 0;
+		if( !parseProjection( item.c_str(), input, value ) )
+		{
+			std::fprintf( stderr, "Unknown %s projection '%s'\n", input ? "input" : "output", item.c_str() );
+			return false;
+		}
+		values.push_back( value );
+	}
+	return !values.empty();
+}
+
+bool parseSize( const char* value, int& width, int& height )
+{
+	return std::sscanf( value, "%dx%d", &width, &height ) == 2 && width > 0 && height > 0;
+}
+
+bool parseKernel( const char* name, SimdLevel& level )
+{
+	for( SimdLevel candidate : { SimdLevel::Scalar, SimdLevel::AVX2, SimdLevel::AVX512 } )
+	{
+		if( std::strcmp( name, simdLevelName( candidate ) ) == 0 && simdLevelSupported( candidate ) )
+		{
+			level = candidate;
+			return true;
+		}
+	}
+	return false;
+}
+
+bool parseOptions( int argc, char** argv, Options& options )
+{
+	options.inputs  = projectionOptions( true, true );
+	options.outputs = projectionOptions( false, true );
+	options.inputs.erase( std::remove( options.inputs.begin(), options.inputs.end(), int( MIRROR_DOME ) ), options.inputs.end() );
+	options.level   = detectSimdLevel();
+	for( int i = 1; i < argc; ++i )
+	{
+		const char* option = argv[ i ];
+		if( std::strcmp( option, "--help" ) == 0 )
+			return false;
+		if( i + 1 == argc )
+		{
+			std::fprintf( stderr, "Missing value for %s\n", option );
+			return false;
+		}
+		const char* value = argv[ ++i ];
+		bool valid        = true;
+		if( std::strcmp( option, "--inputs" ) == 0 )
+			valid = parseProjections( value, true, options.inputs );
+		else if( std::strcmp( option, "--outputs" ) == 0 )
+			valid = parseProjections( value, false, options.outputs );
+		else if( std::strcmp( option, "--grid" ) == 0 )
+			valid = parseSize( value, options.gridWidth, options.gridHeight );
+		else if( std::strcmp( option, "--source" ) == 0 )
+			valid = parseSize( value, options.sourceWidth, options.sourceHeight );
+		else if( std::strcmp( option, "--budget" ) == 0 )
+			valid = ( options.budget = std::atof( value ) ) > 0.0;
+		else if( std::strcmp( option, "--kernel" ) == 0 )
+			valid = parseKernel( value, options.level );
+		else
+		{
+			std::fprintf( stderr, "Unknown option %s\n", option );
+			return false;
+		}
+		if( !valid )
+		{
+			std::fprintf( stderr, "Invalid value '%s' for %s\n", value, option );
+			return false;
+		}
+	}
+	return true;
+}
+
+// The first half of main(): the output projection followed by the rotation, i.e. the direction handed to the input side.
+// Returns false where the output projection has no direction.
+bool rotatedDir( Fragment& fragment, vec2 uv, vec3& dir )
+{
+	if( !outputDirection( fragment, uv, dir ) )
+		return false;
+	dir = fragment.k.rotation * dir;
+	return true;
+}
+
+// Distance between two source coordinates in source pixels, as measured on the sphere. Equirectangular sources wrap
+// around horizontally, and their rows shrink to a single point towards the poles, so a horizontal step there counts
+// cos( latitude ) times as much.
+double pixelDistance( const Options& options, int input, vec2 a, vec2 b )
+{
+	double du = std::fabs( double( a.x ) - double( b.x ) );
+	double dv = std::fabs( double( a.y ) - double( b.y ) );
+	if( input == EQUI )
+		du = std::min( du, 1.0 - du ) * std::cos( ( double( a.y ) - 0.5 ) * PI );
+	du *= options.sourceWidth;
+	dv *= options.sourceHeight;
+	return std::sqrt( du * du + dv * dv );
+}
+
+// Cubemap and EAC sources are a 3 x 2 atlas, cube faces sources a strip of 6. A direction right on a cube edge may land on
+// either face, which is the same spot on the sphere but a jump across the atlas, so those samples are left out like
+// transparency flips. The same goes for the middle of the seam of a dual fisheye source, where either lens may win.
+bool sameFace( int input, vec2 a, vec2 b )
+{
+	if( input == DUAL_FISHEYE )
+		return ( a.x < 0.5f ) == ( b.x < 0.5f );
+	if( input == CUBE_FACES )
+		return std::min( int( a.y * 6.0f ), 5 ) == std::min( int( b.y * 6.0f ), 5 );
+	if( input != CUBEMAP && input != EAC )
+		return true;
+	auto face = []( vec2 uv ) { return std::min( int( uv.x * 3.0f ), 2 ) + 3 * std::min( int( uv.y * 2.0f ), 1 ); };
+	return face( a ) == face( b );
+}
+
+// How far off the sphere the fast source coordinate is, in radians: the angle between dir, the exact rotated direction
+// of the pixel, and the direction the exact input projection would put at fastSource. The exact input projection is
+// linearized around dir, by central differences along two tangents, and the difference of the source coordinates
+// mapped back through it, so the error of both halves of the fast main() is in the figure. Returns false where a
+// probe falls off the input or onto another face, or the projection is degenerate there.
+bool sourceAngle( const Uniforms& exact, const FrameConstants& k, vec3 dir, vec2 exactSource, vec2 fastSource, double& radians )
+{
+	const float step    = 1e-3f;
+	const int input     = exact.inputProjection;
+	vec3 tangentU       = normalize( cross( dir, std::fabs( dir.y ) < 0.9f ? vec3( 0.0f, 1.0f, 0.0f ) : vec3( 1.0f, 0.0f, 0.0f ) ) );
+	vec3 tangentV       = cross( dir, tangentU );
+	const vec3 steps[ 4 ] = { step * tangentU, -step * tangentU, step * tangentV, -step * tangentV };
+	vec2 probes[ 4 ];
+	for( int i = 0; i < 4; ++i )
+	{
+		Fragment probe( exact, k );
+		if( !inputUv( probe, normalize( dir + steps[ i ] ), probes[ i ] ) || !sameFace( input, probes[ i ], exactSource ) )
+			return false;
+	}
+	// Equirectangular sources wrap around horizontally, so do their differences.
+	auto difference = [input]( vec2 a, vec2 b ) {
+		double du = double( a.x ) - double( b.x );
+		if( input == EQUI )
+			du -= std::round( du );
+		return std::make_pair( du, double( a.y ) - double( b.y ) );
+	};
+	auto alongU = difference( probes[ 0 ], probes[ 1 ] );
+	auto alongV = difference( probes[ 2 ], probes[ 3 ] );
+	double a = alongU.first / ( 2.0 * step ), b = alongV.first / ( 2.0 * step );
+	double c = alongU.second / ( 2.0 * step ), d = alongV.second / ( 2.0 * step );
+	double determinant = a * d - b * c;
+	if( determinant == 0.0 )
+		return false;
+	auto offset = difference( fastSource, exactSource );
+	double s    = ( d * offset.first - b * offset.second ) / determinant;
+	double t    = ( a * offset.second - c * offset.first ) / determinant;
+	radians     = std::sqrt( s * s + t * t );
+	return true;
+}
+
+Result measure( const Options& options, int input, int output )
+{
+	Uniforms exact;
+	exact.inputProjection  = input;
+	exact.outputProjection = output;
+	exact.width            = options.sourceWidth;
+	exact.height           = options.sourceHeight;
+	exact.rotation         = vec3( 0.1f, -0.2f, 0.3f );
+	Uniforms fast          = exact;
+	fast.precision         = PRECISION_FAST;
+	const FrameConstants k = computeFrameConstants( exact );
+
+	Result result;
+	result.input  = input;
+	result.output = output;
+	std::vector< float > exactRow( size_t( options.gridWidth ) * 2 );
+	std::vector< float > fastRow( size_t( options.gridWidth ) * 2 );
+	for( int y = 0; y < options.gridHeight; ++y )
+	{
+		reprojectRow( options.level, exact, k, options.gridWidth, options.gridHeight, y, 0, options.gridWidth, exactRow.data() );
+		reprojectRow( options.level, fast, k, options.gridWidth, options.gridHeight, y, 0, options.gridWidth, fastRow.data() );
+		for( int x = 0; x < options.gridWidth; ++x )
+		{
+			vec2 uv = vec2( ( x + 0.5f ) / options.gridWidth, ( y + 0.5f ) / options.gridHeight );
+			Fragment exactFragment( exact, k );
+			Fragment fastFragment( fast, k );
+			vec2 exactSource       = exactFragment.main( uv );
+			vec2 fastSource        = fastFragment.main( uv );
+			vec2 exactKernelSource = vec2( exactRow[ size_t( x ) * 2 ], exactRow[ size_t( x ) * 2 + 1 ] );
+			vec2 fastKernelSource  = vec2( fastRow[ size_t( x ) * 2 ], fastRow[ size_t( x ) * 2 + 1 ] );
+
+			bool transparent = exactSource == SET_TO_TRANSPARENT;
+			if( transparent != ( fastSource == SET_TO_TRANSPARENT ) || transparent != ( exactKernelSource == SET_TO_TRANSPARENT ) ||
+				transparent != ( fastKernelSource == SET_TO_TRANSPARENT ) )
+			{
+				++result.edges;
+				continue;
+			}
+			if( transparent )
+				continue;
+			if( !sameFace( input, exactSource, fastSource ) || !sameFace( input, exactKernelSource, fastKernelSource ) )
+			{
+				++result.edges;
+				continue;
+			}
+			++result.samples;
+			Fragment exactDir( exact, k );
+			vec3 dir;
+			double radians;
+			if( rotatedDir( exactDir, uv, dir ) && sourceAngle( exact, k, dir, exactSource, fastSource, radians ) )
+				result.maxRadians = std::max( result.maxRadians, radians );
+			result.maxPixels       = std::max( result.maxPixels, pixelDistance( options, input, exactSource, fastSource ) );
+			result.maxKernelPixels = std::max( result.maxKernelPixels, pixelDistance( options, input, exactKernelSource, fastKernelSource ) );
+		}
+	}
+	return result;
+}
+
+}// namespace
+
+int main( int argc, char** argv )
+{
+	Options options;
+	if( !parseOptions( argc, argv, options ) )
+	{
+		printUsage();
+		return 1;
+	}
+
+	std::printf( "fast trig against exact, %dx%d output samples, error in %dx%d source pixels, %s kernel\n", options.gridWidth, options.gridHeight,
+				 options.sourceWidth, options.sourceHeight, simdLevelName( options.level ) );
+	std::printf( "%-12s %-12s %12s %10s %10s %12s %8s\n", "input", "output", "max rad", "max px", "kernel px", "samples", "edges" );
+	bool withinBudget = true;
+	for( int input : options.inputs )
+	{
+		for( int output : options.outputs )
+		{
+			Result r = measure( options, input, output );
+			bool ok  = r.maxPixels <= options.budget && r.maxKernelPixels <= options.budget;
+			std::printf( "%-12s %-12s %12.3e %10.4f %10.4f %12lld %8lld%s\n", projectionName( r.input ), projectionName( r.output ), r.maxRadians,
+						 r.maxPixels, r.maxKernelPixels, r.samples, r.edges, ok ? "" : "  over budget" );
+			std::fflush( stdout );
+			withinBudget = withinBudget && ok;
+		}
+	}
+	std::printf( "%s the %.3f source pixel budget\n", withinBudget ? "Within" : "Over", options.budget );
+	return withinBudget ? 0 : 1;
+}
@@ -0,0 +1,413 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Engine.h"
+
+// Headless throughput benchmark of the CPU port of Shader.h.
+// Renders every selected input x output x stereo combination at every selected resolution and reports
+// Mpixels/s, ns/pixel and p50/p99 frame times, optionally as JSON so runs can be compared between releases.
+using namespace reprojection;
+
+namespace
+{
+struct Resolution
+{
+	std::string name;
+	int width;
+	int height;
+};
+
+struct Options
+{
+	std::vector< Resolution > resolutions;
+	std::vector< int > inputs;
+	std::vector< int > outputs;
+	std::vector< int > stereoModes;
+	int frames   = 5;
+	int warmup   = 1;
+	int threads  = 0;
+	int tileSize = 64;
+	std::string kernel;//!< "reference" or simdLevelName( level ), empty picks the widest level the CPU supports
+	SimdLevel level = SimdLevel::Scalar;
+	int precision   = PRECISION_EXACT;
+	bool skipEmpty  = false;
+	std::string jsonPath;
+};
+
+struct Result
+{
+	int input;
+	int output;
+	int stereo;
+	Resolution resolution;
+	double meanMs;
+	double p50Ms;
+	double p99Ms;
+	double megapixelsPerSecond;
+	double nsPerPixel;
+	double emptyTiles; //!< Fraction of the tiles classifyTiles() found Empty, --skip-empty only
+	double classifyMs; //!< Time classifyTiles() took, not part of the frame times
+};
+
+const Resolution STANDARD_RESOLUTIONS[] = {
+	{ "1080p", 1920, 1080 },
+	{ "4k", 3840, 2160 },
+	{ "8k", 7680, 4320 },
+};
+
+void printUsage()
+{
+	std::printf( "Usage: ReprojectionBenchmark [options]\n"
+				 "  --resolutions LIST  1080p, 4k, 8k or WIDTHxHEIGHT, comma separated (default: 1080p,4k,8k)\n"
+				 "  --inputs LIST       %s, comma separated (default: all but mirror-dome)\n"
+				 "  --outputs LIST      %s, comma separated (default: all)\n"
+				 "  --stereo LIST       mono, over-under, side-by-side (default: all)\n"
+				 "  --frames N          timed frames per combination (default: 5)\n"
+				 "  --warmup N          untimed frames per combination (default: 1)\n"
+				 "  --threads N         render threads, 0 for every hardware thread (default: 0)\n"
+				 "  --tile N            tile edge in pixels (default: 64)\n"
+				 "  --kernel NAME       reference, scalar, avx2 or avx512 (default: the widest this CPU runs)\n"
+				 "  --precision NAME    exact or fast trig (default: exact)\n"
+				 "  --skip-empty 1      classify the tiles once per combination and clear the empty ones\n"
+				 "  --json PATH         also write the results as JSON\n",
+				 projectionNameList( true ).c_str(), projectionNameList( false ).c_str() );
+}
+
+std::vector< std::string > split( const char* list )
+{
+	std::vector< std::string > items;
+	std::string item;
+	for( const char* c = list;; ++c )
+	{
+		if( *c == ',' || *c == '\0' )
+		{
+			if( !item.empty() )
+				items.push_back( item );
+			item.clear();
+			if( *c == '\0' )
+				return items;
+		}
+		else
+		{
+			item += *c;
+		}
+	}
+}
+
+// Parses a list of names against nameOf( 0 .. count - 1 ). Returns false on an unknown name.
+bool parseNames( const char* list, int count, const char* ( *nameOf )( int ), std::vector< int >& values )
+{
+	values.clear();
+	for( const std::string& item : split( list ) )
+	{
+		int value = 0;
+		while( value < count && item != nameOf( value ) )
+			++value;
+		if( value == count )
+		{
+			std::fprintf( stderr, "Unknown name '%s'\n", item.c_str() );
+			return false;
+		}
+		values.push_back( value );
+	}
+	return !values.empty();
+}
+
+// Parses a list of input ( input true ) or output projections. Returns false on any other name.
+bool parseProjections( const char* list, bool input, std::vector< int >& values )
+{
+	values.clear();
+	for( const std::string& item : split( list ) )
+	{
+		int value = 0;
+		if( !parseProjection( item.c_str(), input, value ) )
+		{
+			std::fprintf( stderr, "Unknown %s projection '%s'\n", input ? "input" : "output", item.c_str() );
+			return false;
+		}
+		values.push_back( value );
+	}
+	return !values.empty();
+}
+
+bool parseResolutions( const char* list, std::vector< Resolution >& resolutions )
+{
+	resolutions.clear();
+	for( const std::string& item : split( list ) )
+	{
+		bool found = false;
+		for( const Resolution& standard : STANDARD_RESOLUTIONS )
+		{
+			if( item == standard.name )
+			{
+				resolutions.push_back( standard );
+				found = true;
+			}
+		}
+		int width = 0, height = 0;
+		if( !found && std::sscanf( item.c_str(), "%dx%d", &width, &height ) == 2 && width > 0 && height > 0 )
+		{
+			resolutions.push_back( { item, width, height } );
+			found = true;
+		}
+		if( !found )
+		{
+			std::fprintf( stderr, "Unknown resolution '%s'\n", item.c_str() );
+			return false;
+		}
+	}
+	return !resolutions.empty();
+}
+
+bool parseKernel( const char* name, Options& options )
+{
+	options.kernel = name;
+	if( options.kernel == "reference" )
+		return true;
+	for( SimdLevel level : { SimdLevel::Scalar, SimdLevel::AVX2, SimdLevel::AVX512 } )
+	{
+		if( options.kernel == simdLevelName( level ) )
+		{
+			if( !simdLevelSupported( level ) )
+				std::fprintf( stderr, "This CPU or build can't run the %s kernel\n", name );
+			options.level = level;
+			return simdLevelSupported( level );
+		}
+	}
+	return false;
+}
+
+bool parseOptions( int argc, char** argv, Options& options )
+{
+	options.resolutions.assign( std::begin( STANDARD_RESOLUTIONS ), std::end( STANDARD_RESOLUTIONS ) );
+	options.inputs      = projectionOptions( true, true );
+	options.outputs     = projectionOptions( false, true );
+	options.inputs.erase( std::remove( options.inputs.begin(), options.inputs.end(), int( MIRROR_DOME ) ), options.inputs.end() );
+	options.stereoModes = { STEREO_NONE, STEREO_OVER_UNDER, STEREO_SIDE_BY_SIDE };
+	for( int i = 1; i < argc; ++i )
+	{
+		const char* option = argv[ i ];
+		if( std::strcmp( option, "--help" ) == 0 )
+			return false;
+		if( i + 1 == argc )
+		{
+			std::fprintf( stderr, "Missing value for %s\n", option );
+			return false;
+		}
+		const char* value = argv[ ++i ];
+		bool valid        = true;
+		if( std::strcmp( option, "--resolutions" ) == 0 )
+			valid = parseResolutions( value, options.resolutions );
+		else if( std::strcmp( option, "--inputs" ) == 0 )
+			valid = parseProjections( value, true, options.inputs );
+		else if( std::strcmp( option, "--outputs" ) == 0 )
+			valid = parseProjections( value, false, options.outputs );
+		else if( std::strcmp( option, "--stereo" ) == 0 )
+			valid = parseNames( value, STEREO_MODE_COUNT, stereoModeName, options.stereoModes );
+		else if( std::strcmp( option, "--frames" ) == 0 )
+			valid = ( options.frames = std::atoi( value ) ) > 0;
+		else if( std::strcmp( option, "--warmup" ) == 0 )
+			valid = ( options.warmup = std::atoi( value ) ) >= 0;
+		else if( std::strcmp( option, "--threads" ) == 0 )
+			valid = ( options.threads = std::atoi( value ) ) >= 0;
+		else if( std::strcmp( option, "--tile" ) == 0 )
+			valid = ( options.tileSize = std::atoi( value ) ) > 0;
+		else if( std::strcmp( option, "--kernel" ) == 0 )
+			valid = parseKernel( value, options );
+		else if( std::strcmp( option, "--precision" ) == 0 )
+		{
+			std::vector< int > precision;
+			valid             = parseNames( value, PRECISION_MODE_COUNT, precisionModeName, precision ) && precision.size() == 1;
+			options.precision = valid ? precision[ 0 ] : PRECISION_EXACT;
+		}
+		else if( std::strcmp( option, "--skip-empty" ) == 0 )
+			options.skipEmpty = std::atoi( value ) != 0;
+		else if( std::strcmp( option, "--json" ) == 0 )
+			options.jsonPath = value;
+		else
+		{
+			std::fprintf( stderr, "Unknown option %s\n", option );
+			return false;
+		}
+		if( !valid )
+		{
+			std::fprintf( stderr, "Invalid value '%s' for %s\n", value, option );
+			return false;
+		}
+	}
+	return true;
+}
+
+// Nearest-rank percentile of an already sorted list.
+double percentile( const std::vector< double >& sorted, double p )
+{
+	size_t rank = size_t( std::ceil( p * sorted.size() ) );
+	return sorted[ std::min( std::max( rank, size_t( 1 ) ), sorted.size() ) - 1 ];
+}
+
+// Something with detail in every direction so the bilinear fetches touch real data.
+void fillTestPattern( Image& image )
+{
+	for( int y = 0; y < image.height; ++y )
+		for( int x = 0; x < image.width; ++x )
+			image.store( x, y, vec4( float( x ) / image.width, float( y ) / image.height, float( ( x ^ y ) & 0xff ) / 255.0f, 1.0f ) );
+}
+
+void renderFrame( const Options& options, TileExecutor& executor, const Uniforms& uniforms, const TileCoverage& coverage, const Image& source,
+				  Image& destination )
+{
+	if( options.kernel == "reference" )
+		renderReference( uniforms, source, destination, executor );
+	else if( options.skipEmpty )
+		render( uniforms, source, destination, executor, options.level, coverage );
+	else
+		render( uniforms, source, destination, executor, options.level );
+}
+
+Result run( const Options& options, TileExecutor& executor, const Resolution& resolution, const Image& source, Image& destination, int input, int output,
+			int stereo )
+{
+	Uniforms uniforms;
+	uniforms.inputProjection  = input;
+	uniforms.outputProjection = output;
+	uniforms.stereo           = stereo;
+	uniforms.precision        = options.precision;
+	uniforms.width            = source.width;
+	uniforms.height           = source.height;
+	uniforms.rotation         = vec3( 0.1f, -0.2f, 0.3f );
+
+	// The parameters never change within a combination, so the plugins would classify once too.
+	TileCoverage coverage;
+	double classifyMs = 0.0;
+	if( options.skipEmpty && options.kernel != "reference" )
+	{
+		auto start = std::chrono::steady_clock::now();
+		classifyTiles( uniforms, destination.width, destination.height, executor.tileSize(), coverage, executor, options.level );
+		classifyMs = std::chrono::duration< double, std::milli >( std::chrono::steady_clock::now() - start ).count();
+	}
+
+	for( int i = 0; i < options.warmup; ++i )
+		renderFrame( options, executor, uniforms, coverage, source, destination );
+
+	std::vector< double > frameMs;
+	for( int i = 0; i < options.frames; ++i )
+	{
+		auto start = std::chrono::steady_clock::now();
+		renderFrame( options, executor, uniforms, coverage, source, destination );
+		auto end = std::chrono::steady_clock::now();
+		frameMs.push_back( std::chrono::duration< double, std::milli >( end - start ).count() );
+	}
+	std::sort( frameMs.begin(), frameMs.end() );
+
+	Result result;
+	result.input      = input;
+	result.output     = output;
+	result.stereo     = stereo;
+	result.resolution = resolution;
+	result.meanMs     = 0.0;
+	for( double ms : frameMs )
+		result.meanMs += ms;
+	result.meanMs /= frameMs.size();
+	result.p50Ms = percentile( frameMs, 0.50 );
+	result.p99Ms = percentile( frameMs, 0.99 );
+
+	double pixels              = double( resolution.width ) * resolution.height;
+	result.megapixelsPerSecond = pixels / ( result.meanMs * 1e-3 ) / 1e6;
+	result.nsPerPixel          = result.meanMs * 1e6 / pixels;
+	result.emptyTiles          = coverage.classes.empty() ? 0.0 : double( coverage.count( TileClass::Empty ) ) / coverage.classes.size();
+	result.classifyMs          = classifyMs;
+	return result;
+}
+
+bool writeJson( const std::string& path, const Options& options, const TileExecutor& executor, const std::vector< Result >& results )
+{
+	FILE* file = std::fopen( path.c_str(), "w" );
+	if( file == nullptr )
+		return false;
+	std::fprintf( file, "{\n" );
+	std::fprintf( file, "  \"schema\": 1,\n" );
+	std::fprintf( file, "  \"renderer\": \"%s\",\n", options.kernel.c_str() );
+	std::fprintf( file, "  \"precision\": \"%s\",\n", precisionModeName( options.precision ) );
+	std::fprintf( file, "  \"skipEmpty\": %s,\n", options.skipEmpty ? "true" : "false" );
+	std::fprintf( file, "  \"threads\": %d,\n", executor.threadCount() );
+	std::fprintf( file, "  \"tileSize\": %d,\n", executor.tileSize() );
+	std::fprintf( file, "  \"hardwareThreads\": %u,\n", std::thread::hardware_concurrency() );
+	std::fprintf( file, "  \"pixelFormat\": \"rgba8\",\n" );
+	std::fprintf( file, "  \"frames\": %d,\n", options.frames );
+	std::fprintf( file, "  \"warmup\": %d,\n", options.warmup );
+	std::fprintf( file, "  \"results\": [\n" );
+	for( size_t i = 0; i < results.size(); ++i )
+	{
+		const Result& r = results[ i ];
+		std::fprintf( file,
+					  "    { \"input\": \"%s\", \"output\": \"%s\", \"stereo\": \"%s\", \"resolution\": \"%s\", \"width\": %d, \"height\": %d, "
+					  "\"megapixelsPerSecond\": %.3f, \"nsPerPixel\": %.3f, \"meanMs\": %.3f, \"p50Ms\": %.3f, \"p99Ms\": %.3f, \"emptyTiles\": %.3f, \"classifyMs\": %.3f }%s\n",
+					  projectionName( r.input ), projectionName( r.output ), stereoModeName( r.stereo ), r.resolution.name.c_str(),
+					  r.resolution.width, r.resolution.height, r.megapixelsPerSecond, r.nsPerPixel, r.meanMs, r.p50Ms, r.p99Ms, r.emptyTiles,
+					  r.classifyMs, i + 1 < results.size() ? "," : "" );
+	}
+	std::fprintf( file, "  ]\n}\n" );
+	return std::fclose( file ) == 0;
+}
+
+}// namespace
+
+int main( int argc, char** argv )
+{
+	Options options;
+	if( !parseOptions( argc, argv, options ) )
+	{
+		printUsage();
+		return 1;
+	}
+	if( options.kernel.empty() )
+	{
+		options.level  = detectSimdLevel();
+		options.kernel = simdLevelName( options.level );
+	}
+
+	TileExecutor executor( options.threads, options.tileSize );
+	std::printf( "%s kernel, %s trig, %d threads, %d pixel tiles%s\n", options.kernel.c_str(), precisionModeName( options.precision ),
+				 executor.threadCount(), executor.tileSize(), options.skipEmpty ? ", empty tiles skipped" : "" );
+
+	std::vector< Result > results;
+	std::printf( "%-8s %-12s %-12s %-13s %10s %9s %10s %10s", "size", "input", "output", "stereo", "Mpx/s", "ns/px", "p50 ms", "p99 ms" );
+	std::printf( options.skipEmpty ? " %7s %11s\n" : "\n", "empty", "classify ms" );
+	for( const Resolution& resolution : options.resolutions )
+	{
+		// The source has the output's size, so every combination reads the same amount of data.
+		Image source( resolution.width, resolution.height, PixelFormat::RGBA8 );
+		Image destination( resolution.width, resolution.height, PixelFormat::RGBA8 );
+		fillTestPattern( source );
+		for( int input : options.inputs )
+		{
+			for( int output : options.outputs )
+			{
+				for( int stereo : options.stereoModes )
+				{
+					Result r = run( options, executor, resolution, source, destination, input, output, stereo );
+					std::printf( "%-8s %-12s %-12s %-13s %10.2f %9.2f %10.2f %10.2f", resolution.name.c_str(), projectionName( input ),
+								 projectionName( output ), stereoModeName( stereo ), r.megapixelsPerSecond, r.nsPerPixel, r.p50Ms, r.p99Ms );
+					if( options.skipEmpty )
+						std::printf( " %6.1f%% %11.2f", r.emptyTiles * 100.0, r.classifyMs );
+					std::printf( "\n" );
+					std::fflush( stdout );
+					results.push_back( r );
+				}
+			}
+		}
+	}
+
+	if( !options.jsonPath.empty() && !writeJson( options.jsonPath, options, executor, results ) )
+	{
+		std::fprintf( stderr, "Could not write %s\n", options.jsonPath.c_str() );
+		return 1;
+	}
+	return 0;
+}
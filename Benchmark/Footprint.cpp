@@ -0,0 +1,182 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "ProjectionRegistry.h"
+#include "RemapTable.h"
+#include "SourceFootprint.h"
+
+// Prints the source footprint computeSourceFootprint() finds for one set of parameters: the rectangles, how much of
+// the source they cover and how long it took. --verify bakes the full mapping and checks that every texel the
+// renderer would fetch lies inside the footprint, exiting with 1 when one does not.
+using namespace reprojection;
+
+namespace
+{
+struct Options
+{
+	Uniforms uniforms;
+	int outputWidth  = 1920;
+	int outputHeight = 1080;
+	int cellSize     = 64;
+	int maxRects     = 16;
+	bool verify      = false;
+};
+
+void printUsage()
+{
+	std::printf( "Usage: ReprojectionFootprint [options]\n"
+				 "  --from NAME         %s (default: equi)\n"
+				 "  --to NAME           %s (default: flat)\n"
+				 "  --stereo NAME       mono, over-under or side-by-side (default: mono)\n"
+				 "  --pitch, --roll, --yaw DEGREES  rotation (default: 0)\n"
+				 "  --fov-in, --fov-out V           the plugins' fov In / fov Out slider, 0 to 1 (default: 0.5)\n"
+				 "  --source WxH        source size (default: 7680x3840)\n"
+				 "  --output-size WxH   output size (default: 1920x1080)\n"
+				 "  --cell N            cell edge in source texels (default: 64)\n"
+				 "  --max-rects N       merge down to N rectangles, 0 for no limit (default: 16)\n"
+				 "  --verify 1          check the footprint against every output pixel's fetch\n",
+				 projectionNameList( true ).c_str(), projectionNameList( false ).c_str() );
+}
+
+bool parseName( const char* name, int count, const char* ( *nameOf )( int ), int& value )
+{
+	for( value = 0; value < count; ++value )
+	{
+		if( std::strcmp( name, nameOf( value ) ) == 0 )
+			return true;
+	}
+	return false;
+}
+
+bool parseSize( const char* value, int& width, int& height )
+{
+	return std::sscanf( value, "%dx%d", &width, &height ) == 2 && width > 0 && height > 0;
+}
+
+bool parseOptions( int argc, char** argv, Options& options )
+{
+	Uniforms& uniforms        = options.uniforms;
+	uniforms.outputProjection = FLAT;
+	uniforms.width            = 7680;
+	uniforms.height           = 3840;
+	double degrees            = PI / 180.0;
+	for( int i = 1; i < argc; ++i )
+	{
+		const char* option = argv[ i ];
+		if( std::strcmp( option, "--help" ) == 0 )
+			return false;
+		if( i + 1 == argc )
+		{
+			std::fprintf( stderr, "Missing value for %s\n", option );
+			return false;
+		}
+		const char* value = argv[ ++i ];
+		bool valid        = true;
+		if( std::strcmp( option, "--from" ) == 0 )
+			valid = parseProjection( value, true, uniforms.inputProjection );
+		else if( std::strcmp( option, "--to" ) == 0 )
+			valid = parseProjection( value, false, uniforms.outputProjection );
+		else if( std::strcmp( option, "--stereo" ) == 0 )
+			valid = parseName( value, STEREO_MODE_COUNT, stereoModeName, uniforms.stereo );
+		else if( std::strcmp( option, "--pitch" ) == 0 )
+			uniforms.rotation.x = float( std::atof( value ) * degrees );
+		else if( std::strcmp( option, "--roll" ) == 0 )
+			uniforms.rotation.y = float( std::atof( value ) * degrees );
+		else if( std::strcmp( option, "--yaw" ) == 0 )
+			uniforms.rotation.z = float( std::atof( value ) * degrees );
+		else if( std::strcmp( option, "--fov-in" ) == 0 )
+			uniforms.fovIn = float( std::atof( value ) * PI / 2.0 );// Same mapping as currentUniforms() in the plugins
+		else if( std::strcmp( option, "--fov-out" ) == 0 )
+			uniforms.fovOut = float( std::atof( value ) * PI / 2.0 );
+		else if( std::strcmp( option, "--source" ) == 0 )
+			valid = parseSize( value, uniforms.width, uniforms.height );
+		else if( std::strcmp( option, "--output-size" ) == 0 )
+			valid = parseSize( value, options.outputWidth, options.outputHeight );
+		else if( std::strcmp( option, "--cell" ) == 0 )
+			valid = ( options.cellSize = std::atoi( value ) ) > 0;
+		else if( std::strcmp( option, "--max-rects" ) == 0 )
+			valid = ( options.maxRects = std::atoi( value ) ) >= 0;
+		else if( std::strcmp( option, "--verify" ) == 0 )
+			options.verify = std::atoi( value ) != 0;
+		else
+		{
+			std::fprintf( stderr, "Unknown option %s\n", option );
+			return false;
+		}
+		if( !valid )
+		{
+			std::fprintf( stderr, "Invalid value '%s' for %s\n", value, option );
+			return false;
+		}
+	}
+	return true;
+}
+
+// Counts the output pixels whose bilinear fetch, by the vectorized kernel the plugins bake with, reads a texel in an
+// untouched cell. Inside a DUAL_FISHEYE seam band the fetch of the other lens counts too.
+long long countMisses( const Options& options, const SourceFootprint& footprint )
+{
+	RemapTable table;
+	bakeRemapTable( options.uniforms, options.outputWidth, options.outputHeight, table, detectSimdLevel() );
+	auto inside = [&]( vec2 uv ) {
+		float tx = uv.x * footprint.sourceWidth - 0.5f, ty = uv.y * footprint.sourceHeight - 0.5f;
+		for( int dy = 0; dy <= 1; ++dy )
+		{
+			for( int dx = 0; dx <= 1; ++dx )
+			{
+				int cx = std::min( std::max( int( std::floor( tx ) ) + dx, 0 ), footprint.sourceWidth - 1 ) / footprint.cellSize;
+				int cy = std::min( std::max( int( std::floor( ty ) ) + dy, 0 ), footprint.sourceHeight - 1 ) / footprint.cellSize;
+				if( footprint.cells[ size_t( cy ) * size_t( footprint.cellsX ) + size_t( cx ) ] == 0 )
+					return false;
+			}
+		}
+		return true;
+	};
+	long long misses = 0;
+	for( int y = 0; y < table.height; ++y )
+	{
+		for( int x = 0; x < table.width; ++x )
+		{
+			vec2 uv = table.at( x, y );
+			if( uv == SET_TO_TRANSPARENT )
+				continue;
+			vec2 seamPixel;
+			bool seam = table.seamAt( x, y, seamPixel ) > 0.0f;
+			misses += inside( uv ) && ( !seam || inside( seamPixel ) ) ? 0 : 1;
+		}
+	}
+	return misses;
+}
+
+}// namespace
+
+int main( int argc, char** argv )
+{
+	Options options;
+	if( !parseOptions( argc, argv, options ) )
+	{
+		printUsage();
+		return 1;
+	}
+
+	auto start                = std::chrono::steady_clock::now();
+	SourceFootprint footprint = computeSourceFootprint( options.uniforms, options.outputWidth, options.outputHeight, options.cellSize, options.maxRects );
+	double ms                 = std::chrono::duration< double, std::milli >( std::chrono::steady_clock::now() - start ).count();
+
+	std::printf( "%s %dx%d -> %s %dx%d: %zu rects cover %.1f%% of the source, found in %.2f ms\n", projectionName( options.uniforms.inputProjection ),
+				 footprint.sourceWidth, footprint.sourceHeight, projectionName( options.uniforms.outputProjection ), options.outputWidth,
+				 options.outputHeight, footprint.rects.size(), footprint.coverage() * 100.0, ms );
+	for( const SourceRect& rect : footprint.rects )
+		std::printf( "  x %5d .. %5d  y %5d .. %5d\n", rect.x0, rect.x1, rect.y0, rect.y1 );
+
+	if( options.verify )
+	{
+		long long misses = countMisses( options, footprint );
+		std::printf( "%lld output pixels fetch outside the footprint\n", misses );
+		return misses == 0 ? 0 : 1;
+	}
+	return 0;
+}
@@ -0,0 +1,141 @@
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "CompactRemap.h"
+#include "ProjectionRegistry.h"
+
+// Bakes the mapping for one set of parameters and encodes it in every RemapFormat, printing how big each one is and
+// how far its decoded source positions are off, then the smallest format within --budget source pixels.
+using namespace reprojection;
+
+namespace
+{
+struct Options
+{
+	Uniforms uniforms;
+	int outputWidth  = 3840;
+	int outputHeight = 2160;
+	double budget    = 0.25;
+};
+
+void printUsage()
+{
+	std::printf( "Usage: ReprojectionRemapFormats [options]\n"
+				 "  --from NAME         %s (default: equi)\n"
+				 "  --to NAME           %s (default: mirror-dome)\n"
+				 "  --stereo NAME       mono, over-under or side-by-side (default: mono)\n"
+				 "  --pitch, --roll, --yaw DEGREES  rotation (default: 0)\n"
+				 "  --fov-in, --fov-out V           the plugins' fov In / fov Out slider, 0 to 1 (default: 0.5)\n"
+				 "  --source WxH        source size the error is measured in (default: 7680x3840)\n"
+				 "  --output-size WxH   output size (default: 3840x2160)\n"
+				 "  --budget PIXELS     largest error allowed, in source pixels (default: 0.25)\n",
+				 projectionNameList( true ).c_str(), projectionNameList( false ).c_str() );
+}
+
+bool parseName( const char* name, int count, const char* ( *nameOf )( int ), int& value )
+{
+	for( value = 0; value < count; ++value )
+	{
+		if( std::strcmp( name, nameOf( value ) ) == 0 )
+			return true;
+	}
+	return false;
+}
+
+bool parseSize( const char* value, int& width, int& height )
+{
+	return std::sscanf( value, "%dx%d", &width, &height ) == 2 && width > 0 && height > 0;
+}
+
+bool parseOptions( int argc, char** argv, Options& options )
+{
+	Uniforms& uniforms        = options.uniforms;
+	uniforms.outputProjection = MIRROR_DOME;
+	uniforms.width            = 7680;
+	uniforms.height           = 3840;
+	double degrees            = PI / 180.0;
+	for( int i = 1; i < argc; ++i )
+	{
+		const char* option = argv[ i ];
+		if( std::strcmp( option, "--help" ) == 0 )
+			return false;
+		if( i + 1 == argc )
+		{
+			std::fprintf( stderr, "Missing value for %s\n", option );
+			return false;
+		}
+		const char* value = argv[ ++i ];
+		bool valid        = true;
+		if( std::strcmp( option, "--from" ) == 0 )
+			valid = parseProjection( value, true, uniforms.inputProjection );
+		else if( std::strcmp( option, "--to" ) == 0 )
+			valid = parseProjection( value, false, uniforms.outputProjection );
+		else if( std::strcmp( option, "--stereo" ) == 0 )
+			valid = parseName( value, STEREO_MODE_COUNT, stereoModeName, uniforms.stereo );
+		else if( std::strcmp( option, "--pitch" ) == 0 )
+			uniforms.rotation.x = float( std::atof( value ) * degrees );
+		else if( std::strcmp( option, "--roll" ) == 0 )
+			uniforms.rotation.y = float( std::atof( value ) * degrees );
+		else if( std::strcmp( option, "--yaw" ) == 0 )
+			uniforms.rotation.z = float( std::atof( value ) * degrees );
+		else if( std::strcmp( option, "--fov-in" ) == 0 )
+			uniforms.fovIn = float( std::atof( value ) * PI / 2.0 );// Same mapping as currentUniforms() in the plugins
+		else if( std::strcmp( option, "--fov-out" ) == 0 )
+			uniforms.fovOut = float( std::atof( value ) * PI / 2.0 );
+		else if( std::strcmp( option, "--source" ) == 0 )
+			valid = parseSize( value, uniforms.width, uniforms.height );
+		else if( std::strcmp( option, "--output-size" ) == 0 )
+			valid = parseSize( value, options.outputWidth, options.outputHeight );
+		else if( std::strcmp( option, "--budget" ) == 0 )
+			valid = ( options.budget = std::atof( value ) ) > 0.0;
+		else
+		{
+			std::fprintf( stderr, "Unknown option %s\n", option );
+			return false;
+		}
+		if( !valid )
+		{
+			std::fprintf( stderr, "Invalid value '%s' for %s\n", value, option );
+			return false;
+		}
+	}
+	return true;
+}
+
+}// namespace
+
+int main( int argc, char** argv )
+{
+	Options options;
+	if( !parseOptions( argc, argv, options ) )
+	{
+		printUsage();
+		return 1;
+	}
+	const Uniforms& uniforms = options.uniforms;
+
+	RemapTable table;
+	bakeRemapTable( uniforms, options.outputWidth, options.outputHeight, table, detectSimdLevel() );
+	const double pixels = double( table.width ) * double( table.height );
+
+	std::printf( "%s %dx%d -> %s %dx%d\n", projectionName( uniforms.inputProjection ), uniforms.width, uniforms.height,
+				 projectionName( uniforms.outputProjection ), options.outputWidth, options.outputHeight );
+	std::printf( "%-9s %10s %8s %12s %12s %10s\n", "format", "MB", "B/px", "max px", "mean px", "encode ms" );
+	CompactRemapTable compact;
+	for( int format = 0; format < REMAP_FORMAT_COUNT; ++format )
+	{
+		auto start = std::chrono::steady_clock::now();
+		encodeRemapTable( table, RemapFormat( format ), compact );
+		double ms        = std::chrono::duration< double, std::milli >( std::chrono::steady_clock::now() - start ).count();
+		RemapError error = measureRemapError( table, compact, uniforms.width, uniforms.height );
+		std::printf( "%-9s %10.1f %8.2f %12.5f %12.5f %10.1f%s\n", remapFormatName( RemapFormat( format ) ), compact.bytes() / 1048576.0,
+					 compact.bytes() / pixels, error.maxPixels, error.meanPixels, ms,
+					 error.transparencyMismatches != 0 ? "  transparency differs" : "" );
+	}
+
+	RemapFormat best = smallestRemapFormat( table, uniforms.width, uniforms.height, options.budget, compact );
+	std::printf( "smallest within %.3f source pixels: %s, %.1f MB\n", options.budget, remapFormatName( best ), compact.bytes() / 1048576.0 );
+	return 0;
+}
@@ -0,0 +1,229 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include "AdaptiveMesh.h"
+#include "BourkeMesh.h"
+#include "CompactRemap.h"
+#include "ProjectionRegistry.h"
+
+// Builds the adaptive warp mesh for one set of parameters at a few tolerances, printing how many cells and output
+// projection evaluations each one takes and how far the mapping it rasterizes to is off from the per pixel one.
+// With --export it writes the mesh of the parameters in the format of Paul Bourke's tools instead, and with --compare
+// it reports how far the nodes of such a mesh, calibrated in a venue say, are from what the parameters give.
+using namespace reprojection;
+
+namespace
+{
+struct Options
+{
+	Uniforms uniforms;
+	int outputWidth  = 3840;
+	int outputHeight = 2160;
+	int minCell      = 4;
+	const char* exportPath  = nullptr;
+	const char* comparePath = nullptr;
+	int gridColumns         = 65;
+	int gridRows            = 37;
+};
+
+void printUsage()
+{
+	std::printf( "Usage: ReprojectionWarpMesh [options]\n"
+				 "  --from NAME         %s (default: equi)\n"
+				 "  --to NAME           %s (default: mirror-dome)\n"
+				 "  --stereo NAME       mono, over-under or side-by-side (default: mono)\n"
+				 "  --pitch, --roll, --yaw DEGREES  rotation (default: 0)\n"
+				 "  --fov-in, --fov-out V           the plugins' fov In / fov Out slider, 0 to 1 (default: 0.5)\n"
+				 "  --source WxH        source size the error is measured in (default: 7680x3840)\n"
+				 "  --output-size WxH   output size (default: 3840x2160)\n"
+				 "  --min-cell PIXELS   smallest cell edge (default: 4)\n"
+				 "  --mirror R,D,L,F,T,DOME  mirror radius, projector distance and lift, projector fov and tilt in degrees,\n"
+				 "                      dome radius, in the units the plugin displays (default: the engine's defaults)\n"
+				 "  --export FILE       write the Bourke format warp mesh of the parameters to FILE and exit\n"
+				 "  --grid CxR          node columns and rows of --export (default: 65x37)\n"
+				 "  --compare FILE      angles between the nodes of a Bourke format mesh and the parameters' directions\n",
+				 projectionNameList( true ).c_str(), projectionNameList( false ).c_str() );
+}
+
+bool parseName( const char* name, int count, const char* ( *nameOf )( int ), int& value )
+{
+	for( value = 0; value < count; ++value )
+	{
+		if( std::strcmp( name, nameOf( value ) ) == 0 )
+			return true;
+	}
+	return false;
+}
+
+bool parseSize( const char* value, int& width, int& height )
+{
+	return std::sscanf( value, "%dx%d", &width, &height ) == 2 && width > 0 && height > 0;
+}
+
+bool parseOptions( int argc, char** argv, Options& options )
+{
+	Uniforms& uniforms        = options.uniforms;
+	uniforms.outputProjection = MIRROR_DOME;
+	uniforms.width            = 7680;
+	uniforms.height           = 3840;
+	double degrees            = PI / 180.0;
+	for( int i = 1; i < argc; ++i )
+	{
+		const char* option = argv[ i ];
+		if( std::strcmp( option, "--help" ) == 0 )
+			return false;
+		if( i + 1 == argc )
+		{
+			std::fprintf( stderr, "Missing value for %s\n", option );
+			return false;
+		}
+		const char* value = argv[ ++i ];
+		bool valid        = true;
+		if( std::strcmp( option, "--from" ) == 0 )
+			valid = parseProjection( value, true, uniforms.inputProjection );
+		else if( std::strcmp( option, "--to" ) == 0 )
+			valid = parseProjection( value, false, uniforms.outputProjection );
+		else if( std::strcmp( option, "--stereo" ) == 0 )
+			valid = parseName( value, STEREO_MODE_COUNT, stereoModeName, uniforms.stereo );
+		else if( std::strcmp( option, "--pitch" ) == 0 )
+			uniforms.rotation.x = float( std::atof( value ) * degrees );
+		else if( std::strcmp( option, "--roll" ) == 0 )
+			uniforms.rotation.y = float( std::atof( value ) * degrees );
+		else if( std::strcmp( option, "--yaw" ) == 0 )
+			uniforms.rotation.z = float( std::atof( value ) * degrees );
+		else if( std::strcmp( option, "--fov-in" ) == 0 )
+			uniforms.fovIn = float( std::atof( value ) * PI / 2.0 );// Same mapping as currentUniforms() in the plugins
+		else if( std::strcmp( option, "--fov-out" ) == 0 )
+			uniforms.fovOut = float( std::atof( value ) * PI / 2.0 );
+		else if( std::strcmp( option, "--source" ) == 0 )
+			valid = parseSize( value, uniforms.width, uniforms.height );
+		else if( std::strcmp( option, "--output-size" ) == 0 )
+			valid = parseSize( value, options.outputWidth, options.outputHeight );
+		else if( std::strcmp( option, "--min-cell" ) == 0 )
+			valid = ( options.minCell = std::atoi( value ) ) > 0;
+		else if( std::strcmp( option, "--mirror" ) == 0 )
+		{
+			float fov = 0.0f, tilt = 0.0f;
+			valid = std::sscanf( value, "%f,%f,%f,%f,%f,%f", &uniforms.mirrorRadius, &uniforms.projDistance, &uniforms.projLift, &fov, &tilt,
+								 &uniforms.domeRadius ) == 6;
+			uniforms.mirrorProjFov = float( fov * degrees );
+			uniforms.projTilt      = float( tilt * degrees );
+		}
+		else if( std::strcmp( option, "--export" ) == 0 )
+			options.exportPath = value;
+		else if( std::strcmp( option, "--grid" ) == 0 )
+			valid = parseSize( value, options.gridColumns, options.gridRows ) && options.gridColumns > 1 && options.gridRows > 1;
+		else if( std::strcmp( option, "--compare" ) == 0 )
+			options.comparePath = value;
+		else
+		{
+			std::fprintf( stderr, "Unknown option %s\n", option );
+			return false;
+		}
+		if( !valid )
+		{
+			std::fprintf( stderr, "Invalid value '%s' for %s\n", value, option );
+			return false;
+		}
+	}
+	return true;
+}
+
+// Prints the angle between each visible node of the mesh at path and the direction the output projection gives at the
+// node's position, and the nodes only one of them has visible.
+bool compareMesh( const Uniforms& uniforms, const char* path )
+{
+	BourkeMesh mesh;
+	std::string error;
+	if( !readBourkeMesh( path, mesh, error ) )
+	{
+		std::fprintf( stderr, "%s\n", error.c_str() );
+		return false;
+	}
+	const FrameConstants constants = computeFrameConstants( uniforms );
+	Fragment fragment( uniforms, constants );
+	const float aspect = mesh.aspect();
+	double largest = 0.0, sum = 0.0;
+	int compared = 0, onlyMesh = 0, onlyModel = 0;
+	for( const BourkeMeshNode& node : mesh.nodes )
+	{
+		vec3 dir;
+		bool modelVisible = outputDirection( fragment, vec2( ( node.x / aspect + 1.0f ) / 2.0f, ( node.y + 1.0f ) / 2.0f ), dir );
+		bool meshVisible  = node.intensity >= 0.0f;
+		onlyMesh += meshVisible && !modelVisible ? 1 : 0;
+		onlyModel += modelVisible && !meshVisible ? 1 : 0;
+		if( !meshVisible || !modelVisible )
+			continue;
+		vec3 meshDir  = domeMasterUvToDir( vec2( node.u, node.v ) );
+		double angle  = std::atan2( double( length( cross( meshDir, dir ) ) ), double( dot( meshDir, dir ) ) ) * 180.0 / PI;
+		largest       = std::max( largest, angle );
+		sum += angle;
+		++compared;
+	}
+	std::printf( "%s: %dx%d nodes, aspect %.4f\n", path, mesh.columns, mesh.rows, aspect );
+	std::printf( "%d nodes compared, max %.4f degrees, mean %.4f degrees\n", compared, largest, compared > 0 ? sum / compared : 0.0 );
+	std::printf( "%d nodes only visible in the mesh, %d only in the parameters\n", onlyMesh, onlyModel );
+	return true;
+}
+
+}// namespace
+
+int main( int argc, char** argv )
+{
+	Options options;
+	if( !parseOptions( argc, argv, options ) )
+	{
+		printUsage();
+		return 1;
+	}
+	const Uniforms& uniforms = options.uniforms;
+	if( options.comparePath != nullptr )
+		return compareMesh( uniforms, options.comparePath ) ? 0 : 1;
+	if( options.exportPath != nullptr )
+	{
+		BourkeMesh mesh;
+		std::string error;
+		exportBourkeMesh( uniforms, float( options.outputWidth ) / float( options.outputHeight ), options.gridColumns, options.gridRows, mesh );
+		if( !writeBourkeMesh( options.exportPath, mesh, error ) )
+		{
+			std::fprintf( stderr, "%s\n", error.c_str() );
+			return 1;
+		}
+		std::printf( "Wrote %dx%d nodes to %s\n", mesh.columns, mesh.rows, options.exportPath );
+		return 0;
+	}
+
+	const SimdLevel level = detectSimdLevel();
+	RemapTable table;
+	auto start = std::chrono::steady_clock::now();
+	bakeRemapTable( uniforms, options.outputWidth, options.outputHeight, table, level );
+	double bakeMs       = std::chrono::duration< double, std::milli >( std::chrono::steady_clock::now() - start ).count();
+	const double pixels = double( table.width ) * double( table.height );
+
+	std::printf( "%s %dx%d -> %s %dx%d, per pixel bake %.1f ms\n", projectionName( uniforms.inputProjection ), uniforms.width, uniforms.height,
+				 projectionName( uniforms.outputProjection ), options.outputWidth, options.outputHeight, bakeMs );
+	std::printf( "%-8s %8s %8s %8s %8s %10s %9s %12s %12s %10s\n", "arcmin", "cells", "interp", "exact", "empty", "evals", "build ms", "max px",
+				 "mean px", "mismatches" );
+	AdaptiveMesh mesh;
+	RemapTable rasterized;
+	CompactRemapTable compact;
+	for( double arcMinutes : { 0.25, 0.5, 1.0, 2.0, 5.0, 10.0 } )
+	{
+		start = std::chrono::steady_clock::now();
+		buildAdaptiveMesh( uniforms, options.outputWidth, options.outputHeight, arcMinutes / 60.0 * PI / 180.0, mesh, options.minCell );
+		double ms = std::chrono::duration< double, std::milli >( std::chrono::steady_clock::now() - start ).count();
+
+		rasterizeAdaptiveMesh( mesh, uniforms, rasterized, level );
+		encodeRemapTable( rasterized, RemapFormat::Float32, compact );
+		RemapError error = measureRemapError( table, compact, uniforms.width, uniforms.height );
+		// Mismatches are pixels the input projection cuts off on one side of the interpolated direction and not the other.
+		std::printf( "%-8.2f %8zu %8d %8d %8d %9.2f%% %9.1f %12.5f %12.5f %10lld\n", arcMinutes, mesh.cells.size(),
+					 mesh.count( MeshCellKind::Interpolated ), mesh.count( MeshCellKind::Exact ), mesh.count( MeshCellKind::Empty ),
+					 100.0 * double( mesh.evaluations ) / pixels, ms, error.maxPixels, error.meanPixels, error.transparencyMismatches );
+	}
+	return 0;
+}
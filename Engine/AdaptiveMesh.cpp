@@ -0,0 +1,215 @@
+#include "AdaptiveMesh.h"
+#include <algorithm>
+#include <cmath>
+
+namespace reprojection
+{
+namespace
+{
+const int SAMPLES = 5;//!< Per cell edge, at 0, 1/4, 1/2, 3/4 and 1
+
+// Linear interpolation over the triangle of corners s and t fall in, 0 1 2 below the diagonal and 0 2 3 above it, which
+// is what the GL rasterizer does with the two triangles of a cell.
+vec3 interpolateDirection( const vec3 ( &corners )[ 4 ], float s, float t )
+{
+	if( s >= t )
+		return corners[ 0 ] * ( 1.0f - s ) + corners[ 1 ] * ( s - t ) + corners[ 2 ] * t;
+	return corners[ 0 ] * ( 1.0f - t ) + corners[ 3 ] * ( t - s ) + corners[ 2 ] * s;
+}
+
+double angleBetween( vec3 a, vec3 b )
+{
+	return std::atan2( double( length( cross( a, b ) ) ), double( dot( a, b ) ) );
+}
+
+class MeshBuilder
+{
+public:
+	// Only the output projection runs, so a mirror dome input's inverse is not built for the mesh.
+	MeshBuilder( AdaptiveMesh& mesh, int minCell ) :
+		mesh( mesh ), constants( computeFrameConstants( mesh.uniforms, false ) ), fragment( mesh.uniforms, constants ), minCell( float( minCell ) )
+	{
+	}
+
+	// parent holds the samples of the parent cell when index is its child'th child. Its samples fall on every other one
+	// of the child's, so only the remaining 16 are evaluated.
+	void refine( int index, const vec3* parentDirs = nullptr, const bool* parentVisible = nullptr, int child = 0 )
+	{
+		const vec2 uv0 = mesh.cells[ index ].uv0, uv1 = mesh.cells[ index ].uv1;
+		vec3 dirs[ SAMPLES * SAMPLES ];
+		bool visible[ SAMPLES * SAMPLES ];
+		int visibleCount = 0;
+		for( int j = 0; j < SAMPLES; ++j )
+		{
+			for( int i = 0; i < SAMPLES; ++i )
+			{
+				const int sample = j * SAMPLES + i;
+				if( parentDirs != nullptr && i % 2 == 0 && j % 2 == 0 )
+				{
+					const int parentSample = ( ( child & 2 ? 2 : 0 ) + j / 2 ) * SAMPLES + ( child & 1 ? 2 : 0 ) + i / 2;
+					dirs[ sample ]         = parentDirs[ parentSample ];
+					visible[ sample ]      = parentVisible[ parentSample ];
+				}
+				else
+				{
+					vec2 uv = vec2( uv0.x + ( uv1.x - uv0.x ) * float( i ) / float( SAMPLES - 1 ), uv0.y + ( uv1.y - uv0.y ) * float( j ) / float( SAMPLES - 1 ) );
+					visible[ sample ] = outputDirection( fragment, uv, dirs[ sample ] );
+					++mesh.evaluations;
+				}
+				visibleCount += visible[ sample ] ? 1 : 0;
+			}
+		}
+
+		if( visibleCount == 0 )
+		{
+			mesh.cells[ index ].kind = MeshCellKind::Empty;
+			return;
+		}
+		if( visibleCount == SAMPLES * SAMPLES )
+		{
+			const int last = SAMPLES - 1;
+			vec3 corners[ 4 ] = { dirs[ 0 ], dirs[ last ], dirs[ last * SAMPLES + last ], dirs[ last * SAMPLES ] };
+			double error      = 0.0;
+			for( int j = 0; j < SAMPLES; ++j )
+			{
+				for( int i = 0; i < SAMPLES; ++i )
+				{
+					vec3 interpolated = interpolateDirection( corners, float( i ) / float( last ), float( j ) / float( last ) );
+					error             = std::max( error, angleBetween( interpolated, dirs[ j * SAMPLES + i ] ) );
+				}
+			}
+			if( error <= mesh.tolerance )
+			{
+				MeshCell& cell = mesh.cells[ index ];
+				cell.kind      = MeshCellKind::Interpolated;
+				std::copy( corners, corners + 4, cell.corners );
+				return;
+			}
+		}
+		if( ( uv1.x - uv0.x ) * mesh.eyeWidth < 2.0f * minCell || ( uv1.y - uv0.y ) * mesh.eyeHeight < 2.0f * minCell )
+		{
+			mesh.cells[ index ].kind = MeshCellKind::Exact;
+			return;
+		}
+
+		const vec2 mid = ( uv0 + uv1 ) * 0.5f;
+		const int first = int( mesh.cells.size() );
+		mesh.cells[ index ].children = first;
+		mesh.cells.resize( mesh.cells.size() + 4 );
+		for( int child = 0; child < 4; ++child )
+		{
+			MeshCell& cell = mesh.cells[ first + child ];
+			cell.uv0       = vec2( child & 1 ? mid.x : uv0.x, child & 2 ? mid.y : uv0.y );
+			cell.uv1       = vec2( child & 1 ? uv1.x : mid.x, child & 2 ? uv1.y : mid.y );
+		}
+		for( int child = 0; child < 4; ++child )
+			refine( first + child, dirs, visible, child );
+	}
+
+private:
+	AdaptiveMesh& mesh;
+	const FrameConstants constants;
+	Fragment fragment;
+	float minCell;
+};
+}// namespace
+
+int AdaptiveMesh::leafAt( vec2 local_uv ) const
+{
+	int column = std::min( std::max( int( local_uv.x * eyeWidth / float( MESH_ROOT_CELL ) ), 0 ), columns - 1 );
+	int row    = std::min( std::max( int( local_uv.y * eyeHeight / float( MESH_ROOT_CELL ) ), 0 ), rows - 1 );
+	int index  = row * columns + column;
+	while( cells[ index ].children >= 0 )
+	{
+		const MeshCell& cell = cells[ index ];
+		vec2 mid             = ( cell.uv0 + cell.uv1 ) * 0.5f;
+		index                = cell.children + ( local_uv.x >= mid.x ? 1 : 0 ) + ( local_uv.y >= mid.y ? 2 : 0 );
+	}
+	return index;
+}
+
+int AdaptiveMesh::count( MeshCellKind kind ) const
+{
+	return int( std::count_if( cells.begin(), cells.end(), [&]( const MeshCell& cell ) { return cell.kind == kind; } ) );
+}
+
+void buildAdaptiveMesh( const Uniforms& uniforms, int width, int height, double toleranceRadians, AdaptiveMesh& mesh, int minCell )
+{
+	mesh.uniforms        = uniforms;
+	mesh.uniforms.maxUV  = vec2( 1.0f, 1.0f );
+	mesh.width           = width;
+	mesh.height          = height;
+	mesh.eyeWidth        = uniforms.stereo == STEREO_SIDE_BY_SIDE ? float( width ) / 2.0f : float( width );
+	mesh.eyeHeight       = uniforms.stereo == STEREO_OVER_UNDER ? float( height ) / 2.0f : float( height );
+	mesh.columns         = std::max( int( std::ceil( mesh.eyeWidth / float( MESH_ROOT_CELL ) ) ), 1 );
+	mesh.rows            = std::max( int( std::ceil( mesh.eyeHeight / float( MESH_ROOT_CELL ) ) ), 1 );
+	mesh.tolerance       = toleranceRadians;
+	mesh.evaluations     = 0;
+	mesh.cells.assign( size_t( mesh.columns ) * size_t( mesh.rows ), MeshCell() );
+	for( int row = 0; row < mesh.rows; ++row )
+	{
+		for( int column = 0; column < mesh.columns; ++column )
+		{
+			MeshCell& cell = mesh.cells[ row * mesh.columns + column ];
+			cell.uv0       = vec2( float( column * MESH_ROOT_CELL ) / mesh.eyeWidth, float( row * MESH_ROOT_CELL ) / mesh.eyeHeight );
+			cell.uv1       = vec2( std::min( float( ( column + 1 ) * MESH_ROOT_CELL ) / mesh.eyeWidth, 1.0f ),
+								   std::min( float( ( row + 1 ) * MESH_ROOT_CELL ) / mesh.eyeHeight, 1.0f ) );
+		}
+	}
+
+	MeshBuilder builder( mesh, std::max( minCell, 1 ) );
+	for( int root = 0; root < mesh.columns * mesh.rows; ++root )
+		builder.refine( root );
+}
+
+void rasterizeAdaptiveMesh( const AdaptiveMesh& mesh, const Uniforms& uniforms, RemapTable& table, SimdLevel level )
+{
+	table.width  = mesh.width;
+	table.height = mesh.height;
+	table.uv.resize( size_t( mesh.width ) * size_t( mesh.height ) * 2 );
+	Uniforms mapUniforms           = uniforms;
+	mapUniforms.maxUV              = vec2( 1.0f, 1.0f );
+	const FrameConstants constants = computeFrameConstants( mapUniforms );
+
+	// Interpolated pixels get their direction from the mesh, Exact ones from the kernel like the per pixel shader
+	// draws them, in runs.
+	std::vector< float > rayX( mesh.width ), rayY( mesh.width ), rayZ( mesh.width );
+	std::vector< bool > exact( mesh.width );
+	for( int y = 0; y < mesh.height; ++y )
+	{
+		for( int x = 0; x < mesh.width; ++x )
+		{
+			// The stretch at the top of main().
+			vec2 local_uv = vec2( ( float( x ) + 0.5f ) / float( mesh.width ), ( float( y ) + 0.5f ) / float( mesh.height ) );
+			if( uniforms.stereo == STEREO_OVER_UNDER )
+				local_uv.y = local_uv.y <= 0.5f ? local_uv.y * 2.0f : ( local_uv.y - 0.5f ) * 2.0f;
+			else if( uniforms.stereo == STEREO_SIDE_BY_SIDE )
+				local_uv.x = local_uv.x <= 0.5f ? local_uv.x * 2.0f : ( local_uv.x - 0.5f ) * 2.0f;
+			const MeshCell& cell = mesh.cells[ mesh.leafAt( local_uv ) ];
+			vec3 dir             = vec3( 0.0f, 0.0f, 0.0f );
+			if( cell.kind == MeshCellKind::Interpolated )
+			{
+				float s = ( local_uv.x - cell.uv0.x ) / ( cell.uv1.x - cell.uv0.x );
+				float t = ( local_uv.y - cell.uv0.y ) / ( cell.uv1.y - cell.uv0.y );
+				dir     = normalize( interpolateDirection( cell.corners, s, t ) );
+			}
+			exact[ x ] = cell.kind == MeshCellKind::Exact;
+			rayX[ x ]  = dir.x;
+			rayY[ x ]  = dir.y;
+			rayZ[ x ]  = dir.z;
+		}
+		for( int x0 = 0; x0 < mesh.width; )
+		{
+			int x1 = x0;
+			while( x1 < mesh.width && exact[ x1 ] )
+				++x1;
+			if( x1 > x0 )
+				outputRaysRow( level, mapUniforms, constants, mesh.width, mesh.height, y, x0, x1, &rayX[ x0 ], &rayY[ x0 ], &rayZ[ x0 ] );
+			x0 = x1 + 1;
+		}
+		mapRaysRow( level, mapUniforms, constants, mesh.width, mesh.height, y, 0, mesh.width, rayX.data(), rayY.data(), rayZ.data(),
+					&table.uv[ size_t( y ) * size_t( mesh.width ) * 2 ] );
+	}
+}
+
+}// namespace reprojection
@@ -0,0 +1,63 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "Projection.h"
+#include "RemapTable.h"
+#include "Simd.h"
+
+namespace reprojection
+{
+// The output half of main() sampled on a quadtree instead of at every pixel: the GL side draws the leaves as two
+// triangles each and lets the rasterizer interpolate the directions at their corners, so the output projection only
+// runs at the vertices. A cell is split wherever the interpolated direction strays from the exact one by more than the
+// tolerance, which keeps it coarse where the mapping is smooth and takes it down to a few pixels along the mirror
+// silhouette and the other edges of the visible area. Like RayTable it does not depend on the rotation.
+// Cells are in the stretched uv main() runs the output projection at, so both halves of a stereo frame share them.
+enum class MeshCellKind : uint8_t
+{
+	Split,       //!< Has children, see MeshCell::children
+	Empty,       //!< Transparent at every sample, cleared instead of drawn
+	Interpolated,//!< Within tolerance at every sample, drawn as two triangles with interpolated directions
+	Exact        //!< Smallest size and still over tolerance or partly transparent, drawn per pixel
+};
+
+struct MeshCell
+{
+	vec2 uv0;//!< Bottom left corner in the stretched uv
+	vec2 uv1;//!< Top right corner
+	int children      = -1;//!< Index of the first of four, bottom left, bottom right, top left, top right
+	MeshCellKind kind = MeshCellKind::Split;
+	// Exact unrotated directions at uv0, ( uv1.x, uv0.y ), uv1 and ( uv0.x, uv1.y ). Only set for Interpolated.
+	// The triangles are corners 0 1 2 and 0 2 3, the same split interpolateDirection() uses.
+	vec3 corners[ 4 ];
+};
+
+struct AdaptiveMesh
+{
+	// Index of the leaf holding local_uv, a stretched uv in [0, 1].
+	int leafAt( vec2 local_uv ) const;
+	int count( MeshCellKind kind ) const;
+
+	Uniforms uniforms;//!< What the mesh was built for, see sameRays()
+	int width        = 0;//!< Size of the output frame
+	int height       = 0;
+	float eyeWidth   = 0.0f;//!< Output pixels the stretched uv square spans, one eye for stereo
+	float eyeHeight  = 0.0f;
+	int columns      = 0;//!< Root cells of MESH_ROOT_CELL pixels, the first columns x rows entries of cells, bottom row first
+	int rows         = 0;
+	double tolerance = 0.0;//!< Largest angle between an interpolated and the exact direction, in radians
+	long long evaluations = 0;//!< Output projection evaluations it took to build
+	std::vector< MeshCell > cells;
+};
+
+const int MESH_ROOT_CELL = 32;//!< Edge of the root cells in output pixels
+
+// Builds the mesh of a width x height output for uniforms. Each cell is checked at 5 x 5 samples and split while one
+// of them is off by more than toleranceRadians or visibility changes between them, down to minCell pixels.
+void buildAdaptiveMesh( const Uniforms& uniforms, int width, int height, double toleranceRadians, AdaptiveMesh& mesh, int minCell = 4 );
+
+// The RemapTable the GL side's drawing of mesh amounts to, for uniforms with the same rays as the mesh, through the
+// level's kernel. Compare it with bakeRemapTable() to see what the tolerance costs, see measureRemapError().
+void rasterizeAdaptiveMesh( const AdaptiveMesh& mesh, const Uniforms& uniforms, RemapTable& table, SimdLevel level );
+
+}// namespace reprojection
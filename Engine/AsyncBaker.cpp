@@ -0,0 +1,89 @@
+#include "AsyncBaker.h"
+#include <algorithm>
+#include <chrono>
+
+namespace reprojection
+{
+AsyncBaker::AsyncBaker( SimdLevel level, int threadCount ) : level( level ), executor( threadCount ), worker( [this]() { workerLoop(); } ) {}
+
+AsyncBaker::~AsyncBaker()
+{
+	{
+		std::lock_guard< std::mutex > lock( mutex );
+		stopping = true;
+	}
+	wake.notify_one();
+	worker.join();
+}
+
+void AsyncBaker::request( const Uniforms& uniforms, int width, int height )
+{
+	{
+		std::lock_guard< std::mutex > lock( mutex );
+		if( hasRequest )
+			++counters.coalesced;
+		++counters.requested;
+		requestUniforms = uniforms;
+		requestWidth    = width;
+		requestHeight   = height;
+		hasRequest      = true;
+	}
+	wake.notify_one();
+}
+
+bool AsyncBaker::take( RemapTable& table )
+{
+	std::lock_guard< std::mutex > lock( mutex );
+	if( !hasReady )
+		return false;
+	std::swap( table, ready );
+	hasReady = false;
+	return true;
+}
+
+bool AsyncBaker::busy() const
+{
+	std::lock_guard< std::mutex > lock( mutex );
+	return hasRequest || baking;
+}
+
+AsyncBaker::Stats AsyncBaker::stats() const
+{
+	std::lock_guard< std::mutex > lock( mutex );
+	return counters;
+}
+
+void AsyncBaker::workerLoop()
+{
+	std::unique_lock< std::mutex > lock( mutex );
+	for( ;; )
+	{
+		wake.wait( lock, [this]() { return hasRequest || stopping; } );
+		if( stopping )
+			return;
+		const Uniforms uniforms = requestUniforms;
+		const int width         = requestWidth;
+		const int height        = requestHeight;
+		hasRequest              = false;
+		baking                  = true;
+		lock.unlock();
+
+		auto start = std::chrono::steady_clock::now();
+		if( rays.width != width || rays.height != height || !sameRays( uniforms, rays.uniforms ) )
+			bakeRayTable( uniforms, width, height, rays, executor, level );
+		mapRayTable( uniforms, rays, back, executor, level );
+		double milliseconds = std::chrono::duration< double, std::milli >( std::chrono::steady_clock::now() - start ).count();
+
+		lock.lock();
+		std::swap( ready, back );
+		if( hasReady )
+			++counters.dropped;
+		hasReady = true;
+		baking   = false;
+		++counters.completed;
+		counters.lastBakeMs = milliseconds;
+		counters.maxBakeMs  = std::max( counters.maxBakeMs, milliseconds );
+	}
+}
+
+}// namespace reprojection
@@ -0,0 +1,81 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include "Projection.h"
+#include "RayTable.h"
+#include "RemapTable.h"
+#include "Simd.h"
+#include "TileExecutor.h"
+
+namespace reprojection
+{
+// Bakes RemapTables on a worker thread, so the thread drawing frames never waits for one. An 8K mirror dome bake
+// takes hundreds of milliseconds, far longer than a frame, so the caller keeps drawing with the last table it took
+// while the next one is baked.
+//
+// Three tables take turns: the worker bakes into its back table, publishes it by swapping it with the ready table,
+// and take() swaps the ready table with the caller's. Every swap is a pointer exchange under the mutex, so a table
+// changes hands whole or not at all.
+//
+// Only the newest request matters. A request that arrives while another one still waits replaces it (coalesced), and a
+// finished table that the caller did not take before the next one finished is thrown away (dropped). The bake in
+// flight is never abandoned, so however fast the requests come:
+// - a request is finished at most two bake durations after it is made, the rest of the bake in flight plus its own;
+// - while requests keep coming, a new table is finished every bake duration.
+// The worker keeps a RayTable of its own, so requests that only change the rotation bake at mapRayTable() cost.
+class AsyncBaker
+{
+public:
+	struct Stats
+	{
+		uint64_t requested = 0;//!< request() calls
+		uint64_t completed = 0;//!< Bakes finished
+		uint64_t coalesced = 0;//!< Requests replaced by a newer one before the worker started on them
+		uint64_t dropped   = 0;//!< Finished tables replaced by a newer one before take()
+		double lastBakeMs  = 0.0;
+		double maxBakeMs   = 0.0;
+	};
+
+	// threadCount is the TileExecutor's, 1 bakes on the worker thread alone.
+	AsyncBaker( SimdLevel level, int threadCount = 1 );
+	~AsyncBaker();//!< Waits for the bake in flight
+	AsyncBaker( const AsyncBaker& ) = delete;
+	AsyncBaker& operator=( const AsyncBaker& ) = delete;
+
+	// Asks for the table of uniforms at width x height, see bakeRemapTable(). Never waits for the worker.
+	void request( const Uniforms& uniforms, int width, int height );
+	// Swaps the newest finished table into table and returns true, or returns false if none finished since the last
+	// call. The worker bakes into table's old buffer next. Never waits for the worker.
+	bool take( RemapTable& table );
+	// True while a request waits or is being baked.
+	bool busy() const;
+	Stats stats() const;
+
+private:
+	void workerLoop();
+
+	SimdLevel level;
+	TileExecutor executor;
+
+	mutable std::mutex mutex;
+	std::condition_variable wake;
+	Uniforms requestUniforms;//!< Newest request, valid while hasRequest
+	int requestWidth  = 0;
+	int requestHeight = 0;
+	bool hasRequest   = false;
+	bool baking       = false;
+	RemapTable ready;//!< Newest finished table, valid while hasReady
+	bool hasReady = false;
+	bool stopping = false;
+	Stats counters;
+
+	// Only touched by the worker.
+	RayTable rays;
+	RemapTable back;
+
+	std::thread worker;//!< Last, so it starts once everything above is constructed
+};
+
+}// namespace reprojection
@@ -0,0 +1,122 @@
+#include "BourkeMesh.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace reprojection
+{
+float BourkeMesh::aspect() const
+{
+	float largest = 0.0f;
+	for( const BourkeMeshNode& node : nodes )
+		largest = std::max( largest, std::fabs( node.x ) );
+	return largest > 0.0f ? largest : 1.0f;
+}
+
+vec3 domeMasterUvToDir( vec2 uv )
+{
+	vec2 pos    = 2.0f * uv - 1.0f;
+	float r     = length( pos );
+	float theta = r * ( PI / 2.0f );
+	vec2 around = r > 0.0f ? pos / r : vec2( 0.0f, 0.0f );
+	return vec3( std::sin( theta ) * around.x, std::sin( theta ) * around.y, std::cos( theta ) );
+}
+
+vec2 dirToDomeMasterUv( vec3 dir )
+{
+	float axisDistance = length( vec2( dir.x, dir.y ) );
+	float theta        = std::atan2( axisDistance, dir.z );
+	vec2 around        = axisDistance > 0.0f ? vec2( dir.x, dir.y ) / axisDistance : vec2( 0.0f, 0.0f );
+	return ( theta / ( PI / 2.0f ) * around + 1.0f ) / 2.0f;
+}
+
+void exportBourkeMesh( const Uniforms& uniforms, float aspect, int columns, int rows, BourkeMesh& mesh )
+{
+	Uniforms monoUniforms          = uniforms;
+	monoUniforms.stereo            = STEREO_NONE;
+	monoUniforms.maxUV             = vec2( 1.0f, 1.0f );
+	// The output half alone, so a mirror dome input's inverse is not built for it.
+	const FrameConstants constants = computeFrameConstants( monoUniforms, false );
+	Fragment fragment( monoUniforms, constants );
+
+	mesh.type    = 2;
+	mesh.columns = columns;
+	mesh.rows    = rows;
+	mesh.nodes.resize( size_t( columns ) * size_t( rows ) );
+	for( int row = 0; row < rows; ++row )
+	{
+		for( int column = 0; column < columns; ++column )
+		{
+			vec2 uv              = vec2( float( column ) / float( columns - 1 ), float( row ) / float( rows - 1 ) );
+			BourkeMeshNode& node = mesh.nodes[ size_t( row ) * size_t( columns ) + size_t( column ) ];
+			node.x               = ( uv.x * 2.0f - 1.0f ) * aspect;
+			node.y               = uv.y * 2.0f - 1.0f;
+			vec3 dir;
+			if( outputDirection( fragment, uv, dir ) )
+			{
+				vec2 domeUv    = dirToDomeMasterUv( dir );
+				node.u         = domeUv.x;
+				node.v         = domeUv.y;
+				node.intensity = 1.0f;
+			}
+			else
+			{
+				node.u = node.v = 0.0f;
+				node.intensity  = -1.0f;
+			}
+		}
+	}
+}
+
+bool readBourkeMesh( const std::string& path, BourkeMesh& mesh, std::string& error )
+{
+	FILE* file = std::fopen( path.c_str(), "r" );
+	if( file == nullptr )
+	{
+		error = "Cannot open " + path;
+		return false;
+	}
+	bool complete = std::fscanf( file, "%d %d %d", &mesh.type, &mesh.columns, &mesh.rows ) == 3 && mesh.columns > 1 && mesh.rows > 1 &&
+					mesh.columns <= 4096 && mesh.rows <= 4096;
+	if( complete )
+	{
+		mesh.nodes.resize( size_t( mesh.columns ) * size_t( mesh.rows ) );
+		for( BourkeMeshNode& node : mesh.nodes )
+		{
+			if( std::fscanf( file, "%f %f %f %f %f", &node.x, &node.y, &node.u, &node.v, &node.intensity ) != 5 )
+			{
+				complete = false;
+				break;
+			}
+		}
+	}
+	std::fclose( file );
+	if( !complete )
+	{
+		error = path + " is not a complete warp mesh";
+		mesh.nodes.clear();
+		mesh.columns = mesh.rows = 0;
+	}
+	return complete;
+}
+
+bool writeBourkeMesh( const std::string& path, const BourkeMesh& mesh, std::string& error )
+{
+	FILE* file = std::fopen( path.c_str(), "w" );
+	if( file == nullptr )
+	{
+		error = "Cannot create " + path;
+		return false;
+	}
+	std::fprintf( file, "%d\n%d %d\n", mesh.type, mesh.columns, mesh.rows );
+	for( const BourkeMeshNode& node : mesh.nodes )
+		std::fprintf( file, "%.6f %.6f %.6f %.6f %.4f\n", node.x, node.y, node.u, node.v, node.intensity );
+	if( std::fclose( file ) != 0 )
+	{
+		error = "Cannot write " + path;
+		return false;
+	}
+	return true;
+}
+
+}// namespace reprojection
@@ -0,0 +1,51 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "Projection.h"
+
+namespace reprojection
+{
+// Warp meshes in the text format of Paul Bourke's fulldome tools (.data). The first line holds the mesh type, 1 for a
+// rectangular and 2 for a polar mesh, the second the node count across and up, and every line after that one node:
+//
+//     x y u v i
+//
+// x and y place the node in the projector frame, x in [-aspect, aspect] and y in [-1, 1], rows run bottom-up and
+// nodes left to right within a row. u and v are where the node samples the dome master, a 180 degree angular fisheye
+// of the dome with the zenith in the middle, see domeMasterUvToDir(). i scales the brightness of the node, and a
+// negative i leaves the cells around the node out of the mesh.
+struct BourkeMeshNode
+{
+	float x         = 0.0f;
+	float y         = 0.0f;
+	float u         = 0.0f;
+	float v         = 0.0f;
+	float intensity = 1.0f;
+};
+
+struct BourkeMesh
+{
+	// Half the width of the projector frame in the units of x, the largest |x| of any node. 1 for an empty mesh.
+	float aspect() const;
+
+	int type    = 2;
+	int columns = 0;
+	int rows    = 0;
+	std::vector< BourkeMeshNode > nodes;//!< columns x rows, bottom row first
+};
+
+// The dome master is in the frame mirrorDomeUvToDir() returns its directions in: zenith +Z in the middle of the image,
+// +X to the right and +Y up. The radius is proportional to the angle from the zenith, 90 degrees at the edge.
+vec3 domeMasterUvToDir( vec2 uv );
+vec2 dirToDomeMasterUv( vec3 dir );
+
+// Samples the output projection of uniforms, normally the mirror dome, at columns x rows nodes spread evenly over a
+// projector frame aspect times as wide as it is high. Nodes the output projection makes transparent get intensity -1,
+// the visible ones 1: the analytic model has no brightness falloff to put there.
+void exportBourkeMesh( const Uniforms& uniforms, float aspect, int columns, int rows, BourkeMesh& mesh );
+
+// Returns false and describes the problem in error when the file cannot be opened or does not hold a complete mesh.
+bool readBourkeMesh( const std::string& path, BourkeMesh& mesh, std::string& error );
+bool writeBourkeMesh( const std::string& path, const BourkeMesh& mesh, std::string& error );
+
+}// namespace reprojection
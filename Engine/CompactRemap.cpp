@@ -0,0 +1,379 @@
+#include "CompactRemap.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace reprojection
+{
+namespace
+{
+bool isTransparent( const float* uv )
+{
+	return uv[ 0 ] == SET_TO_TRANSPARENT.x && uv[ 1 ] == SET_TO_TRANSPARENT.y;
+}
+
+int tileColumns( int width )
+{
+	return ( width + FIXED16_TILE - 1 ) / FIXED16_TILE;
+}
+
+int segmentsPerRow( int width )
+{
+	return ( width + DELTA_SEGMENT - 1 ) / DELTA_SEGMENT;
+}
+
+void encodeHalf( const RemapTable& table, CompactRemapTable& compact )
+{
+	compact.codes.resize( table.uv.size() );
+	for( size_t i = 0; i < table.uv.size(); i += 2 )
+	{
+		bool transparent       = isTransparent( &table.uv[ i ] );
+		compact.codes[ i ]     = transparent ? TRANSPARENT_CODE : floatToHalf( table.uv[ i ] );
+		compact.codes[ i + 1 ] = transparent ? TRANSPARENT_CODE : floatToHalf( table.uv[ i + 1 ] );
+	}
+}
+
+// Each tile stores the bounding box of its visible uv, and each pixel its position in that box in 65534 steps.
+void encodeFixed16( const RemapTable& table, CompactRemapTable& compact )
+{
+	const int columns = tileColumns( table.width );
+	const int rows    = ( table.height + FIXED16_TILE - 1 ) / FIXED16_TILE;
+	compact.values.assign( size_t( columns ) * size_t( rows ) * 4, 0.0f );
+	compact.codes.assign( table.uv.size(), TRANSPARENT_CODE );
+	for( int row = 0; row < rows; ++row )
+	{
+		for( int column = 0; column < columns; ++column )
+		{
+			const int x0 = column * FIXED16_TILE, x1 = std::min( x0 + FIXED16_TILE, table.width );
+			const int y0 = row * FIXED16_TILE, y1 = std::min( y0 + FIXED16_TILE, table.height );
+			float minU = 1e30f, minV = 1e30f, maxU = -1e30f, maxV = -1e30f;
+			for( int y = y0; y < y1; ++y )
+			{
+				for( int x = x0; x < x1; ++x )
+				{
+					const float* uv = &table.uv[ ( size_t( y ) * size_t( table.width ) + size_t( x ) ) * 2 ];
+					if( isTransparent( uv ) )
+						continue;
+					minU = std::min( minU, uv[ 0 ] );
+					maxU = std::max( maxU, uv[ 0 ] );
+					minV = std::min( minV, uv[ 1 ] );
+					maxV = std::max( maxV, uv[ 1 ] );
+				}
+			}
+			float* range = &compact.values[ ( size_t( row ) * size_t( columns ) + size_t( column ) ) * 4 ];
+			if( minU > maxU )
+				continue;// Nothing visible, every code is TRANSPARENT_CODE
+			range[ 0 ] = minU;
+			range[ 1 ] = minV;
+			range[ 2 ] = maxU - minU;
+			range[ 3 ] = maxV - minV;
+			auto quantize = []( float value, float origin, float extent ) {
+				return extent > 0.0f ? uint16_t( std::lround( double( value - origin ) / extent * 65534.0 ) ) : uint16_t( 0 );
+			};
+			for( int y = y0; y < y1; ++y )
+			{
+				for( int x = x0; x < x1; ++x )
+				{
+					size_t i = ( size_t( y ) * size_t( table.width ) + size_t( x ) ) * 2;
+					if( isTransparent( &table.uv[ i ] ) )
+						continue;
+					compact.codes[ i ]     = quantize( table.uv[ i ], range[ 0 ], range[ 2 ] );
+					compact.codes[ i + 1 ] = quantize( table.uv[ i + 1 ], range[ 1 ], range[ 3 ] );
+				}
+			}
+		}
+	}
+}
+
+// Delta codes each pixel as the difference to a prediction from the visible pixels to its left, in steps of
+// 1 / DELTA_SCALE: the two left neighbours extrapolated linearly, the left neighbour alone, or 0 right after a restart.
+// Residuals are zigzag varints, so the usual ones of under 64 steps take a byte per axis:
+//   varint( zigzag( u residual ) + 1 ), varint( zigzag( v residual ) )   a visible pixel
+//   0, varint( n )                                                       n transparent pixels, which restarts the prediction
+// Every segment starts with a restart, so it decodes without the ones before it.
+struct DeltaPredictor
+{
+	int32_t predict( int32_t previous, int32_t beforePrevious ) const
+	{
+		return history >= 2 ? 2 * previous - beforePrevious : history == 1 ? previous : 0;
+	}
+	void push( int32_t u, int32_t v )
+	{
+		beforePreviousU = previousU;
+		beforePreviousV = previousV;
+		previousU       = u;
+		previousV       = v;
+		history         = std::min( history + 1, 2 );
+	}
+
+	int history       = 0;//!< Visible pixels since the last restart, capped at 2
+	int32_t previousU = 0, previousV = 0;
+	int32_t beforePreviousU = 0, beforePreviousV = 0;
+};
+
+void appendVarint( std::vector< uint8_t >& stream, uint32_t value )
+{
+	while( value >= 0x80u )
+	{
+		stream.push_back( uint8_t( value | 0x80u ) );
+		value >>= 7;
+	}
+	stream.push_back( uint8_t( value ) );
+}
+
+uint32_t readVarint( const uint8_t*& p )
+{
+	uint32_t value = 0;
+	for( int shift = 0;; shift += 7 )
+	{
+		uint8_t byte = *p++;
+		value |= uint32_t( byte & 0x7Fu ) << shift;
+		if( ( byte & 0x80u ) == 0 )
+			return value;
+	}
+}
+
+uint32_t zigzag( int32_t value )
+{
+	return ( uint32_t( value ) << 1 ) ^ uint32_t( value >> 31 );
+}
+
+int32_t unzigzag( uint32_t value )
+{
+	return int32_t( value >> 1 ) ^ -int32_t( value & 1u );
+}
+
+void encodeDelta( const RemapTable& table, CompactRemapTable& compact )
+{
+	const int segments = segmentsPerRow( table.width );
+	compact.stream.clear();
+	compact.stream.reserve( table.uv.size() + table.uv.size() / 4 );
+	compact.offsets.resize( size_t( segments ) * size_t( table.height ) );
+	for( int y = 0; y < table.height; ++y )
+	{
+		for( int segment = 0; segment < segments; ++segment )
+		{
+			compact.offsets[ size_t( y ) * size_t( segments ) + size_t( segment ) ] = uint32_t( compact.stream.size() );
+			const int x0 = segment * DELTA_SEGMENT, x1 = std::min( x0 + DELTA_SEGMENT, table.width );
+			DeltaPredictor predictor;
+			uint32_t transparentRun = 0;
+			for( int x = x0; x <= x1; ++x )
+			{
+				const float* uv = x < x1 ? &table.uv[ ( size_t( y ) * size_t( table.width ) + size_t( x ) ) * 2 ] : nullptr;
+				if( uv != nullptr && isTransparent( uv ) )
+				{
+					++transparentRun;
+					predictor.history = 0;
+					continue;
+				}
+				if( transparentRun > 0 )
+				{
+					compact.stream.push_back( 0 );
+					appendVarint( compact.stream, transparentRun );
+					transparentRun = 0;
+				}
+				if( uv == nullptr )
+					break;
+				int32_t u = int32_t( std::lround( double( uv[ 0 ] ) * DELTA_SCALE ) );
+				int32_t v = int32_t( std::lround( double( uv[ 1 ] ) * DELTA_SCALE ) );
+				appendVarint( compact.stream, zigzag( u - predictor.predict( predictor.previousU, predictor.beforePreviousU ) ) + 1u );
+				appendVarint( compact.stream, zigzag( v - predictor.predict( predictor.previousV, predictor.beforePreviousV ) ) );
+				predictor.push( u, v );
+			}
+		}
+	}
+	compact.stream.shrink_to_fit();
+}
+
+// Decodes the segment's pixels up to x1 or its end, writing those from x0 on.
+void decodeDeltaSegment( const CompactRemapTable& compact, int y, int segment, int x0, int x1, float*& uv )
+{
+	const int segments = segmentsPerRow( compact.width );
+	const uint8_t* p   = &compact.stream[ compact.offsets[ size_t( y ) * size_t( segments ) + size_t( segment ) ] ];
+	DeltaPredictor predictor;
+	int x         = segment * DELTA_SEGMENT;
+	const int end = std::min( x + DELTA_SEGMENT, x1 );
+	while( x < end )
+	{
+		uint32_t first = readVarint( p );
+		if( first == 0 )
+		{
+			predictor.history = 0;
+			for( uint32_t count = readVarint( p ); count > 0 && x < end; --count, ++x )
+			{
+				if( x < x0 )
+					continue;
+				*uv++ = SET_TO_TRANSPARENT.x;
+				*uv++ = SET_TO_TRANSPARENT.y;
+			}
+			continue;
+		}
+		int32_t u = predictor.predict( predictor.previousU, predictor.beforePreviousU ) + unzigzag( first - 1u );
+		int32_t v = predictor.predict( predictor.previousV, predictor.beforePreviousV ) + unzigzag( readVarint( p ) );
+		predictor.push( u, v );
+		if( x >= x0 )
+		{
+			*uv++ = float( u ) / DELTA_SCALE;
+			*uv++ = float( v ) / DELTA_SCALE;
+		}
+		++x;
+	}
+}
+
+void renderCompactTile( const CompactRemapTable& table, const Image& source, Image& destination, const Tile& tile )
+{
+	const vec4 TRANSPARENT_PIXEL = vec4( 0.0f, 0.0f, 0.0f, 0.0f );
+	std::vector< float > uv( size_t( tile.x1 - tile.x0 ) * 2 );
+	for( int y = tile.y0; y < tile.y1; ++y )
+	{
+		table.decodeRow( y, tile.x0, tile.x1, uv.data() );
+		for( int x = tile.x0; x < tile.x1; ++x )
+		{
+			vec2 sourcePixel( uv[ size_t( x - tile.x0 ) * 2 ], uv[ size_t( x - tile.x0 ) * 2 + 1 ] );
+			if( sourcePixel == SET_TO_TRANSPARENT )
+				destination.store( x, y, TRANSPARENT_PIXEL );
+			else
+				destination.store( x, y, texture( source, sourcePixel ) );
+		}
+	}
+}
+}// namespace
+
+const char* remapFormatName( RemapFormat format )
+{
+	switch( format )
+	{
+	case RemapFormat::Half:
+		return "half";
+	case RemapFormat::Fixed16:
+		return "fixed16";
+	case RemapFormat::Delta:
+		return "delta";
+	default:
+		return "float32";
+	}
+}
+
+void CompactRemapTable::decodeRow( int y, int x0, int x1, float* uv ) const
+{
+	const size_t rowStart = size_t( y ) * size_t( width ) * 2;
+	switch( format )
+	{
+	case RemapFormat::Float32:
+		std::memcpy( uv, &values[ rowStart + size_t( x0 ) * 2 ], size_t( x1 - x0 ) * 2 * sizeof( float ) );
+		return;
+	case RemapFormat::Half:
+		for( size_t i = rowStart + size_t( x0 ) * 2; i < rowStart + size_t( x1 ) * 2; i += 2 )
+		{
+			bool transparent = codes[ i ] == TRANSPARENT_CODE;
+			*uv++            = transparent ? SET_TO_TRANSPARENT.x : halfToFloat( codes[ i ] );
+			*uv++            = transparent ? SET_TO_TRANSPARENT.y : halfToFloat( codes[ i + 1 ] );
+		}
+		return;
+	case RemapFormat::Fixed16:
+	{
+		const float* tileRow = &values[ size_t( y / FIXED16_TILE ) * size_t( tileColumns( width ) ) * 4 ];
+		for( int x = x0; x < x1; ++x )
+		{
+			const float* range = tileRow + size_t( x / FIXED16_TILE ) * 4;
+			size_t i           = rowStart + size_t( x ) * 2;
+			bool transparent   = codes[ i ] == TRANSPARENT_CODE;
+			*uv++              = transparent ? SET_TO_TRANSPARENT.x : range[ 0 ] + float( codes[ i ] ) * ( range[ 2 ] / 65534.0f );
+			*uv++              = transparent ? SET_TO_TRANSPARENT.y : range[ 1 ] + float( codes[ i + 1 ] ) * ( range[ 3 ] / 65534.0f );
+		}
+		return;
+	}
+	case RemapFormat::Delta:
+		for( int segment = x0 / DELTA_SEGMENT; segment * DELTA_SEGMENT < x1; ++segment )
+			decodeDeltaSegment( *this, y, segment, x0, x1, uv );
+		return;
+	}
+}
+
+size_t CompactRemapTable::bytes() const
+{
+	return values.size() * sizeof( float ) + codes.size() * sizeof( uint16_t ) + stream.size() + offsets.size() * sizeof( uint32_t );
+}
+
+void encodeRemapTable( const RemapTable& table, RemapFormat format, CompactRemapTable& compact )
+{
+	compact.format = format;
+	compact.width  = table.width;
+	compact.height = table.height;
+	compact.values.clear();
+	compact.codes.clear();
+	compact.stream.clear();
+	compact.offsets.clear();
+	switch( format )
+	{
+	case RemapFormat::Float32:
+		compact.values = table.uv;
+		break;
+	case RemapFormat::Half:
+		encodeHalf( table, compact );
+		break;
+	case RemapFormat::Fixed16:
+		encodeFixed16( table, compact );
+		break;
+	case RemapFormat::Delta:
+		encodeDelta( table, compact );
+		break;
+	}
+}
+
+RemapError measureRemapError( const RemapTable& table, const CompactRemapTable& compact, int sourceWidth, int sourceHeight )
+{
+	RemapError error;
+	std::vector< float > decoded( size_t( table.width ) * 2 );
+	double sum        = 0.0;
+	long long visible = 0;
+	for( int y = 0; y < table.height; ++y )
+	{
+		compact.decodeRow( y, 0, table.width, decoded.data() );
+		const float* exact = &table.uv[ size_t( y ) * size_t( table.width ) * 2 ];
+		for( size_t i = 0; i < decoded.size(); i += 2 )
+		{
+			bool exactTransparent = isTransparent( &exact[ i ] ), decodedTransparent = isTransparent( &decoded[ i ] );
+			if( exactTransparent != decodedTransparent )
+				++error.transparencyMismatches;
+			if( exactTransparent || decodedTransparent )
+				continue;
+			double dx        = ( double( decoded[ i ] ) - exact[ i ] ) * sourceWidth;
+			double dy        = ( double( decoded[ i + 1 ] ) - exact[ i + 1 ] ) * sourceHeight;
+			double distance  = std::sqrt( dx * dx + dy * dy );
+			error.maxPixels  = std::max( error.maxPixels, distance );
+			sum             += distance;
+			++visible;
+		}
+	}
+	error.meanPixels = visible > 0 ? sum / double( visible ) : 0.0;
+	return error;
+}
+
+RemapFormat smallestRemapFormat( const RemapTable& table, int sourceWidth, int sourceHeight, double maxErrorPixels, CompactRemapTable& compact )
+{
+	encodeRemapTable( table, RemapFormat::Float32, compact );
+	CompactRemapTable candidate;
+	for( int format = 1; format < REMAP_FORMAT_COUNT; ++format )
+	{
+		encodeRemapTable( table, RemapFormat( format ), candidate );
+		if( candidate.bytes() >= compact.bytes() )
+			continue;
+		RemapError error = measureRemapError( table, candidate, sourceWidth, sourceHeight );
+		if( error.maxPixels <= maxErrorPixels && error.transparencyMismatches == 0 )
+			std::swap( compact, candidate );
+	}
+	return compact.format;
+}
+
+void renderRemapped( const CompactRemapTable& table, const Image& source, Image& destination )
+{
+	renderCompactTile( table, source, destination, Tile{ 0, 0, destination.width, destination.height } );
+}
+
+void renderRemapped( const CompactRemapTable& table, const Image& source, Image& destination, TileExecutor& executor )
+{
+	executor.run( destination.width, destination.height, [&]( const Tile& tile ) { renderCompactTile( table, source, destination, tile ); } );
+}
+
+}// namespace reprojection
@@ -0,0 +1,67 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Image.h"
+#include "RemapTable.h"
+#include "TileExecutor.h"
+
+namespace reprojection
+{
+// Smaller encodings of a RemapTable. At RG32F an 8K x 4K output takes 256 MB, and the precision it carries is far
+// beyond what a bilinear fetch from any real source resolves. measureRemapError() reports what each encoding costs
+// in source pixels so the smallest one within budget can be picked, see smallestRemapFormat().
+enum class RemapFormat
+{
+	Float32,//!< The RemapTable as is, 8 bytes per pixel
+	Half,   //!< IEEE half floats, 4 bytes per pixel. Steps of 1 / 2048 near 1, so only fit for small sources
+	Fixed16,//!< 16 bit unorm relative to the range of a FIXED16_TILE square, 4 bytes per pixel plus 16 per tile
+	Delta   //!< Quantized to 1 / DELTA_SCALE and predicted from the pixels to the left, 2 to 3 bytes per pixel at typical scales
+};
+const int REMAP_FORMAT_COUNT = 4;
+const char* remapFormatName( RemapFormat format );
+
+// Replaces SET_TO_TRANSPARENT in the 16 bit formats. 0xFFFF is a NaN as a half float and the top code as a unorm,
+// neither of which a visible pixel encodes to. Decoding turns it back into SET_TO_TRANSPARENT.
+const uint16_t TRANSPARENT_CODE = 0xFFFF;
+
+const int FIXED16_TILE  = 32;       //!< Edge of the squares Fixed16 stores one range for
+const int DELTA_SEGMENT = 64;       //!< Delta restarts its prediction every this many pixels of a row, so a tile decodes on its own
+const float DELTA_SCALE = 262144.0f;//!< Delta's quantization steps per unit of uv
+
+struct CompactRemapTable
+{
+	// Decodes pixels x0 .. x1 - 1 of row y to interleaved ( u, v ) pairs like RemapTable::uv holds them.
+	void decodeRow( int y, int x0, int x1, float* uv ) const;
+	size_t bytes() const;
+
+	RemapFormat format = RemapFormat::Float32;
+	int width          = 0;
+	int height         = 0;
+	std::vector< float > values;    //!< Float32: the table's uv. Fixed16: origin u, v and extent u, v per tile, rows of tiles bottom first
+	std::vector< uint16_t > codes;  //!< Half and Fixed16: two per pixel, bottom row first
+	std::vector< uint8_t > stream;  //!< Delta: the encoded segments one after the other, bottom row first
+	std::vector< uint32_t > offsets;//!< Delta: where each segment starts in stream
+};
+
+void encodeRemapTable( const RemapTable& table, RemapFormat format, CompactRemapTable& compact );
+
+struct RemapError
+{
+	double maxPixels  = 0.0;//!< Largest distance between the exact and the decoded source position, in source pixels
+	double meanPixels = 0.0;//!< Over the pixels that are visible in both
+	long long transparencyMismatches = 0;//!< Pixels visible in one and transparent in the other, 0 for every format here
+};
+
+// Compares compact against the table it was encoded from, for a sourceWidth x sourceHeight source.
+RemapError measureRemapError( const RemapTable& table, const CompactRemapTable& compact, int sourceWidth, int sourceHeight );
+
+// Encodes table in every format and keeps the smallest whose measureRemapError() stays within maxErrorPixels in
+// compact. Float32 always does, so something is always returned.
+RemapFormat smallestRemapFormat( const RemapTable& table, int sourceWidth, int sourceHeight, double maxErrorPixels, CompactRemapTable& compact );
+
+// renderRemapped() through a compact table, destination must be table sized.
+void renderRemapped( const CompactRemapTable& table, const Image& source, Image& destination );
+void renderRemapped( const CompactRemapTable& table, const Image& source, Image& destination, TileExecutor& executor );
+
+}// namespace reprojection
@@ -0,0 +1,228 @@
+#include "Engine.h"
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#include "StereoEyes.h"
+
+namespace reprojection
+{
+namespace
+{
+// The bilinear fetch at sourcePixel, with the second sample of a DUAL_FISHEYE seam mixed in like the shader does.
+template< class Source >
+vec4 fetch( const Source& source, vec2 sourcePixel, vec2 seamPixel, float seamWeight )
+{
+	vec4 color = texture( source, sourcePixel );
+	if( seamWeight > 0.0f )
+		color = mix( color, texture( source, seamPixel ), seamWeight );
+	return color;
+}
+
+void renderReferenceTile( const Uniforms& uniforms, const FrameConstants& constants, const Image& source, Image& destination, const Tile& tile )
+{
+	const vec4 TRANSPARENT_PIXEL      = vec4( 0.0f, 0.0f, 0.0f, 0.0f );
+	const ReprojectFunction reproject = reprojectFunction( uniforms.inputProjection, uniforms.outputProjection );
+	Fragment fragment( uniforms, constants );
+	for( int y = tile.y0; y < tile.y1; ++y )
+	{
+		for( int x = tile.x0; x < tile.x1; ++x )
+		{
+			vec2 uv          = vec2( ( x + 0.5f ) / destination.width, ( y + 0.5f ) / destination.height );
+			vec2 sourcePixel = reproject( fragment, uv );
+			if( sourcePixel == SET_TO_TRANSPARENT )
+				destination.store( x, y, TRANSPARENT_PIXEL );
+			else
+				destination.store( x, y, fetch( source, sourcePixel, fragment.seamPixel, fragment.seamWeight ) );
+		}
+	}
+}
+
+// destination holds rows firstRow .. firstRow + destination.height - 1 of a frameWidth x frameHeight output.
+template< class Source >
+void renderTile( SimdLevel level, const Uniforms& uniforms, const FrameConstants& constants, const Source& source, Image& destination, int frameWidth,
+				 int frameHeight, int firstRow, const Tile& tile )
+{
+	const vec4 TRANSPARENT_PIXEL = vec4( 0.0f, 0.0f, 0.0f, 0.0f );
+	const size_t count           = size_t( tile.x1 - tile.x0 );
+	const bool seam              = uniforms.inputProjection == DUAL_FISHEYE;
+	std::vector< float > uv( count * 2 ), seamUv( seam ? count * 2 : 0 ), seamWeight( seam ? count : 0 );
+	for( int y = tile.y0; y < tile.y1; ++y )
+	{
+		reprojectRow( level, uniforms, constants, frameWidth, frameHeight, firstRow + y, tile.x0, tile.x1, uv.data(), seam ? seamUv.data() : nullptr,
+					  seam ? seamWeight.data() : nullptr );
+		for( size_t i = 0; i < count; ++i )
+		{
+			vec2 sourceUv = vec2( uv[ i * 2 ], uv[ i * 2 + 1 ] );
+			int x         = tile.x0 + int( i );
+			if( sourceUv == SET_TO_TRANSPARENT )
+				destination.store( x, y, TRANSPARENT_PIXEL );
+			else if( seam )
+				destination.store( x, y, fetch( source, sourceUv, vec2( seamUv[ i * 2 ], seamUv[ i * 2 + 1 ] ), seamWeight[ i ] ) );
+			else
+				destination.store( x, y, texture( source, sourceUv ) );
+		}
+	}
+}
+// tile is in eye 0, each run of main() fills the pixel in both eyes.
+void renderStereoTile( SimdLevel level, const StereoEyes& eyes, const FrameConstants& constants, const Image& source, Image& destination, const Tile& tile )
+{
+	const vec4 TRANSPARENT_PIXEL = vec4( 0.0f, 0.0f, 0.0f, 0.0f );
+	const int count              = tile.x1 - tile.x0;
+	const bool seam              = eyes.eye.inputProjection == DUAL_FISHEYE;
+	std::vector< float > uv( size_t( count ) * 2 ), secondUv( uv.size() );
+	std::vector< float > seamUv( seam ? uv.size() : 0 ), secondSeamUv( seamUv.size() ), seamWeight( seam ? size_t( count ) : 0 );
+	for( int y = tile.y0; y < tile.y1; ++y )
+	{
+		reprojectRow( level, eyes.eye, constants, eyes.width, eyes.height, y, tile.x0, tile.x1, uv.data(), seam ? seamUv.data() : nullptr,
+					  seam ? seamWeight.data() : nullptr );
+		eyes.splitRow( uv.data(), secondUv.data(), count );
+		// Both eyes have the same seam weights, only the coordinates split.
+		if( seam )
+			eyes.splitRow( seamUv.data(), secondSeamUv.data(), count );
+		for( int i = 0; i < count; ++i )
+		{
+			size_t at    = size_t( i ) * 2;
+			vec2 firstUv = vec2( uv[ at ], uv[ at + 1 ] );
+			int x        = tile.x0 + i;
+			if( firstUv == SET_TO_TRANSPARENT )
+			{
+				destination.store( x, y, TRANSPARENT_PIXEL );
+				destination.store( x + eyes.offsetX, y + eyes.offsetY, TRANSPARENT_PIXEL );
+			}
+			else if( seam )
+			{
+				destination.store( x, y, fetch( source, firstUv, vec2( seamUv[ at ], seamUv[ at + 1 ] ), seamWeight[ size_t( i ) ] ) );
+				destination.store( x + eyes.offsetX, y + eyes.offsetY,
+								   fetch( source, vec2( secondUv[ at ], secondUv[ at + 1 ] ), vec2( secondSeamUv[ at ], secondSeamUv[ at + 1 ] ),
+										  seamWeight[ size_t( i ) ] ) );
+			}
+			else
+			{
+				destination.store( x, y, texture( source, firstUv ) );
+				destination.store( x + eyes.offsetX, y + eyes.offsetY, texture( source, vec2( secondUv[ at ], secondUv[ at + 1 ] ) ) );
+			}
+		}
+	}
+}
+
+// Transparent is all zero bits in both pixel formats.
+void clearTile( Image& destination, const Tile& tile )
+{
+	size_t offset = size_t( tile.x0 ) * destination.bytesPerPixel(), bytes = size_t( tile.x1 - tile.x0 ) * destination.bytesPerPixel();
+	for( int y = tile.y0; y < tile.y1; ++y )
+		std::memset( destination.row( y ) + offset, 0, bytes );
+}
+}// namespace
+
+void renderReference( const Uniforms& uniforms, const Image& source, Image& destination )
+{
+	const FrameConstants constants = computeFrameConstants( uniforms );
+	renderReferenceTile( uniforms, constants, source, destination, Tile{ 0, 0, destination.width, destination.height } );
+}
+
+void renderReference( const Uniforms& uniforms, const Image& source, Image& destination, TileExecutor& executor )
+{
+	const FrameConstants constants = computeFrameConstants( uniforms );
+	executor.run( destination.width, destination.height, [&]( const Tile& tile ) {
+		renderReferenceTile( uniforms, constants, source, destination, tile );
+	} );
+}
+
+void render( const Uniforms& uniforms, const Image& source, Image& destination, TileExecutor& executor, SimdLevel level )
+{
+	const StereoEyes eyes = splitStereoEyes( uniforms, destination.width, destination.height );
+	if( eyes.shared )
+	{
+		const FrameConstants eyeConstants = computeFrameConstants( eyes.eye );
+		executor.run( eyes.width, eyes.height, [&]( const Tile& tile ) { renderStereoTile( level, eyes, eyeConstants, source, destination, tile ); } );
+		return;
+	}
+	const FrameConstants constants = computeFrameConstants( uniforms );
+	executor.run( destination.width, destination.height, [&]( const Tile& tile ) {
+		renderTile( level, uniforms, constants, source, destination, destination.width, destination.height, 0, tile );
+	} );
+}
+
+void render( const Uniforms& uniforms, const Image& source, Image& destination, TileExecutor& executor, SimdLevel level, const TileCoverage& coverage )
+{
+	const StereoEyes eyes = splitStereoEyes( uniforms, destination.width, destination.height );
+	if( eyes.shared )
+	{
+		const FrameConstants eyeConstants = computeFrameConstants( eyes.eye );
+		int size                          = coverage.tileSize;
+		executor.run( eyes.width, eyes.height, [&]( const Tile& tile ) {
+			// Cut eye 0's tile where the coverage tiles of either eye start, so each piece is a single coverage tile in both.
+			// Both eyes have the same transparent pixels, so a piece only counts as Empty when the sampling of both agrees.
+			auto cuts = [&]( int a0, int a1, int offset ) {
+				std::vector< int > at = { a0, a1 };
+				for( int shift : { 0, offset % size } )
+				{
+					for( int a = ( a0 + shift ) / size * size + size - shift; a < a1; a += size )
+						at.push_back( a );
+				}
+				std::sort( at.begin(), at.end() );
+				at.erase( std::unique( at.begin(), at.end() ), at.end() );
+				return at;
+			};
+			std::vector< int > xs = cuts( tile.x0, tile.x1, eyes.offsetX ), ys = cuts( tile.y0, tile.y1, eyes.offsetY );
+			for( size_t j = 1; j < ys.size(); ++j )
+			{
+				for( size_t i = 1; i < xs.size(); ++i )
+				{
+					Tile piece = { xs[ i - 1 ], ys[ j - 1 ], xs[ i ], ys[ j ] };
+					if( coverage.at( piece.x0 / size, piece.y0 / size ) == TileClass::Empty &&
+						coverage.at( ( piece.x0 + eyes.offsetX ) / size, ( piece.y0 + eyes.offsetY ) / size ) == TileClass::Empty )
+					{
+						clearTile( destination, piece );
+						clearTile( destination, Tile{ piece.x0 + eyes.offsetX, piece.y0 + eyes.offsetY, piece.x1 + eyes.offsetX, piece.y1 + eyes.offsetY } );
+					}
+					else
+					{
+						renderStereoTile( level, eyes, eyeConstants, source, destination, piece );
+					}
+				}
+			}
+		} );
+		return;
+	}
+	const FrameConstants constants = computeFrameConstants( uniforms );
+	int size                       = coverage.tileSize;
+	executor.run( destination.width, destination.height, [&]( const Tile& tile ) {
+		// Split at the coverage tiles' edges and handle each piece by its class.
+		for( int row = tile.y0 / size; row * size < tile.y1; ++row )
+		{
+			for( int column = tile.x0 / size; column * size < tile.x1; ++column )
+			{
+				Tile piece = { std::max( tile.x0, column * size ), std::max( tile.y0, row * size ), std::min( tile.x1, ( column + 1 ) * size ),
+							   std::min( tile.y1, ( row + 1 ) * size ) };
+				if( coverage.at( column, row ) == TileClass::Empty )
+					clearTile( destination, piece );
+				else
+					renderTile( level, uniforms, constants, source, destination, destination.width, destination.height, 0, piece );
+			}
+		}
+	} );
+}
+
+bool renderBands( const Uniforms& uniforms, MappedImage& source, int width, int height, int bandHeight, TileExecutor& executor, SimdLevel level,
+				  const std::function< bool( const Image& band ) >& writeBand )
+{
+	const FrameConstants constants = computeFrameConstants( uniforms );
+	Image band;
+	for( int y1 = height; y1 > 0; y1 -= bandHeight )
+	{
+		int y0 = std::max( y1 - bandHeight, 0 );
+		if( band.height != y1 - y0 )
+			band = Image( width, y1 - y0, PixelFormat::RGBA8 );
+		executor.run( width, band.height, [&]( const Tile& tile ) {
+			renderTile( level, uniforms, constants, source, band, width, height, y0, tile );
+		} );
+		// The next band maps to other source pages, drop this band's before they add up to the whole source.
+		source.release();
+		if( !writeBand( band ) )
+			return false;
+	}
+	return true;
+}
+
+}// namespace reprojection
@@ -0,0 +1,38 @@
+#pragma once
+#include <functional>
+#include "Image.h"
+#include "MappedImage.h"
+#include "Projection.h"
+#include "ProjectionRegistry.h"
+#include "Rig.h"
+#include "Simd.h"
+#include "TileCoverage.h"
+#include "TileExecutor.h"
+
+namespace reprojection
+{
+// Renders destination from source on the CPU exactly like the fragment shader does on the GPU:
+// main() runs once per destination pixel center and the result is a bilinear fetch from source.
+// Pixels that main() leaves transparent are written as (0, 0, 0, 0).
+// uniforms.width / uniforms.height should hold the source size, just like the plugins upload the input texture size.
+void renderReference( const Uniforms& uniforms, const Image& source, Image& destination );
+// Same result, split into tiles and rendered by every thread of executor.
+void renderReference( const Uniforms& uniforms, const Image& source, Image& destination, TileExecutor& executor );
+
+// The fast path: main() runs a row of a tile at a time through the level's vectorized kernel, then every pixel is
+// fetched like renderReference() does. Matches renderReference() up to the last bits of the trig, see reprojectRow().
+// Stereo frames that split between two pixels run main() once per pair of eye pixels, see StereoEyes.
+void render( const Uniforms& uniforms, const Image& source, Image& destination, TileExecutor& executor, SimdLevel level );
+// Same, except that the tiles coverage classifies as Empty are cleared to (0, 0, 0, 0) without running main().
+// coverage must come from classifyTiles() for these uniforms and the destination size; its tiles need not line up
+// with the executor's.
+void render( const Uniforms& uniforms, const Image& source, Image& destination, TileExecutor& executor, SimdLevel level, const TileCoverage& coverage );
+
+// Same as render(), out of core: the source is read through its memory mapping and the width x height output is
+// rendered bandHeight rows at a time, top band first. Each finished band goes to writeBand before the next one starts,
+// and the source pages it touched are released, so memory stays at one band of output plus the part of the source that
+// band maps to, whatever the image sizes. Stops and returns false as soon as writeBand does.
+bool renderBands( const Uniforms& uniforms, MappedImage& source, int width, int height, int bandHeight, TileExecutor& executor, SimdLevel level,
+				  const std::function< bool( const Image& band ) >& writeBand );
+
+}// namespace reprojection
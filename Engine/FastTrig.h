@@ -0,0 +1,54 @@
+#pragma once
+#include "Math.h"
+
+// Minimax polynomial stand-ins for the trig in the per-pixel path, used when Uniforms::precision is PRECISION_FAST.
+// Written once against a batch type B (see SimdKernel.h, a plain float batch works too) so the reference Fragment and
+// every vectorized kernel evaluate the same polynomials, and the fast trig block in Shader.h is a copy of them.
+// Worst absolute error over the whole argument range, evaluated in single precision:
+//   sin, cos  7e-7    degree 7 odd polynomial on [-PI/2, PI/2] after folding the argument into that range
+//   atan      3.4e-7  degree 13 odd polynomial of min( |y|, |x| ) / max( |y|, |x| ), then the octant is restored
+//   tan       sin / cos
+// atan gets the most terms because fisheyeUvToDir feeds it through tan( atan( r ) / fovOutput ), which amplifies its
+// error about fivefold at the rim. Benchmark/Accuracy.cpp measures what these add up to for every projection pair.
+namespace reprojection
+{
+template< class B >
+struct FastTrig
+{
+	typedef typename B::F F;
+	typedef typename B::M M;
+
+	static F sin( F x )
+	{
+		// Bring x into [-PI, PI], then fold it into [-PI/2, PI/2] where sin is odd and monotonic.
+		F r = x - 2.0f * PI * B::floor( x * ( 0.5f / PI ) + 0.5f );
+		r   = B::select( r > PI / 2.0f, PI - r, B::select( r < -PI / 2.0f, -PI - r, r ) );
+		F z = r * r;
+		return ( ( ( -1.8363743e-4f * z + 8.3063282e-3f ) * z - 1.6664828e-1f ) * z + 9.9999660e-1f ) * r;
+	}
+	static F cos( F x ) { return sin( x + PI / 2.0f ); }
+	static void sincos( F x, F& sine, F& cosine )
+	{
+		sine   = sin( x );
+		cosine = cos( x );
+	}
+	static F tan( F x ) { return sin( x ) / cos( x ); }
+	static F atan2( F y, F x )
+	{
+		F ay = B::abs( y ), ax = B::abs( x );
+		M steep = ay > ax;
+		// Always in [0, 1], and 0 / 0 only when both are 0, which atan2 maps to 0.
+		F a = B::select( steep, ax, ay ) / B::select( steep, ay, ax );
+		a   = B::select( ( ax == 0.0f ) & ( ay == 0.0f ), F( 0.0f ), a );
+		F z = a * a;
+		F r = ( ( ( ( ( ( 6.8120738e-3f * z - 3.3605054e-2f ) * z + 7.9624616e-2f ) * z - 1.3233393e-1f ) * z + 1.9807829e-1f ) * z - 3.331737e-1f ) * z +
+				9.999961e-1f ) *
+			  a;
+		r   = B::select( steep, PI / 2.0f - r, r );
+		r   = B::select( x < 0.0f, PI - r, r );
+		return B::select( y < 0.0f, -r, r );
+	}
+	static F atan( F x ) { return atan2( x, F( 1.0f ) ); }
+};
+
+}// namespace reprojection
@@ -0,0 +1,150 @@
+#include "Image.h"
+#include <algorithm>
+#include <cstring>
+
+namespace reprojection
+{
+Image::Image() :
+	width( 0 ), height( 0 ), format( PixelFormat::RGBA8 )
+{
+}
+
+Image::Image( int width, int height, PixelFormat format ) :
+	width( width ), height( height ), format( format ), data( size_t( width ) * size_t( height ) * ( format == PixelFormat::RGBA8 ? 4 : 8 ) )
+{
+}
+
+size_t Image::bytesPerPixel() const
+{
+	return format == PixelFormat::RGBA8 ? 4 : 8;
+}
+
+size_t Image::rowBytes() const
+{
+	return size_t( width ) * bytesPerPixel();
+}
+
+uint8_t* Image::row( int y )
+{
+	return data.data() + size_t( y ) * rowBytes();
+}
+
+const uint8_t* Image::row( int y ) const
+{
+	return data.data() + size_t( y ) * rowBytes();
+}
+
+vec4 Image::load( int x, int y ) const
+{
+	if( format == PixelFormat::RGBA8 )
+	{
+		const uint8_t* p = row( y ) + size_t( x ) * 4;
+		return vec4( p[ 0 ] / 255.0f, p[ 1 ] / 255.0f, p[ 2 ] / 255.0f, p[ 3 ] / 255.0f );
+	}
+	uint16_t p[ 4 ];
+	std::memcpy( p, row( y ) + size_t( x ) * 8, sizeof( p ) );
+	return vec4( halfToFloat( p[ 0 ] ), halfToFloat( p[ 1 ] ), halfToFloat( p[ 2 ] ), halfToFloat( p[ 3 ] ) );
+}
+
+void Image::store( int x, int y, vec4 color )
+{
+	if( format == PixelFormat::RGBA8 )
+	{
+		auto toUnorm = []( float v ) {
+			return uint8_t( std::min( std::max( v, 0.0f ), 1.0f ) * 255.0f + 0.5f );
+		};
+		uint8_t* p = row( y ) + size_t( x ) * 4;
+		p[ 0 ]     = toUnorm( color.x );
+		p[ 1 ]     = toUnorm( color.y );
+		p[ 2 ]     = toUnorm( color.z );
+		p[ 3 ]     = toUnorm( color.w );
+		return;
+	}
+	uint16_t p[ 4 ] = { floatToHalf( color.x ), floatToHalf( color.y ), floatToHalf( color.z ), floatToHalf( color.w ) };
+	std::memcpy( row( y ) + size_t( x ) * 8, p, sizeof( p ) );
+}
+
+uint16_t floatToHalf( float value )
+{
+	uint32_t bits;
+	std::memcpy( &bits, &value, sizeof( bits ) );
+	uint32_t sign     = ( bits >> 16 ) & 0x8000u;
+	int32_t exponent  = int32_t( ( bits >> 23 ) & 0xFFu ) - 127 + 15;
+	uint32_t mantissa = bits & 0x7FFFFFu;
+
+	if( ( ( bits >> 23 ) & 0xFFu ) == 0xFFu )
+	{
+		// Inf stays inf, NaN stays NaN
+		return uint16_t( sign | 0x7C00u | ( mantissa ? 0x200u : 0u ) );
+	}
+	if( exponent >= 31 )
+	{
+		// Too big for a half, saturate to inf
+		return uint16_t( sign | 0x7C00u );
+	}
+	if( exponent <= 0 )
+	{
+		// Denormal half, or zero when too small
+		if( exponent < -10 )
+			return uint16_t( sign );
+		mantissa |= 0x800000u;
+		uint32_t shift   = uint32_t( 14 - exponent );
+		uint32_t half    = mantissa >> shift;
+		uint32_t rest    = mantissa & ( ( 1u << shift ) - 1u );
+		uint32_t halfway = 1u << ( shift - 1u );
+		if( rest > halfway || ( rest == halfway && ( half & 1u ) ) )
+			++half;
+		return uint16_t( sign | half );
+	}
+	uint32_t half = sign | ( uint32_t( exponent ) << 10 ) | ( mantissa >> 13 );
+	uint32_t rest = mantissa & 0x1FFFu;
+	// Round to nearest even, a carry into the exponent is exactly what we want.
+	if( rest > 0x1000u || ( rest == 0x1000u && ( half & 1u ) ) )
+		++half;
+	return uint16_t( half );
+}
+
+float halfToFloat( uint16_t value )
+{
+	uint32_t sign     = uint32_t( value & 0x8000u ) << 16;
+	uint32_t exponent = ( value >> 10 ) & 0x1Fu;
+	uint32_t mantissa = value & 0x3FFu;
+	uint32_t bits;
+	if( exponent == 0 )
+	{
+		if( mantissa == 0 )
+		{
+			bits = sign;
+		}
+		else
+		{
+			// Denormal half, normalize it for the float
+			exponent = 127 - 15 + 1;
+			while( !( mantissa & 0x400u ) )
+			{
+				mantissa <<= 1;
+				--exponent;
+			}
+			mantissa &= 0x3FFu;
+			bits = sign | ( exponent << 23 ) | ( mantissa << 13 );
+		}
+	}
+	else if( exponent == 31 )
+	{
+		bits = sign | 0x7F800000u | ( mantissa << 13 );
+	}
+	else
+	{
+		bits = sign | ( ( exponent - 15 + 127 ) << 23 ) | ( mantissa << 13 );
+	}
+	float result;
+	std::memcpy( &result, &bits, sizeof( result ) );
+	return result;
+}
+
+vec4 texture( const Image& image, vec2 uv )
+{
+	return bilinear( image, uv );
+}
+
+}// namespace reprojection
@@ -0,0 +1,65 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Math.h"
+
+namespace reprojection
+{
+enum class PixelFormat
+{
+	RGBA8,  //!< 8 bit unsigned normalized per channel
+	RGBA16F //!< IEEE half float per channel
+};
+
+// A CPU side stand-in for a GL texture.
+// Rows are stored bottom-up like a GL texture, so row 0 is at v = 0.
+struct Image
+{
+	Image();
+	Image( int width, int height, PixelFormat format );
+
+	size_t bytesPerPixel() const;
+	size_t rowBytes() const;
+	uint8_t* row( int y );
+	const uint8_t* row( int y ) const;
+
+	vec4 load( int x, int y ) const;
+	void store( int x, int y, vec4 color );
+
+	int width;
+	int height;
+	PixelFormat format;
+	std::vector< uint8_t > data;
+};
+
+uint16_t floatToHalf( float value );
+float halfToFloat( uint16_t value );
+
+// Bilinear fetch with clamp-to-edge addressing, matching what GLSL's texture() does for a GL_LINEAR sampler.
+// Works on anything with width, height and load( x, y ), so sources that are not an Image (see MappedImage) filter the same.
+template< class Texels >
+vec4 bilinear( const Texels& image, vec2 uv )
+{
+	// Texel centers are at (i + 0.5) / size
+	float x = uv.x * float( image.width ) - 0.5f;
+	float y = uv.y * float( image.height ) - 0.5f;
+	float fx = std::floor( x );
+	float fy = std::floor( y );
+	float ax = x - fx;
+	float ay = y - fy;
+	int x0   = std::min( std::max( int( fx ), 0 ), image.width - 1 );
+	int y0   = std::min( std::max( int( fy ), 0 ), image.height - 1 );
+	int x1   = std::min( std::max( int( fx ) + 1, 0 ), image.width - 1 );
+	int y1   = std::min( std::max( int( fy ) + 1, 0 ), image.height - 1 );
+
+	vec4 bottom = ( 1.0f - ax ) * image.load( x0, y0 ) + ax * image.load( x1, y0 );
+	vec4 top    = ( 1.0f - ax ) * image.load( x0, y1 ) + ax * image.load( x1, y1 );
+	return ( 1.0f - ay ) * bottom + ay * top;
+}
+
+vec4 texture( const Image& image, vec2 uv );
+
+}// namespace reprojection
@@ -0,0 +1,304 @@
+#include "InverseMirror.h"
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+#include "BourkeMesh.h"
+
+namespace reprojection
+{
+namespace
+{
+const int SCATTER_PER_TEXEL = 1;    //!< Projector samples per texel edge seeding the table
+const float DIFFERENCE_STEP = 1e-4f;//!< In projector uv, for the Jacobian
+const int NEWTON_STEPS      = 10;
+const int MAX_ATTEMPTS      = 4;//!< Neighbours a texel is grown from before it is given up
+
+// The maps of sharedInverseMirrorMap(), most recently used first.
+struct MirrorCache
+{
+	static const size_t CACHED = 4;
+	std::mutex mutex;     //!< Guards maps
+	std::mutex buildMutex;//!< Held for a whole build
+	std::vector< std::shared_ptr< const InverseMirrorMap > > maps;
+};
+
+MirrorCache& mirrorCache()
+{
+	static MirrorCache cache;
+	return cache;
+}
+
+// The forward trace, projector uv to dome master uv, and Newton on it.
+class Solver
+{
+public:
+	Solver( const Uniforms& uniforms, float tolerance, long long& evaluations ) :
+		uniforms( uniforms ), constants( computeFrameConstants( uniforms ) ), fragment( this->uniforms, constants ), tolerance( tolerance ),
+		evaluations( evaluations )
+	{
+	}
+
+	bool forward( vec2 projectorUv, vec2& domeUv )
+	{
+		++evaluations;
+		vec3 dir;
+		if( !outputDirection( fragment, projectorUv, dir ) )
+			return false;
+		domeUv = dirToDomeMasterUv( dir );
+		return true;
+	}
+
+	// The projector uv that lands on target, starting from guess. False when the steps leave the mirror or stall.
+	bool solve( vec2 target, vec2 guess, vec2& result )
+	{
+		vec2 p = guess, q;
+		if( !forward( p, q ) )
+			return false;
+		for( int step = 0; step < NEWTON_STEPS; ++step )
+		{
+			vec2 residual = q - target;
+			if( length( residual ) <= tolerance )
+			{
+				result = p;
+				return p.x >= 0.0f && p.y >= 0.0f && p.x <= 1.0f && p.y <= 1.0f;
+			}
+			// Forward differences, stepping the other way where the first step falls off the mirror.
+			vec2 qx, qy;
+			float hx = DIFFERENCE_STEP, hy = DIFFERENCE_STEP;
+			if( !forward( p + vec2( hx, 0.0f ), qx ) && !forward( p + vec2( hx = -hx, 0.0f ), qx ) )
+				return false;
+			if( !forward( p + vec2( 0.0f, hy ), qy ) && !forward( p + vec2( 0.0f, hy = -hy ), qy ) )
+				return false;
+			vec2 dx   = ( qx - q ) / hx;
+			vec2 dy   = ( qy - q ) / hy;
+			float det = dx.x * dy.y - dy.x * dx.y;
+			if( det == 0.0f )
+				return false;
+			vec2 delta = vec2( dy.y * residual.x - dy.x * residual.y, dx.x * residual.y - dx.y * residual.x ) / det;
+			// Halve the step while it leaves the mirror or does not bring the residual down.
+			bool improved = false;
+			for( int halving = 0; halving < 8 && !improved; ++halving, delta = delta * 0.5f )
+			{
+				vec2 next = p - delta, nextQ;
+				if( forward( next, nextQ ) && length( nextQ - target ) < length( residual ) )
+				{
+					p        = next;
+					q        = nextQ;
+					improved = true;
+				}
+			}
+			if( !improved )
+				return false;
+		}
+		return false;
+	}
+
+private:
+	const Uniforms uniforms;
+	const FrameConstants constants;
+	Fragment fragment;
+	const float tolerance;
+	long long& evaluations;
+};
+}// namespace
+
+vec2 InverseMirrorMap::lookup( vec2 domeUv ) const
+{
+	if( size == 0 || std::isnan( domeUv.x ) || std::isnan( domeUv.y ) )
+		return SET_TO_TRANSPARENT;
+	const float last = float( size - 1 );
+	float x          = std::min( std::max( domeUv.x * float( size ) - 0.5f, 0.0f ), last );
+	float y          = std::min( std::max( domeUv.y * float( size ) - 0.5f, 0.0f ), last );
+	int x0 = int( x ), y0 = int( y );
+	int x1 = std::min( x0 + 1, size - 1 ), y1 = std::min( y0 + 1, size - 1 );
+	float fx = x - float( x0 ), fy = y - float( y0 );
+
+	const int columns[ 4 ]   = { x0, x1, x0, x1 };
+	const int rows[ 4 ]      = { y0, y0, y1, y1 };
+	const float weights[ 4 ] = { ( 1.0f - fx ) * ( 1.0f - fy ), fx * ( 1.0f - fy ), ( 1.0f - fx ) * fy, fx * fy };
+	vec2 result              = vec2( 0.0f, 0.0f );
+	for( int i = 0; i < 4; ++i )
+	{
+		if( weights[ i ] == 0.0f )
+			continue;
+		const float* texel = &uv[ ( size_t( rows[ i ] ) * size_t( size ) + size_t( columns[ i ] ) ) * 2 ];
+		if( texel[ 0 ] < 0.0f )
+			return SET_TO_TRANSPARENT;
+		result += weights[ i ] * vec2( texel[ 0 ], texel[ 1 ] );
+	}
+	return result;
+}
+
+bool sameMirror( const Uniforms& a, const Uniforms& b )
+{
+	return a.mirrorRadius == b.mirrorRadius && a.projDistance == b.projDistance && a.projLift == b.projLift && a.mirrorProjFov == b.mirrorProjFov &&
+		   a.projTilt == b.projTilt && a.domeRadius == b.domeRadius && float( a.width ) / float( a.height ) == float( b.width ) / float( b.height );
+}
+
+void buildInverseMirrorMap( const Uniforms& uniforms, int size, InverseMirrorMap& map )
+{
+	map.uniforms = uniforms;
+	map.size     = size;
+	map.uv.assign( size_t( size ) * size_t( size ) * 2, INVERSE_MIRROR_INVALID );
+	map.evaluations = 0;
+
+	// The forward trace alone: mirror dome output, mono, no MaxUV, and an input projection that does not come back here.
+	Uniforms traceUniforms         = uniforms;
+	traceUniforms.outputProjection = MIRROR_DOME;
+	traceUniforms.inputProjection  = EQUI;
+	traceUniforms.stereo           = STEREO_NONE;
+	traceUniforms.maxUV            = vec2( 1.0f, 1.0f );
+	Solver solver( traceUniforms, 0.01f / float( size ), map.evaluations );
+
+	// Texel centers past the horizon aim at the point of the horizon below them, so lookups reach all the way to it.
+	std::vector< vec2 > targets( size_t( size ) * size_t( size ) );
+	std::vector< bool > reachable( targets.size() );
+	for( int j = 0; j < size; ++j )
+	{
+		for( int i = 0; i < size; ++i )
+		{
+			const size_t texel = size_t( j ) * size_t( size ) + size_t( i );
+			vec2 pos           = 2.0f * vec2( ( float( i ) + 0.5f ) / float( size ), ( float( j ) + 0.5f ) / float( size ) ) - 1.0f;
+			float r            = length( pos );
+			reachable[ texel ] = r <= 1.0f + 2.0f / float( size );
+			targets[ texel ]   = ( ( r > 1.0f ? pos / r : pos ) + 1.0f ) / 2.0f;
+		}
+	}
+
+	// Seed each texel with the projector sample that lands closest to its center.
+	const int samples = size * SCATTER_PER_TEXEL;
+	std::vector< vec2 > seeds( targets.size() );
+	std::vector< float > seedDistance( targets.size(), -1.0f );
+	for( int j = 0; j < samples; ++j )
+	{
+		for( int i = 0; i < samples; ++i )
+		{
+			vec2 projectorUv = vec2( ( float( i ) + 0.5f ) / float( samples ), ( float( j ) + 0.5f ) / float( samples ) );
+			vec2 domeUv;
+			if( !solver.forward( projectorUv, domeUv ) )
+				continue;
+			int column     = std::min( std::max( int( domeUv.x * float( size ) ), 0 ), size - 1 );
+			int row        = std::min( std::max( int( domeUv.y * float( size ) ), 0 ), size - 1 );
+			size_t texel   = size_t( row ) * size_t( size ) + size_t( column );
+			float distance = length( domeUv - targets[ texel ] );
+			if( seedDistance[ texel ] < 0.0f || distance < seedDistance[ texel ] )
+			{
+				seeds[ texel ]        = projectorUv;
+				seedDistance[ texel ] = distance;
+			}
+		}
+	}
+
+	// Solve the seeded texels, then grow into their neighbours from each solution, breadth first.
+	struct Attempt
+	{
+		int column, row;
+		vec2 guess;
+	};
+	std::vector< Attempt > queue;
+	std::vector< unsigned char > attempts( targets.size(), 0 );
+	for( int j = 0; j < size; ++j )
+	{
+		for( int i = 0; i < size; ++i )
+		{
+			if( seedDistance[ size_t( j ) * size_t( size ) + size_t( i ) ] >= 0.0f )
+				queue.push_back( Attempt{ i, j, seeds[ size_t( j ) * size_t( size ) + size_t( i ) ] } );
+		}
+	}
+	for( size_t next = 0; next < queue.size(); ++next )
+	{
+		const Attempt attempt = queue[ next ];
+		const size_t texel    = size_t( attempt.row ) * size_t( size ) + size_t( attempt.column );
+		if( !reachable[ texel ] || map.uv[ texel * 2 ] >= 0.0f || attempts[ texel ] >= MAX_ATTEMPTS )
+			continue;
+		++attempts[ texel ];
+		vec2 solution;
+		if( !solver.solve( targets[ texel ], attempt.guess, solution ) )
+			continue;
+		map.uv[ texel * 2 ]     = solution.x;
+		map.uv[ texel * 2 + 1 ] = solution.y;
+		const int offsets[ 4 ][ 2 ] = { { -1, 0 }, { 1, 0 }, { 0, -1 }, { 0, 1 } };
+		for( const auto& offset : offsets )
+		{
+			int column = attempt.column + offset[ 0 ], row = attempt.row + offset[ 1 ];
+			if( column >= 0 && row >= 0 && column < size && row < size && map.uv[ ( size_t( row ) * size_t( size ) + size_t( column ) ) * 2 ] < 0.0f )
+				queue.push_back( Attempt{ column, row, solution } );
+		}
+	}
+}
+
+std::shared_ptr< const InverseMirrorMap > sharedInverseMirrorMap( const Uniforms& uniforms )
+{
+	std::shared_ptr< const InverseMirrorMap > map = cachedInverseMirrorMap( uniforms );
+	if( map )
+		return map;
+	// One build at a time: a second caller usually wants the same map, and finds it cached once the first is done.
+	MirrorCache& cache = mirrorCache();
+	std::lock_guard< std::mutex > buildLock( cache.buildMutex );
+	map = cachedInverseMirrorMap( uniforms );
+	if( map )
+		return map;
+	std::shared_ptr< InverseMirrorMap > built = std::make_shared< InverseMirrorMap >();
+	buildInverseMirrorMap( uniforms, INVERSE_MIRROR_SIZE, *built );
+	std::lock_guard< std::mutex > lock( cache.mutex );
+	if( cache.maps.size() == MirrorCache::CACHED )
+		cache.maps.pop_back();
+	cache.maps.insert( cache.maps.begin(), built );
+	return built;
+}
+
+std::shared_ptr< const InverseMirrorMap > cachedInverseMirrorMap( const Uniforms& uniforms )
+{
+	MirrorCache& cache = mirrorCache();
+	std::lock_guard< std::mutex > lock( cache.mutex );
+	auto hit = std::find_if( cache.maps.begin(), cache.maps.end(),
+							 [&]( const std::shared_ptr< const InverseMirrorMap >& map ) { return sameMirror( map->uniforms, uniforms ); } );
+	if( hit == cache.maps.end() )
+		return nullptr;
+	std::shared_ptr< const InverseMirrorMap > map = *hit;
+	cache.maps.erase( hit );
+	cache.maps.insert( cache.maps.begin(), map );
+	return map;
+}
+
+AsyncInverseMirror::AsyncInverseMirror() : worker( [this]() { workerLoop(); } ) {}
+
+AsyncInverseMirror::~AsyncInverseMirror()
+{
+	{
+		std::lock_guard< std::mutex > lock( mutex );
+		stopping = true;
+	}
+	wake.notify_one();
+	worker.join();
+}
+
+void AsyncInverseMirror::request( const Uniforms& uniforms )
+{
+	{
+		std::lock_guard< std::mutex > lock( mutex );
+		requestUniforms = uniforms;
+		hasRequest      = true;
+	}
+	wake.notify_one();
+}
+
+void AsyncInverseMirror::workerLoop()
+{
+	std::unique_lock< std::mutex > lock( mutex );
+	for( ;; )
+	{
+		wake.wait( lock, [this]() { return hasRequest || stopping; } );
+		if( stopping )
+			return;
+		const Uniforms uniforms = requestUniforms;
+		hasRequest              = false;
+		lock.unlock();
+
+		sharedInverseMirrorMap( uniforms );
+
+		lock.lock();
+	}
+}
+
+}// namespace reprojection
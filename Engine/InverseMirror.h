@@ -0,0 +1,72 @@
+#pragma once
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Projection.h"
+
+namespace reprojection
+{
+// The mirror dome as an input projection: a projector frame made for the mirror read back onto the sphere.
+// mirrorDomeUvToDir() has no closed form inverse, so the inverse is tabulated once over the dome master (see
+// domeMasterUvToDir() in BourkeMesh.h) and looked up per pixel: for each texel center the projector uv whose ray lands
+// there. A fine projector grid is scattered through the forward trace to seed every texel it reaches, Newton steps on
+// the forward trace take each seed to the texel center, and texels no seed reached are grown from solved neighbours.
+// Texels the projector cannot reach through the mirror hold INVERSE_MIRROR_INVALID.
+// The table only depends on the mirror parameters and the aspect ratio of the projector frame, see sameMirror(), so it
+// is built when those change and costs one bilinear fetch per pixel after that, on the CPU and in the shader alike.
+struct InverseMirrorMap
+{
+	// Projector uv for the dome master uv domeUv, bilinear between texel centers like GL_LINEAR with GL_CLAMP_TO_EDGE.
+	// SET_TO_TRANSPARENT when a texel with a nonzero weight is invalid. The shader gets the same from the filtered
+	// sentinel going negative.
+	vec2 lookup( vec2 domeUv ) const;
+
+	Uniforms uniforms;//!< What the table was built for, see sameMirror()
+	int size = 0;//!< Texels across and up
+	std::vector< float > uv;//!< size x size projector u, v pairs, bottom row first
+	long long evaluations = 0;//!< Forward traces it took to build
+};
+
+const int INVERSE_MIRROR_SIZE      = 512;
+const float INVERSE_MIRROR_INVALID = -1000.0f;//!< Far enough below 0 that any filter weight on it makes the fetch negative
+
+// True when a and b give the same inverse: same mirror parameters and the same input aspect ratio.
+bool sameMirror( const Uniforms& a, const Uniforms& b );
+
+void buildInverseMirrorMap( const Uniforms& uniforms, int size, InverseMirrorMap& map );
+
+// The map for uniforms from a small process wide cache, built on a miss. computeFrameConstants() calls it whenever the
+// input projection is MIRROR_DOME, so several plugin instances with different mirrors do not rebuild every frame.
+// A build takes a few hundred milliseconds. Builds run one at a time, but lookups never wait for one.
+std::shared_ptr< const InverseMirrorMap > sharedInverseMirrorMap( const Uniforms& uniforms );
+// The map for uniforms if the cache holds it, nullptr otherwise. Never builds.
+std::shared_ptr< const InverseMirrorMap > cachedInverseMirrorMap( const Uniforms& uniforms );
+
+// Builds maps into the cache of sharedInverseMirrorMap() on a worker thread, for the thread drawing frames, which takes
+// them from there with cachedInverseMirrorMap() once they are ready. Only the newest request is built, like AsyncBaker.
+class AsyncInverseMirror
+{
+public:
+	AsyncInverseMirror();
+	~AsyncInverseMirror();//!< Waits for the build in flight
+	AsyncInverseMirror( const AsyncInverseMirror& ) = delete;
+	AsyncInverseMirror& operator=( const AsyncInverseMirror& ) = delete;
+
+	// Asks for the map of uniforms. Never waits for the worker.
+	void request( const Uniforms& uniforms );
+
+private:
+	void workerLoop();
+
+	std::mutex mutex;
+	std::condition_variable wake;
+	Uniforms requestUniforms;//!< Newest request, valid while hasRequest
+	bool hasRequest = false;
+	bool stopping   = false;
+
+	std::thread worker;//!< Last, so it starts once everything above is constructed
+};
+
+}// namespace reprojection
@@ -0,0 +1,216 @@
+#include "MappedImage.h"
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace reprojection
+{
+namespace
+{
+const char TILED_MAGIC[ 8 ]    = { 'R', 'P', 'R', 'J', 'T', 'I', 'L', 'E' };
+const uint32_t TILED_VERSION   = 1;
+const size_t TILED_HEADER_SIZE = 64;
+
+uint32_t readUint32( const uint8_t* p )
+{
+	return uint32_t( p[ 0 ] ) | uint32_t( p[ 1 ] ) << 8 | uint32_t( p[ 2 ] ) << 16 | uint32_t( p[ 3 ] ) << 24;
+}
+
+void writeUint32( uint8_t* p, uint32_t value )
+{
+	p[ 0 ] = uint8_t( value );
+	p[ 1 ] = uint8_t( value >> 8 );
+	p[ 2 ] = uint8_t( value >> 16 );
+	p[ 3 ] = uint8_t( value >> 24 );
+}
+}// namespace
+
+MappedImage::~MappedImage()
+{
+	close();
+}
+
+bool MappedImage::open( const std::string& path, int rawWidth, int rawHeight, std::string& error )
+{
+	close();
+#ifdef _WIN32
+	HANDLE file = CreateFileA( path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, nullptr );
+	LARGE_INTEGER size;
+	if( file == INVALID_HANDLE_VALUE || !GetFileSizeEx( file, &size ) )
+	{
+		if( file != INVALID_HANDLE_VALUE )
+			CloseHandle( file );
+		error = "Could not open " + path;
+		return false;
+	}
+	fileHandle    = file;
+	mappingSize   = size_t( size.QuadPart );
+	mappingHandle = mappingSize != 0 ? CreateFileMappingA( file, nullptr, PAGE_READONLY, 0, 0, nullptr ) : nullptr;
+	mapping       = mappingHandle != nullptr ? MapViewOfFile( mappingHandle, FILE_MAP_READ, 0, 0, 0 ) : nullptr;
+#else
+	int file = ::open( path.c_str(), O_RDONLY );
+	struct stat status;
+	if( file < 0 || fstat( file, &status ) != 0 )
+	{
+		if( file >= 0 )
+			::close( file );
+		error = "Could not open " + path;
+		return false;
+	}
+	mappingSize = size_t( status.st_size );
+	mapping     = mappingSize != 0 ? mmap( nullptr, mappingSize, PROT_READ, MAP_PRIVATE, file, 0 ) : MAP_FAILED;
+	::close( file );// The mapping keeps the file open
+	if( mapping == MAP_FAILED )
+		mapping = nullptr;
+	else
+		madvise( mapping, mappingSize, MADV_RANDOM );// Fetches jump around, read ahead would pull in pages nobody uses
+#endif
+	if( mapping == nullptr )
+	{
+		close();
+		error = "Could not map " + path;
+		return false;
+	}
+
+	const uint8_t* header = static_cast< const uint8_t* >( mapping );
+	size_t dataOffset     = 0;
+	if( mappingSize >= TILED_IMAGE_DATA_OFFSET && std::memcmp( header, TILED_MAGIC, sizeof( TILED_MAGIC ) ) == 0 )
+	{
+		if( readUint32( header + 8 ) != TILED_VERSION || readUint32( header + 28 ) != 0 )
+		{
+			close();
+			error = path + " is a tiled image of a newer version or an unknown pixel format";
+			return false;
+		}
+		width      = int( readUint32( header + 12 ) );
+		height     = int( readUint32( header + 16 ) );
+		tileWidth  = int( readUint32( header + 20 ) );
+		tileHeight = int( readUint32( header + 24 ) );
+		dataOffset = TILED_IMAGE_DATA_OFFSET;
+	}
+	else
+	{
+		width      = rawWidth;
+		height     = rawHeight;
+		tileWidth  = rawWidth;
+		tileHeight = 1;
+	}
+	if( width <= 0 || height <= 0 || tileWidth <= 0 || tileHeight <= 0 )
+	{
+		close();
+		error = path + " has no tiled image header, and raw input needs a size";
+		return false;
+	}
+
+	tilesX        = ( size_t( width ) + size_t( tileWidth ) - 1 ) / size_t( tileWidth );
+	size_t tilesY = ( size_t( height ) + size_t( tileHeight ) - 1 ) / size_t( tileHeight );
+	tileBytes     = size_t( tileWidth ) * size_t( tileHeight ) * 4;
+	if( mappingSize < dataOffset + tilesX * tilesY * tileBytes )
+	{
+		close();
+		error = path + " is shorter than its image";
+		return false;
+	}
+	data = header + dataOffset;
+	return true;
+}
+
+void MappedImage::close()
+{
+#ifdef _WIN32
+	if( mapping != nullptr )
+		UnmapViewOfFile( mapping );
+	if( mappingHandle != nullptr )
+		CloseHandle( mappingHandle );
+	if( fileHandle != nullptr )
+		CloseHandle( fileHandle );
+	fileHandle    = nullptr;
+	mappingHandle = nullptr;
+#else
+	if( mapping != nullptr )
+		munmap( mapping, mappingSize );
+#endif
+	mapping     = nullptr;
+	mappingSize = 0;
+	data        = nullptr;
+	width       = 0;
+	height      = 0;
+}
+
+void MappedImage::release()
+{
+	if( mapping == nullptr )
+		return;
+#ifdef _WIN32
+	// Unlocking pages that were never locked takes them out of the working set.
+	VirtualUnlock( mapping, mappingSize );
+#else
+	madvise( mapping, mappingSize, MADV_DONTNEED );
+#endif
+}
+
+vec4 texture( const MappedImage& image, vec2 uv )
+{
+	return bilinear( image, uv );
+}
+
+bool writeTiledImage( FILE* raw, int width, int height, int tileSize, FILE* tiled, std::string& error )
+{
+	uint8_t header[ TILED_IMAGE_DATA_OFFSET ] = {};
+	std::memcpy( header, TILED_MAGIC, sizeof( TILED_MAGIC ) );
+	writeUint32( header + 8, TILED_VERSION );
+	writeUint32( header + 12, uint32_t( width ) );
+	writeUint32( header + 16, uint32_t( height ) );
+	writeUint32( header + 20, uint32_t( tileSize ) );
+	writeUint32( header + 24, uint32_t( tileSize ) );
+	writeUint32( header + 28, 0 );
+	static_assert( TILED_HEADER_SIZE <= TILED_IMAGE_DATA_OFFSET, "The header must fit before the first tile" );
+	if( std::fwrite( header, 1, sizeof( header ), tiled ) != sizeof( header ) )
+	{
+		error = "Could not write the tiled image";
+		return false;
+	}
+
+	size_t tilesX   = ( size_t( width ) + size_t( tileSize ) - 1 ) / size_t( tileSize );
+	size_t rowBytes = size_t( width ) * 4;
+	size_t tileRow  = size_t( tileSize ) * 4;
+	// One row of tiles at a time: the raw rows of the band, padded to whole tiles, then cut into tiles.
+	std::vector< uint8_t > band( tilesX * tileRow * size_t( tileSize ) );
+	std::vector< uint8_t > tile( tileRow * size_t( tileSize ) );
+	for( int y0 = 0; y0 < height; y0 += tileSize )
+	{
+		std::fill( band.begin(), band.end(), uint8_t( 0 ) );
+		int rows = std::min( tileSize, height - y0 );
+		for( int row = 0; row < rows; ++row )
+		{
+			if( std::fread( &band[ size_t( row ) * tilesX * tileRow ], 1, rowBytes, raw ) != rowBytes )
+			{
+				error = "Raw RGBA input is shorter than its size";
+				return false;
+			}
+		}
+		for( size_t tx = 0; tx < tilesX; ++tx )
+		{
+			for( int row = 0; row < tileSize; ++row )
+				std::memcpy( &tile[ size_t( row ) * tileRow ], &band[ size_t( row ) * tilesX * tileRow + tx * tileRow ], tileRow );
+			if( std::fwrite( tile.data(), 1, tile.size(), tiled ) != tile.size() )
+			{
+				error = "Could not write the tiled image";
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+}// namespace reprojection
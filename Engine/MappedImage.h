@@ -0,0 +1,68 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include "Image.h"
+
+// Sources too big to load, read straight from a memory mapped file instead.
+// A tiled file stores the image as tileWidth x tileHeight RGBA8 blocks, each one contiguous, so a bilinear fetch
+// touches the pages of a single tile and a neighbourhood of output pixels touches a handful of tiles. Layout:
+//   64 byte header: "RPRJTILE", then uint32 little endian version (1), width, height, tileWidth, tileHeight, format (0 = RGBA8)
+//   tiles from offset TILED_IMAGE_DATA_OFFSET, the top row of tiles first and left to right, rows inside a tile top-down;
+//   tiles on the right and bottom edge are padded to full size.
+// A headerless raw RGBA8 file maps as well, it is the same layout with width x 1 tiles.
+namespace reprojection
+{
+const size_t TILED_IMAGE_DATA_OFFSET = 4096;//!< Keeps every tile page aligned
+
+class MappedImage
+{
+public:
+	MappedImage() = default;
+	~MappedImage();
+	MappedImage( const MappedImage& ) = delete;
+	MappedImage& operator=( const MappedImage& ) = delete;
+
+	// Maps a tiled file, or a raw RGBA8 file of rawWidth x rawHeight when it has no tiled header.
+	// Nothing is read up front, pages come in as load() touches them.
+	bool open( const std::string& path, int rawWidth, int rawHeight, std::string& error );
+	void close();
+
+	// Same addressing as Image::load(), row 0 is the bottom row.
+	vec4 load( int x, int y ) const
+	{
+		size_t row       = size_t( height - 1 - y );
+		size_t tile      = row / size_t( tileHeight ) * tilesX + size_t( x ) / size_t( tileWidth );
+		size_t inTile    = ( row % size_t( tileHeight ) ) * size_t( tileWidth ) + size_t( x ) % size_t( tileWidth );
+		const uint8_t* p = data + tile * tileBytes + inTile * 4;
+		return vec4( p[ 0 ] / 255.0f, p[ 1 ] / 255.0f, p[ 2 ] / 255.0f, p[ 3 ] / 255.0f );
+	}
+
+	// Drops the pages touched so far from this process' resident set. They stay in the OS file cache, so touching
+	// them again is a page fault but no disk read.
+	void release();
+
+	int width      = 0;
+	int height     = 0;
+	int tileWidth  = 0;
+	int tileHeight = 0;
+
+private:
+	const uint8_t* data = nullptr;//!< First tile
+	size_t tilesX       = 0;
+	size_t tileBytes    = 0;
+	void* mapping       = nullptr;//!< Start of the whole mapped file
+	size_t mappingSize  = 0;
+#ifdef _WIN32
+	void* fileHandle    = nullptr;
+	void* mappingHandle = nullptr;
+#endif
+};
+
+vec4 texture( const MappedImage& image, vec2 uv );
+
+// Converts a raw RGBA8 stream of width x height (rows top-down) to the tiled layout, reading tileSize rows at a time,
+// so memory stays at one row of tiles however big the image is.
+bool writeTiledImage( FILE* raw, int width, int height, int tileSize, FILE* tiled, std::string& error );
+
+}// namespace reprojection
@@ -0,0 +1,102 @@
+#pragma once
+#include <cmath>
+
+// Just enough of the GLSL vector types to port Shader.h line by line.
+// Matrices are column-major and the mat3 constructor takes its arguments column by column, exactly like GLSL,
+// so `mat3( 1, 0, 0, 0, cos( th ), -sin( th ), 0, sin( th ), cos( th ) )` means the same thing in both languages.
+namespace reprojection
+{
+const float PI = 3.141592653589793f;
+
+struct vec2
+{
+	float x, y;
+	vec2() : x( 0.0f ), y( 0.0f ) {}
+	vec2( float x, float y ) : x( x ), y( y ) {}
+	explicit vec2( float s ) : x( s ), y( s ) {}
+};
+
+struct vec3
+{
+	float x, y, z;
+	vec3() : x( 0.0f ), y( 0.0f ), z( 0.0f ) {}
+	vec3( float x, float y, float z ) : x( x ), y( y ), z( z ) {}
+	explicit vec3( float s ) : x( s ), y( s ), z( s ) {}
+};
+
+struct vec4
+{
+	float x, y, z, w;
+	vec4() : x( 0.0f ), y( 0.0f ), z( 0.0f ), w( 0.0f ) {}
+	vec4( float x, float y, float z, float w ) : x( x ), y( y ), z( z ), w( w ) {}
+};
+
+struct mat3
+{
+	vec3 c[ 3 ];//!< Columns
+	mat3() : c{ vec3( 1, 0, 0 ), vec3( 0, 1, 0 ), vec3( 0, 0, 1 ) } {}
+	mat3( float m00, float m01, float m02, float m10, float m11, float m12, float m20, float m21, float m22 ) :
+		c{ vec3( m00, m01, m02 ), vec3( m10, m11, m12 ), vec3( m20, m21, m22 ) }
+	{
+	}
+};
+
+inline vec2 operator+( vec2 a, vec2 b ) { return vec2( a.x + b.x, a.y + b.y ); }
+inline vec2 operator-( vec2 a, vec2 b ) { return vec2( a.x - b.x, a.y - b.y ); }
+inline vec2 operator*( vec2 a, vec2 b ) { return vec2( a.x * b.x, a.y * b.y ); }
+inline vec2 operator*( float s, vec2 a ) { return vec2( s * a.x, s * a.y ); }
+inline vec2 operator*( vec2 a, float s ) { return vec2( a.x * s, a.y * s ); }
+inline vec2 operator/( vec2 a, float s ) { return vec2( a.x / s, a.y / s ); }
+inline vec2 operator+( vec2 a, float s ) { return vec2( a.x + s, a.y + s ); }
+inline vec2 operator-( vec2 a, float s ) { return vec2( a.x - s, a.y - s ); }
+inline vec2& operator+=( vec2& a, vec2 b ) { return a = a + b; }
+inline vec2& operator+=( vec2& a, float s ) { return a = a + s; }
+inline vec2& operator*=( vec2& a, vec2 b ) { return a = a * b; }
+inline vec2& operator*=( vec2& a, float s ) { return a = a * s; }
+inline vec2& operator/=( vec2& a, float s ) { return a = a / s; }
+inline bool operator==( vec2 a, vec2 b ) { return a.x == b.x && a.y == b.y; }
+inline bool operator!=( vec2 a, vec2 b ) { return !( a == b ); }
+
+inline vec3 operator+( vec3 a, vec3 b ) { return vec3( a.x + b.x, a.y + b.y, a.z + b.z ); }
+inline vec3 operator-( vec3 a, vec3 b ) { return vec3( a.x - b.x, a.y - b.y, a.z - b.z ); }
+inline vec3 operator-( vec3 a ) { return vec3( -a.x, -a.y, -a.z ); }
+inline vec3 operator*( float s, vec3 a ) { return vec3( s * a.x, s * a.y, s * a.z ); }
+inline vec3 operator*( vec3 a, float s ) { return vec3( a.x * s, a.y * s, a.z * s ); }
+inline vec3 operator/( vec3 a, float s ) { return vec3( a.x / s, a.y / s, a.z / s ); }
+
+inline vec4 operator+( vec4 a, vec4 b ) { return vec4( a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w ); }
+inline vec4 operator*( float s, vec4 a ) { return vec4( s * a.x, s * a.y, s * a.z, s * a.w ); }
+
+inline float dot( vec2 a, vec2 b ) { return a.x * b.x + a.y * b.y; }
+inline float dot( vec3 a, vec3 b ) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+inline float length( vec2 a ) { return std::sqrt( dot( a, a ) ); }
+inline float length( vec3 a ) { return std::sqrt( dot( a, a ) ); }
+inline float distance( vec2 a, vec2 b ) { return length( a - b ); }
+inline float distance( vec3 a, vec3 b ) { return length( a - b ); }
+inline vec3 normalize( vec3 a ) { return a / length( a ); }
+inline vec3 cross( vec3 a, vec3 b )
+{
+	return vec3( a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x );
+}
+inline float smoothstep( float edge0, float edge1, float x )
+{
+	float t = std::fmin( std::fmax( ( x - edge0 ) / ( edge1 - edge0 ), 0.0f ), 1.0f );
+	return t * t * ( 3.0f - 2.0f * t );
+}
+inline vec4 mix( vec4 a, vec4 b, float t ) { return ( 1.0f - t ) * a + t * b; }
+inline vec2 abs( vec2 a ) { return vec2( std::fabs( a.x ), std::fabs( a.y ) ); }
+inline vec3 abs( vec3 a ) { return vec3( std::fabs( a.x ), std::fabs( a.y ), std::fabs( a.z ) ); }
+
+inline vec3 operator*( const mat3& m, vec3 v )
+{
+	return v.x * m.c[ 0 ] + v.y * m.c[ 1 ] + v.z * m.c[ 2 ];
+}
+inline mat3 operator*( const mat3& a, const mat3& b )
+{
+	mat3 result;
+	for( int i = 0; i < 3; ++i )
+		result.c[ i ] = a * b.c[ i ];
+	return result;
+}
+
+}// namespace reprojection
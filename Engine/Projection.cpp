@@ -0,0 +1,672 @@
+#include "Projection.h"
+#include <algorithm>
+#include "FastTrig.h"
+#include "InverseMirror.h"
+#include "ProjectionRegistry.h"
+
+namespace reprojection
+{
+namespace
+{
+// A transformation matrix rotating about the x axis by th degrees.
+mat3 Rx( float th )
+{
+	return mat3( 1, 0, 0, 0, std::cos( th ), -std::sin( th ), 0, std::sin( th ), std::cos( th ) );
+}
+// A transformation matrix rotating about the y axis by th degrees.
+mat3 Ry( float th )
+{
+	return mat3( std::cos( th ), 0, std::sin( th ), 0, 1, 0, -std::sin( th ), 0, std::cos( th ) );
+}
+// A transformation matrix rotating about the z axis by th degrees.
+mat3 Rz( float th )
+{
+	return mat3( std::cos( th ), -std::sin( th ), 0, std::sin( th ), std::cos( th ), 0, 0, 0, 1 );
+}
+
+bool sameLens( const DualFisheyeLens& a, const DualFisheyeLens& b )
+{
+	return a.center == b.center && a.radius == b.radius && a.fov == b.fov;
+}
+
+bool outOfFlatBounds( vec2 xy, float lower, float upper )
+{
+	return xy.x < lower || xy.y < lower || xy.x > upper || xy.y > upper;
+}
+
+// FastTrig on single floats.
+struct ScalarMath
+{
+	typedef float F;
+	typedef bool M;
+
+	static F select( M mask, F a, F b ) { return mask ? a : b; }
+	static F sqrt( F a ) { return std::sqrt( a ); }
+	static F abs( F a ) { return std::fabs( a ); }
+	static F floor( F a ) { return std::floor( a ); }
+};
+typedef FastTrig< ScalarMath > Fast;
+}// namespace
+
+FrameConstants computeFrameConstants( const Uniforms& uniforms, bool waitForInverseMirror )
+{
+	FrameConstants k;
+	// Rotate by pitch about x, then roll about y, then yaw about z.
+	k.rotation = Rx( uniforms.rotation.x ) * Ry( uniforms.rotation.y ) * Rz( uniforms.rotation.z );
+
+	// Projector is at (0, -projDistance, projLift) aimed at the mirror center (the origin).
+	vec3 mirrorCenter = vec3( 0.0f, 0.0f, 0.0f );
+	k.projPos         = vec3( 0.0f, -uniforms.projDistance, uniforms.projLift );
+	k.projForward     = normalize( mirrorCenter - k.projPos );
+	// Build projector's local coordinate system
+	vec3 worldUp = vec3( 0.0f, 0.0f, 1.0f );
+	k.projRight  = normalize( cross( k.projForward, worldUp ) );
+	k.projUp     = normalize( cross( k.projRight, k.projForward ) );
+	// Apply tilt: rotate projForward around projRight by projTilt angle
+	k.projForward = normalize( k.projForward * std::cos( uniforms.projTilt ) + k.projUp * std::sin( uniforms.projTilt ) );
+	// Recompute projUp to stay perpendicular to the tilted forward direction
+	k.projUp  = normalize( cross( k.projRight, k.projForward ) );
+	k.halfTan = std::tan( uniforms.mirrorProjFov / 2.0f );
+
+	k.aspectRatio  = float( uniforms.width ) / float( uniforms.height );
+	k.fovOut       = uniforms.fovOut;
+	k.fovIn        = uniforms.fovIn;
+	k.maxUV        = uniforms.maxUV;
+	k.mirrorRadius = uniforms.mirrorRadius;
+	k.domeRadius   = uniforms.domeRadius;
+	if( uniforms.inputProjection == MIRROR_DOME )
+		k.inverseMirror = waitForInverseMirror ? sharedInverseMirrorMap( uniforms ) : cachedInverseMirrorMap( uniforms );
+	if( uniforms.inputProjection == CUBE_FACES )
+	{
+		// A face is one eye wide and a sixth of one eye high. MaxUV is left out like in sameMapping(), it only ever shrinks
+		// the faces a little.
+		float faceWidth  = float( uniforms.width ) / ( uniforms.stereo == STEREO_SIDE_BY_SIDE ? 2.0f : 1.0f );
+		float faceHeight = float( uniforms.height ) / ( uniforms.stereo == STEREO_OVER_UNDER ? 12.0f : 6.0f );
+		k.cubeFacesEdge  = vec2( std::min( 0.5f / faceWidth, 0.5f ), std::min( 0.5f / faceHeight, 0.5f ) );
+	}
+	const DualFisheyeLens& front = uniforms.frontLens;
+	const DualFisheyeLens& back  = uniforms.backLens;
+	k.frontLens                  = vec4( front.center.x, front.center.y, front.radius, 2.0f / front.fov );
+	k.backLens                   = vec4( back.center.x, back.center.y, back.radius, 2.0f / back.fov );
+	// The cross fade is centered on the plane between the lenses and squeezed into the band both of them see. Without
+	// an overlap it degenerates to a step, smoothstep() needs its edges apart.
+	float seamStart = std::max( PI / 2.0f - uniforms.seamFeather / 2.0f, PI - back.fov / 2.0f );
+	float seamEnd   = std::min( PI / 2.0f + uniforms.seamFeather / 2.0f, front.fov / 2.0f );
+	k.seamBand      = vec2( seamStart, std::max( seamEnd, seamStart + 1e-6f ) );
+	return k;
+}
+
+float Fragment::trigSin( float x ) const
+{
+	return u.precision == PRECISION_FAST ? Fast::sin( x ) : std::sin( x );
+}
+
+float Fragment::trigCos( float x ) const
+{
+	return u.precision == PRECISION_FAST ? Fast::cos( x ) : std::cos( x );
+}
+
+float Fragment::trigTan( float x ) const
+{
+	return u.precision == PRECISION_FAST ? Fast::tan( x ) : std::tan( x );
+}
+
+float Fragment::trigAtan( float x ) const
+{
+	return u.precision == PRECISION_FAST ? Fast::atan( x ) : std::atan( x );
+}
+
+float Fragment::trigAtan( float y, float x ) const
+{
+	return u.precision == PRECISION_FAST ? Fast::atan2( y, x ) : std::atan2( y, x );
+}
+
+// Convert pixel coordinates from an Equirectangular image into a direction on the unit sphere.
+vec3 Fragment::equiUvToDir( vec2 local_uv ) const
+{
+	float lat = local_uv.y * PI - PI / 2.0f;
+	float lon = local_uv.x * 2.0f * PI - PI;
+	vec3 dir;
+	dir.x = trigCos( lat ) * trigSin( lon );
+	dir.y = trigCos( lat ) * trigCos( lon );
+	dir.z = trigSin( lat );
+	return dir;
+}
+
+// Convert a direction to x, y pixel coordinates on an equirectangular image.
+vec2 Fragment::dirToEquiUv( vec3 dir )
+{
+	// Not asin( dir.z / length( dir ) ), which near the poles turns the rounding of its argument into whole pixels.
+	float lat = trigAtan( dir.z, length( vec2( dir.x, dir.y ) ) );
+	float lon = trigAtan( dir.x, dir.y );
+	vec2 local_uv;
+	local_uv.x = ( lon + PI ) / ( 2.0f * PI );
+	local_uv.y = ( lat + PI / 2.0f ) / PI;
+	// Set to transparent if out of bounds
+	if( local_uv.x < -1.0f || local_uv.y < -1.0f || local_uv.x > 1.0f || local_uv.y > 1.0f )
+	{
+		isTransparent = true;
+		return SET_TO_TRANSPARENT;
+	}
+	return local_uv;
+}
+
+// Convert pixel coordinates from a Fisheye image into a direction. The fisheye looks along +Y.
+vec3 Fragment::fisheyeUvToDir( vec2 local_uv, float fovOutput )
+{
+	vec2 pos = 2.0f * local_uv - 1.0f;
+	// The distance from the source pixel to the center of the image
+	float r = length( pos );
+	// Don't bother with pixels outside of the fisheye circle
+	if( 1.0f < r )
+	{
+		isTransparent = true;
+		return vec3( 0.0f, 0.0f, 0.0f );
+	}
+	// Angle between the direction and the Y axis is (PI/2 - lat), lat being the latitude of the lens' own pole.
+	float lat = ( 1.0f - trigTan( trigAtan( r ) / fovOutput ) ) * ( PI / 2.0f );
+	// pos / r is already the cosine and sine of the angle around the lens axis.
+	vec2 around = r > 0.0f ? pos / r : vec2( 0.0f, 0.0f );
+	return vec3( trigCos( lat ) * around.x, trigSin( lat ), trigCos( lat ) * around.y );
+}
+
+// Convert a direction to x, y pixel coordinates on the source fisheye image. The fisheye looks along +Y.
+vec2 Fragment::dirToFisheyeUv( vec3 dir, float fovIn )
+{
+	// Distance of the direction from the lens axis
+	float axisDistance = length( vec2( dir.x, dir.z ) );
+	// Phi and theta are flipped depending on where you read about them.
+	float theta = trigAtan( axisDistance, dir.y );
+	// The distance from the source pixel to the center of the image
+	float r = ( 2.0f / PI ) * ( theta / fovIn );
+	// The angle of the source pixel around the center, as cosine and sine, without calling atan/cos/sin.
+	vec2 around = axisDistance > 0.0f ? vec2( dir.x, dir.z ) / axisDistance : vec2( 1.0f, 0.0f );
+	// Get the position of the source pixel, normalized to be in the range [0,1]
+	vec2 sourcePixel = ( r * around + 1.0f ) / 2.0f;
+	// Don't bother with source pixels outside of the fisheye circle
+	if( 1.0f < r || sourcePixel.x < 0.0f || sourcePixel.y < 0.0f || sourcePixel.x > 1.0f || sourcePixel.y > 1.0f )
+	{
+		isTransparent = true;
+		return SET_TO_TRANSPARENT;
+	}
+	return sourcePixel;
+}
+
+// The image plane sits at y = 1 / fovOutput, so the direction is just the normalized point on it.
+vec3 Fragment::flatImageUvToDir( vec2 local_uv, float fovOutput ) const
+{
+	// Position of the source pixel in uv coordinates in the range [-1,1]
+	vec2 pos = 2.0f * local_uv - 1.0f;
+	return normalize( vec3( pos.x * k.aspectRatio, 1.0f / fovOutput, pos.y ) );
+}
+
+// Project a direction onto the image plane at y = 1 and convert it to x, y pixel coordinates.
+vec2 Fragment::dirToFlatUv( vec3 dir, float fovInput )
+{
+	// Directions behind the image plane never hit it.
+	if( dir.y <= 0.0f )
+	{
+		isTransparent = true;
+		return SET_TO_TRANSPARENT;
+	}
+	// Derive the point on the plane which is hit by the direction.
+	vec2 p = vec2( dir.x, dir.z ) / dir.y;
+	p.x /= k.aspectRatio;
+	// Control the scale with the user's fov input parameter.
+	p *= fovInput;
+	// Position of the source pixel in the source image in the range [0,1]
+	vec2 xyOnImagePlane = p / 2.0f + 0.5f;
+	if( outOfFlatBounds( xyOnImagePlane, 0.0f, 1.0f ) )
+	{
+		isTransparent = true;
+		return SET_TO_TRANSPARENT;
+	}
+	return xyOnImagePlane;
+}
+
+// Convert a cubemap uv to a 3d point on a unit cube
+vec3 Fragment::cubemapUvToPoint( vec2 local_uv ) const
+{
+	float verticalBoundary = 0.5f;
+	float leftBoundary     = 1.0f / 3.0f;
+	float rightBoundary    = 2.0f / 3.0f;
+	// Position of the source pixel in uv coordinates in the range [-1,1]
+	vec2 pos = ( 2.0f * local_uv ) - 1.0f;
+	vec3 point;
+	// Is it a standard cubemap or an EAC?
+	// Link for more details: https://blog.google/products/google-ar-vr/bringing-pixels-front-and-center-vr-video/
+	bool equiAngularCubemap = u.outputProjection == EAC;
+	// An EAC face always spans 90 degrees: its warp is only equi-angular on the unscaled face, so fov Out is left out.
+	float faceDistance = equiAngularCubemap ? 1.0f / 3.0f : k.fovOut / 3.0f;
+	// Remove overlap in the image.
+	float verticalCorrection = 2.0f / 3.0f;
+	// An EAC face spreads the 90 degrees of its edge evenly: the face coordinates 3 pos.x and 2 pos.y, both in [-1, 1],
+	// are angles of +-PI/4 that the point on the cube face is the tangent of. A face is 2/3 of pos wide but 1 high, hence
+	// the different scales.
+	auto equiAngular = [&]() {
+		if( equiAngularCubemap )
+		{
+			pos.x = trigTan( pos.x * ( 3.0f * PI / 4.0f ) ) / 3.0f;
+			pos.y = trigTan( pos.y * ( PI / 2.0f ) ) / 2.0f;
+		}
+	};
+	// Top left face in output image
+	if( local_uv.x <= leftBoundary && verticalBoundary <= local_uv.y )
+	{
+		pos += vec2( 2.0f / 3.0f, -0.5f );
+		equiAngular();
+		// "Left" face of cube
+		point = vec3( -faceDistance, pos.x, verticalCorrection * pos.y );
+	}
+	// Top Middle Face in output image
+	else if( leftBoundary < local_uv.x && local_uv.x <= rightBoundary && verticalBoundary <= local_uv.y )
+	{
+		pos += vec2( 0.0f, -0.5f );
+		equiAngular();
+		// "Front" face of cube
+		point = vec3( pos.x, faceDistance, verticalCorrection * pos.y );
+	}
+	// Top Right Face in output image
+	else if( rightBoundary < local_uv.x && verticalBoundary <= local_uv.y )
+	{
+		pos += vec2( -2.0f / 3.0f, -0.5f );
+		equiAngular();
+		// "Right" face of cube
+		point = vec3( faceDistance, -pos.x, verticalCorrection * pos.y );
+	}
+	// Bottom left face in output image
+	else if( local_uv.x <= leftBoundary && local_uv.y < verticalBoundary )
+	{
+		pos += vec2( 2.0f / 3.0f, 0.5f );
+		equiAngular();
+		// "Top" face of cube
+		point = vec3( -pos.y * verticalCorrection, -pos.x, faceDistance );
+	}
+	// Bottom Middle Face in output image
+	else if( leftBoundary < local_uv.x && local_uv.x <= rightBoundary && local_uv.y < verticalBoundary )
+	{
+		pos += vec2( 0.0f, 0.5f );
+		equiAngular();
+		// "Back" face of cube
+		point = vec3( -pos.y * verticalCorrection, -faceDistance, -pos.x );
+	}
+	// Bottom Right Face in output image
+	else if( rightBoundary < local_uv.x && local_uv.y < verticalBoundary )
+	{
+		pos += vec2( -2.0f / 3.0f, 0.5f );
+		equiAngular();
+		// "Bottom" face of cube
+		point = vec3( -pos.y * verticalCorrection, pos.x, -faceDistance );
+	}
+	return point;
+}
+
+// Convert a cubemap uv to a direction
+vec3 Fragment::cubemapUvToDir( vec2 local_uv ) const
+{
+	return normalize( cubemapUvToPoint( local_uv ) );
+}
+
+// Convert a uv on the CUBE_FACES strip to a direction. Face f covers v in [f/6, (f+1)/6) and is the GL_TEXTURE_CUBE_MAP
+// face POSITIVE_X + f for the direction r = ( x, -z, y ): right, left, down, up, front, back, each upright and seen
+// from inside the cube. sc and tc are the face coordinates the GL spec derives from r, the major axis sits at fovOutput.
+vec3 Fragment::cubeFacesUvToDir( vec2 local_uv, float fovOutput ) const
+{
+	int face = std::min( int( local_uv.y * 6.0f ), 5 );
+	float sc = 2.0f * local_uv.x - 1.0f;
+	float tc = 2.0f * ( local_uv.y * 6.0f - float( face ) ) - 1.0f;
+	float ma = fovOutput;
+	vec3 r;
+	if( face == 0 )
+		r = vec3( ma, -tc, -sc );
+	else if( face == 1 )
+		r = vec3( -ma, -tc, sc );
+	else if( face == 2 )
+		r = vec3( sc, ma, tc );
+	else if( face == 3 )
+		r = vec3( sc, -ma, -tc );
+	else if( face == 4 )
+		r = vec3( sc, -tc, ma );
+	else
+		r = vec3( -sc, -tc, -ma );
+	return normalize( vec3( r.x, r.z, -r.y ) );
+}
+
+// Trace a ray from the projector through the pixel, intersect it with the spherical mirror
+// and return the surface normal of the mirror at the hit point.
+vec3 Fragment::mirrorUvToMirrorNormal( vec2 local_uv )
+{
+	// The projector position and its tilted basis come from the frame constants.
+	vec3 mirrorCenter = vec3( 0.0f, 0.0f, 0.0f );
+
+	// Convert UV [0,1] to pixel position [-1,1] on the projector's image plane
+	vec2 pixelPos = 2.0f * local_uv - 1.0f;
+
+	// Ray direction from projector through this pixel
+	vec3 rayDir = normalize(
+		k.projForward
+		+ k.halfTan * pixelPos.x * k.aspectRatio * k.projRight
+		+ k.halfTan * pixelPos.y * k.projUp );
+
+	// Ray-sphere intersection: ray P = projPos + t * rayDir, sphere |P|^2 = mirrorRadius^2
+	vec3 oc            = k.projPos - mirrorCenter;
+	float b            = 2.0f * dot( oc, rayDir );
+	float c            = dot( oc, oc ) - k.mirrorRadius * k.mirrorRadius;
+	float discriminant = b * b - 4.0f * c;
+
+	if( discriminant < 0.0f )
+	{
+		// Ray misses the mirror
+		isTransparent = true;
+		return vec3( 0.0f, 0.0f, 0.0f );
+	}
+
+	// Take the closer intersection (smaller t)
+	float t = ( -b - std::sqrt( discriminant ) ) / 2.0f;
+	if( t < 0.0f )
+	{
+		// Mirror is behind the projector
+		isTransparent = true;
+		return vec3( 0.0f, 0.0f, 0.0f );
+	}
+
+	// Hit point on mirror surface
+	vec3 hitPoint = k.projPos + t * rayDir;
+
+	// The direction from the mirror center to the hit point is the surface normal
+	return normalize( hitPoint - mirrorCenter );
+}
+
+// Reflect the projector ray off the mirror where its normal is mirrorNormal and intersect it with the dome hemisphere.
+vec3 Fragment::mirrorNormalToDomePoint( vec3 mirrorNormal )
+{
+	vec3 mirrorCenter = vec3( 0.0f, 0.0f, 0.0f );
+
+	// Reconstruct the hit point on the mirror surface from its normal
+	vec3 hitPoint = mirrorCenter + k.mirrorRadius * mirrorNormal;
+
+	// Incident ray direction (from projector to hit point on mirror)
+	vec3 incidentDir = normalize( hitPoint - k.projPos );
+
+	// Reflect the incident ray off the mirror surface
+	// R = I - 2(I . N)N
+	vec3 reflectedDir = incidentDir - 2.0f * dot( incidentDir, mirrorNormal ) * mirrorNormal;
+	reflectedDir      = normalize( reflectedDir );
+
+	// Intersect reflected ray with dome hemisphere (sphere at origin, radius = domeRadius)
+	float b            = 2.0f * dot( hitPoint, reflectedDir );
+	float c            = dot( hitPoint, hitPoint ) - k.domeRadius * k.domeRadius;
+	float discriminant = b * b - 4.0f * c;
+
+	if( discriminant < 0.0f )
+	{
+		isTransparent = true;
+		return vec3( 0.0f, 0.0f, 0.0f );
+	}
+
+	// Take the farther intersection (we are inside the dome, want the outward hit)
+	float t = ( -b + std::sqrt( discriminant ) ) / 2.0f;
+	if( t < 0.0f )
+	{
+		isTransparent = true;
+		return vec3( 0.0f, 0.0f, 0.0f );
+	}
+
+	vec3 domePoint = hitPoint + t * reflectedDir;
+
+	// Only accept points on the upper hemisphere (the dome surface)
+	if( domePoint.z < 0.0f )
+	{
+		isTransparent = true;
+		return vec3( 0.0f, 0.0f, 0.0f );
+	}
+
+	return domePoint;
+}
+
+// Chains the full ray trace: projector pixel -> mirror hit -> reflection -> dome point -> direction.
+vec3 Fragment::mirrorDomeUvToDir( vec2 local_uv )
+{
+	vec3 mirrorNormal = mirrorUvToMirrorNormal( local_uv );
+	if( isTransparent ) return vec3( 0.0f, 0.0f, 0.0f );
+	vec3 domePoint = mirrorNormalToDomePoint( mirrorNormal );
+	if( isTransparent ) return vec3( 0.0f, 0.0f, 0.0f );
+	return normalize( domePoint );
+}
+
+// Look the direction up in the inverse of mirrorDomeUvToDir(), tabulated over the dome master, see InverseMirror.h.
+// Directions below the dome's horizon and parts of the dome the projector does not reach are transparent.
+vec2 Fragment::dirToMirrorDomeUv( vec3 dir )
+{
+	float axisDistance = length( vec2( dir.x, dir.y ) );
+	float theta        = trigAtan( axisDistance, dir.z );
+	vec2 around        = axisDistance > 0.0f ? vec2( dir.x, dir.y ) / axisDistance : vec2( 0.0f, 0.0f );
+	vec2 domeUv        = ( theta / ( PI / 2.0f ) * around + 1.0f ) / 2.0f;
+	vec2 sourcePixel   = dir.z < 0.0f || !k.inverseMirror ? SET_TO_TRANSPARENT : k.inverseMirror->lookup( domeUv );
+	if( sourcePixel.x < 0.0f )
+	{
+		isTransparent = true;
+		return SET_TO_TRANSPARENT;
+	}
+	return sourcePixel;
+}
+
+vec2 Fragment::dirToCubemapUv( vec3 point, float fovInput )
+{
+	// The inverse of equiAngular() in cubemapUvToPoint(): from the tangent on the cube face back to the angle. Like there
+	// an EAC face always spans 90 degrees and fovInput is left out.
+	bool equiAngularCubemap  = u.inputProjection == EAC;
+	float faceDistance       = equiAngularCubemap ? 1.0f / 3.0f : fovInput / 3.0f;
+	float verticalCorrection = 2.0f / 3.0f;
+	float epsilon            = 0.000001f;
+	vec2 pos;
+	vec2 local_uv;
+	vec3 absPoint = abs( point );
+	auto equiAngular        = [&]() {
+		if( equiAngularCubemap )
+		{
+			pos.x = trigAtan( 3.0f * pos.x ) * ( 4.0f / ( 3.0f * PI ) );
+			pos.y = trigAtan( 2.0f * pos.y ) * ( 2.0f / PI );
+		}
+	};
+
+	if( absPoint.x >= absPoint.y && absPoint.x >= absPoint.z )
+	{
+		if( std::fabs( point.x ) < epsilon )
+		{
+			isTransparent = true;
+			return SET_TO_TRANSPARENT;
+		}
+		if( point.x < 0.0f )
+		{
+			pos.x      = -faceDistance * point.y / point.x;
+			pos.y      = -faceDistance * point.z / ( verticalCorrection * point.x );
+			equiAngular();
+			local_uv.x = ( pos.x + 1.0f / 3.0f ) / 2.0f;
+			local_uv.y = ( pos.y + 1.5f ) / 2.0f;
+		}
+		else
+		{
+			pos.x      = -faceDistance * point.y / point.x;
+			pos.y      = faceDistance * point.z / ( verticalCorrection * point.x );
+			equiAngular();
+			local_uv.x = ( pos.x + 5.0f / 3.0f ) / 2.0f;
+			local_uv.y = ( pos.y + 1.5f ) / 2.0f;
+		}
+	}
+	else if( absPoint.y >= absPoint.x && absPoint.y >= absPoint.z )
+	{
+		if( std::fabs( point.y ) < epsilon )
+		{
+			isTransparent = true;
+			return SET_TO_TRANSPARENT;
+		}
+		if( point.y > 0.0f )
+		{
+			pos.x      = faceDistance * point.x / point.y;
+			pos.y      = faceDistance * point.z / ( verticalCorrection * point.y );
+			equiAngular();
+			local_uv.x = ( pos.x + 1.0f ) / 2.0f;
+			local_uv.y = ( pos.y + 1.5f ) / 2.0f;
+		}
+		else
+		{
+			pos.x      = faceDistance * point.z / point.y;
+			pos.y      = faceDistance * point.x / ( verticalCorrection * point.y );
+			equiAngular();
+			local_uv.x = ( pos.x + 1.0f ) / 2.0f;
+			local_uv.y = ( pos.y + 0.5f ) / 2.0f;
+		}
+	}
+	else
+	{
+		if( std::fabs( point.z ) < epsilon )
+		{
+			isTransparent = true;
+			return SET_TO_TRANSPARENT;
+		}
+		if( point.z > 0.0f )
+		{
+			pos.x      = -faceDistance * point.y / point.z;
+			pos.y      = -faceDistance * point.x / ( verticalCorrection * point.z );
+			equiAngular();
+			local_uv.x = ( pos.x + 1.0f / 3.0f ) / 2.0f;
+			local_uv.y = ( pos.y + 0.5f ) / 2.0f;
+		}
+		else
+		{
+			pos.x      = -faceDistance * point.y / point.z;
+			pos.y      = faceDistance * point.x / ( verticalCorrection * point.z );
+			equiAngular();
+			local_uv.x = ( pos.x + 5.0f / 3.0f ) / 2.0f;
+			local_uv.y = ( pos.y + 0.5f ) / 2.0f;
+		}
+	}
+
+	if( outOfFlatBounds( local_uv, 0.0f, 1.0f ) )
+	{
+		isTransparent = true;
+		return SET_TO_TRANSPARENT;
+	}
+	return local_uv;
+}
+
+// What the cube map sampler of the GL side does for dir: pick the face by the major axis of r = ( x, -z, y ) and
+// project onto it, see cubeFacesUvToDir(). The face coordinates are scaled by fovInput like the CUBEMAP atlas' are.
+// The shader gets the same face from the minor components of r scaled by fovInput, see cubeFacesLookupDir() there.
+vec2 Fragment::dirToCubeFacesUv( vec3 dir, float fovInput )
+{
+	vec3 r   = vec3( dir.x, -dir.z, dir.y );
+	vec3 a   = abs( r );
+	int face = 0;
+	float sc, tc, ma;
+	if( a.x >= a.y && a.x >= a.z )
+	{
+		ma   = a.x;
+		face = r.x > 0.0f ? 0 : 1;
+		sc   = r.x > 0.0f ? -r.z : r.z;
+		tc   = -r.y;
+	}
+	else if( a.y >= a.z )
+	{
+		ma   = a.y;
+		face = r.y > 0.0f ? 2 : 3;
+		sc   = r.x;
+		tc   = r.y > 0.0f ? r.z : -r.z;
+	}
+	else
+	{
+		ma   = a.z;
+		face = r.z > 0.0f ? 4 : 5;
+		sc   = r.z > 0.0f ? r.x : -r.x;
+		tc   = -r.y;
+	}
+	vec2 st = ( fovInput * vec2( sc, tc ) / ma + 1.0f ) / 2.0f;
+	// Only a fovInput above 1 reaches past the face, where the hardware would pick its neighbour.
+	if( ma == 0.0f || outOfFlatBounds( st, 0.0f, 1.0f ) )
+	{
+		isTransparent = true;
+		return SET_TO_TRANSPARENT;
+	}
+	// The faces are stacked without a gutter: keep the bilinear footprint off the face above and below, and off the
+	// other eye beside a side by side one.
+	st = vec2( std::min( std::max( st.x, k.cubeFacesEdge.x ), 1.0f - k.cubeFacesEdge.x ),
+			   std::min( std::max( st.y, k.cubeFacesEdge.y ), 1.0f - k.cubeFacesEdge.y ) );
+	return vec2( st.x, ( float( face ) + st.y ) / 6.0f );
+}
+
+// Where the lens whose calibration is lens sees the direction theta radians off its axis, around its axis in the
+// direction around, in the uv of its half of the frame. The equidistant mapping of dirToFisheyeUv() with the lens' own
+// FoV, center and radius.
+vec2 Fragment::dualFisheyeLensUv( float theta, vec2 around, vec4 lens ) const
+{
+	return vec2( lens.x, lens.y ) + 0.5f * lens.z * ( theta * lens.w ) * around;
+}
+
+// Both lenses of a DUAL_FISHEYE input from one atan2: the back lens sees the direction PI - theta off its axis, with
+// x mirrored since it looks the other way. Where both circles hold it, the lens with the larger weight in the cross fade
+// over seamBand is returned, the other one goes to seamPixel with its weight in seamWeight to be blended in.
+vec2 Fragment::dirToDualFisheyeUv( vec3 dir )
+{
+	float axisDistance = length( vec2( dir.x, dir.z ) );
+	float theta        = trigAtan( axisDistance, dir.y );
+	vec2 around        = axisDistance > 0.0f ? vec2( dir.x, dir.z ) / axisDistance : vec2( 1.0f, 0.0f );
+	vec2 front         = dualFisheyeLensUv( theta, around, k.frontLens );
+	vec2 back          = dualFisheyeLensUv( PI - theta, vec2( -around.x, around.y ), k.backLens );
+	bool frontSees     = theta * k.frontLens.w <= 1.0f && !outOfFlatBounds( front, 0.0f, 1.0f );
+	bool backSees      = ( PI - theta ) * k.backLens.w <= 1.0f && !outOfFlatBounds( back, 0.0f, 1.0f );
+	if( !frontSees && !backSees )
+	{
+		isTransparent = true;
+		return SET_TO_TRANSPARENT;
+	}
+	float frontWeight = !backSees ? 1.0f : ( !frontSees ? 0.0f : 1.0f - smoothstep( k.seamBand.x, k.seamBand.y, theta ) );
+	// The front lens fills the left half of the frame, the back lens the right half.
+	front.x         = front.x * 0.5f;
+	back.x          = back.x * 0.5f + 0.5f;
+	bool frontFirst = frontWeight >= 0.5f;
+	seamPixel       = frontFirst ? back : front;
+	seamWeight      = frontFirst ? 1.0f - frontWeight : frontWeight;
+	return frontFirst ? front : back;
+}
+
+const char* projectionName( int projection )
+{
+	return projectionInfo( projection ).name;
+}
+
+const char* stereoModeName( int stereo )
+{
+	static const char* names[ STEREO_MODE_COUNT ] = { "mono", "over-under", "side-by-side" };
+	return stereo >= 0 && stereo < STEREO_MODE_COUNT ? names[ stereo ] : "unknown";
+}
+
+const char* precisionModeName( int precision )
+{
+	static const char* names[ PRECISION_MODE_COUNT ] = { "exact", "fast" };
+	return precision >= 0 && precision < PRECISION_MODE_COUNT ? names[ precision ] : "unknown";
+}
+
+bool sameMapping( const Uniforms& a, const Uniforms& b )
+{
+	return a.rotation.x == b.rotation.x && a.rotation.y == b.rotation.y && a.rotation.z == b.rotation.z &&
+		   a.inputProjection == b.inputProjection && a.outputProjection == b.outputProjection && a.stereo == b.stereo &&
+		   a.precision == b.precision &&
+		   a.width == b.width && a.height == b.height && a.fovOut == b.fovOut && a.fovIn == b.fovIn &&
+		   a.mirrorRadius == b.mirrorRadius && a.projDistance == b.projDistance && a.projLift == b.projLift &&
+		   a.mirrorProjFov == b.mirrorProjFov && a.projTilt == b.projTilt && a.domeRadius == b.domeRadius &&
+		   sameLens( a.frontLens, b.frontLens ) && sameLens( a.backLens, b.backLens ) && a.seamFeather == b.seamFeather;
+}
+
+vec2 reprojectUv( const Uniforms& uniforms, const FrameConstants& constants, vec2 uv )
+{
+	Fragment fragment( uniforms, constants );
+	return fragment.main( uv );
+}
+
+vec2 reprojectUv( const Uniforms& uniforms, vec2 uv )
+{
+	return reprojectUv( uniforms, computeFrameConstants( uniforms ), uv );
+}
+
+}// namespace reprojection
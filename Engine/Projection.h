@@ -0,0 +1,187 @@
+#pragma once
+#include <memory>
+#include "Math.h"
+
+// A C++ port of the projection math in Reprojection/Shader.h.
+// Function names, argument order and transparency handling follow the GLSL one to one so the two can be diffed
+// side by side. When you change one, change the other.
+namespace reprojection
+{
+struct InverseMirrorMap;
+
+// Projection type constants, also the option values of both plugins. Each one has a ProjectionTraits specialization in
+// ProjectionRegistry.h, which Shader.h and the plugins are generated from.
+enum ProjectionType : int
+{
+	EQUI         = 0,
+	FISHEYE      = 1,
+	FLAT         = 2,
+	CUBEMAP      = 3,
+	MIRROR_DOME  = 4,
+	EAC          = 5,//!< Equi-angular cubemap: the CUBEMAP atlas with faces sampled evenly in angle
+	CUBE_FACES   = 6,//!< Six square faces stacked bottom up in GL_TEXTURE_CUBE_MAP order, see dirToCubeFacesUv()
+	DUAL_FISHEYE = 7 //!< Two back to back fisheye circles side by side, see dirToDualFisheyeUv(). Input only
+};
+
+enum StereoMode : int
+{
+	STEREO_NONE         = 0,
+	STEREO_OVER_UNDER   = 1,
+	STEREO_SIDE_BY_SIDE = 2
+};
+
+// How the per-pixel trig is evaluated. Like the projections and stereo mode it is compiled into the shader.
+enum PrecisionMode : int
+{
+	PRECISION_EXACT = 0,//!< The library / GLSL built-ins
+	PRECISION_FAST  = 1 //!< The minimax polynomials in FastTrig.h, see there for their error
+};
+
+const int PROJECTION_COUNT     = DUAL_FISHEYE + 1;
+const int STEREO_MODE_COUNT    = STEREO_SIDE_BY_SIDE + 1;
+const int PRECISION_MODE_COUNT = PRECISION_FAST + 1;
+
+// Short lower case names, used by the command line tools and their reports.
+const char* projectionName( int projection );
+const char* stereoModeName( int stereo );
+const char* precisionModeName( int precision );
+
+// Calibration of one lens of a DUAL_FISHEYE input, in the half of the frame that lens fills.
+struct DualFisheyeLens
+{
+	vec2 center  = vec2( 0.5f, 0.5f );  //!< Center of the image circle in the uv of the half frame
+	float radius = 1.0f;                //!< Of the image circle, 1 touches the edges of a square half frame
+	float fov    = 190.0f * PI / 180.0f;//!< Full field of view the circle spans in radians, equidistant like FISHEYE
+};
+
+// The plugin parameters the shader is built from. Values are already mapped from the [0,1] sliders to their
+// physical ranges, the same way currentUniforms() does in the plugins.
+struct Uniforms
+{
+	vec3 rotation;                   //!< pitch, roll, yaw in radians
+	vec2 maxUV = vec2( 1.0f, 1.0f ); //!< Content area of the input texture
+	int inputProjection  = EQUI;
+	int outputProjection = EQUI;
+	int stereo           = STEREO_NONE;
+	int precision        = PRECISION_EXACT;
+	int width            = 1;//!< Width of the input texture in pixels
+	int height           = 1;//!< Height of the input texture in pixels
+	float fovOut         = PI / 4.0f;
+	float fovIn          = PI / 4.0f;
+	// Mirror dome parameters, see Shader.h for their units.
+	float mirrorRadius  = 0.255f;
+	float projDistance  = 1.75f;
+	float projLift      = 0.0f;
+	float mirrorProjFov = 0.147174f;
+	float projTilt      = 0.0864f;
+	float domeRadius    = 1.0f;
+	// Dual fisheye parameters: the front lens looks along +Y and fills the left half of the frame, the back lens looks
+	// along -Y and fills the right half. Where both see a direction they are cross faded over seamFeather radians.
+	DualFisheyeLens frontLens;
+	DualFisheyeLens backLens;
+	float seamFeather = 10.0f * PI / 180.0f;
+};
+
+// True when both sets of uniforms produce the same mapping from output uv to input uv (MaxUV is applied afterwards and ignored).
+bool sameMapping( const Uniforms& a, const Uniforms& b );
+
+// Everything in the shader that only depends on the parameters, evaluated once per frame instead of per pixel.
+// This is the CPU side of the FrameConstants uniform block in Shader.h.
+struct FrameConstants
+{
+	mat3 rotation;//!< Rx( pitch ) * Ry( roll ) * Rz( yaw )
+	// Mirror dome projector, aimed at the mirror center and tilted by projTilt.
+	vec3 projPos;
+	vec3 projForward;
+	vec3 projRight;
+	vec3 projUp;
+	float halfTan;    //!< tan( mirrorProjFov / 2 )
+	float aspectRatio;//!< width / height of the input texture
+	float fovOut;
+	float fovIn;
+	vec2 maxUV;
+	float mirrorRadius;
+	float domeRadius;
+	vec4 frontLens;//!< center, radius and 2 / fov of DualFisheyeLens
+	vec4 backLens;
+	vec2 seamBand;//!< Angles from the front lens axis the seam cross fade runs between, clamped to where both lenses see
+	// Not part of the uniform block: the table dirToMirrorDomeUv() looks directions up in, set only when the input
+	// projection is MIRROR_DOME. The GL side uploads it as InverseMirrorTexture, see Engine/InverseMirror.h.
+	std::shared_ptr< const InverseMirrorMap > inverseMirror;
+	// Not part of the uniform block either: half a texel of one face of the CUBE_FACES strip across and up, in face
+	// coordinates. dirToCubeFacesUv() keeps its bilinear fetch that far inside the face, off its neighbours and off the
+	// other stereo eye. The GL side samples a cube map instead.
+	vec2 cubeFacesEdge = vec2( 0.0f, 0.0f );
+};
+
+// waitForInverseMirror false only takes a MIRROR_DOME input's inverse from the cache and leaves inverseMirror null while
+// it is not built yet, for callers that cannot wait for a build or only need the output half, see AsyncInverseMirror.
+FrameConstants computeFrameConstants( const Uniforms& uniforms, bool waitForInverseMirror = true );
+
+const vec2 SET_TO_TRANSPARENT = vec2( -1.0f, -1.0f );
+
+// State of a single fragment shader invocation: the uniforms plus the shader's global isTransparent flag.
+struct Fragment
+{
+	Fragment( const Uniforms& uniforms, const FrameConstants& constants ) : u( uniforms ), k( constants ), isTransparent( false ) {}
+
+	// The trig the projections call, std:: or FastTrig depending on u.precision. Shader.h has the same functions.
+	float trigSin( float x ) const;
+	float trigCos( float x ) const;
+	float trigTan( float x ) const;
+	float trigAtan( float x ) const;
+	float trigAtan( float y, float x ) const;
+
+	// Output projections: uv -> unit direction.
+	vec3 equiUvToDir( vec2 local_uv ) const;
+	vec3 fisheyeUvToDir( vec2 local_uv, float fovOutput );
+	vec3 flatImageUvToDir( vec2 local_uv, float fovOutput ) const;
+	vec3 cubemapUvToPoint( vec2 local_uv ) const;
+	vec3 cubemapUvToDir( vec2 local_uv ) const;
+	vec3 cubeFacesUvToDir( vec2 local_uv, float fovOutput ) const;
+	vec3 mirrorUvToMirrorNormal( vec2 local_uv );
+	vec3 mirrorNormalToDomePoint( vec3 mirrorNormal );
+	vec3 mirrorDomeUvToDir( vec2 local_uv );
+
+	// Input projections: direction -> uv.
+	vec2 dirToEquiUv( vec3 dir );
+	vec2 dirToFisheyeUv( vec3 dir, float fovIn );
+	vec2 dirToFlatUv( vec3 dir, float fovInput );
+	vec2 dirToCubemapUv( vec3 point, float fovInput );
+	vec2 dirToCubeFacesUv( vec3 dir, float fovInput );
+	vec2 dualFisheyeLensUv( float theta, vec2 around, vec4 lens ) const;
+	vec2 dirToDualFisheyeUv( vec3 dir );
+	vec2 dirToMirrorDomeUv( vec3 dir );
+
+	// main() without the final texture fetch. Returns the (MaxUV scaled) coordinate to sample the input at,
+	// or SET_TO_TRANSPARENT when the output pixel should be left transparent.
+	vec2 main( vec2 uv );
+	// main() with both projections fixed at compile time through their ProjectionTraits, so it has no branch on them.
+	// main() calls the instantiation for u's projections, see reprojectFunction() in ProjectionRegistry.h. Resets the
+	// globals first, so one Fragment can run any number of pixels.
+	template< int InputProjection, int OutputProjection >
+	vec2 specializedMain( vec2 uv );
+
+	const Uniforms& u;
+	const FrameConstants& k;
+	bool isTransparent;//!< The shader's global flag, set by any stage that wants the pixel to be transparent.
+	// The shader's other two globals: the uv of the lens dirToDualFisheyeUv() did not return, and its weight in the
+	// seam cross fade. Wherever the weight is above 0, main() squeezes and scales seamPixel like its result, and the
+	// renderers mix a second fetch from there into the first, mix( color, texture( seamPixel ), seamWeight ).
+	vec2 seamPixel   = SET_TO_TRANSPARENT;
+	float seamWeight = 0.0f;
+};
+
+// Runs a fresh Fragment for a single output uv.
+vec2 reprojectUv( const Uniforms& uniforms, const FrameConstants& constants, vec2 uv );
+// Same, but computes the frame constants too. Only meant for one-off lookups.
+vec2 reprojectUv( const Uniforms& uniforms, vec2 uv );
+
+// The output projection block of main() alone, for a uv already stretched over one stereo eye: the unrotated direction
+// of local_uv in dir. Returns false where the output projection makes the pixel transparent. Clears isTransparent first.
+bool outputDirection( Fragment& fragment, vec2 local_uv, vec3& dir );
+// The input projection block of main() alone, for a direction already rotated: the uv of the input dir lands on, before
+// the stereo squeeze and MaxUV. Returns false where the input projection makes the pixel transparent. Clears isTransparent first.
+bool inputUv( Fragment& fragment, vec3 dir, vec2& sourcePixel );
+
+}// namespace reprojection
@@ -0,0 +1,230 @@
+#include "ProjectionRegistry.h"
+#include <cstring>
+#include <utility>
+
+namespace reprojection
+{
+namespace
+{
+typedef std::make_integer_sequence< int, PROJECTION_COUNT > AllProjections;
+typedef std::make_integer_sequence< int, PROJECTION_COUNT * PROJECTION_COUNT > AllPairs;
+
+// &Entry< P >::call for every P of the sequence, in order: a table the runtime projection indexes into.
+template< template< int > class Entry, class Function, int... Indices >
+const Function* functionTable( std::integer_sequence< int, Indices... > )
+{
+	static const Function table[] = { &Entry< Indices >::call... };
+	return table;
+}
+
+template< int... Projections >
+const ProjectionInfo* infoTable( std::integer_sequence< int, Projections... > )
+{
+	static const ProjectionInfo table[] = { ProjectionTraits< Projections >::info()... };
+	return table;
+}
+
+bool isProjection( int projection )
+{
+	return projection >= 0 && projection < PROJECTION_COUNT;
+}
+
+// Pair is inputProjection * PROJECTION_COUNT + outputProjection.
+template< int Pair >
+struct ReprojectEntry
+{
+	static vec2 call( Fragment& fragment, vec2 uv )
+	{
+		return fragment.specializedMain< Pair / PROJECTION_COUNT, Pair % PROJECTION_COUNT >( uv );
+	}
+};
+
+// The end of main(): squeezes sourcePixel into the stereo half the output pixel is in, then applies MaxUV.
+vec2 squeezeIntoEye( const Uniforms& u, const FrameConstants& k, bool stereoImageSecondHalf, vec2 sourcePixel )
+{
+	if( u.stereo == STEREO_OVER_UNDER )
+	{
+		if( stereoImageSecondHalf )
+			sourcePixel.y = sourcePixel.y / 2.0f + 0.5f;
+		else
+			sourcePixel.y = sourcePixel.y / 2.0f;
+	}
+	else if( u.stereo == STEREO_SIDE_BY_SIDE )
+	{
+		if( stereoImageSecondHalf )
+			sourcePixel.x = sourcePixel.x / 2.0f + 0.5f;
+		else
+			sourcePixel.x = sourcePixel.x / 2.0f;
+	}
+	// Applying the MaxUV after our operations fixes the "seam" from
+	// https://github.com/DanielArnett/360-VJ/issues/10
+	sourcePixel *= k.maxUV;
+	return sourcePixel;
+}
+
+vec2 transparentReprojection( Fragment& fragment, vec2 )
+{
+	fragment.isTransparent = true;
+	return SET_TO_TRANSPARENT;
+}
+
+typedef bool ( *OutputDirectionFunction )( Fragment& fragment, vec2 local_uv, vec3& dir );
+typedef bool ( *InputUvFunction )( Fragment& fragment, vec3 dir, vec2& sourcePixel );
+
+template< int Projection >
+struct OutputDirectionEntry
+{
+	static bool call( Fragment& fragment, vec2 local_uv, vec3& dir )
+	{
+		fragment.isTransparent = false;
+		dir                    = ProjectionTraits< Projection >::uvToDir( fragment, local_uv );
+		return !fragment.isTransparent;
+	}
+};
+
+template< int Projection >
+struct InputUvEntry
+{
+	static bool call( Fragment& fragment, vec3 dir, vec2& sourcePixel )
+	{
+		fragment.isTransparent = false;
+		sourcePixel            = ProjectionTraits< Projection >::dirToUv( fragment, dir );
+		return !fragment.isTransparent;
+	}
+};
+}// namespace
+
+template< int InputProjection, int OutputProjection >
+vec2 Fragment::specializedMain( vec2 uv )
+{
+	isTransparent = false;
+	seamPixel     = SET_TO_TRANSPARENT;
+	seamWeight    = 0.0f;
+
+	vec2 local_uv              = uv;
+	bool stereoImageSecondHalf = false;
+	if( u.stereo == STEREO_OVER_UNDER )
+	{
+		if( local_uv.y <= 0.5f )
+		{
+			local_uv.y = local_uv.y * 2.0f;
+		}
+		else
+		{
+			local_uv.y            = ( local_uv.y - 0.5f ) * 2.0f;
+			stereoImageSecondHalf = true;
+		}
+	}
+	if( u.stereo == STEREO_SIDE_BY_SIDE )
+	{
+		if( local_uv.x <= 0.5f )
+		{
+			local_uv.x = local_uv.x * 2.0f;
+		}
+		else
+		{
+			local_uv.x            = ( local_uv.x - 0.5f ) * 2.0f;
+			stereoImageSecondHalf = true;
+		}
+	}
+	// Direction of the destination pixel (uv) on the unit sphere
+	vec3 dir = ProjectionTraits< OutputProjection >::uvToDir( *this, local_uv );
+	if( isTransparent )
+		return SET_TO_TRANSPARENT;
+
+	// Rotate the direction based on the user input in radians
+	dir = k.rotation * dir;
+	// Convert to the normalized pixel coordinate
+	vec2 sourcePixel = ProjectionTraits< InputProjection >::dirToUv( *this, dir );
+	if( isTransparent )
+		return SET_TO_TRANSPARENT;
+
+	// The other lens of a DUAL_FISHEYE input inside the seam band is fetched from the same stereo half.
+	if( seamWeight > 0.0f )
+		seamPixel = squeezeIntoEye( u, k, stereoImageSecondHalf, seamPixel );
+	sourcePixel = squeezeIntoEye( u, k, stereoImageSecondHalf, sourcePixel );
+	return sourcePixel;
+}
+
+const ProjectionInfo& projectionInfo( int projection )
+{
+	static const ProjectionInfo* infos = infoTable( AllProjections() );
+	static const ProjectionInfo unknown = { "unknown", "UNKNOWN", "Unknown", false, false, false, "SET_TO_TRANSPARENT", "SET_TO_TRANSPARENT" };
+	return isProjection( projection ) ? infos[ projection ] : unknown;
+}
+
+std::vector< int > projectionOptions( bool input, bool mirrorDomePlugin )
+{
+	std::vector< int > options;
+	for( int projection = 0; projection < PROJECTION_COUNT; ++projection )
+	{
+		const ProjectionInfo& info = projectionInfo( projection );
+		if( ( input ? info.input : info.output ) && ( mirrorDomePlugin || !info.mirrorDomePlugin ) )
+			options.push_back( projection );
+	}
+	return options;
+}
+
+std::string projectionNameList( bool input )
+{
+	std::vector< int > projections = projectionOptions( input, true );
+	std::string list;
+	for( size_t i = 0; i < projections.size(); ++i )
+	{
+		if( i > 0 )
+			list += i + 1 == projections.size() ? " or " : ", ";
+		list += projectionInfo( projections[ i ] ).name;
+	}
+	return list;
+}
+
+bool parseProjection( const char* name, bool input, int& projection )
+{
+	for( int candidate : projectionOptions( input, true ) )
+	{
+		if( std::strcmp( name, projectionInfo( candidate ).name ) == 0 )
+		{
+			projection = candidate;
+			return true;
+		}
+	}
+	return false;
+}
+
+ReprojectFunction reprojectFunction( int inputProjection, int outputProjection )
+{
+	static const ReprojectFunction* table = functionTable< ReprojectEntry, ReprojectFunction >( AllPairs() );
+	if( !isProjection( inputProjection ) || !isProjection( outputProjection ) )
+		return &transparentReprojection;
+	return table[ inputProjection * PROJECTION_COUNT + outputProjection ];
+}
+
+vec2 Fragment::main( vec2 uv )
+{
+	return reprojectFunction( u.inputProjection, u.outputProjection )( *this, uv );
+}
+
+bool outputDirection( Fragment& fragment, vec2 local_uv, vec3& dir )
+{
+	static const OutputDirectionFunction* table = functionTable< OutputDirectionEntry, OutputDirectionFunction >( AllProjections() );
+	if( !isProjection( fragment.u.outputProjection ) )
+	{
+		fragment.isTransparent = true;
+		return false;
+	}
+	return table[ fragment.u.outputProjection ]( fragment, local_uv, dir );
+}
+
+bool inputUv( Fragment& fragment, vec3 dir, vec2& sourcePixel )
+{
+	static const InputUvFunction* table = functionTable< InputUvEntry, InputUvFunction >( AllProjections() );
+	if( !isProjection( fragment.u.inputProjection ) )
+	{
+		fragment.isTransparent = true;
+		sourcePixel            = SET_TO_TRANSPARENT;
+		return false;
+	}
+	return table[ fragment.u.inputProjection ]( fragment, dir, sourcePixel );
+}
+
+}// namespace reprojection
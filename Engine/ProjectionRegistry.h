@@ -0,0 +1,225 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "Projection.h"
+
+namespace reprojection
+{
+// The projections, each described once by a ProjectionTraits specialization. Everything that used to list them one
+// by one is generated from the traits instead:
+// - projectionInfo(): the names the tools parse and print, and the options the plugins offer, see projectionOptions();
+// - the GLSL calls buildFragmentShader() #defines as OUTPUT_UV_TO_DIR and INPUT_DIR_TO_UV, so main() in Shader.h
+//   calls the two projections of its program without a chain of #ifs;
+// - Fragment::specializedMain(), main() for one (input, output) pair with both projections picked at compile time,
+//   one instantiation per pair, see reprojectFunction();
+// - the batch kernels of SimdKernel.h, likewise one instantiation per pair.
+// Adding a projection takes a ProjectionType (and PROJECTION_COUNT), its functions in Projection.cpp, SimdKernel.h and
+// Shader.h, and a trait here; the plugins, the tools and every dispatch pick it up from there, and no existing pair
+// gets a new branch.
+struct ProjectionInfo
+{
+	const char* name;       //!< Short lower case name, see projectionName()
+	const char* constant;   //!< The ProjectionType enumerator, which buildFragmentShader() #defines for the #if blocks
+	const char* label;      //!< Option label in the plugins
+	bool input;             //!< Works as an input projection
+	bool output;            //!< Works as an output projection
+	bool mirrorDomePlugin;  //!< Only the MirrorDome plugin offers it
+	const char* glslUvToDir;//!< GLSL expression for the direction of local_uv, see OUTPUT_UV_TO_DIR in Shader.h
+	const char* glslDirToUv;//!< GLSL expression for the source uv of dir, see INPUT_DIR_TO_UV in Shader.h
+};
+
+// Each specialization holds:
+//   info()                                    its ProjectionInfo
+//   uvToDir( fragment, local_uv )             Fragment's output projection, setting isTransparent where it has no direction
+//   dirToUv( fragment, dir )                  Fragment's input projection
+//   batchUvToDir< K, T >( k, u, v, transparent )           the same for a batch of pixels in BatchKernel K, trig from T
+//   batchDirToUv< K, T >( k, dir, u, v, transparent )
+// The batch functions are only instantiated by SimdKernel.h, in the translation units built for their batch type.
+template< int Projection >
+struct ProjectionTraits;
+
+template<>
+struct ProjectionTraits< EQUI >
+{
+	static ProjectionInfo info() { return { "equi", "EQUI", "Equirectangular", true, true, false, "equiUvToDir( local_uv )", "dirToEquiUv( dir )" }; }
+	static vec3 uvToDir( Fragment& fragment, vec2 local_uv ) { return fragment.equiUvToDir( local_uv ); }
+	static vec2 dirToUv( Fragment& fragment, vec3 dir ) { return fragment.dirToEquiUv( dir ); }
+	template< class K, class T >
+	static typename K::V3 batchUvToDir( const FrameConstants&, typename K::F u, typename K::F v, typename K::M& )
+	{
+		return K::template equiUvToDir< T >( u, v );
+	}
+	template< class K, class T >
+	static void batchDirToUv( const FrameConstants&, typename K::V3 dir, typename K::F& u, typename K::F& v, typename K::M& transparent )
+	{
+		K::template dirToEquiUv< T >( dir, u, v, transparent );
+	}
+};
+
+template<>
+struct ProjectionTraits< FISHEYE >
+{
+	static ProjectionInfo info()
+	{
+		return { "fisheye", "FISHEYE", "Fisheye", true, true, false, "fisheyeUvToDir( local_uv, fovOut )", "dirToFisheyeUv( dir, fovIn )" };
+	}
+	static vec3 uvToDir( Fragment& fragment, vec2 local_uv ) { return fragment.fisheyeUvToDir( local_uv, fragment.k.fovOut ); }
+	static vec2 dirToUv( Fragment& fragment, vec3 dir ) { return fragment.dirToFisheyeUv( dir, fragment.k.fovIn ); }
+	template< class K, class T >
+	static typename K::V3 batchUvToDir( const FrameConstants& k, typename K::F u, typename K::F v, typename K::M& transparent )
+	{
+		return K::template fisheyeUvToDir< T >( u, v, k.fovOut, transparent );
+	}
+	template< class K, class T >
+	static void batchDirToUv( const FrameConstants& k, typename K::V3 dir, typename K::F& u, typename K::F& v, typename K::M& transparent )
+	{
+		K::template dirToFisheyeUv< T >( dir, k.fovIn, u, v, transparent );
+	}
+};
+
+template<>
+struct ProjectionTraits< FLAT >
+{
+	static ProjectionInfo info()
+	{
+		return { "flat", "FLAT", "Flat", true, true, false, "flatImageUvToDir( local_uv, fovOut )", "dirToFlatUv( dir, fovIn )" };
+	}
+	static vec3 uvToDir( Fragment& fragment, vec2 local_uv ) { return fragment.flatImageUvToDir( local_uv, fragment.k.fovOut ); }
+	static vec2 dirToUv( Fragment& fragment, vec3 dir ) { return fragment.dirToFlatUv( dir, fragment.k.fovIn ); }
+	template< class K, class T >
+	static typename K::V3 batchUvToDir( const FrameConstants& k, typename K::F u, typename K::F v, typename K::M& )
+	{
+		return K::flatImageUvToDir( u, v, k, k.fovOut );
+	}
+	template< class K, class T >
+	static void batchDirToUv( const FrameConstants& k, typename K::V3 dir, typename K::F& u, typename K::F& v, typename K::M& transparent )
+	{
+		K::dirToFlatUv( dir, k, k.fovIn, u, v, transparent );
+	}
+};
+
+// CUBEMAP and EAC share the atlas code, which warps the face coordinates when its projection is EAC.
+template< int Projection >
+struct CubemapAtlasTraits
+{
+	static vec3 uvToDir( Fragment& fragment, vec2 local_uv ) { return fragment.cubemapUvToDir( local_uv ); }
+	static vec2 dirToUv( Fragment& fragment, vec3 dir ) { return fragment.dirToCubemapUv( dir, fragment.k.fovIn ); }
+	template< class K, class T >
+	static typename K::V3 batchUvToDir( const FrameConstants& k, typename K::F u, typename K::F v, typename K::M& )
+	{
+		return K::template cubemapUvToDir< T >( u, v, k, Projection == EAC );
+	}
+	template< class K, class T >
+	static void batchDirToUv( const FrameConstants& k, typename K::V3 dir, typename K::F& u, typename K::F& v, typename K::M& transparent )
+	{
+		K::template dirToCubemapUv< T >( dir, k.fovIn, Projection == EAC, u, v, transparent );
+	}
+};
+
+template<>
+struct ProjectionTraits< CUBEMAP > : CubemapAtlasTraits< CUBEMAP >
+{
+	static ProjectionInfo info()
+	{
+		return { "cubemap", "CUBEMAP", "Cubemap", true, true, false, "cubemapUvToDir( local_uv )", "dirToCubemapUv( dir, fovIn )" };
+	}
+};
+
+template<>
+struct ProjectionTraits< EAC > : CubemapAtlasTraits< EAC >
+{
+	static ProjectionInfo info() { return { "eac", "EAC", "EAC", true, true, false, "cubemapUvToDir( local_uv )", "dirToCubemapUv( dir, fovIn )" }; }
+};
+
+template<>
+struct ProjectionTraits< MIRROR_DOME >
+{
+	static ProjectionInfo info()
+	{
+		return { "mirror-dome", "MIRROR_DOME", "MirrorDome", true, true, true, "mirrorDomeUvToDir( local_uv )", "dirToMirrorDomeUv( dir )" };
+	}
+	static vec3 uvToDir( Fragment& fragment, vec2 local_uv ) { return fragment.mirrorDomeUvToDir( local_uv ); }
+	static vec2 dirToUv( Fragment& fragment, vec3 dir ) { return fragment.dirToMirrorDomeUv( dir ); }
+	template< class K, class T >
+	static typename K::V3 batchUvToDir( const FrameConstants& k, typename K::F u, typename K::F v, typename K::M& transparent )
+	{
+		return K::mirrorDomeUvToDir( u, v, k, transparent );
+	}
+	template< class K, class T >
+	static void batchDirToUv( const FrameConstants& k, typename K::V3 dir, typename K::F& u, typename K::F& v, typename K::M& transparent )
+	{
+		K::template dirToMirrorDomeUv< T >( dir, k, u, v, transparent );
+	}
+};
+
+// As an input the shader samples a cube map with the direction itself instead of a source uv, see Shader.h.
+template<>
+struct ProjectionTraits< CUBE_FACES >
+{
+	static ProjectionInfo info()
+	{
+		return { "cube-faces", "CUBE_FACES", "Cube Faces", true, true, false, "cubeFacesUvToDir( local_uv, fovOut )", "SET_TO_TRANSPARENT" };
+	}
+	static vec3 uvToDir( Fragment& fragment, vec2 local_uv ) { return fragment.cubeFacesUvToDir( local_uv, fragment.k.fovOut ); }
+	static vec2 dirToUv( Fragment& fragment, vec3 dir ) { return fragment.dirToCubeFacesUv( dir, fragment.k.fovIn ); }
+	template< class K, class T >
+	static typename K::V3 batchUvToDir( const FrameConstants& k, typename K::F u, typename K::F v, typename K::M& )
+	{
+		return K::cubeFacesUvToDir( u, v, k.fovOut );
+	}
+	template< class K, class T >
+	static void batchDirToUv( const FrameConstants& k, typename K::V3 dir, typename K::F& u, typename K::F& v, typename K::M& transparent )
+	{
+		K::dirToCubeFacesUv( dir, k, k.fovIn, u, v, transparent );
+	}
+};
+
+// Input only: as an output every pixel is transparent.
+template<>
+struct ProjectionTraits< DUAL_FISHEYE >
+{
+	static ProjectionInfo info()
+	{
+		return { "dual-fisheye", "DUAL_FISHEYE", "Dual Fisheye", true, false, false, "inputOnlyUvToDir()", "dirToDualFisheyeUv( dir )" };
+	}
+	static vec3 uvToDir( Fragment& fragment, vec2 )
+	{
+		fragment.isTransparent = true;
+		return vec3( 0.0f, 0.0f, 0.0f );
+	}
+	static vec2 dirToUv( Fragment& fragment, vec3 dir ) { return fragment.dirToDualFisheyeUv( dir ); }
+	template< class K, class T >
+	static typename K::V3 batchUvToDir( const FrameConstants&, typename K::F, typename K::F, typename K::M& transparent )
+	{
+		const typename K::F zero = typename K::F( 0.0f );
+		transparent              = K::allLanes();
+		return typename K::V3{ zero, zero, zero };
+	}
+	template< class K, class T >
+	static void batchDirToUv( const FrameConstants& k, typename K::V3 dir, typename K::F& u, typename K::F& v, typename K::M& transparent )
+	{
+		K::template dirToDualFisheyeUv< T >( dir, k, u, v, transparent );
+	}
+};
+
+// The traits of every ProjectionType as a table, indexed by the type.
+const ProjectionInfo& projectionInfo( int projection );
+
+// The projections a plugin offers as input ( input true ) or output options, in type order. The Reprojection plugin
+// leaves out the mirrorDomePlugin ones.
+std::vector< int > projectionOptions( bool input, bool mirrorDomePlugin );
+
+// The names of the input ( input true ) or output projections, in type order, as "equi, fisheye, ... or cube-faces" for
+// the tools' usage texts.
+std::string projectionNameList( bool input );
+
+// Looks name up among the input ( input true ) or output projections, so "--to dual-fisheye" is rejected like an unknown
+// name. Returns false and leaves projection alone if none matches.
+bool parseProjection( const char* name, bool input, int& projection );
+
+// main() specialized for one (input, output) pair, see Fragment::specializedMain(). Picking it once per frame or tile
+// leaves no per pixel branch on the projections.
+typedef vec2 ( *ReprojectFunction )( Fragment& fragment, vec2 uv );
+ReprojectFunction reprojectFunction( int inputProjection, int outputProjection );
+
+}// namespace reprojection
@@ -0,0 +1,101 @@
+#include "RayTable.h"
+
+namespace reprojection
+{
+namespace
+{
+// The uniforms the kernels run with: MaxUV at 1 like RemapTable, and one eye's when the eyes share the rays. That comes
+// from uniforms rather than eyes.eye, which is left from the bake and may have another input.
+Uniforms rayUniforms( const Uniforms& uniforms, const StereoEyes& eyes )
+{
+	if( eyes.shared )
+		return eyeUniforms( uniforms );
+	Uniforms rayUniforms = uniforms;
+	rayUniforms.maxUV    = vec2( 1.0f, 1.0f );
+	return rayUniforms;
+}
+
+void bakeRayTile( SimdLevel level, const Uniforms& uniforms, const FrameConstants& constants, RayTable& rays, const Tile& tile )
+{
+	for( int y = tile.y0; y < tile.y1; ++y )
+	{
+		size_t offset = size_t( y ) * size_t( rays.rayWidth ) + size_t( tile.x0 );
+		outputRaysRow( level, uniforms, constants, rays.rayWidth, rays.rayHeight, y, tile.x0, tile.x1, &rays.x[ offset ], &rays.y[ offset ],
+					   &rays.z[ offset ] );
+	}
+}
+
+// tile is in the rays, for shared eyes each row fills the entries of both.
+void mapRayTile( SimdLevel level, const Uniforms& uniforms, const FrameConstants& constants, const RayTable& rays, RemapTable& table, const Tile& tile )
+{
+	const StereoEyes& eyes = rays.eyes;
+	const bool seam        = !table.seamWeight.empty();
+	for( int y = tile.y0; y < tile.y1; ++y )
+	{
+		size_t offset = size_t( y ) * size_t( rays.rayWidth ) + size_t( tile.x0 );
+		size_t first  = size_t( y ) * size_t( table.width ) + size_t( tile.x0 );
+		mapRaysRow( level, uniforms, constants, rays.rayWidth, rays.rayHeight, y, tile.x0, tile.x1, &rays.x[ offset ], &rays.y[ offset ],
+					&rays.z[ offset ], &table.uv[ first * 2 ], seam ? &table.seamUv[ first * 2 ] : nullptr, seam ? &table.seamWeight[ first ] : nullptr );
+		if( !eyes.shared )
+			continue;
+		size_t second = size_t( y + eyes.offsetY ) * size_t( table.width ) + size_t( tile.x0 + eyes.offsetX );
+		eyes.splitRow( &table.uv[ first * 2 ], &table.uv[ second * 2 ], tile.x1 - tile.x0 );
+		if( seam )
+			eyes.splitSeamRow( &table.seamUv[ first * 2 ], &table.seamWeight[ first ], &table.seamUv[ second * 2 ], &table.seamWeight[ second ],
+							   tile.x1 - tile.x0 );
+	}
+}
+
+void resize( RayTable& rays, const Uniforms& uniforms, int width, int height )
+{
+	rays.width     = width;
+	rays.height    = height;
+	rays.uniforms  = uniforms;
+	rays.eyes      = splitStereoEyes( rayUniforms( uniforms, StereoEyes() ), width, height );
+	rays.rayWidth  = rays.eyes.shared ? rays.eyes.width : width;
+	rays.rayHeight = rays.eyes.shared ? rays.eyes.height : height;
+	size_t count   = size_t( rays.rayWidth ) * size_t( rays.rayHeight );
+	rays.x.resize( count );
+	rays.y.resize( count );
+	rays.z.resize( count );
+}
+}// namespace
+
+bool sameRays( const Uniforms& a, const Uniforms& b )
+{
+	return a.outputProjection == b.outputProjection && a.stereo == b.stereo && a.precision == b.precision && a.width == b.width && a.height == b.height &&
+		   a.fovOut == b.fovOut && a.mirrorRadius == b.mirrorRadius && a.projDistance == b.projDistance && a.projLift == b.projLift &&
+		   a.mirrorProjFov == b.mirrorProjFov && a.projTilt == b.projTilt && a.domeRadius == b.domeRadius;
+}
+
+void bakeRayTable( const Uniforms& uniforms, int width, int height, RayTable& rays, SimdLevel level )
+{
+	resize( rays, uniforms, width, height );
+	const Uniforms bakeUniforms = rayUniforms( uniforms, rays.eyes );
+	bakeRayTile( level, bakeUniforms, computeFrameConstants( bakeUniforms ), rays, Tile{ 0, 0, rays.rayWidth, rays.rayHeight } );
+}
+
+void bakeRayTable( const Uniforms& uniforms, int width, int height, RayTable& rays, TileExecutor& executor, SimdLevel level )
+{
+	resize( rays, uniforms, width, height );
+	const Uniforms bakeUniforms    = rayUniforms( uniforms, rays.eyes );
+	const FrameConstants constants = computeFrameConstants( bakeUniforms );
+	executor.run( rays.rayWidth, rays.rayHeight, [&]( const Tile& tile ) { bakeRayTile( level, bakeUniforms, constants, rays, tile ); } );
+}
+
+void mapRayTable( const Uniforms& uniforms, const RayTable& rays, RemapTable& table, SimdLevel level )
+{
+	table.resize( rays.width, rays.height, uniforms.inputProjection == DUAL_FISHEYE );
+	const Uniforms mapUniforms = rayUniforms( uniforms, rays.eyes );
+	mapRayTile( level, mapUniforms, computeFrameConstants( mapUniforms ), rays, table, Tile{ 0, 0, rays.rayWidth, rays.rayHeight } );
+}
+
+void mapRayTable( const Uniforms& uniforms, const RayTable& rays, RemapTable& table, TileExecutor& executor, SimdLevel level )
+{
+	table.resize( rays.width, rays.height, uniforms.inputProjection == DUAL_FISHEYE );
+	const Uniforms mapUniforms     = rayUniforms( uniforms, rays.eyes );
+	const FrameConstants constants = computeFrameConstants( mapUniforms );
+	executor.run( rays.rayWidth, rays.rayHeight, [&]( const Tile& tile ) { mapRayTile( level, mapUniforms, constants, rays, table, tile ); } );
+}
+
+}// namespace reprojection
@@ -0,0 +1,43 @@
+#pragma once
+#include <vector>
+#include "Projection.h"
+#include "RemapTable.h"
+#include "Simd.h"
+#include "StereoEyes.h"
+#include "TileExecutor.h"
+
+namespace reprojection
+{
+// The output half of main() baked for every pixel of an output frame: the direction each pixel looks along, before
+// the rotation. That half only depends on the output projection and its parameters, while rotation is what gets
+// animated, so a RemapTable for a new rotation can be made from it with one matrix multiply and the input projection
+// per pixel, see mapRayTable(), instead of running all of main() again.
+// For stereo frames that split between two pixels only eye 0 is stored, see StereoEyes.
+struct RayTable
+{
+	int width  = 0;//!< Size of the output frame
+	int height = 0;
+	Uniforms uniforms;//!< What the rays were baked for, see sameRays()
+	StereoEyes eyes;
+	int rayWidth  = 0;//!< Size of the stored rays, one eye when eyes.shared and the frame otherwise
+	int rayHeight = 0;
+	std::vector< float > x;//!< rayWidth x rayHeight each, bottom row first. ( 0, 0, 0 ) where the output projection is transparent
+	std::vector< float > y;
+	std::vector< float > z;
+};
+
+// True when a and b have the same output half of main(): everything but the rotation, the input projection, fov In
+// and MaxUV matches. The input size counts too, the flat and mirror dome outputs use its aspect ratio.
+bool sameRays( const Uniforms& a, const Uniforms& b );
+
+// Bakes the rays of a width x height output frame through the level's kernel, see outputRaysRow().
+void bakeRayTable( const Uniforms& uniforms, int width, int height, RayTable& rays, SimdLevel level );
+void bakeRayTable( const Uniforms& uniforms, int width, int height, RayTable& rays, TileExecutor& executor, SimdLevel level );
+
+// Fills table with what bakeRemapTable() would for uniforms and the rays' frame size, through the level's kernel.
+// sameRays( uniforms, rays.uniforms ) must hold. About the cost of the input projection alone, which makes a rotation
+// change several times cheaper than a rebake for the outputs with expensive directions such as the mirror dome.
+void mapRayTable( const Uniforms& uniforms, const RayTable& rays, RemapTable& table, SimdLevel level );
+void mapRayTable( const Uniforms& uniforms, const RayTable& rays, RemapTable& table, TileExecutor& executor, SimdLevel level );
+
+}// namespace reprojection
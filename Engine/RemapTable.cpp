@@ -0,0 +1,207 @@
+#include "RemapTable.h"
+#include "ProjectionRegistry.h"
+#include "StereoEyes.h"
+
+namespace reprojection
+{
+namespace
+{
+// Where the seam of entry index is, nullptr in a table without a seam, which reprojectRow() then leaves out.
+float* seamUvAt( RemapTable& table, size_t index )
+{
+	return table.seamWeight.empty() ? nullptr : &table.seamUv[ index * 2 ];
+}
+float* seamWeightAt( RemapTable& table, size_t index )
+{
+	return table.seamWeight.empty() ? nullptr : &table.seamWeight[ index ];
+}
+
+// The second sample the last main() of fragment left, as entry index of the seam.
+void storeSeam( const Fragment& fragment, RemapTable& table, size_t index )
+{
+	if( table.seamWeight.empty() )
+		return;
+	table.seamUv[ index * 2 ]     = fragment.seamPixel.x;
+	table.seamUv[ index * 2 + 1 ] = fragment.seamPixel.y;
+	table.seamWeight[ index ]     = fragment.seamWeight;
+}
+
+// Splits the seam of count entries of eye 0 from first on like StereoEyes::splitRow(), eye 1's go from second on.
+void splitSeamRow( const StereoEyes& eyes, RemapTable& table, size_t first, size_t second, int count )
+{
+	if( !table.seamWeight.empty() )
+		eyes.splitSeamRow( &table.seamUv[ first * 2 ], &table.seamWeight[ first ], &table.seamUv[ second * 2 ], &table.seamWeight[ second ], count );
+}
+
+void bakeTile( const Uniforms& bakeUniforms, const FrameConstants& constants, RemapTable& table, const Tile& tile )
+{
+	const ReprojectFunction reproject = reprojectFunction( bakeUniforms.inputProjection, bakeUniforms.outputProjection );
+	Fragment fragment( bakeUniforms, constants );
+	for( int y = tile.y0; y < tile.y1; ++y )
+	{
+		size_t index = size_t( y ) * size_t( table.width ) + size_t( tile.x0 );
+		float* out   = &table.uv[ index * 2 ];
+		for( int x = tile.x0; x < tile.x1; ++x )
+		{
+			vec2 sourcePixel = reproject( fragment, vec2( ( x + 0.5f ) / table.width, ( y + 0.5f ) / table.height ) );
+			*out++           = sourcePixel.x;
+			*out++           = sourcePixel.y;
+			storeSeam( fragment, table, index++ );
+		}
+	}
+}
+
+void bakeTile( SimdLevel level, const Uniforms& bakeUniforms, const FrameConstants& constants, RemapTable& table, const Tile& tile )
+{
+	for( int y = tile.y0; y < tile.y1; ++y )
+	{
+		size_t index = size_t( y ) * size_t( table.width ) + size_t( tile.x0 );
+		reprojectRow( level, bakeUniforms, constants, table.width, table.height, y, tile.x0, tile.x1, &table.uv[ index * 2 ], seamUvAt( table, index ),
+					  seamWeightAt( table, index ) );
+	}
+}
+
+// tile is in eye 0, each run of main() fills the entries of both eyes.
+void bakeStereoTile( const StereoEyes& eyes, const FrameConstants& constants, RemapTable& table, const Tile& tile )
+{
+	const ReprojectFunction reproject = reprojectFunction( eyes.eye.inputProjection, eyes.eye.outputProjection );
+	Fragment fragment( eyes.eye, constants );
+	for( int y = tile.y0; y < tile.y1; ++y )
+	{
+		size_t first  = size_t( y ) * size_t( table.width ) + size_t( tile.x0 );
+		size_t second = size_t( y + eyes.offsetY ) * size_t( table.width ) + size_t( tile.x0 + eyes.offsetX );
+		float* out    = &table.uv[ first * 2 ];
+		for( int x = tile.x0; x < tile.x1; ++x )
+		{
+			vec2 eyeUv = reproject( fragment, vec2( ( x + 0.5f ) / eyes.width, ( y + 0.5f ) / eyes.height ) );
+			*out++     = eyeUv.x;
+			*out++     = eyeUv.y;
+			storeSeam( fragment, table, first + size_t( x - tile.x0 ) );
+		}
+		eyes.splitRow( &table.uv[ first * 2 ], &table.uv[ second * 2 ], tile.x1 - tile.x0 );
+		splitSeamRow( eyes, table, first, second, tile.x1 - tile.x0 );
+	}
+}
+
+void bakeStereoTile( SimdLevel level, const StereoEyes& eyes, const FrameConstants& constants, RemapTable& table, const Tile& tile )
+{
+	for( int y = tile.y0; y < tile.y1; ++y )
+	{
+		size_t first  = size_t( y ) * size_t( table.width ) + size_t( tile.x0 );
+		size_t second = size_t( y + eyes.offsetY ) * size_t( table.width ) + size_t( tile.x0 + eyes.offsetX );
+		reprojectRow( level, eyes.eye, constants, eyes.width, eyes.height, y, tile.x0, tile.x1, &table.uv[ first * 2 ], seamUvAt( table, first ),
+					  seamWeightAt( table, first ) );
+		eyes.splitRow( &table.uv[ first * 2 ], &table.uv[ second * 2 ], tile.x1 - tile.x0 );
+		splitSeamRow( eyes, table, first, second, tile.x1 - tile.x0 );
+	}
+}
+
+void renderRemappedTile( const RemapTable& table, const Image& source, Image& destination, const Tile& tile )
+{
+	const vec4 TRANSPARENT_PIXEL = vec4( 0.0f, 0.0f, 0.0f, 0.0f );
+	for( int y = tile.y0; y < tile.y1; ++y )
+	{
+		for( int x = tile.x0; x < tile.x1; ++x )
+		{
+			vec2 sourcePixel = table.at( x, y );
+			if( sourcePixel == SET_TO_TRANSPARENT )
+			{
+				destination.store( x, y, TRANSPARENT_PIXEL );
+				continue;
+			}
+			vec4 color = texture( source, sourcePixel );
+			vec2 seamPixel;
+			float seamWeight = table.seamAt( x, y, seamPixel );
+			if( seamWeight > 0.0f )
+				color = mix( color, texture( source, seamPixel ), seamWeight );
+			destination.store( x, y, color );
+		}
+	}
+}
+
+// The table holds the mapping before MaxUV, so it is baked with MaxUV at 1.
+Uniforms withoutMaxUV( const Uniforms& uniforms )
+{
+	Uniforms bakeUniforms = uniforms;
+	bakeUniforms.maxUV    = vec2( 1.0f, 1.0f );
+	return bakeUniforms;
+}
+}// namespace
+
+void RemapTable::resize( int newWidth, int newHeight, bool seam )
+{
+	size_t count = size_t( newWidth ) * size_t( newHeight );
+	width        = newWidth;
+	height       = newHeight;
+	uv.resize( count * 2 );
+	seamUv.resize( seam ? count * 2 : 0 );
+	seamWeight.resize( seam ? count : 0 );
+}
+
+void bakeRemapTable( const Uniforms& uniforms, int width, int height, RemapTable& table )
+{
+	const Uniforms bakeUniforms = withoutMaxUV( uniforms );
+	const StereoEyes eyes       = splitStereoEyes( bakeUniforms, width, height );
+	table.resize( width, height, uniforms.inputProjection == DUAL_FISHEYE );
+	if( eyes.shared )
+		bakeStereoTile( eyes, computeFrameConstants( eyes.eye ), table, Tile{ 0, 0, eyes.width, eyes.height } );
+	else
+		bakeTile( bakeUniforms, computeFrameConstants( bakeUniforms ), table, Tile{ 0, 0, width, height } );
+}
+
+void bakeRemapTable( const Uniforms& uniforms, int width, int height, RemapTable& table, TileExecutor& executor )
+{
+	const Uniforms bakeUniforms = withoutMaxUV( uniforms );
+	const StereoEyes eyes       = splitStereoEyes( bakeUniforms, width, height );
+	table.resize( width, height, uniforms.inputProjection == DUAL_FISHEYE );
+	if( eyes.shared )
+	{
+		const FrameConstants constants = computeFrameConstants( eyes.eye );
+		executor.run( eyes.width, eyes.height, [&]( const Tile& tile ) { bakeStereoTile( eyes, constants, table, tile ); } );
+	}
+	else
+	{
+		const FrameConstants constants = computeFrameConstants( bakeUniforms );
+		executor.run( width, height, [&]( const Tile& tile ) { bakeTile( bakeUniforms, constants, table, tile ); } );
+	}
+}
+
+void bakeRemapTable( const Uniforms& uniforms, int width, int height, RemapTable& table, SimdLevel level )
+{
+	const Uniforms bakeUniforms = withoutMaxUV( uniforms );
+	const StereoEyes eyes       = splitStereoEyes( bakeUniforms, width, height );
+	table.resize( width, height, uniforms.inputProjection == DUAL_FISHEYE );
+	if( eyes.shared )
+		bakeStereoTile( level, eyes, computeFrameConstants( eyes.eye ), table, Tile{ 0, 0, eyes.width, eyes.height } );
+	else
+		bakeTile( level, bakeUniforms, computeFrameConstants( bakeUniforms ), table, Tile{ 0, 0, width, height } );
+}
+
+void bakeRemapTable( const Uniforms& uniforms, int width, int height, RemapTable& table, TileExecutor& executor, SimdLevel level )
+{
+	const Uniforms bakeUniforms = withoutMaxUV( uniforms );
+	const StereoEyes eyes       = splitStereoEyes( bakeUniforms, width, height );
+	table.resize( width, height, uniforms.inputProjection == DUAL_FISHEYE );
+	if( eyes.shared )
+	{
+		const FrameConstants constants = computeFrameConstants( eyes.eye );
+		executor.run( eyes.width, eyes.height, [&]( const Tile& tile ) { bakeStereoTile( level, eyes, constants, table, tile ); } );
+	}
+	else
+	{
+		const FrameConstants constants = computeFrameConstants( bakeUniforms );
+		executor.run( width, height, [&]( const Tile& tile ) { bakeTile( level, bakeUniforms, constants, table, tile ); } );
+	}
+}
+
+void renderRemapped( const RemapTable& table, const Image& source, Image& destination )
+{
+	renderRemappedTile( table, source, destination, Tile{ 0, 0, destination.width, destination.height } );
+}
+
+void renderRemapped( const RemapTable& table, const Image& source, Image& destination, TileExecutor& executor )
+{
+	executor.run( destination.width, destination.height, [&]( const Tile& tile ) { renderRemappedTile( table, source, destination, tile ); } );
+}
+
+}// namespace reprojection
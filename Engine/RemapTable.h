@@ -0,0 +1,56 @@
+#pragma once
+#include <vector>
+#include "Image.h"
+#include "Projection.h"
+#include "Simd.h"
+#include "TileExecutor.h"
+
+namespace reprojection
+{
+// The output uv -> source uv mapping of main(), baked for every pixel of an output frame.
+// The mapping only changes when a parameter does, so baking it once turns every following frame into a
+// single dependent texture fetch.
+// Coordinates are stored before the MaxUV multiply so the table survives input content area changes,
+// and transparent pixels hold SET_TO_TRANSPARENT.
+// A DUAL_FISHEYE input samples twice inside its seam band, so its table holds the second sample too: the other lens'
+// coordinate and its weight in the cross fade, see Fragment::seamPixel. Tables of other inputs leave both empty.
+struct RemapTable
+{
+	vec2 at( int x, int y ) const
+	{
+		const float* p = &uv[ ( size_t( y ) * size_t( width ) + size_t( x ) ) * 2 ];
+		return vec2( p[ 0 ], p[ 1 ] );
+	}
+	// The weight of the second sample at x, y, 0 outside the seam band or without a seam, and its coordinate in seamPixel.
+	float seamAt( int x, int y, vec2& seamPixel ) const
+	{
+		if( seamWeight.empty() )
+			return 0.0f;
+		size_t i  = size_t( y ) * size_t( width ) + size_t( x );
+		seamPixel = vec2( seamUv[ i * 2 ], seamUv[ i * 2 + 1 ] );
+		return seamWeight[ i ];
+	}
+	// Sizes the table for a width x height frame, with the seam arrays when seam is true and without them otherwise.
+	void resize( int newWidth, int newHeight, bool seam );
+
+	int width  = 0;
+	int height = 0;
+	std::vector< float > uv;        //!< Interleaved RG32F, bottom row first, ready for glTexImage2D
+	std::vector< float > seamUv;    //!< Same layout as uv, SET_TO_TRANSPARENT where the weight is 0
+	std::vector< float > seamWeight;//!< R32F, one per pixel
+};
+
+// Runs main() once per output pixel center of a width x height frame, or once per pair of eye pixels for stereo
+// frames that split between two pixels, see StereoEyes.
+void bakeRemapTable( const Uniforms& uniforms, int width, int height, RemapTable& table );
+void bakeRemapTable( const Uniforms& uniforms, int width, int height, RemapTable& table, TileExecutor& executor );
+// Same, through the level's vectorized kernel, see reprojectRow().
+void bakeRemapTable( const Uniforms& uniforms, int width, int height, RemapTable& table, SimdLevel level );
+void bakeRemapTable( const Uniforms& uniforms, int width, int height, RemapTable& table, TileExecutor& executor, SimdLevel level );
+
+// Renders destination through a baked table, destination must be table sized. The seam, if any, is mixed in like
+// render() does.
+void renderRemapped( const RemapTable& table, const Image& source, Image& destination );
+void renderRemapped( const RemapTable& table, const Image& source, Image& destination, TileExecutor& executor );
+
+}// namespace reprojection
@@ -0,0 +1,280 @@
+#include "Rig.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+namespace reprojection
+{
+namespace
+{
+const vec4 TRANSPARENT_PIXEL = vec4( 0.0f, 0.0f, 0.0f, 0.0f );
+
+// One camera of the rig as the bake runs it: its uniforms and frame constants, with the view rotation folded in.
+struct StitchCamera
+{
+	Uniforms uniforms;
+	FrameConstants constants;
+};
+
+void bakeStitchTile( const Rig& rig, const std::vector< StitchCamera >& cameras, const Uniforms& view, const FrameConstants& viewConstants,
+					 StitchMap& map, const Tile& tile )
+{
+	Fragment output( view, viewConstants );
+	std::vector< Fragment > inputs;
+	inputs.reserve( cameras.size() );
+	for( const StitchCamera& camera : cameras )
+		inputs.emplace_back( camera.uniforms, camera.constants );
+
+	for( int y = tile.y0; y < tile.y1; ++y )
+	{
+		for( int x = tile.x0; x < tile.x1; ++x )
+		{
+			const size_t pixel = size_t( y ) * size_t( map.width ) + size_t( x );
+			float* uv          = &map.uv[ pixel * 4 ];
+			uint8_t* selection = &map.selection[ pixel * 4 ];
+			uint8_t first = STITCH_NONE, second = STITCH_NONE;
+			float firstAngle = 0.0f, secondAngle = 0.0f;
+			vec2 firstUv = SET_TO_TRANSPARENT, secondUv = SET_TO_TRANSPARENT;
+
+			vec3 dir;
+			vec2 local_uv = vec2( ( float( x ) + 0.5f ) / float( map.width ), ( float( y ) + 0.5f ) / float( map.height ) );
+			if( outputDirection( output, local_uv, dir ) )
+			{
+				for( size_t camera = 0; camera < cameras.size(); ++camera )
+				{
+					vec3 cameraDir = cameras[ camera ].constants.rotation * dir;
+					vec2 cameraUv;
+					if( !inputUv( inputs[ camera ], cameraDir, cameraUv ) )
+						continue;
+					float angle = std::atan2( length( vec2( cameraDir.x, cameraDir.z ) ), cameraDir.y );
+					if( first == STITCH_NONE || angle < firstAngle )
+					{
+						second      = first;
+						secondAngle = firstAngle;
+						secondUv    = firstUv;
+						first       = uint8_t( camera );
+						firstAngle  = angle;
+						firstUv     = cameraUv;
+					}
+					else if( second == STITCH_NONE || angle < secondAngle )
+					{
+						second      = uint8_t( camera );
+						secondAngle = angle;
+						secondUv    = cameraUv;
+					}
+				}
+			}
+
+			float weight = 0.0f;
+			if( second != STITCH_NONE && rig.feather > 0.0f )
+				weight = 0.5f * ( 1.0f - smoothstep( 0.0f, rig.feather, secondAngle - firstAngle ) );
+			uv[ 0 ]        = firstUv.x;
+			uv[ 1 ]        = firstUv.y;
+			uv[ 2 ]        = secondUv.x;
+			uv[ 3 ]        = secondUv.y;
+			selection[ 0 ] = first;
+			selection[ 1 ] = second;
+			selection[ 2 ] = uint8_t( std::lround( weight * 255.0f ) );
+			selection[ 3 ] = 0;
+		}
+	}
+}
+
+void renderStitchedTile( const StitchMap& map, const std::vector< const Image* >& sources, Image& destination, const Tile& tile )
+{
+	for( int y = tile.y0; y < tile.y1; ++y )
+	{
+		for( int x = tile.x0; x < tile.x1; ++x )
+		{
+			const size_t pixel       = size_t( y ) * size_t( map.width ) + size_t( x );
+			const float* uv          = &map.uv[ pixel * 4 ];
+			const uint8_t* selection = &map.selection[ pixel * 4 ];
+			if( selection[ 0 ] >= sources.size() )
+			{
+				destination.store( x, y, TRANSPARENT_PIXEL );
+				continue;
+			}
+			vec4 color = texture( *sources[ selection[ 0 ] ], vec2( uv[ 0 ], uv[ 1 ] ) );
+			if( selection[ 2 ] != 0 && selection[ 1 ] < sources.size() )
+			{
+				float weight = float( selection[ 2 ] ) / 255.0f;
+				color        = ( 1.0f - weight ) * color + weight * texture( *sources[ selection[ 1 ] ], vec2( uv[ 2 ], uv[ 3 ] ) );
+			}
+			destination.store( x, y, color );
+		}
+	}
+}
+}// namespace
+
+bool sameRig( const Rig& a, const Rig& b )
+{
+	if( a.feather != b.feather || a.cameras.size() != b.cameras.size() )
+		return false;
+	for( size_t i = 0; i < a.cameras.size(); ++i )
+	{
+		const RigCamera& p = a.cameras[ i ];
+		const RigCamera& q = b.cameras[ i ];
+		if( p.projection != q.projection || p.rotation.x != q.rotation.x || p.rotation.y != q.rotation.y || p.rotation.z != q.rotation.z ||
+			p.fovIn != q.fovIn || p.width != q.width || p.height != q.height )
+			return false;
+	}
+	return true;
+}
+
+bool readRig( const std::string& path, Rig& rig, std::string& error )
+{
+	FILE* file = std::fopen( path.c_str(), "r" );
+	if( file == nullptr )
+	{
+		error = "Cannot open " + path;
+		return false;
+	}
+	rig = Rig();
+	error.clear();
+	const float degrees = PI / 180.0f;
+	char line[ 256 ];
+	int lineNumber = 0;
+	while( error.empty() && std::fgets( line, sizeof( line ), file ) != nullptr )
+	{
+		++lineNumber;
+		if( char* comment = std::strchr( line, '#' ) )
+			*comment = '\0';
+		char keyword[ 16 ], projection[ 16 ], rest[ 2 ];
+		float feather, pitch, roll, yaw, fovIn;
+		if( std::sscanf( line, "%15s", keyword ) != 1 )
+			continue;
+		if( std::strcmp( keyword, "feather" ) == 0 && std::sscanf( line, "%*s %f %1s", &feather, rest ) == 1 && feather >= 0.0f )
+		{
+			rig.feather = feather * degrees;
+			continue;
+		}
+		RigCamera camera;
+		bool valid = std::strcmp( keyword, "camera" ) == 0 &&
+					 std::sscanf( line, "%*s %15s %f %f %f %f %1s", projection, &pitch, &roll, &yaw, &fovIn, rest ) == 5;
+		for( camera.projection = 0; valid && camera.projection < PROJECTION_COUNT; ++camera.projection )
+		{
+			if( std::strcmp( projection, projectionName( camera.projection ) ) == 0 )
+				break;
+		}
+		if( !valid || camera.projection == PROJECTION_COUNT )
+			error = path + " line " + std::to_string( lineNumber ) + " is neither \"camera PROJECTION PITCH ROLL YAW FOV_IN\" nor \"feather DEGREES\"";
+		else if( int( rig.cameras.size() ) == RIG_MAX_CAMERAS )
+			error = path + " has more than " + std::to_string( RIG_MAX_CAMERAS ) + " cameras";
+		// The floats are only set when the line parsed.
+		if( !error.empty() )
+			break;
+		camera.rotation = vec3( pitch * degrees, roll * degrees, yaw * degrees );
+		camera.fovIn    = fovIn * PI / 2.0f;
+		rig.cameras.push_back( camera );
+	}
+	std::fclose( file );
+	if( error.empty() && rig.cameras.empty() )
+		error = path + " has no cameras";
+	if( !error.empty() )
+	{
+		rig = Rig();
+		return false;
+	}
+	return true;
+}
+
+Uniforms rigCameraUniforms( const Uniforms& view, const RigCamera& camera )
+{
+	Uniforms uniforms        = view;
+	uniforms.inputProjection = camera.projection;
+	uniforms.fovIn           = camera.fovIn;
+	uniforms.width           = camera.width;
+	uniforms.height          = camera.height;
+	return uniforms;
+}
+
+void bakeStitchMap( const Rig& rig, const Uniforms& view, int width, int height, StitchMap& map, TileExecutor& executor )
+{
+	// Mono, and before MaxUV like a RemapTable.
+	Uniforms monoView                  = view;
+	monoView.stereo                    = STEREO_NONE;
+	monoView.maxUV                     = vec2( 1.0f, 1.0f );
+	const FrameConstants viewConstants = computeFrameConstants( monoView );
+
+	// Each camera turns the output direction by the view rotation first and its own after that.
+	std::vector< StitchCamera > cameras( rig.cameras.size() );
+	for( size_t i = 0; i < cameras.size(); ++i )
+	{
+		StitchCamera& camera      = cameras[ i ];
+		camera.uniforms           = rigCameraUniforms( monoView, rig.cameras[ i ] );
+		camera.uniforms.rotation  = rig.cameras[ i ].rotation;
+		camera.constants          = computeFrameConstants( camera.uniforms );
+		camera.constants.rotation = camera.constants.rotation * viewConstants.rotation;
+	}
+
+	map.width  = width;
+	map.height = height;
+	map.uv.resize( size_t( width ) * size_t( height ) * 4 );
+	map.selection.resize( size_t( width ) * size_t( height ) * 4 );
+	executor.run( width, height, [&]( const Tile& tile ) { bakeStitchTile( rig, cameras, monoView, viewConstants, map, tile ); } );
+}
+
+void renderStitched( const StitchMap& map, const std::vector< const Image* >& sources, Image& destination, TileExecutor& executor )
+{
+	executor.run( destination.width, destination.height, [&]( const Tile& tile ) { renderStitchedTile( map, sources, destination, tile ); } );
+}
+
+StitchBaker::StitchBaker( int threadCount ) : executor( threadCount ), worker( [this]() { workerLoop(); } ) {}
+
+StitchBaker::~StitchBaker()
+{
+	{
+		std::lock_guard< std::mutex > lock( mutex );
+		stopping = true;
+	}
+	wake.notify_one();
+	worker.join();
+}
+
+void StitchBaker::request( const Rig& rig, const Uniforms& view, int width, int height )
+{
+	{
+		std::lock_guard< std::mutex > lock( mutex );
+		requestRig    = rig;
+		requestView   = view;
+		requestWidth  = width;
+		requestHeight = height;
+		hasRequest    = true;
+	}
+	wake.notify_one();
+}
+
+bool StitchBaker::take( StitchMap& map )
+{
+	std::lock_guard< std::mutex > lock( mutex );
+	if( !hasReady )
+		return false;
+	std::swap( map, ready );
+	hasReady = false;
+	return true;
+}
+
+void StitchBaker::workerLoop()
+{
+	std::unique_lock< std::mutex > lock( mutex );
+	for( ;; )
+	{
+		wake.wait( lock, [this]() { return hasRequest || stopping; } );
+		if( stopping )
+			return;
+		const Rig rig       = requestRig;
+		const Uniforms view = requestView;
+		const int width     = requestWidth;
+		const int height    = requestHeight;
+		hasRequest          = false;
+		lock.unlock();
+
+		bakeStitchMap( rig, view, width, height, back, executor );
+
+		lock.lock();
+		std::swap( ready, back );
+		hasReady = true;
+	}
+}
+
+}// namespace reprojection
@@ -0,0 +1,113 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Image.h"
+#include "Projection.h"
+#include "TileExecutor.h"
+
+namespace reprojection
+{
+// A rig of several cameras, one input each, stitched into one output frame in a single pass.
+// Each camera is an input projection on its own, with the rotation and fov In the plugins would need to line up that
+// input alone. A StitchMap bakes, for every output pixel, which camera it samples and at which uv, and where two
+// cameras overlap how much of the second one is mixed in, so the stitch itself costs two fetches per pixel at most.
+//
+// Rig files are text, one camera or setting per line, with # starting a comment:
+//
+//     feather DEGREES
+//     camera PROJECTION PITCH ROLL YAW FOV_IN
+//
+// PROJECTION is one of the projectionName()s, the rotation is in degrees and FOV_IN is the fov In slider value, 0 to 1,
+// the same mapping currentUniforms() in the plugins and --fov-in of the tools use.
+const int RIG_MAX_CAMERAS = 4;//!< Input textures the plugins accept, and the stitch shader samples
+
+struct RigCamera
+{
+	int projection = FISHEYE;
+	vec3 rotation;                 //!< pitch, roll, yaw in radians, turning the output direction before this camera's projection
+	float fovIn = PI / 4.0f;       //!< Like Uniforms::fovIn
+	int width   = 1;               //!< Size of the camera's input texture in pixels. Not in the file, the caller fills it in
+	int height  = 1;
+};
+
+struct Rig
+{
+	std::vector< RigCamera > cameras;
+	float feather = 10.0f * PI / 180.0f;//!< How much closer one camera's axis must be before the other one is faded out
+};
+
+bool sameRig( const Rig& a, const Rig& b );
+
+// Returns false and describes the problem in error when the file cannot be opened, has a line it does not understand,
+// or has no cameras or more than RIG_MAX_CAMERAS.
+bool readRig( const std::string& path, Rig& rig, std::string& error );
+
+const uint8_t STITCH_NONE = 255;//!< Camera index of the pixels no camera sees
+
+// The per pixel camera selection of a rig for one view, bottom row first like a RemapTable.
+// Each pixel samples the camera whose axis, its +Y after its rotation, is closest to the pixel's direction among the
+// cameras that see it. Within the feather of the second closest camera that one is mixed in too, half and half where
+// both are equally close, so the selection never jumps.
+struct StitchMap
+{
+	int width  = 0;
+	int height = 0;
+	std::vector< float > uv;         //!< Interleaved RGBA32F: uv of the first camera, then of the second, before MaxUV
+	std::vector< uint8_t > selection;//!< Interleaved RGBA8: first camera, second camera, 255 x the weight of the second, 0
+};
+
+// Uniforms for one camera of the rig: the input projection, fov In and size of camera, everything else from view.
+// The rotation is still view's, bakeStitchMap() turns the direction by the camera's after it.
+Uniforms rigCameraUniforms( const Uniforms& view, const RigCamera& camera );
+
+// Runs the output projection of view once per pixel center of a width x height frame, and every camera's input
+// projection on the direction. The output is mono, view's stereo mode is ignored.
+void bakeStitchMap( const Rig& rig, const Uniforms& view, int width, int height, StitchMap& map, TileExecutor& executor );
+
+// Renders destination through a baked map, from one source per camera of the rig. destination must be map sized.
+void renderStitched( const StitchMap& map, const std::vector< const Image* >& sources, Image& destination, TileExecutor& executor );
+
+// Bakes StitchMaps on a worker thread, the way AsyncBaker bakes RemapTables: only the newest request is baked, a
+// finished map changes hands whole in take(), and the thread drawing frames keeps stitching through the last map it
+// took meanwhile. A rig bake runs every camera's input projection per pixel, several times a plain bake.
+class StitchBaker
+{
+public:
+	// threadCount is the TileExecutor's, 1 bakes on the worker thread alone.
+	explicit StitchBaker( int threadCount = 1 );
+	~StitchBaker();//!< Waits for the bake in flight
+	StitchBaker( const StitchBaker& ) = delete;
+	StitchBaker& operator=( const StitchBaker& ) = delete;
+
+	// Asks for the map of rig and view at width x height, see bakeStitchMap(). Never waits for the worker.
+	void request( const Rig& rig, const Uniforms& view, int width, int height );
+	// Swaps the newest finished map into map and returns true, or returns false if none finished since the last call.
+	// Never waits for the worker.
+	bool take( StitchMap& map );
+
+private:
+	void workerLoop();
+
+	TileExecutor executor;
+
+	std::mutex mutex;
+	std::condition_variable wake;
+	Rig requestRig;//!< Newest request, valid while hasRequest
+	Uniforms requestView;
+	int requestWidth  = 0;
+	int requestHeight = 0;
+	bool hasRequest   = false;
+	StitchMap ready;//!< Newest finished map, valid while hasReady
+	bool hasReady = false;
+	bool stopping = false;
+
+	StitchMap back;//!< Only touched by the worker
+
+	std::thread worker;//!< Last, so it starts once everything above is constructed
+};
+
+}// namespace reprojection
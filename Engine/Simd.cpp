@@ -0,0 +1,136 @@
+#include "Simd.h"
+#include "SimdKernel.h"
+
+#if defined( _MSC_VER ) && ( defined( _M_X64 ) || defined( _M_IX86 ) )
+#include <intrin.h>
+#include <immintrin.h>
+#define REPROJECTION_X86_CPUID 1
+#elif defined( __GNUC__ ) && ( defined( __x86_64__ ) || defined( __i386__ ) )
+#define REPROJECTION_X86_CPUID 1
+#endif
+
+namespace reprojection
+{
+namespace
+{
+struct CpuFeatures
+{
+	bool avx2   = false;
+	bool avx512 = false;
+};
+
+CpuFeatures detectCpuFeatures()
+{
+	CpuFeatures features;
+#if defined( REPROJECTION_X86_CPUID ) && defined( _MSC_VER )
+	int info[ 4 ];
+	__cpuid( info, 0 );
+	if( info[ 0 ] < 7 )
+		return features;
+	__cpuid( info, 1 );
+	bool fma     = ( info[ 2 ] & ( 1 << 12 ) ) != 0;
+	bool osxsave = ( info[ 2 ] & ( 1 << 27 ) ) != 0;
+	if( !osxsave )
+		return features;
+	// The OS has to save the YMM (and for AVX-512 the ZMM and opmask) registers on context switches.
+	unsigned long long xcr0 = _xgetbv( 0 );
+	bool ymmState           = ( xcr0 & 0x6 ) == 0x6;
+	bool zmmState           = ( xcr0 & 0xe6 ) == 0xe6;
+	__cpuidex( info, 7, 0 );
+	features.avx2   = ymmState && fma && ( info[ 1 ] & ( 1 << 5 ) ) != 0;
+	features.avx512 = zmmState && fma && ( info[ 1 ] & ( 1 << 16 ) ) != 0;
+#elif defined( REPROJECTION_X86_CPUID )
+	// __builtin_cpu_supports also checks that the OS saves the wider registers.
+	__builtin_cpu_init();
+	features.avx2   = __builtin_cpu_supports( "avx2" ) && __builtin_cpu_supports( "fma" );
+	features.avx512 = __builtin_cpu_supports( "avx512f" ) && __builtin_cpu_supports( "fma" );
+#endif
+	return features;
+}
+
+ReprojectRowFunction kernelFor( SimdLevel level )
+{
+	static const CpuFeatures features = detectCpuFeatures();
+	switch( level )
+	{
+	case SimdLevel::AVX512:
+		return features.avx512 ? avx512ReprojectRow() : nullptr;
+	case SimdLevel::AVX2:
+		return features.avx2 ? avx2ReprojectRow() : nullptr;
+	default:
+		return scalarReprojectRow();
+	}
+}
+
+RayKernels rayKernelsFor( SimdLevel level )
+{
+	static const CpuFeatures features = detectCpuFeatures();
+	switch( level )
+	{
+	case SimdLevel::AVX512:
+		return features.avx512 ? avx512RayKernels() : RayKernels{ nullptr, nullptr };
+	case SimdLevel::AVX2:
+		return features.avx2 ? avx2RayKernels() : RayKernels{ nullptr, nullptr };
+	default:
+		return scalarRayKernels();
+	}
+}
+}// namespace
+
+SimdLevel detectSimdLevel()
+{
+	if( simdLevelSupported( SimdLevel::AVX512 ) )
+		return SimdLevel::AVX512;
+	if( simdLevelSupported( SimdLevel::AVX2 ) )
+		return SimdLevel::AVX2;
+	return SimdLevel::Scalar;
+}
+
+bool simdLevelSupported( SimdLevel level )
+{
+	return kernelFor( level ) != nullptr;
+}
+
+const char* simdLevelName( SimdLevel level )
+{
+	switch( level )
+	{
+	case SimdLevel::AVX512:
+		return "avx512";
+	case SimdLevel::AVX2:
+		return "avx2";
+	default:
+		return "scalar";
+	}
+}
+
+void reprojectRow( SimdLevel level, const Uniforms& uniforms, const FrameConstants& constants, int width, int height, int y, int x0, int x1, float* uv )
+{
+	kernelFor( level )( uniforms, constants, width, height, y, x0, x1, uv, nullptr, nullptr );
+}
+
+void reprojectRow( SimdLevel level, const Uniforms& uniforms, const FrameConstants& constants, int width, int height, int y, int x0, int x1, float* uv,
+				   float* seamUv, float* seamWeight )
+{
+	kernelFor( level )( uniforms, constants, width, height, y, x0, x1, uv, seamUv, seamWeight );
+}
+
+void outputRaysRow( SimdLevel level, const Uniforms& uniforms, const FrameConstants& constants, int width, int height, int y, int x0, int x1, float* rayX,
+					float* rayY, float* rayZ )
+{
+	rayKernelsFor( level ).outputRaysRow( uniforms, constants, width, height, y, x0, x1, rayX, rayY, rayZ );
+}
+
+void mapRaysRow( SimdLevel level, const Uniforms& uniforms, const FrameConstants& constants, int width, int height, int y, int x0, int x1, const float* rayX,
+				 const float* rayY, const float* rayZ, float* uv )
+{
+	rayKernelsFor( level ).mapRaysRow( uniforms, constants, width, height, y, x0, x1, rayX, rayY, rayZ, uv, nullptr, nullptr );
+}
+
+void mapRaysRow( SimdLevel level, const Uniforms& uniforms, const FrameConstants& constants, int width, int height, int y, int x0, int x1, const float* rayX,
+				 const float* rayY, const float* rayZ, float* uv, float* seamUv, float* seamWeight )
+{
+	rayKernelsFor( level ).mapRaysRow( uniforms, constants, width, height, y, x0, x1, rayX, rayY, rayZ, uv, seamUv, seamWeight );
+}
+
+}// namespace reprojection
@@ -0,0 +1,46 @@
+#pragma once
+#include "Projection.h"
+
+namespace reprojection
+{
+// Instruction sets the vectorized main() is built for. Every level computes the same mapping as reprojectUv(),
+// WIDTH output pixels at a time, with the transparency early returns turned into lane masks.
+enum class SimdLevel
+{
+	Scalar,//!< One pixel at a time, available everywhere
+	AVX2,  //!< 8 pixels at a time, needs AVX2 and FMA
+	AVX512 //!< 16 pixels at a time, needs AVX-512F
+};
+
+// The widest level this CPU can run and this build contains.
+SimdLevel detectSimdLevel();
+bool simdLevelSupported( SimdLevel level );
+const char* simdLevelName( SimdLevel level );
+
+// Writes reprojectUv() of output pixels x0 .. x1 - 1 on row y of a width x height frame to uv, as interleaved
+// (u, v) pairs, i.e. 2 * ( x1 - x0 ) floats. Transparent pixels get SET_TO_TRANSPARENT like reprojectUv() returns.
+// The trig is a polynomial approximation rather than the std:: calls, so results differ from reprojectUv() in the
+// last bits. level must be supported.
+void reprojectRow( SimdLevel level, const Uniforms& uniforms, const FrameConstants& constants, int width, int height, int y, int x0, int x1, float* uv );
+// reprojectRow() plus the seam cross fade of a DUAL_FISHEYE input, see Fragment::seamPixel: the coordinate of the lens
+// uv does not hold goes to seamUv, laid out like uv, and its weight to seamWeight, one float per pixel. Outside the
+// seam band, and for every other input, the weight is 0 and the coordinate SET_TO_TRANSPARENT. Both may be nullptr,
+// then only uv is written.
+void reprojectRow( SimdLevel level, const Uniforms& uniforms, const FrameConstants& constants, int width, int height, int y, int x0, int x1, float* uv,
+				   float* seamUv, float* seamWeight );
+
+// reprojectRow() in two halves, split where main() rotates the output direction, see RayTable.h.
+// outputRaysRow() writes the unrotated direction of each pixel to rayX, rayY and rayZ, x1 - x0 floats each, or
+// ( 0, 0, 0 ) where the output projection alone already makes the pixel transparent. Only the output side of uniforms
+// and constants is read.
+void outputRaysRow( SimdLevel level, const Uniforms& uniforms, const FrameConstants& constants, int width, int height, int y, int x0, int x1, float* rayX,
+					float* rayY, float* rayZ );
+// mapRaysRow() takes those directions for the same pixels and writes what reprojectRow() would, as long as uniforms
+// only differ from the ones the rays were made with in rotation, input projection, fov In and MaxUV.
+void mapRaysRow( SimdLevel level, const Uniforms& uniforms, const FrameConstants& constants, int width, int height, int y, int x0, int x1, const float* rayX,
+				 const float* rayY, const float* rayZ, float* uv );
+// Same, plus the seam the seamUv and seamWeight reprojectRow() writes.
+void mapRaysRow( SimdLevel level, const Uniforms& uniforms, const FrameConstants& constants, int width, int height, int y, int x0, int x1, const float* rayX,
+				 const float* rayY, const float* rayZ, float* uv, float* seamUv, float* seamWeight );
+
+}// namespace reprojection
@@ -0,0 +1,105 @@
+#include "SimdKernel.h"
+
+// BatchKernel eight pixels at a time. CMake builds this file with AVX2 and FMA enabled, and only this file,
+// so the rest of the library still runs on any x86-64. detectSimdLevel() makes sure it is only called on CPUs that have both.
+#if defined( __AVX2__ )
+#include <immintrin.h>
+
+namespace reprojection
+{
+namespace
+{
+struct Avx2Float
+{
+	__m256 v;
+	Avx2Float() {}
+	Avx2Float( __m256 v ) : v( v ) {}
+	Avx2Float( float s ) : v( _mm256_set1_ps( s ) ) {}
+};
+
+struct Avx2Mask
+{
+	__m256 v;
+	Avx2Mask( __m256 v ) : v( v ) {}
+};
+
+inline Avx2Float operator+( Avx2Float a, Avx2Float b ) { return _mm256_add_ps( a.v, b.v ); }
+inline Avx2Float operator-( Avx2Float a, Avx2Float b ) { return _mm256_sub_ps( a.v, b.v ); }
+inline Avx2Float operator*( Avx2Float a, Avx2Float b ) { return _mm256_mul_ps( a.v, b.v ); }
+inline Avx2Float operator/( Avx2Float a, Avx2Float b ) { return _mm256_div_ps( a.v, b.v ); }
+inline Avx2Float operator-( Avx2Float a ) { return _mm256_xor_ps( a.v, _mm256_set1_ps( -0.0f ) ); }
+inline Avx2Mask operator<( Avx2Float a, Avx2Float b ) { return _mm256_cmp_ps( a.v, b.v, _CMP_LT_OQ ); }
+inline Avx2Mask operator<=( Avx2Float a, Avx2Float b ) { return _mm256_cmp_ps( a.v, b.v, _CMP_LE_OQ ); }
+inline Avx2Mask operator>( Avx2Float a, Avx2Float b ) { return _mm256_cmp_ps( a.v, b.v, _CMP_GT_OQ ); }
+inline Avx2Mask operator>=( Avx2Float a, Avx2Float b ) { return _mm256_cmp_ps( a.v, b.v, _CMP_GE_OQ ); }
+inline Avx2Mask operator==( Avx2Float a, Avx2Float b ) { return _mm256_cmp_ps( a.v, b.v, _CMP_EQ_OQ ); }
+inline Avx2Mask operator&( Avx2Mask a, Avx2Mask b ) { return _mm256_and_ps( a.v, b.v ); }
+inline Avx2Mask operator|( Avx2Mask a, Avx2Mask b ) { return _mm256_or_ps( a.v, b.v ); }
+inline Avx2Mask operator^( Avx2Mask a, Avx2Mask b ) { return _mm256_xor_ps( a.v, b.v ); }
+inline Avx2Mask operator!( Avx2Mask a ) { return _mm256_xor_ps( a.v, _mm256_castsi256_ps( _mm256_set1_epi32( -1 ) ) ); }
+
+struct Avx2Batch
+{
+	static const int WIDTH = 8;
+	typedef Avx2Float F;
+	typedef Avx2Mask M;
+
+	static F select( M mask, F a, F b ) { return _mm256_blendv_ps( b.v, a.v, mask.v ); }
+	static F sqrt( F a ) { return _mm256_sqrt_ps( a.v ); }
+	static F abs( F a ) { return _mm256_andnot_ps( _mm256_set1_ps( -0.0f ), a.v ); }
+	static F floor( F a ) { return _mm256_floor_ps( a.v ); }
+	static F min( F a, F b ) { return _mm256_min_ps( a.v, b.v ); }
+	static F max( F a, F b ) { return _mm256_max_ps( a.v, b.v ); }
+	static M none() { return _mm256_setzero_ps(); }
+	static F iota( float start ) { return _mm256_add_ps( _mm256_set1_ps( start ), _mm256_setr_ps( 0, 1, 2, 3, 4, 5, 6, 7 ) ); }
+	static F load( const float* source ) { return _mm256_loadu_ps( source ); }
+	static void store( float* destination, F a ) { _mm256_storeu_ps( destination, a.v ); }
+};
+
+void reprojectRowAvx2( const Uniforms& uniforms, const FrameConstants& constants, int width, int height, int y, int x0, int x1, float* uv,
+					  float* seamUv, float* seamWeight )
+{
+	BatchKernel< Avx2Batch >::reprojectRow( uniforms, constants, width, height, y, x0, x1, uv, seamUv, seamWeight );
+}
+
+void outputRaysRowAvx2( const Uniforms& uniforms, const FrameConstants& constants, int width, int height, int y, int x0, int x1, float* rayX, float* rayY,
+						float* rayZ )
+{
+	BatchKernel< Avx2Batch >::outputRaysRow( uniforms, constants, width, height, y, x0, x1, rayX, rayY, rayZ );
+}
+
+void mapRaysRowAvx2( const Uniforms& uniforms, const FrameConstants& constants, int width, int height, int y, int x0, int x1, const float* rayX,
+					 const float* rayY, const float* rayZ, float* uv, float* seamUv, float* seamWeight )
+{
+	BatchKernel< Avx2Batch >::mapRaysRow( uniforms, constants, width, height, y, x0, x1, rayX, rayY, rayZ, uv, seamUv, seamWeight );
+}
+}// namespace
+
+ReprojectRowFunction avx2ReprojectRow()
+{
+	return reprojectRowAvx2;
+}
+
+RayKernels avx2RayKernels()
+{
+	return RayKernels{ outputRaysRowAvx2, mapRaysRowAvx2 };
+}
+
+}// namespace reprojection
+
+#else
+
+namespace reprojection
+{
+ReprojectRowFunction avx2ReprojectRow()
+{
+	return nullptr;
+}
+
+RayKernels avx2RayKernels()
+{
+	return RayKernels{ nullptr, nullptr };
+}
+
+}// namespace reprojection
+#endif
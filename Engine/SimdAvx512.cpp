@@ -0,0 +1,113 @@
+#include "SimdKernel.h"
+
+// BatchKernel sixteen pixels at a time. CMake builds this file with AVX-512F enabled, and only this file,
+// so the rest of the library still runs on any x86-64. detectSimdLevel() makes sure it is only called on CPUs that have it.
+#if defined( __AVX512F__ )
+#include <immintrin.h>
+
+#if defined( __GNUC__ ) && !defined( __clang__ )
+// GCC's own AVX-512 headers trip this on every _mm512_undefined_ps() they use for unmasked intrinsics.
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+namespace reprojection
+{
+namespace
+{
+struct Avx512Float
+{
+	__m512 v;
+	Avx512Float() {}
+	Avx512Float( __m512 v ) : v( v ) {}
+	Avx512Float( float s ) : v( _mm512_set1_ps( s ) ) {}
+};
+
+struct Avx512Mask
+{
+	__mmask16 v;
+	Avx512Mask( __mmask16 v ) : v( v ) {}
+};
+
+inline Avx512Float operator+( Avx512Float a, Avx512Float b ) { return _mm512_add_ps( a.v, b.v ); }
+inline Avx512Float operator-( Avx512Float a, Avx512Float b ) { return _mm512_sub_ps( a.v, b.v ); }
+inline Avx512Float operator*( Avx512Float a, Avx512Float b ) { return _mm512_mul_ps( a.v, b.v ); }
+inline Avx512Float operator/( Avx512Float a, Avx512Float b ) { return _mm512_div_ps( a.v, b.v ); }
+inline Avx512Float operator-( Avx512Float a ) { return _mm512_sub_ps( _mm512_setzero_ps(), a.v ); }
+inline Avx512Mask operator<( Avx512Float a, Avx512Float b ) { return _mm512_cmp_ps_mask( a.v, b.v, _CMP_LT_OQ ); }
+inline Avx512Mask operator<=( Avx512Float a, Avx512Float b ) { return _mm512_cmp_ps_mask( a.v, b.v, _CMP_LE_OQ ); }
+inline Avx512Mask operator>( Avx512Float a, Avx512Float b ) { return _mm512_cmp_ps_mask( a.v, b.v, _CMP_GT_OQ ); }
+inline Avx512Mask operator>=( Avx512Float a, Avx512Float b ) { return _mm512_cmp_ps_mask( a.v, b.v, _CMP_GE_OQ ); }
+inline Avx512Mask operator==( Avx512Float a, Avx512Float b ) { return _mm512_cmp_ps_mask( a.v, b.v, _CMP_EQ_OQ ); }
+inline Avx512Mask operator&( Avx512Mask a, Avx512Mask b ) { return __mmask16( a.v & b.v ); }
+inline Avx512Mask operator|( Avx512Mask a, Avx512Mask b ) { return __mmask16( a.v | b.v ); }
+inline Avx512Mask operator^( Avx512Mask a, Avx512Mask b ) { return __mmask16( a.v ^ b.v ); }
+inline Avx512Mask operator!( Avx512Mask a ) { return __mmask16( ~a.v ); }
+
+struct Avx512Batch
+{
+	static const int WIDTH = 16;
+	typedef Avx512Float F;
+	typedef Avx512Mask M;
+
+	static F select( M mask, F a, F b ) { return _mm512_mask_blend_ps( mask.v, b.v, a.v ); }
+	static F sqrt( F a ) { return _mm512_sqrt_ps( a.v ); }
+	static F abs( F a ) { return _mm512_abs_ps( a.v ); }
+	static F floor( F a ) { return _mm512_roundscale_ps( a.v, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC ); }
+	static F min( F a, F b ) { return _mm512_min_ps( a.v, b.v ); }
+	static F max( F a, F b ) { return _mm512_max_ps( a.v, b.v ); }
+	static M none() { return __mmask16( 0 ); }
+	static F iota( float start )
+	{
+		return _mm512_add_ps( _mm512_set1_ps( start ), _mm512_setr_ps( 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 ) );
+	}
+	static F load( const float* source ) { return _mm512_loadu_ps( source ); }
+	static void store( float* destination, F a ) { _mm512_storeu_ps( destination, a.v ); }
+};
+
+void reprojectRowAvx512( const Uniforms& uniforms, const FrameConstants& constants, int width, int height, int y, int x0, int x1, float* uv,
+						float* seamUv, float* seamWeight )
+{
+	BatchKernel< Avx512Batch >::reprojectRow( uniforms, constants, width, height, y, x0, x1, uv, seamUv, seamWeight );
+}
+
+void outputRaysRowAvx512( const Uniforms& uniforms, const FrameConstants& constants, int width, int height, int y, int x0, int x1, float* rayX, float* rayY,
+						float* rayZ )
+{
+	BatchKernel< Avx512Batch >::outputRaysRow( uniforms, constants, width, height, y, x0, x1, rayX, rayY, rayZ );
+}
+
+void mapRaysRowAvx512( const Uniforms& uniforms, const FrameConstants& constants, int width, int height, int y, int x0, int x1, const float* rayX,
+					 const float* rayY, const float* rayZ, float* uv, float* seamUv, float* seamWeight )
+{
+	BatchKernel< Avx512Batch >::mapRaysRow( uniforms, constants, width, height, y, x0, x1, rayX, rayY, rayZ, uv, seamUv, seamWeight );
+}
+}// namespace
+
+ReprojectRowFunction avx512ReprojectRow()
+{
+	return reprojectRowAvx512;
+}
+
+RayKernels avx512RayKernels()
+{
+	return RayKernels{ outputRaysRowAvx512, mapRaysRowAvx512 };
+}
+
+}// namespace reprojection
+
+#else
+
+namespace reprojection
+{
+ReprojectRowFunction avx512ReprojectRow()
+{
+	return nullptr;
+}
+
+RayKernels avx512RayKernels()
+{
+	return RayKernels{ nullptr, nullptr };
+}
+
+}// namespace reprojection
+#endif
@@ -0,0 +1,637 @@
+#pragma once
+#include <utility>
+#include "FastTrig.h"
+#include "InverseMirror.h"
+#include "Projection.h"
+#include "ProjectionRegistry.h"
+
+// The batch version of Fragment::main(), shared by SimdScalar.cpp, SimdAvx2.cpp and SimdAvx512.cpp.
+// Each of those compiles this template for its own batch type B with its own instruction set flags, so nothing in
+// here may be used from a translation unit that is not built for B. B provides:
+//   F               a batch of WIDTH floats, with + - * / and comparisons against F or float
+//   M               the mask those comparisons return, with & | ^ !
+//   select( m, a, b ), sqrt, abs, floor, min, max, none(), iota( start ), load( const float* ), store( float*, F )
+//
+// The functions follow Projection.cpp one to one, except that an early return of SET_TO_TRANSPARENT becomes a lane
+// in the `transparent` mask. Every lane always runs the whole pipeline; masked lanes may compute garbage, which is
+// thrown away by the final select. The ones that need trig take it from T, which is BatchKernel itself for
+// PRECISION_EXACT and FastTrig< B > for PRECISION_FAST. The row functions are instantiated per precision and per
+// input and output projection through ProjectionTraits, so all three are decided once per row and not per call.
+namespace reprojection
+{
+// Vectorized main() over output pixels x0 .. x1 - 1 of row y, see reprojectRow() in Simd.h. seamUv and seamWeight
+// may be nullptr, then no seam is written.
+typedef void ( *ReprojectRowFunction )( const Uniforms& uniforms, const FrameConstants& constants, int width, int height, int y, int x0, int x1,
+										float* uv, float* seamUv, float* seamWeight );
+
+// One per batch type. Returns nullptr when its translation unit was built without the instruction set.
+ReprojectRowFunction scalarReprojectRow();
+ReprojectRowFunction avx2ReprojectRow();
+ReprojectRowFunction avx512ReprojectRow();
+
+// The two halves of main() around the rotation, see outputRaysRow() and mapRaysRow() in Simd.h.
+typedef void ( *OutputRaysRowFunction )( const Uniforms& uniforms, const FrameConstants& constants, int width, int height, int y, int x0, int x1,
+										 float* rayX, float* rayY, float* rayZ );
+typedef void ( *MapRaysRowFunction )( const Uniforms& uniforms, const FrameConstants& constants, int width, int height, int y, int x0, int x1,
+									  const float* rayX, const float* rayY, const float* rayZ, float* uv, float* seamUv, float* seamWeight );
+struct RayKernels
+{
+	OutputRaysRowFunction outputRaysRow;
+	MapRaysRowFunction mapRaysRow;
+};
+
+// Same as the ReprojectRowFunction getters, both members are nullptr when the instruction set was not built.
+RayKernels scalarRayKernels();
+RayKernels avx2RayKernels();
+RayKernels avx512RayKernels();
+
+template< class B >
+struct BatchKernel
+{
+	typedef typename B::F F;
+	typedef typename B::M M;
+
+	struct V3
+	{
+		F x, y, z;
+	};
+
+	static V3 normalize( V3 a )
+	{
+		F length = B::sqrt( a.x * a.x + a.y * a.y + a.z * a.z );
+		return V3{ a.x / length, a.y / length, a.z / length };
+	}
+	static F dot( V3 a, V3 b ) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+	static F dot( V3 a, vec3 b ) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+	static V3 rotate( const mat3& m, V3 v )
+	{
+		return V3{ v.x * m.c[ 0 ].x + v.y * m.c[ 1 ].x + v.z * m.c[ 2 ].x,
+				   v.x * m.c[ 0 ].y + v.y * m.c[ 1 ].y + v.z * m.c[ 2 ].y,
+				   v.x * m.c[ 0 ].z + v.y * m.c[ 1 ].z + v.z * m.c[ 2 ].z };
+	}
+	static M outOfUnitSquare( F u, F v ) { return ( u < 0.0f ) | ( v < 0.0f ) | ( u > 1.0f ) | ( v > 1.0f ); }
+
+	// Single precision sin, cos, tan, atan and atan2, after Cephes. Around 1 ulp for the argument ranges
+	// the projections produce, so the kernels agree with the std:: calls of the reference to float precision.
+
+	// Cody-Waite reduction by PI/4: returns x - j * PI/4 for |x|, j rounded up to even.
+	static F reduceQuarterPi( F absX, F& j )
+	{
+		j = B::floor( absX * 1.27323954473516f );
+		j = j + ( j - 2.0f * B::floor( j * 0.5f ) );
+		return ( ( absX - j * 0.78515625f ) - j * 2.4187564849853515625e-4f ) - j * 3.77489497744594108e-8f;
+	}
+	static F sinPolynomial( F x, F z ) { return ( ( -1.9515295891e-4f * z + 8.3321608736e-3f ) * z - 1.6666654611e-1f ) * z * x + x; }
+	static F cosPolynomial( F z ) { return ( ( 2.443315711809948e-5f * z - 1.388731625493765e-3f ) * z + 4.166664568298827e-2f ) * z * z - 0.5f * z + 1.0f; }
+	static void sincos( F x, F& sine, F& cosine )
+	{
+		F j;
+		F r = reduceQuarterPi( B::abs( x ), j );
+		F z = r * r;
+		F s = sinPolynomial( r, z );
+		F c = cosPolynomial( z );
+		// j is 0, 2, 4 or 6 eighths of a turn.
+		F octant          = j - 8.0f * B::floor( j * 0.125f );
+		M swap            = ( octant == 2.0f ) | ( octant == 6.0f );
+		M negateSine      = ( octant >= 4.0f ) ^ ( x < 0.0f );
+		M negateCosine    = ( octant == 2.0f ) | ( octant == 4.0f );
+		F sineMagnitude   = B::select( swap, c, s );
+		F cosineMagnitude = B::select( swap, s, c );
+		sine              = B::select( negateSine, -sineMagnitude, sineMagnitude );
+		cosine            = B::select( negateCosine, -cosineMagnitude, cosineMagnitude );
+	}
+	static F tan( F x )
+	{
+		F j;
+		F r = reduceQuarterPi( B::abs( x ), j );
+		F z = r * r;
+		F t = ( ( ( ( ( 9.38540185543e-3f * z + 3.11992232697e-3f ) * z + 2.44301354525e-2f ) * z + 5.34112807005e-2f ) * z + 1.33387994085e-1f ) * z +
+				3.33331568548e-1f ) *
+				  z * r +
+			  r;
+		t = B::select( j - 4.0f * B::floor( j * 0.25f ) == 2.0f, -1.0f / t, t );
+		return B::select( x < 0.0f, -t, t );
+	}
+	static F atan( F x )
+	{
+		F a       = B::abs( x );
+		M large   = a > 2.414213562373095f;
+		M medium  = ( !large ) & ( a > 0.4142135623730950f );
+		F offset  = B::select( large, F( PI / 2.0f ), B::select( medium, F( PI / 4.0f ), F( 0.0f ) ) );
+		F reduced = B::select( large, -1.0f / a, B::select( medium, ( a - 1.0f ) / ( a + 1.0f ), a ) );
+		F z       = reduced * reduced;
+		F result  = offset + ( ( ( ( 8.05374449538e-2f * z - 1.38776856032e-1f ) * z + 1.99777106478e-1f ) * z - 3.33329491539e-1f ) * z * reduced + reduced );
+		return B::select( x < 0.0f, -result, result );
+	}
+	static F atan2( F y, F x )
+	{
+		F result = atan( y / x );
+		result   = result + B::select( x < 0.0f, B::select( y < 0.0f, F( -PI ), F( PI ) ), F( 0.0f ) );
+		// atan( y / 0 ) already is +-PI/2, only 0 / 0 needs fixing up.
+		return B::select( ( x == 0.0f ) & ( y == 0.0f ), F( 0.0f ), result );
+	}
+
+	// Output projections: uv -> unit direction.
+
+	template< class T >
+	static V3 equiUvToDir( F u, F v )
+	{
+		F lat = v * PI - PI / 2.0f;
+		F lon = u * 2.0f * PI - PI;
+		F sinLat, cosLat, sinLon, cosLon;
+		T::sincos( lat, sinLat, cosLat );
+		T::sincos( lon, sinLon, cosLon );
+		return V3{ cosLat * sinLon, cosLat * cosLon, sinLat };
+	}
+	template< class T >
+	static V3 fisheyeUvToDir( F u, F v, float fovOutput, M& transparent )
+	{
+		F px = 2.0f * u - 1.0f;
+		F py = 2.0f * v - 1.0f;
+		F r  = B::sqrt( px * px + py * py );
+		transparent = transparent | ( r > 1.0f );
+		F lat = ( 1.0f - T::tan( T::atan( r ) / fovOutput ) ) * ( PI / 2.0f );
+		M centered = r > 0.0f;
+		F inverseR = 1.0f / r;
+		F aroundX  = B::select( centered, px * inverseR, F( 0.0f ) );
+		F aroundY  = B::select( centered, py * inverseR, F( 0.0f ) );
+		F sinLat, cosLat;
+		T::sincos( lat, sinLat, cosLat );
+		return V3{ cosLat * aroundX, sinLat, cosLat * aroundY };
+	}
+	static V3 flatImageUvToDir( F u, F v, const FrameConstants& k, float fovOutput )
+	{
+		return normalize( V3{ ( 2.0f * u - 1.0f ) * k.aspectRatio, F( 1.0f / fovOutput ), 2.0f * v - 1.0f } );
+	}
+	template< class T >
+	static V3 cubemapUvToDir( F u, F v, const FrameConstants& k, bool equiAngularCubemap )
+	{
+		const float leftBoundary       = 1.0f / 3.0f;
+		const float rightBoundary      = 2.0f / 3.0f;
+		// An EAC face always spans 90 degrees, see Fragment::cubemapUvToPoint().
+		const float faceDistance       = equiAngularCubemap ? 1.0f / 3.0f : k.fovOut / 3.0f;
+		const float verticalCorrection = 2.0f / 3.0f;
+		M top   = v >= 0.5f;
+		M left  = u <= leftBoundary;
+		M right = u > rightBoundary;
+		F posX  = 2.0f * u - 1.0f + B::select( left, F( 2.0f / 3.0f ), B::select( right, F( -2.0f / 3.0f ), F( 0.0f ) ) );
+		F posY  = 2.0f * v - 1.0f + B::select( top, F( -0.5f ), F( 0.5f ) );
+		if( equiAngularCubemap )
+		{
+			posX = T::tan( posX * ( 3.0f * PI / 4.0f ) ) / 3.0f;
+			posY = T::tan( posY * ( PI / 2.0f ) ) / 2.0f;
+		}
+
+		// Top row: Left, Front, Right faces. Bottom row: Top, Back, Bottom faces.
+		F fd = F( faceDistance ), negFd = F( -faceDistance );
+		F topX = B::select( left, negFd, B::select( right, fd, posX ) );
+		F topY = B::select( left, posX, B::select( right, -posX, fd ) );
+		F topZ = verticalCorrection * posY;
+		F bottomX = -posY * verticalCorrection;
+		F bottomY = B::select( left, -posX, B::select( right, posX, negFd ) );
+		F bottomZ = B::select( left, fd, B::select( right, negFd, -posX ) );
+		return normalize( V3{ B::select( top, topX, bottomX ), B::select( top, topY, bottomY ), B::select( top, topZ, bottomZ ) } );
+	}
+	// Faces stacked bottom up, see Fragment::cubeFacesUvToDir() for the face order and the r = ( x, -z, y ) frame.
+	static V3 cubeFacesUvToDir( F u, F v, float fovOutput )
+	{
+		F face = B::min( B::floor( v * 6.0f ), F( 5.0f ) );
+		F sc   = 2.0f * u - 1.0f;
+		F tc   = 2.0f * ( v * 6.0f - face ) - 1.0f;
+		F ma = F( fovOutput ), negMa = F( -fovOutput );
+		M x = face < 2.0f, y = ( !x ) & ( face < 4.0f );
+		M first = ( face == 0.0f ) | ( face == 2.0f ) | ( face == 4.0f );
+		F rx = B::select( x, B::select( first, ma, negMa ), B::select( ( face == 5.0f ), -sc, sc ) );
+		F ry = B::select( y, B::select( first, ma, negMa ), -tc );
+		F rz = B::select( x, B::select( first, -sc, sc ), B::select( y, B::select( first, tc, -tc ), B::select( first, ma, negMa ) ) );
+		return normalize( V3{ rx, rz, -ry } );
+	}
+	static V3 mirrorDomeUvToDir( F u, F v, const FrameConstants& k, M& transparent )
+	{
+		F px = 2.0f * u - 1.0f;
+		F py = 2.0f * v - 1.0f;
+		F sx = k.halfTan * px * k.aspectRatio;
+		F sy = k.halfTan * py;
+		V3 rayDir = normalize( V3{ k.projForward.x + sx * k.projRight.x + sy * k.projUp.x,
+								   k.projForward.y + sx * k.projRight.y + sy * k.projUp.y,
+								   k.projForward.z + sx * k.projRight.z + sy * k.projUp.z } );
+
+		// Ray-sphere intersection with the mirror, take the closer hit.
+		F b            = 2.0f * dot( rayDir, k.projPos );
+		float c        = reprojection::dot( k.projPos, k.projPos ) - k.mirrorRadius * k.mirrorRadius;
+		F discriminant = b * b - 4.0f * c;
+		F t            = ( -b - B::sqrt( B::max( discriminant, F( 0.0f ) ) ) ) / 2.0f;
+		transparent    = transparent | ( discriminant < 0.0f ) | ( t < 0.0f );
+		V3 mirrorNormal = normalize( V3{ k.projPos.x + t * rayDir.x, k.projPos.y + t * rayDir.y, k.projPos.z + t * rayDir.z } );
+
+		// Reflect off the mirror and intersect the dome, take the farther hit.
+		V3 hitPoint    = V3{ k.mirrorRadius * mirrorNormal.x, k.mirrorRadius * mirrorNormal.y, k.mirrorRadius * mirrorNormal.z };
+		V3 incidentDir = normalize( V3{ hitPoint.x - k.projPos.x, hitPoint.y - k.projPos.y, hitPoint.z - k.projPos.z } );
+		F twiceIDotN   = 2.0f * dot( incidentDir, mirrorNormal );
+		V3 reflectedDir = normalize( V3{ incidentDir.x - twiceIDotN * mirrorNormal.x, incidentDir.y - twiceIDotN * mirrorNormal.y,
+										 incidentDir.z - twiceIDotN * mirrorNormal.z } );
+		b            = 2.0f * dot( hitPoint, reflectedDir );
+		F cDome      = dot( hitPoint, hitPoint ) - k.domeRadius * k.domeRadius;
+		discriminant = b * b - 4.0f * cDome;
+		t            = ( -b + B::sqrt( B::max( discriminant, F( 0.0f ) ) ) ) / 2.0f;
+		V3 domePoint = V3{ hitPoint.x + t * reflectedDir.x, hitPoint.y + t * reflectedDir.y, hitPoint.z + t * reflectedDir.z };
+		transparent  = transparent | ( discriminant < 0.0f ) | ( t < 0.0f ) | ( domePoint.z < 0.0f );
+		return normalize( domePoint );
+	}
+
+	// Input projections: direction -> uv.
+
+	template< class T >
+	static void dirToEquiUv( V3 dir, F& u, F& v, M& transparent )
+	{
+		F lat = T::atan2( dir.z, B::sqrt( dir.x * dir.x + dir.y * dir.y ) );
+		F lon = T::atan2( dir.x, dir.y );
+		u     = ( lon + PI ) / ( 2.0f * PI );
+		v     = ( lat + PI / 2.0f ) / PI;
+		transparent = transparent | ( u < -1.0f ) | ( v < -1.0f ) | ( u > 1.0f ) | ( v > 1.0f );
+	}
+	template< class T >
+	static void dirToFisheyeUv( V3 dir, float fovIn, F& u, F& v, M& transparent )
+	{
+		F axisDistance = B::sqrt( dir.x * dir.x + dir.z * dir.z );
+		F theta        = T::atan2( axisDistance, dir.y );
+		F r            = ( 2.0f / PI ) * ( theta / fovIn );
+		M offAxis      = axisDistance > 0.0f;
+		F inverse      = 1.0f / axisDistance;
+		F aroundX      = B::select( offAxis, dir.x * inverse, F( 1.0f ) );
+		F aroundY      = B::select( offAxis, dir.z * inverse, F( 0.0f ) );
+		u              = ( r * aroundX + 1.0f ) / 2.0f;
+		v              = ( r * aroundY + 1.0f ) / 2.0f;
+		transparent    = transparent | ( r > 1.0f ) | outOfUnitSquare( u, v );
+	}
+	// The table lookup has no batch form, so it runs lane by lane. InverseMirrorMap::lookup() lives in InverseMirror.cpp,
+	// built without the wider instruction sets.
+	template< class T >
+	static void dirToMirrorDomeUv( V3 dir, const FrameConstants& k, F& u, F& v, M& transparent )
+	{
+		F axisDistance = B::sqrt( dir.x * dir.x + dir.y * dir.y );
+		F theta        = T::atan2( axisDistance, dir.z );
+		F r            = theta / ( PI / 2.0f );
+		M offAxis      = axisDistance > 0.0f;
+		F inverse      = 1.0f / axisDistance;
+		F domeU        = ( r * B::select( offAxis, dir.x * inverse, F( 0.0f ) ) + 1.0f ) / 2.0f;
+		F domeV        = ( r * B::select( offAxis, dir.y * inverse, F( 0.0f ) ) + 1.0f ) / 2.0f;
+		float lanesU[ B::WIDTH ], lanesV[ B::WIDTH ];
+		B::store( lanesU, domeU );
+		B::store( lanesV, domeV );
+		for( int i = 0; i < B::WIDTH; ++i )
+		{
+			vec2 sourcePixel = k.inverseMirror ? k.inverseMirror->lookup( vec2( lanesU[ i ], lanesV[ i ] ) ) : SET_TO_TRANSPARENT;
+			lanesU[ i ]      = sourcePixel.x;
+			lanesV[ i ]      = sourcePixel.y;
+		}
+		u           = B::load( lanesU );
+		v           = B::load( lanesV );
+		transparent = transparent | ( dir.z < 0.0f ) | ( u < 0.0f );
+	}
+	static void dirToFlatUv( V3 dir, const FrameConstants& k, float fovInput, F& u, F& v, M& transparent )
+	{
+		transparent = transparent | ( dir.y <= 0.0f );
+		F px        = dir.x / dir.y;
+		F py        = dir.z / dir.y;
+		px          = px / k.aspectRatio;
+		u           = ( px * fovInput ) / 2.0f + 0.5f;
+		v           = ( py * fovInput ) / 2.0f + 0.5f;
+		transparent = transparent | outOfUnitSquare( u, v );
+	}
+	template< class T >
+	static void dirToCubemapUv( V3 point, float fovInput, bool equiAngularCubemap, F& u, F& v, M& transparent )
+	{
+		const float faceDistance       = equiAngularCubemap ? 1.0f / 3.0f : fovInput / 3.0f;
+		const float verticalCorrection = 2.0f / 3.0f;
+		F ax = B::abs( point.x ), ay = B::abs( point.y ), az = B::abs( point.z );
+		M xMajor = ( ax >= ay ) & ( ax >= az );
+		M yMajor = ( !xMajor ) & ( ay >= ax ) & ( ay >= az );
+		M zMajor = ( !xMajor ) & ( !yMajor );
+		// For the major axis m: pos = faceDistance * ( a / m, b / ( verticalCorrection * m ) ), uv = ( pos + offset ) / 2
+		F m        = B::select( xMajor, point.x, B::select( yMajor, point.y, point.z ) );
+		M positive = m > 0.0f;
+		F a        = B::select( yMajor, B::select( positive, point.x, point.z ), -point.y );
+		F b        = B::select( xMajor, B::select( positive, point.z, -point.z ),
+								B::select( yMajor, B::select( positive, point.z, point.x ), B::select( positive, -point.x, point.x ) ) );
+		F offsetX  = B::select( yMajor, F( 1.0f ), B::select( positive ^ zMajor, F( 5.0f / 3.0f ), F( 1.0f / 3.0f ) ) );
+		F offsetY  = B::select( xMajor | ( yMajor & positive ), F( 1.5f ), F( 0.5f ) );
+		transparent = transparent | ( B::abs( m ) < 0.000001f );
+		F posX      = faceDistance * a / m;
+		F posY      = faceDistance * b / ( verticalCorrection * m );
+		if( equiAngularCubemap )
+		{
+			posX = T::atan( 3.0f * posX ) * ( 4.0f / ( 3.0f * PI ) );
+			posY = T::atan( 2.0f * posY ) * ( 2.0f / PI );
+		}
+		u           = ( posX + offsetX ) / 2.0f;
+		v           = ( posY + offsetY ) / 2.0f;
+		transparent = transparent | outOfUnitSquare( u, v );
+	}
+
+	static void dirToCubeFacesUv( V3 dir, const FrameConstants& k, float fovInput, F& u, F& v, M& transparent )
+	{
+		F rx = dir.x, ry = -dir.z, rz = dir.y;
+		F ax = B::abs( rx ), ay = B::abs( ry ), az = B::abs( rz );
+		M xMajor   = ( ax >= ay ) & ( ax >= az );
+		M yMajor   = ( !xMajor ) & ( ay >= az );
+		F ma       = B::select( xMajor, ax, B::select( yMajor, ay, az ) );
+		M positive = B::select( xMajor, rx, B::select( yMajor, ry, rz ) ) > 0.0f;
+		F sc       = B::select( xMajor, B::select( positive, -rz, rz ), B::select( yMajor | positive, rx, -rx ) );
+		F tc       = B::select( yMajor, B::select( positive, rz, -rz ), -ry );
+		F face     = B::select( xMajor, F( 0.0f ), B::select( yMajor, F( 2.0f ), F( 4.0f ) ) ) + B::select( positive, F( 0.0f ), F( 1.0f ) );
+		F s         = ( fovInput * sc / ma + 1.0f ) / 2.0f;
+		F t         = ( fovInput * tc / ma + 1.0f ) / 2.0f;
+		transparent = transparent | ( ma == 0.0f ) | outOfUnitSquare( s, t );
+		u           = B::min( B::max( s, F( k.cubeFacesEdge.x ) ), F( 1.0f - k.cubeFacesEdge.x ) );
+		t           = B::min( B::max( t, F( k.cubeFacesEdge.y ) ), F( 1.0f - k.cubeFacesEdge.y ) );
+		v           = ( face + t ) / 6.0f;
+	}
+
+	// The lens with the larger weight in the seam cross fade to u and v, the other one to seamU and seamV with its
+	// weight in seamWeight, 0 where only one lens sees dir.
+	template< class T >
+	static void dirToDualFisheyeUv( V3 dir, const FrameConstants& k, F& u, F& v, M& transparent, F& seamU, F& seamV, F& seamWeight )
+	{
+		F axisDistance = B::sqrt( dir.x * dir.x + dir.z * dir.z );
+		F theta        = T::atan2( axisDistance, dir.y );
+		M offAxis      = axisDistance > 0.0f;
+		F inverse      = 1.0f / axisDistance;
+		F aroundX      = B::select( offAxis, dir.x * inverse, F( 1.0f ) );
+		F aroundY      = B::select( offAxis, dir.z * inverse, F( 0.0f ) );
+		F frontR       = theta * k.frontLens.w;
+		F backR        = ( PI - theta ) * k.backLens.w;
+		F frontU       = k.frontLens.x + 0.5f * k.frontLens.z * frontR * aroundX;
+		F frontV       = k.frontLens.y + 0.5f * k.frontLens.z * frontR * aroundY;
+		F backU        = k.backLens.x - 0.5f * k.backLens.z * backR * aroundX;
+		F backV        = k.backLens.y + 0.5f * k.backLens.z * backR * aroundY;
+		M frontSees    = !( ( frontR > 1.0f ) | outOfUnitSquare( frontU, frontV ) );
+		M backSees     = !( ( backR > 1.0f ) | outOfUnitSquare( backU, backV ) );
+		F t            = B::min( B::max( ( theta - k.seamBand.x ) / ( k.seamBand.y - k.seamBand.x ), F( 0.0f ) ), F( 1.0f ) );
+		F frontWeight  = B::select( backSees, B::select( frontSees, 1.0f - t * t * ( 3.0f - 2.0f * t ), F( 0.0f ) ), F( 1.0f ) );
+		M frontFirst   = frontWeight >= 0.5f;
+		u              = B::select( frontFirst, frontU * 0.5f, backU * 0.5f + 0.5f );
+		v              = B::select( frontFirst, frontV, backV );
+		seamU          = B::select( frontFirst, backU * 0.5f + 0.5f, frontU * 0.5f );
+		seamV          = B::select( frontFirst, backV, frontV );
+		seamWeight     = B::select( frontFirst, 1.0f - frontWeight, frontWeight );
+		transparent    = transparent | !( frontSees | backSees );
+	}
+	template< class T >
+	static void dirToDualFisheyeUv( V3 dir, const FrameConstants& k, F& u, F& v, M& transparent )
+	{
+		F seamU, seamV, seamWeight;
+		dirToDualFisheyeUv< T >( dir, k, u, v, transparent, seamU, seamV, seamWeight );
+	}
+
+	// main() split at the rotation: stereoStretch() and outputDir() up to the unrotated direction, sourceUv() after it.
+
+	// Stretches the half of a stereo frame pixel ( u, v ) is in over the whole uv square, returns which lanes are in the second half.
+	static M stereoStretch( const Uniforms& uniforms, F& u, F& v )
+	{
+		M secondHalf = B::none();
+		if( uniforms.stereo == STEREO_OVER_UNDER )
+		{
+			secondHalf = v > 0.5f;
+			v          = B::select( secondHalf, ( v - 0.5f ) * 2.0f, v * 2.0f );
+		}
+		else if( uniforms.stereo == STEREO_SIDE_BY_SIDE )
+		{
+			secondHalf = u > 0.5f;
+			u          = B::select( secondHalf, ( u - 0.5f ) * 2.0f, u * 2.0f );
+		}
+		return secondHalf;
+	}
+	// All lanes set, the mask of an output projection that has no directions.
+	static M allLanes() { return !B::none(); }
+	template< class T, int OutputProjection >
+	static V3 outputDir( const FrameConstants& k, F u, F v, M& transparent )
+	{
+		return ProjectionTraits< OutputProjection >::template batchUvToDir< BatchKernel, T >( k, u, v, transparent );
+	}
+	// Squeezes ( u, v ) into the stereo half and scales it by MaxUV, SET_TO_TRANSPARENT in the lanes of transparent.
+	static void squeezeIntoEye( const Uniforms& uniforms, const FrameConstants& k, M secondHalf, M transparent, F& u, F& v )
+	{
+		if( uniforms.stereo == STEREO_OVER_UNDER )
+			v = B::select( secondHalf, v / 2.0f + 0.5f, v / 2.0f );
+		else if( uniforms.stereo == STEREO_SIDE_BY_SIDE )
+			u = B::select( secondHalf, u / 2.0f + 0.5f, u / 2.0f );
+
+		u = B::select( transparent, F( SET_TO_TRANSPARENT.x ), u * k.maxUV.x );
+		v = B::select( transparent, F( SET_TO_TRANSPARENT.y ), v * k.maxUV.y );
+	}
+	// Rotates dir and maps it through the input projection, squeezed into the stereo half and scaled by MaxUV. The
+	// seam cross fade of a DUAL_FISHEYE input goes to seamU, seamV and seamWeight the same way, like the shader's
+	// #if INPUT_PROJECTION == DUAL_FISHEYE block; every other input has weight 0 and a transparent seam.
+	template< class T, int InputProjection >
+	static void sourceUv( const Uniforms& uniforms, const FrameConstants& k, V3 dir, M secondHalf, M transparent, F& sourceU, F& sourceV, F& seamU,
+						  F& seamV, F& seamWeight )
+	{
+		dir = rotate( k.rotation, dir );
+
+		sourceU    = F( 0.0f );
+		sourceV    = F( 0.0f );
+		seamU      = F( 0.0f );
+		seamV      = F( 0.0f );
+		seamWeight = F( 0.0f );
+		if( InputProjection == DUAL_FISHEYE )
+			dirToDualFisheyeUv< T >( dir, k, sourceU, sourceV, transparent, seamU, seamV, seamWeight );
+		else
+			ProjectionTraits< InputProjection >::template batchDirToUv< BatchKernel, T >( k, dir, sourceU, sourceV, transparent );
+
+		M noSeam   = transparent | !( seamWeight > 0.0f );
+		seamWeight = B::select( noSeam, F( 0.0f ), seamWeight );
+		squeezeIntoEye( uniforms, k, secondHalf, noSeam, seamU, seamV );
+		squeezeIntoEye( uniforms, k, secondHalf, transparent, sourceU, sourceV );
+	}
+	// Writes the first count lanes of a and b to out, interleaved, and advances out past them.
+	static void storeInterleaved( F a, F b, int count, float*& out )
+	{
+		float lanesA[ B::WIDTH ], lanesB[ B::WIDTH ];
+		B::store( lanesA, a );
+		B::store( lanesB, b );
+		for( int i = 0; i < count; ++i )
+		{
+			*out++ = lanesA[ i ];
+			*out++ = lanesB[ i ];
+		}
+	}
+	// Writes the seam of sourceUv() for the first count lanes, unless seamUv is nullptr, and advances both outputs.
+	static void storeSeam( F seamU, F seamV, F weight, int count, float*& seamUv, float*& seamWeight )
+	{
+		if( seamUv == nullptr )
+			return;
+		storeInterleaved( seamU, seamV, count, seamUv );
+		float lanes[ B::WIDTH ];
+		B::store( lanes, weight );
+		for( int i = 0; i < count; ++i )
+			*seamWeight++ = lanes[ i ];
+	}
+	// Reads count floats from source into the first lanes, the rest are 0. Full batches load directly.
+	static F loadPartial( const float* source, int count )
+	{
+		if( count == B::WIDTH )
+			return B::load( source );
+		float lanes[ B::WIDTH ] = {};
+		for( int i = 0; i < count; ++i )
+			lanes[ i ] = source[ i ];
+		return B::load( lanes );
+	}
+
+	// Projections outside the registry leave the row transparent, like reprojectFunction() does.
+	static bool knownProjections( const Uniforms& uniforms )
+	{
+		return uniforms.inputProjection >= 0 && uniforms.inputProjection < PROJECTION_COUNT && uniforms.outputProjection >= 0 &&
+			   uniforms.outputProjection < PROJECTION_COUNT;
+	}
+	static void storeTransparent( int count, float* uv, float* seamUv, float* seamWeight )
+	{
+		for( int i = 0; i < count; ++i )
+		{
+			*uv++ = SET_TO_TRANSPARENT.x;
+			*uv++ = SET_TO_TRANSPARENT.y;
+		}
+		if( seamUv != nullptr )
+			storeTransparent( count, seamUv, nullptr, nullptr );
+		for( int i = 0; seamWeight != nullptr && i < count; ++i )
+			*seamWeight++ = 0.0f;
+	}
+
+	// The row functions for every projection, or pair of projections indexed input * PROJECTION_COUNT + output, with
+	// the trig of T.
+	template< class T, int... Pairs >
+	static ReprojectRowFunction reprojectRowFunction( int pair, std::integer_sequence< int, Pairs... > )
+	{
+		static const ReprojectRowFunction table[] = { &reprojectRow< T, Pairs / PROJECTION_COUNT, Pairs % PROJECTION_COUNT >... };
+		return table[ pair ];
+	}
+	template< class T, int... Projections >
+	static OutputRaysRowFunction outputRaysRowFunction( int projection, std::integer_sequence< int, Projections... > )
+	{
+		static const OutputRaysRowFunction table[] = { &outputRaysRow< T, Projections >... };
+		return table[ projection ];
+	}
+	template< class T, int... Projections >
+	static MapRaysRowFunction mapRaysRowFunction( int projection, std::integer_sequence< int, Projections... > )
+	{
+		static const MapRaysRowFunction table[] = { &mapRaysRow< T, Projections >... };
+		return table[ projection ];
+	}
+
+	static void reprojectRow( const Uniforms& uniforms, const FrameConstants& k, int width, int height, int y, int x0, int x1, float* uv,
+							  float* seamUv, float* seamWeight )
+	{
+		if( !knownProjections( uniforms ) )
+			return storeTransparent( x1 - x0, uv, seamUv, seamWeight );
+		const int pair = uniforms.inputProjection * PROJECTION_COUNT + uniforms.outputProjection;
+		const auto pairs = std::make_integer_sequence< int, PROJECTION_COUNT * PROJECTION_COUNT >();
+		ReprojectRowFunction row = uniforms.precision == PRECISION_FAST ? reprojectRowFunction< FastTrig< B > >( pair, pairs )
+																		  : reprojectRowFunction< BatchKernel >( pair, pairs );
+		row( uniforms, k, width, height, y, x0, x1, uv, seamUv, seamWeight );
+	}
+	template< class T, int InputProjection, int OutputProjection >
+	static void reprojectRow( const Uniforms& uniforms, const FrameConstants& k, int width, int height, int y, int x0, int x1, float* uv,
+							  float* seamUv, float* seamWeight )
+	{
+		const F localV = F( ( y + 0.5f ) / height );
+		for( int x = x0; x < x1; x += B::WIDTH )
+		{
+			F u          = ( B::iota( float( x ) ) + 0.5f ) / float( width );
+			F v          = localV;
+			M secondHalf = stereoStretch( uniforms, u, v );
+
+			M transparent = B::none();
+			V3 dir        = outputDir< T, OutputProjection >( k, u, v, transparent );
+
+			F sourceU, sourceV, seamU, seamV, weight;
+			sourceUv< T, InputProjection >( uniforms, k, dir, secondHalf, transparent, sourceU, sourceV, seamU, seamV, weight );
+			int count = x1 - x < B::WIDTH ? x1 - x : B::WIDTH;
+			storeInterleaved( sourceU, sourceV, count, uv );
+			storeSeam( seamU, seamV, weight, count, seamUv, seamWeight );
+		}
+	}
+
+	static void outputRaysRow( const Uniforms& uniforms, const FrameConstants& k, int width, int height, int y, int x0, int x1, float* rayX, float* rayY,
+							   float* rayZ )
+	{
+		if( uniforms.outputProjection < 0 || uniforms.outputProjection >= PROJECTION_COUNT )
+		{
+			// The zero ray mapRaysRow() takes for transparent.
+			for( int x = x0; x < x1; ++x )
+				*rayX++ = *rayY++ = *rayZ++ = 0.0f;
+			return;
+		}
+		const auto projections = std::make_integer_sequence< int, PROJECTION_COUNT >();
+		OutputRaysRowFunction row = uniforms.precision == PRECISION_FAST
+										? outputRaysRowFunction< FastTrig< B > >( uniforms.outputProjection, projections )
+										: outputRaysRowFunction< BatchKernel >( uniforms.outputProjection, projections );
+		row( uniforms, k, width, height, y, x0, x1, rayX, rayY, rayZ );
+	}
+	template< class T, int OutputProjection >
+	static void outputRaysRow( const Uniforms& uniforms, const FrameConstants& k, int width, int height, int y, int x0, int x1, float* rayX, float* rayY,
+							   float* rayZ )
+	{
+		const F zero   = F( 0.0f );
+		const F localV = F( ( y + 0.5f ) / height );
+		for( int x = x0; x < x1; x += B::WIDTH )
+		{
+			F u = ( B::iota( float( x ) ) + 0.5f ) / float( width );
+			F v = localV;
+			stereoStretch( uniforms, u, v );
+
+			M transparent = B::none();
+			V3 dir        = outputDir< T, OutputProjection >( k, u, v, transparent );
+
+			float lanesX[ B::WIDTH ], lanesY[ B::WIDTH ], lanesZ[ B::WIDTH ];
+			B::store( lanesX, B::select( transparent, zero, dir.x ) );
+			B::store( lanesY, B::select( transparent, zero, dir.y ) );
+			B::store( lanesZ, B::select( transparent, zero, dir.z ) );
+			int count = x1 - x < B::WIDTH ? x1 - x : B::WIDTH;
+			for( int i = 0; i < count; ++i )
+			{
+				*rayX++ = lanesX[ i ];
+				*rayY++ = lanesY[ i ];
+				*rayZ++ = lanesZ[ i ];
+			}
+		}
+	}
+
+	static void mapRaysRow( const Uniforms& uniforms, const FrameConstants& k, int width, int height, int y, int x0, int x1, const float* rayX,
+							const float* rayY, const float* rayZ, float* uv, float* seamUv, float* seamWeight )
+	{
+		if( uniforms.inputProjection < 0 || uniforms.inputProjection >= PROJECTION_COUNT )
+			return storeTransparent( x1 - x0, uv, seamUv, seamWeight );
+		const auto projections = std::make_integer_sequence< int, PROJECTION_COUNT >();
+		MapRaysRowFunction row = uniforms.precision == PRECISION_FAST ? mapRaysRowFunction< FastTrig< B > >( uniforms.inputProjection, projections )
+																	   : mapRaysRowFunction< BatchKernel >( uniforms.inputProjection, projections );
+		row( uniforms, k, width, height, y, x0, x1, rayX, rayY, rayZ, uv, seamUv, seamWeight );
+	}
+	template< class T, int InputProjection >
+	static void mapRaysRow( const Uniforms& uniforms, const FrameConstants& k, int width, int height, int y, int x0, int x1, const float* rayX,
+							const float* rayY, const float* rayZ, float* uv, float* seamUv, float* seamWeight )
+	{
+		const F zero   = F( 0.0f );
+		const F localV = F( ( y + 0.5f ) / height );
+		for( int x = x0; x < x1; x += B::WIDTH )
+		{
+			// Only which stereo half the pixel is in matters here, the stretched uv went into the rays already.
+			F u          = ( B::iota( float( x ) ) + 0.5f ) / float( width );
+			F v          = localV;
+			M secondHalf = stereoStretch( uniforms, u, v );
+
+			int count     = x1 - x < B::WIDTH ? x1 - x : B::WIDTH;
+			V3 dir        = V3{ loadPartial( rayX, count ), loadPartial( rayY, count ), loadPartial( rayZ, count ) };
+			M transparent = ( dir.x == zero ) & ( dir.y == zero ) & ( dir.z == zero );
+			rayX += count;
+			rayY += count;
+			rayZ += count;
+
+			F sourceU, sourceV, seamU, seamV, weight;
+			sourceUv< T, InputProjection >( uniforms, k, dir, secondHalf, transparent, sourceU, sourceV, seamU, seamV, weight );
+			storeInterleaved( sourceU, sourceV, count, uv );
+			storeSeam( seamU, seamV, weight, count, seamUv, seamWeight );
+		}
+	}
+};
+
+}// namespace reprojection
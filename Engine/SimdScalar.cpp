@@ -0,0 +1,57 @@
+#include <algorithm>
+#include <cmath>
+#include "SimdKernel.h"
+
+// BatchKernel one pixel at a time. Runs everywhere, and is the fallback when the CPU has neither AVX2 nor AVX-512.
+namespace reprojection
+{
+namespace
+{
+struct ScalarBatch
+{
+	static const int WIDTH = 1;
+	typedef float F;
+	typedef bool M;
+
+	static F select( M mask, F a, F b ) { return mask ? a : b; }
+	static F sqrt( F a ) { return std::sqrt( a ); }
+	static F abs( F a ) { return std::fabs( a ); }
+	static F floor( F a ) { return std::floor( a ); }
+	static F min( F a, F b ) { return std::min( a, b ); }
+	static F max( F a, F b ) { return std::max( a, b ); }
+	static M none() { return false; }
+	static F iota( float start ) { return start; }
+	static F load( const float* source ) { return *source; }
+	static void store( float* destination, F a ) { *destination = a; }
+};
+
+void reprojectRowScalar( const Uniforms& uniforms, const FrameConstants& constants, int width, int height, int y, int x0, int x1, float* uv,
+						float* seamUv, float* seamWeight )
+{
+	BatchKernel< ScalarBatch >::reprojectRow( uniforms, constants, width, height, y, x0, x1, uv, seamUv, seamWeight );
+}
+
+void outputRaysRowScalar( const Uniforms& uniforms, const FrameConstants& constants, int width, int height, int y, int x0, int x1, float* rayX, float* rayY,
+						float* rayZ )
+{
+	BatchKernel< ScalarBatch >::outputRaysRow( uniforms, constants, width, height, y, x0, x1, rayX, rayY, rayZ );
+}
+
+void mapRaysRowScalar( const Uniforms& uniforms, const FrameConstants& constants, int width, int height, int y, int x0, int x1, const float* rayX,
+					 const float* rayY, const float* rayZ, float* uv, float* seamUv, float* seamWeight )
+{
+	BatchKernel< ScalarBatch >::mapRaysRow( uniforms, constants, width, height, y, x0, x1, rayX, rayY, rayZ, uv, seamUv, seamWeight );
+}
+}// namespace
+
+ReprojectRowFunction scalarReprojectRow()
+{
+	return reprojectRowScalar;
+}
+
+RayKernels scalarRayKernels()
+{
+	return RayKernels{ outputRaysRowScalar, mapRaysRowScalar };
+}
+
+}// namespace reprojection
@@ -0,0 +1,281 @@
+#include "SourceFootprint.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include "ProjectionRegistry.h"
+
+namespace reprojection
+{
+namespace
+{
+const int GRID_STRIDE = 16;//!< Output pixels between the corners of the initial grid squares
+
+class FootprintWalker
+{
+public:
+	FootprintWalker( const Uniforms& uniforms, int width, int height, bool seam, SourceFootprint& footprint ) :
+		uniforms( uniforms ), constants( computeFrameConstants( uniforms ) ),
+		reproject( reprojectFunction( uniforms.inputProjection, uniforms.outputProjection ) ), width( width ), height( height ), seam( seam ),
+		footprint( footprint ), maxSpread( 2.0f * footprint.cellSize )
+	{
+	}
+
+	// main() at the center of output pixel x, y, in source texel coordinates (texel centers at integers) so spreads
+	// compare against cell sizes directly.
+	vec2 at( int x, int y ) const
+	{
+		Fragment fragment( uniforms, constants );
+		vec2 uv = reproject( fragment, vec2( ( x + 0.5f ) / width, ( y + 0.5f ) / height ) );
+		if( seam )
+			uv = fragment.seamWeight > 0.0f ? fragment.seamPixel : SET_TO_TRANSPARENT;
+		if( uv == SET_TO_TRANSPARENT )
+			return uv;
+		return vec2( uv.x * footprint.sourceWidth - 0.5f, uv.y * footprint.sourceHeight - 0.5f );
+	}
+
+	// The square between output pixel centers x0 .. x1 and y0 .. y1, and main() at its corners.
+	void visit( int x0, int y0, int x1, int y1, vec2 c00, vec2 c10, vec2 c01, vec2 c11 )
+	{
+		const vec2 corners[ 4 ] = { c00, c10, c01, c11 };
+		int transparent         = 0;
+		for( vec2 c : corners )
+			transparent += c == SET_TO_TRANSPARENT ? 1 : 0;
+		if( transparent == 4 )
+			return;
+
+		if( x1 - x0 <= 1 && y1 - y0 <= 1 )
+		{
+			// Nothing between the corners any more, they are the samples. Half a texel covers the vectorized kernels
+			// rounding a sample right on a texel edge the other way.
+			for( vec2 c : corners )
+			{
+				if( c != SET_TO_TRANSPARENT )
+					mark( c.x - 0.5f, c.y - 0.5f, c.x + 0.5f, c.y + 0.5f );
+			}
+			return;
+		}
+		if( transparent == 0 )
+		{
+			float minX   = std::min( std::min( c00.x, c10.x ), std::min( c01.x, c11.x ) );
+			float maxX   = std::max( std::max( c00.x, c10.x ), std::max( c01.x, c11.x ) );
+			float minY   = std::min( std::min( c00.y, c10.y ), std::min( c01.y, c11.y ) );
+			float maxY   = std::max( std::max( c00.y, c10.y ), std::max( c01.y, c11.y ) );
+			float spread = std::max( maxX - minX, maxY - minY );
+			if( spread <= maxSpread )
+			{
+				// The mapping bends between the corners, a quarter of the spread is plenty for a square this small.
+				float margin = 0.25f * spread;
+				mark( minX - margin, minY - margin, maxX + margin, maxY + margin );
+				return;
+			}
+		}
+
+		int xm = x1 - x0 > 1 ? ( x0 + x1 ) / 2 : x0;
+		int ym = y1 - y0 > 1 ? ( y0 + y1 ) / 2 : y0;
+		if( xm == x0 )
+		{
+			vec2 c0m = at( x0, ym ), c1m = at( x1, ym );
+			visit( x0, y0, x1, ym, c00, c10, c0m, c1m );
+			visit( x0, ym, x1, y1, c0m, c1m, c01, c11 );
+		}
+		else if( ym == y0 )
+		{
+			vec2 cm0 = at( xm, y0 ), cm1 = at( xm, y1 );
+			visit( x0, y0, xm, y1, c00, cm0, c01, cm1 );
+			visit( xm, y0, x1, y1, cm0, c10, cm1, c11 );
+		}
+		else
+		{
+			vec2 cm0 = at( xm, y0 ), cm1 = at( xm, y1 ), c0m = at( x0, ym ), c1m = at( x1, ym ), cmm = at( xm, ym );
+			visit( x0, y0, xm, ym, c00, cm0, c0m, cmm );
+			visit( xm, y0, x1, ym, cm0, c10, cmm, c1m );
+			visit( x0, ym, xm, y1, c0m, cmm, c01, cm1 );
+			visit( xm, ym, x1, y1, cmm, c1m, cm1, c11 );
+		}
+	}
+
+private:
+	// Marks the cells holding the texels a bilinear fetch anywhere in [x0, x1] x [y0, y1] may read.
+	void mark( float x0, float y0, float x1, float y1 )
+	{
+		auto cell = [&]( float texel, int size ) {
+			return std::min( std::max( int( std::floor( texel ) ), 0 ), size - 1 ) / footprint.cellSize;
+		};
+		int cx0 = cell( x0, footprint.sourceWidth ), cx1 = cell( x1 + 1.0f, footprint.sourceWidth );
+		int cy0 = cell( y0, footprint.sourceHeight ), cy1 = cell( y1 + 1.0f, footprint.sourceHeight );
+		for( int cy = cy0; cy <= cy1; ++cy )
+			std::fill_n( &footprint.cells[ size_t( cy ) * size_t( footprint.cellsX ) + size_t( cx0 ) ], cx1 - cx0 + 1, uint8_t( 1 ) );
+	}
+
+	const Uniforms& uniforms;
+	const FrameConstants constants;
+	const ReprojectFunction reproject;//!< main() for uniforms' projections
+	const int width;
+	const int height;
+	const bool seam;//!< Walks the second sample of the seam cross fade instead, transparent outside the seam band
+	SourceFootprint& footprint;
+	const float maxSpread;//!< Texels the corners of a square may spread over before it is split
+};
+
+// Walks the grid of squares over a width x height output, see computeSourceFootprint().
+void walkGrid( FootprintWalker& walker, int width, int height )
+{
+	// Grid lines every GRID_STRIDE pixels plus one through the last row and column, each corner evaluated once.
+	std::vector< int > xs, ys;
+	for( int x = 0; x < width - 1; x += GRID_STRIDE )
+		xs.push_back( x );
+	xs.push_back( width - 1 );
+	for( int y = 0; y < height - 1; y += GRID_STRIDE )
+		ys.push_back( y );
+	ys.push_back( height - 1 );
+
+	std::vector< vec2 > below( xs.size() ), above( xs.size() );
+	for( size_t i = 0; i < xs.size(); ++i )
+		below[ i ] = walker.at( xs[ i ], ys[ 0 ] );
+	if( ys.size() == 1 || xs.size() == 1 )
+	{
+		// A single row or column of output pixels: each one is its own square.
+		for( int y = 0; y < height; ++y )
+		{
+			for( int x = 0; x < width; ++x )
+			{
+				vec2 c = walker.at( x, y );
+				walker.visit( x, y, x, y, c, c, c, c );
+			}
+		}
+	}
+	for( size_t j = 1; j < ys.size() && xs.size() > 1; ++j )
+	{
+		for( size_t i = 0; i < xs.size(); ++i )
+			above[ i ] = walker.at( xs[ i ], ys[ j ] );
+		for( size_t i = 1; i < xs.size(); ++i )
+			walker.visit( xs[ i - 1 ], ys[ j - 1 ], xs[ i ], ys[ j ], below[ i - 1 ], below[ i ], above[ i - 1 ], above[ i ] );
+		below.swap( above );
+	}
+}
+
+// Merges the runs of touched cells in each row with identical runs in the rows above into rectangles.
+void buildRects( SourceFootprint& footprint )
+{
+	struct Open
+	{
+		int cx0;
+		int cx1;
+		int cy0;
+	};
+	std::vector< Open > open, next;
+	auto close = [&]( const Open& run, int cy1 ) {
+		footprint.rects.push_back( { run.cx0 * footprint.cellSize, run.cy0 * footprint.cellSize,
+									 std::min( run.cx1 * footprint.cellSize, footprint.sourceWidth ),
+									 std::min( cy1 * footprint.cellSize, footprint.sourceHeight ) } );
+	};
+	for( int cy = 0; cy <= footprint.cellsY; ++cy )
+	{
+		next.clear();
+		const uint8_t* row = cy < footprint.cellsY ? &footprint.cells[ size_t( cy ) * size_t( footprint.cellsX ) ] : nullptr;
+		for( int cx = 0; row != nullptr && cx < footprint.cellsX; )
+		{
+			if( !row[ cx ] )
+			{
+				++cx;
+				continue;
+			}
+			int end = cx;
+			while( end < footprint.cellsX && row[ end ] )
+				++end;
+			auto match = std::find_if( open.begin(), open.end(), [&]( const Open& run ) { return run.cx0 == cx && run.cx1 == end; } );
+			if( match != open.end() )
+			{
+				next.push_back( *match );
+				open.erase( match );
+			}
+			else
+			{
+				next.push_back( { cx, end, cy } );
+			}
+			cx = end;
+		}
+		for( const Open& run : open )
+			close( run, cy );
+		open.swap( next );
+	}
+}
+
+// Merges the rectangles with the cheapest bounding box until there are maxRects left, then marks the cells they now
+// cover, so cells and coverage() describe what actually gets decoded.
+void mergeRects( SourceFootprint& footprint, size_t maxRects )
+{
+	std::vector< SourceRect >& rects = footprint.rects;
+	auto area = []( const SourceRect& r ) { return double( r.x1 - r.x0 ) * double( r.y1 - r.y0 ); };
+	auto join = []( const SourceRect& a, const SourceRect& b ) {
+		return SourceRect{ std::min( a.x0, b.x0 ), std::min( a.y0, b.y0 ), std::max( a.x1, b.x1 ), std::max( a.y1, b.y1 ) };
+	};
+	while( maxRects > 0 && rects.size() > maxRects )
+	{
+		size_t bestA = 0, bestB = 1;
+		double bestCost = -1.0;
+		for( size_t a = 0; a < rects.size(); ++a )
+		{
+			for( size_t b = a + 1; b < rects.size(); ++b )
+			{
+				double cost = area( join( rects[ a ], rects[ b ] ) ) - area( rects[ a ] ) - area( rects[ b ] );
+				if( bestCost < 0.0 || cost < bestCost )
+				{
+					bestCost = cost;
+					bestA    = a;
+					bestB    = b;
+				}
+			}
+		}
+		rects[ bestA ] = join( rects[ bestA ], rects[ bestB ] );
+		rects.erase( rects.begin() + std::ptrdiff_t( bestB ) );
+	}
+	for( const SourceRect& rect : rects )
+	{
+		for( int cy = rect.y0 / footprint.cellSize; cy * footprint.cellSize < rect.y1; ++cy )
+			std::fill_n( &footprint.cells[ size_t( cy ) * size_t( footprint.cellsX ) + size_t( rect.x0 / footprint.cellSize ) ],
+						 ( rect.x1 - rect.x0 + footprint.cellSize - 1 ) / footprint.cellSize, uint8_t( 1 ) );
+	}
+}
+}// namespace
+
+double SourceFootprint::coverage() const
+{
+	// Counted from the cells, merged rectangles may overlap. Only the last row and column of cells can be partial.
+	double texels = 0.0;
+	for( int cy = 0; cy < cellsY; ++cy )
+	{
+		for( int cx = 0; cx < cellsX; ++cx )
+		{
+			if( cells[ size_t( cy ) * size_t( cellsX ) + size_t( cx ) ] )
+				texels += double( std::min( cellSize, sourceWidth - cx * cellSize ) ) * double( std::min( cellSize, sourceHeight - cy * cellSize ) );
+		}
+	}
+	return texels / ( double( sourceWidth ) * double( sourceHeight ) );
+}
+
+SourceFootprint computeSourceFootprint( const Uniforms& uniforms, int width, int height, int cellSize, int maxRects )
+{
+	SourceFootprint footprint;
+	footprint.sourceWidth  = uniforms.width;
+	footprint.sourceHeight = uniforms.height;
+	footprint.cellSize     = std::max( cellSize, 1 );
+	footprint.cellsX       = ( uniforms.width + footprint.cellSize - 1 ) / footprint.cellSize;
+	footprint.cellsY       = ( uniforms.height + footprint.cellSize - 1 ) / footprint.cellSize;
+	footprint.cells.assign( size_t( footprint.cellsX ) * size_t( footprint.cellsY ), 0 );
+
+	FootprintWalker walker( uniforms, width, height, false, footprint );
+	walkGrid( walker, width, height );
+	// Inside its seam band a DUAL_FISHEYE input fetches the other lens too, another field of samples to walk.
+	if( uniforms.inputProjection == DUAL_FISHEYE )
+	{
+		FootprintWalker seamWalker( uniforms, width, height, true, footprint );
+		walkGrid( seamWalker, width, height );
+	}
+
+	buildRects( footprint );
+	mergeRects( footprint, size_t( std::max( maxRects, 0 ) ) );
+	return footprint;
+}
+
+}// namespace reprojection
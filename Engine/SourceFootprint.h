@@ -0,0 +1,50 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "Projection.h"
+
+namespace reprojection
+{
+// A rectangle of source texels, [x0, x1) x [y0, y1), rows bottom-up like Image and GL textures.
+struct SourceRect
+{
+	int x0;
+	int y0;
+	int x1;
+	int y1;
+};
+
+// The part of the source a frame actually samples, so a decoder or uploader can skip the rest. A narrow flat view of
+// an equirectangular source typically touches a few percent of it.
+// The source is split into cellSize x cellSize texel cells and a cell counts as touched when the bilinear fetch of any
+// output pixel may read a texel in it. rects cover the touched cells; a view across the equirectangular seam gives one
+// rectangle at each edge, one over a pole a full width one, one across cube faces at least one per face.
+struct SourceFootprint
+{
+	// Fraction of the source texels inside rects.
+	double coverage() const;
+
+	int sourceWidth  = 0;
+	int sourceHeight = 0;
+	int cellSize     = 0;
+	int cellsX       = 0;
+	int cellsY       = 0;
+	std::vector< uint8_t > cells;//!< cellsX x cellsY, bottom row first, 1 when touched or inside one of rects
+	std::vector< SourceRect > rects;
+};
+
+// Computes the footprint of a width x height output for uniforms, whose width / height give the source size.
+// Rather than running main() for every output pixel, it walks a 16 pixel grid of them and keeps any grid square whose
+// corners land close together in the source as the bounding box of its corners, with a margin for the curvature in
+// between. Squares whose corners land far apart straddle a seam, a pole, a cube edge or the edge of the visible area,
+// and are split until they are a single pixel apart, where the corners are exactly the pixels the renderer samples.
+// So the cost grows with the length of those curves instead of the output area. Visible areas smaller than a grid
+// square with every corner around them transparent are missed.
+// Curved footprints come out as staircases of many thin rectangles, so the pair whose bounding box adds the fewest
+// untouched texels is merged until at most maxRects are left (0 keeps them all); each upload or decode call has a cost
+// of its own too. Merged rectangles may overlap.
+// The second samples of a DUAL_FISHEYE input's seam cross fade are walked the same way, as a field of their own.
+// Coordinates are the ones reprojectUv() returns, so MaxUV is applied.
+SourceFootprint computeSourceFootprint( const Uniforms& uniforms, int width, int height, int cellSize = 64, int maxRects = 16 );
+
+}// namespace reprojection
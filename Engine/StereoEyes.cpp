@@ -0,0 +1,84 @@
+#include "StereoEyes.h"
+#include <algorithm>
+
+namespace reprojection
+{
+namespace
+{
+// StereoEyes::splitRow() with component SQUEEZED halved. Branch free so it vectorizes: it runs for every pair of eye
+// pixels, which makes it most of the cost left of a cheap mapping once main() is shared.
+template< int SQUEEZED >
+void squeezeRow( float* uv, float* secondUv, int count, vec2 maxUV )
+{
+	const float scale[ 2 ] = { maxUV.x, maxUV.y };
+	for( int i = 0; i < count * 2; i += 2 )
+	{
+		bool transparent = uv[ i ] == SET_TO_TRANSPARENT.x && uv[ i + 1 ] == SET_TO_TRANSPARENT.y;
+		float kept       = uv[ i + 1 - SQUEEZED ] * scale[ 1 - SQUEEZED ];
+		float half       = uv[ i + SQUEEZED ] / 2.0f;
+		float first      = half * scale[ SQUEEZED ];
+		float second     = ( half + 0.5f ) * scale[ SQUEEZED ];
+
+		uv[ i + SQUEEZED ]           = transparent ? SET_TO_TRANSPARENT.x : first;
+		uv[ i + 1 - SQUEEZED ]       = transparent ? SET_TO_TRANSPARENT.y : kept;
+		secondUv[ i + SQUEEZED ]     = transparent ? SET_TO_TRANSPARENT.x : second;
+		secondUv[ i + 1 - SQUEEZED ] = transparent ? SET_TO_TRANSPARENT.y : kept;
+	}
+}
+}// namespace
+
+StereoEyes splitStereoEyes( const Uniforms& uniforms, int width, int height )
+{
+	StereoEyes eyes;
+	if( uniforms.stereo == STEREO_OVER_UNDER && height % 2 == 0 )
+	{
+		eyes.width   = width;
+		eyes.height  = height / 2;
+		eyes.offsetY = height / 2;
+	}
+	else if( uniforms.stereo == STEREO_SIDE_BY_SIDE && width % 2 == 0 )
+	{
+		eyes.width   = width / 2;
+		eyes.height  = height;
+		eyes.offsetX = width / 2;
+	}
+	else
+	{
+		return eyes;
+	}
+	eyes.shared = true;
+	eyes.eye    = eyeUniforms( uniforms );
+	eyes.stereo = uniforms.stereo;
+	eyes.maxUV  = uniforms.maxUV;
+	return eyes;
+}
+
+Uniforms eyeUniforms( const Uniforms& uniforms )
+{
+	Uniforms eye = uniforms;
+	eye.stereo   = STEREO_NONE;
+	eye.maxUV    = vec2( 1.0f, 1.0f );
+	// The faces of a CUBE_FACES input are measured in one eye's half of it, not the whole input, see computeFrameConstants().
+	if( uniforms.inputProjection == CUBE_FACES )
+	{
+		eye.width  = uniforms.stereo == STEREO_SIDE_BY_SIDE ? uniforms.width / 2 : uniforms.width;
+		eye.height = uniforms.stereo == STEREO_OVER_UNDER ? uniforms.height / 2 : uniforms.height;
+	}
+	return eye;
+}
+
+void StereoEyes::splitRow( float* uv, float* secondUv, int count ) const
+{
+	if( stereo == STEREO_OVER_UNDER )
+		squeezeRow< 1 >( uv, secondUv, count, maxUV );
+	else
+		squeezeRow< 0 >( uv, secondUv, count, maxUV );
+}
+
+void StereoEyes::splitSeamRow( float* seamUv, const float* seamWeight, float* secondSeamUv, float* secondSeamWeight, int count ) const
+{
+	splitRow( seamUv, secondSeamUv, count );
+	std::copy_n( seamWeight, count, secondSeamWeight );
+}
+
+}// namespace reprojection
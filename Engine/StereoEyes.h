@@ -0,0 +1,38 @@
+#pragma once
+#include "Projection.h"
+
+namespace reprojection
+{
+// main() maps both halves of a stereo frame through the same projection: it stretches the half an output pixel is in
+// over the whole uv square, runs the mapping, and only then squeezes the source uv into that eye's half. When the
+// split falls between two pixels (an even height for over-under, an even width for side by side) every pixel of the
+// second eye has the same stretched uv as one of the first, so the mapping only has to run once per pair, as the
+// mono mapping of a frame one eye in size.
+// Eye 0 is the left half, or the bottom half for over-under since rows run bottom-up.
+struct StereoEyes
+{
+	// Turns count interleaved ( u, v ) results of the eye mapping into what main() returns for them: eye 0's replace
+	// uv, eye 1's go to secondUv. The squeezed coordinate is halved, and offset by one half for eye 1, then MaxUV applies.
+	void splitRow( float* uv, float* secondUv, int count ) const;
+	// The same for the seam of those results, see reprojectRow(): the coordinates split like uv, the weights are the
+	// same in both eyes.
+	void splitSeamRow( float* seamUv, const float* seamWeight, float* secondSeamUv, float* secondSeamWeight, int count ) const;
+
+	bool shared = false;//!< The eyes can share one mapping, nothing below is set otherwise
+	Uniforms eye;       //!< The frame's uniforms for a mono frame of one eye, with MaxUV at 1 as it applies after the squeeze
+	int stereo  = STEREO_NONE;
+	vec2 maxUV  = vec2( 1.0f, 1.0f );
+	int width   = 0;//!< Size of one eye in pixels
+	int height  = 0;
+	int offsetX = 0;//!< Where eye 1's pixel is relative to the matching pixel of eye 0
+	int offsetY = 0;
+};
+
+// Splits a width x height output for uniforms into its eyes, see StereoEyes. shared is false for mono output and for
+// an odd split, those have to run the mapping on every pixel.
+StereoEyes splitStereoEyes( const Uniforms& uniforms, int width, int height );
+
+// The uniforms of one eye of uniforms' stereo frame as a mono frame, see StereoEyes::eye.
+Uniforms eyeUniforms( const Uniforms& uniforms );
+
+}// namespace reprojection
@@ -0,0 +1,179 @@
+#include "TileCoverage.h"
+#include <algorithm>
+
+namespace reprojection
+{
+namespace
+{
+class TileClassifier
+{
+public:
+	TileClassifier( const Uniforms& uniforms, int width, int height, SimdLevel level ) :
+		uniforms( uniforms ), constants( computeFrameConstants( uniforms ) ), width( width ), height( height ), level( level )
+	{
+	}
+
+	TileClass classify( const Tile& tile )
+	{
+		inside  = tile;
+		visible = transparent = ringVisible = false;
+		int xm = ( tile.x0 + tile.x1 ) / 2, ym = ( tile.y0 + tile.y1 ) / 2;
+		for( int y : { tile.y0 - 1, tile.y0, ym, tile.y1 - 1, tile.y1 } )
+			sample( level, y, tile.x0 - 1, tile.x1 + 1 );
+		// A single pixel would fill one lane of a whole batch, the scalar kernel is 8 to 16 times cheaper for the columns.
+		for( int x : { tile.x0 - 1, tile.x0, xm, tile.x1 - 1, tile.x1 } )
+		{
+			for( int y = tile.y0; y < tile.y1; ++y )
+				sample( SimdLevel::Scalar, y, x, x + 1 );
+		}
+		if( !visible && !ringVisible )
+			return TileClass::Empty;
+		return visible && !transparent ? TileClass::Full : TileClass::Partial;
+	}
+
+private:
+	// Runs main() on pixels x0 .. x1 - 1 of row y, clipped to the frame.
+	void sample( SimdLevel kernel, int y, int x0, int x1 )
+	{
+		x0 = std::max( x0, 0 );
+		x1 = std::min( x1, width );
+		if( y < 0 || y >= height || x0 >= x1 )
+			return;
+		uv.resize( size_t( x1 - x0 ) * 2 );
+		reprojectRow( kernel, uniforms, constants, width, height, y, x0, x1, uv.data() );
+		bool rowInside = y >= inside.y0 && y < inside.y1;
+		for( int x = x0; x < x1; ++x )
+		{
+			bool isTransparent = vec2( uv[ size_t( x - x0 ) * 2 ], uv[ size_t( x - x0 ) * 2 + 1 ] ) == SET_TO_TRANSPARENT;
+			if( rowInside && x >= inside.x0 && x < inside.x1 )
+			{
+				visible     = visible || !isTransparent;
+				transparent = transparent || isTransparent;
+			}
+			else
+			{
+				ringVisible = ringVisible || !isTransparent;
+			}
+		}
+	}
+
+	const Uniforms& uniforms;
+	const FrameConstants constants;
+	const int width;
+	const int height;
+	const SimdLevel level;
+	std::vector< float > uv;
+	Tile inside;
+	bool visible;    //!< A sample inside the tile is visible
+	bool transparent;//!< A sample inside the tile is transparent
+	bool ringVisible;//!< A sample just outside the tile is visible
+};
+
+void resetCoverage( const Uniforms& uniforms, int width, int height, int tileSize, TileCoverage& coverage )
+{
+	coverage.uniforms = uniforms;
+	coverage.width    = width;
+	coverage.height   = height;
+	coverage.tileSize = std::max( tileSize, 1 );
+	coverage.columns  = ( width + coverage.tileSize - 1 ) / coverage.tileSize;
+	coverage.rows     = ( height + coverage.tileSize - 1 ) / coverage.tileSize;
+	coverage.classes.assign( size_t( coverage.columns ) * size_t( coverage.rows ), TileClass::Partial );
+}
+
+// Classifies the tiles whose bottom left pixel lies in pixels.
+void classifyRange( TileClassifier& classifier, TileCoverage& coverage, const Tile& pixels )
+{
+	int size = coverage.tileSize;
+	for( int row = ( pixels.y0 + size - 1 ) / size; row * size < pixels.y1; ++row )
+	{
+		for( int column = ( pixels.x0 + size - 1 ) / size; column * size < pixels.x1; ++column )
+		{
+			Tile tile = { column * size, row * size, std::min( ( column + 1 ) * size, coverage.width ), std::min( ( row + 1 ) * size, coverage.height ) };
+			coverage.classes[ size_t( row ) * size_t( coverage.columns ) + size_t( column ) ] = classifier.classify( tile );
+		}
+	}
+}
+}// namespace
+
+int TileCoverage::count( TileClass tileClass ) const
+{
+	return int( std::count( classes.begin(), classes.end(), tileClass ) );
+}
+
+void classifyTiles( const Uniforms& uniforms, int width, int height, int tileSize, TileCoverage& coverage, SimdLevel level )
+{
+	resetCoverage( uniforms, width, height, tileSize, coverage );
+	TileClassifier classifier( uniforms, width, height, level );
+	classifyRange( classifier, coverage, Tile{ 0, 0, width, height } );
+}
+
+void classifyTiles( const Uniforms& uniforms, int width, int height, int tileSize, TileCoverage& coverage, TileExecutor& executor, SimdLevel level )
+{
+	resetCoverage( uniforms, width, height, tileSize, coverage );
+	// Each of the executor's tiles classifies the tiles that start in it, one each when the sizes match.
+	executor.run( width, height, [&]( const Tile& pixels ) {
+		TileClassifier classifier( uniforms, width, height, level );
+		classifyRange( classifier, coverage, pixels );
+	} );
+}
+
+AsyncClassifier::AsyncClassifier( int tileSize, SimdLevel level, int threadCount ) :
+	level( level ), executor( threadCount, tileSize ), worker( [this]() { workerLoop(); } )
+{
+}
+
+AsyncClassifier::~AsyncClassifier()
+{
+	{
+		std::lock_guard< std::mutex > lock( mutex );
+		stopping = true;
+	}
+	wake.notify_one();
+	worker.join();
+}
+
+void AsyncClassifier::request( const Uniforms& uniforms, int width, int height )
+{
+	{
+		std::lock_guard< std::mutex > lock( mutex );
+		requestUniforms = uniforms;
+		requestWidth    = width;
+		requestHeight   = height;
+		hasRequest      = true;
+	}
+	wake.notify_one();
+}
+
+bool AsyncClassifier::take( TileCoverage& coverage )
+{
+	std::lock_guard< std::mutex > lock( mutex );
+	if( !hasReady )
+		return false;
+	std::swap( coverage, ready );
+	hasReady = false;
+	return true;
+}
+
+void AsyncClassifier::workerLoop()
+{
+	std::unique_lock< std::mutex > lock( mutex );
+	for( ;; )
+	{
+		wake.wait( lock, [this]() { return hasRequest || stopping; } );
+		if( stopping )
+			return;
+		const Uniforms uniforms = requestUniforms;
+		const int width         = requestWidth;
+		const int height        = requestHeight;
+		hasRequest              = false;
+		lock.unlock();
+
+		classifyTiles( uniforms, width, height, executor.tileSize(), back, executor, level );
+
+		lock.lock();
+		std::swap( ready, back );
+		hasReady = true;
+	}
+}
+
+}// namespace reprojection
@@ -0,0 +1,94 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Projection.h"
+#include "Simd.h"
+#include "TileExecutor.h"
+
+namespace reprojection
+{
+enum class TileClass : uint8_t
+{
+	Empty,  //!< Every pixel is transparent, clearing the tile is enough
+	Partial,//!< Some pixels are transparent
+	Full    //!< No sampled pixel is transparent
+};
+
+// Which tiles of a width x height output are transparent, mixed or fully covered for one set of parameters.
+// Large parts of some outputs can never show anything: outside the fisheye circle, wherever the rays miss the mirror
+// of the mirror dome and below the dome horizon, and around a flat or fisheye input with a narrow fov In. Classifying
+// the tiles once per parameter change lets the renderers clear the empty ones instead of running main() on them.
+struct TileCoverage
+{
+	TileClass at( int column, int row ) const
+	{
+		return classes[ size_t( row ) * size_t( columns ) + size_t( column ) ];
+	}
+	int count( TileClass tileClass ) const;
+
+	Uniforms uniforms;//!< The mapping classified
+	int width    = 0;
+	int height   = 0;
+	int tileSize = 0;
+	int columns  = 0;
+	int rows     = 0;
+	std::vector< TileClass > classes;//!< columns x rows, bottom row first like Image
+};
+
+// Classifies the tileSize x tileSize tiles of a width x height output by running main(), through the level's kernel
+// like render() does, on a sparse set of pixels of each tile: all of its edge pixels, the row and column through its
+// middle, and the ring of pixels just outside it.
+// The border between visible and transparent is one long curve per output, so a tile holding both almost always has
+// it crossing its edges. A tile only counts as Empty when the ring around it is transparent too, which keeps a tile
+// that differs from its neighbour just by how the trig rounds right at its edge out of Empty. What this misses is a
+// visible island, or a transparent hole, that touches none of the sampled lines. The projections in Shader.h only
+// produce those from slivers under a pixel wide, such as the edge of a flat input seen edge-on or rays grazing the rim
+// of the mirror dome's mirror, which the pixel centers break up into scattered dots; dots between the lines are cleared.
+// Full is a hint only, renderers run main() on Full and Partial tiles alike.
+// Costs roughly 15% of the main() calls of a 64 pixel tiled frame, so it is meant to run on parameter change only.
+void classifyTiles( const Uniforms& uniforms, int width, int height, int tileSize, TileCoverage& coverage, SimdLevel level );
+void classifyTiles( const Uniforms& uniforms, int width, int height, int tileSize, TileCoverage& coverage, TileExecutor& executor, SimdLevel level );
+
+// Classifies TileCoverages on a worker thread, the way AsyncBaker bakes RemapTables: only the newest request is
+// classified, a finished coverage changes hands whole in take(), and the thread drawing frames keeps drawing without it
+// meanwhile. At 8K a classification takes most of a second on one thread, far too long to wait for in a frame.
+class AsyncClassifier
+{
+public:
+	// threadCount is the TileExecutor's, 1 classifies on the worker thread alone.
+	AsyncClassifier( int tileSize, SimdLevel level, int threadCount = 1 );
+	~AsyncClassifier();//!< Waits for the classification in flight
+	AsyncClassifier( const AsyncClassifier& ) = delete;
+	AsyncClassifier& operator=( const AsyncClassifier& ) = delete;
+
+	// Asks for the coverage of uniforms at width x height, see classifyTiles(). Never waits for the worker.
+	void request( const Uniforms& uniforms, int width, int height );
+	// Swaps the newest finished coverage into coverage and returns true, or returns false if none finished since the
+	// last call. Never waits for the worker.
+	bool take( TileCoverage& coverage );
+
+private:
+	void workerLoop();
+
+	SimdLevel level;
+	TileExecutor executor;//!< Its tile size is the coverage's, so each of its tiles classifies one
+
+	std::mutex mutex;
+	std::condition_variable wake;
+	Uniforms requestUniforms;//!< Newest request, valid while hasRequest
+	int requestWidth  = 0;
+	int requestHeight = 0;
+	bool hasRequest   = false;
+	TileCoverage ready;//!< Newest finished coverage, valid while hasReady
+	bool hasReady = false;
+	bool stopping = false;
+
+	TileCoverage back;//!< Only touched by the worker
+
+	std::thread worker;//!< Last, so it starts once everything above is constructed
+};
+
+}// namespace reprojection
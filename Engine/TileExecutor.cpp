@@ -0,0 +1,135 @@
+#include "TileExecutor.h"
+#include <algorithm>
+
+namespace reprojection
+{
+TileExecutor::TileExecutor( int threadCount, int tileSize ) :
+	tileSizePixels( std::max( tileSize, 1 ) )
+{
+	if( threadCount <= 0 )
+		threadCount = int( std::thread::hardware_concurrency() );
+	threadCount = std::max( threadCount, 1 );
+
+	for( int i = 0; i < threadCount; ++i )
+		queues.emplace_back( new Queue() );
+	for( int i = 1; i < threadCount; ++i )
+		workers.emplace_back( &TileExecutor::workerLoop, this, i );
+}
+
+TileExecutor::~TileExecutor()
+{
+	{
+		std::lock_guard< std::mutex > lock( jobMutex );
+		stopping = true;
+	}
+	jobStarted.notify_all();
+	for( std::thread& worker : workers )
+		worker.join();
+}
+
+int TileExecutor::threadCount() const
+{
+	return int( queues.size() );
+}
+
+int TileExecutor::tileSize() const
+{
+	return tileSizePixels;
+}
+
+void TileExecutor::run( int width, int height, const std::function< void( const Tile& ) >& tileKernel )
+{
+	int columns   = ( width + tileSizePixels - 1 ) / tileSizePixels;
+	int rows      = ( height + tileSizePixels - 1 ) / tileSizePixels;
+	int tileCount = columns * rows;
+	if( tileCount == 0 )
+		return;
+
+	// Hand every thread a contiguous band of tiles in row order, so a thread that never steals walks memory linearly.
+	int threads = threadCount();
+	for( int i = 0; i < tileCount; ++i )
+	{
+		int column = i % columns;
+		int row    = i / columns;
+		Tile tile;
+		tile.x0 = column * tileSizePixels;
+		tile.y0 = row * tileSizePixels;
+		tile.x1 = std::min( tile.x0 + tileSizePixels, width );
+		tile.y1 = std::min( tile.y0 + tileSizePixels, height );
+		queues[ size_t( int64_t( i ) * threads / tileCount ) ]->tiles.push_back( tile );
+	}
+
+	{
+		std::lock_guard< std::mutex > lock( jobMutex );
+		kernel      = &tileKernel;
+		busyWorkers = int( workers.size() );
+		++generation;
+	}
+	jobStarted.notify_all();
+
+	drain( 0 );
+
+	std::unique_lock< std::mutex > lock( jobMutex );
+	jobFinished.wait( lock, [this] { return busyWorkers == 0; } );
+	kernel = nullptr;
+}
+
+void TileExecutor::workerLoop( int index )
+{
+	uint64_t seenGeneration = 0;
+	for( ;; )
+	{
+		{
+			std::unique_lock< std::mutex > lock( jobMutex );
+			jobStarted.wait( lock, [&] { return stopping || generation != seenGeneration; } );
+			if( stopping )
+				return;
+			seenGeneration = generation;
+		}
+		drain( index );
+		{
+			std::lock_guard< std::mutex > lock( jobMutex );
+			if( --busyWorkers == 0 )
+				jobFinished.notify_one();
+		}
+	}
+}
+
+// Tiles are only ever added before the workers are woken, so once a thread finds every queue empty
+// the remaining tiles are all in flight on other threads and it can stop.
+void TileExecutor::drain( int index )
+{
+	Tile tile;
+	while( pop( index, tile ) || steal( index, tile ) )
+		( *kernel )( tile );
+}
+
+bool TileExecutor::pop( int index, Tile& tile )
+{
+	Queue& queue = *queues[ size_t( index ) ];
+	std::lock_guard< std::mutex > lock( queue.mutex );
+	if( queue.tiles.empty() )
+		return false;
+	tile = queue.tiles.front();
+	queue.tiles.pop_front();
+	return true;
+}
+
+// Takes from the back of a victim's band, the tile furthest away from where the victim is working.
+bool TileExecutor::steal( int index, Tile& tile )
+{
+	int threads = threadCount();
+	for( int offset = 1; offset < threads; ++offset )
+	{
+		Queue& victim = *queues[ size_t( ( index + offset ) % threads ) ];
+		std::lock_guard< std::mutex > lock( victim.mutex );
+		if( victim.tiles.empty() )
+			continue;
+		tile = victim.tiles.back();
+		victim.tiles.pop_back();
+		return true;
+	}
+	return false;
+}
+
+}// namespace reprojection
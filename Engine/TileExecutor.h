@@ -0,0 +1,67 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace reprojection
+{
+// A rectangle of destination pixels, [x0, x1) x [y0, y1).
+struct Tile
+{
+	int x0;
+	int y0;
+	int x1;
+	int y1;
+};
+
+// Runs a per-tile kernel over a frame on a pool of threads that lives as long as the executor.
+// Neighbouring tiles cost about the same but the cost across a frame varies wildly (the transparent corners of a
+// fisheye or mirror dome output are nearly free, the center traces full rays), so each thread starts with its own
+// contiguous band of tiles and steals from the far end of the other threads' bands once its own band is done.
+class TileExecutor
+{
+public:
+	// threadCount 0 uses every hardware thread. The calling thread always works too, so 1 means no extra threads.
+	explicit TileExecutor( int threadCount = 0, int tileSize = 64 );
+	~TileExecutor();
+	TileExecutor( const TileExecutor& ) = delete;
+	TileExecutor& operator=( const TileExecutor& ) = delete;
+
+	int threadCount() const;
+	int tileSize() const;
+
+	// Splits width x height into tileSize() squares and calls kernel once for each, on any of the threads.
+	// Returns when every tile is done. Only one run() may be in flight at a time.
+	void run( int width, int height, const std::function< void( const Tile& ) >& kernel );
+
+private:
+	struct Queue
+	{
+		std::mutex mutex;
+		std::deque< Tile > tiles;
+	};
+
+	void workerLoop( int index );
+	void drain( int index );
+	bool pop( int index, Tile& tile );
+	bool steal( int index, Tile& tile );
+
+	int tileSizePixels;
+	std::vector< std::unique_ptr< Queue > > queues;//!< One per thread, index 0 belongs to the thread calling run()
+	std::vector< std::thread > workers;
+
+	std::mutex jobMutex;
+	std::condition_variable jobStarted;
+	std::condition_variable jobFinished;
+	const std::function< void( const Tile& ) >* kernel = nullptr;
+	uint64_t generation = 0;//!< Bumped by every run() so sleeping workers know there is new work
+	int busyWorkers     = 0;
+	bool stopping       = false;
+};
+
+}// namespace reprojection
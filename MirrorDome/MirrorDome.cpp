@@ -1,5 +1,7 @@
 #include "MirrorDome.h" // Switch to AddSubtract.h when building locally
 #include "../Reprojection/Shader.h"
+#include <algorithm>
+#include <cmath>
 #include <fstream>
 
 using namespace ffglex;
@@ -19,7 +21,23 @@ enum ParamType : FFUInt32
 	PT_PROJ_LIFT,
 	PT_MIRROR_PROJ_FOV,
 	PT_PROJ_TILT,
-	PT_DOME_RADIUS
+	PT_DOME_RADIUS,
+	PT_LUT_MODE,
+	PT_FAST_TRIG,
+	PT_WARP_MESH,
+	PT_MESH_TOLERANCE,
+	PT_MESH_FILE,
+	PT_EXPORT_FILE,
+	PT_EXPORT_MESH,
+	PT_FRONT_CENTER_X,
+	PT_FRONT_CENTER_Y,
+	PT_FRONT_RADIUS,
+	PT_FRONT_FOV,
+	PT_BACK_CENTER_X,
+	PT_BACK_CENTER_Y,
+	PT_BACK_RADIUS,
+	PT_BACK_FOV,
+	PT_SEAM_FEATHER
 };
 
 static CFFGLPluginInfo PluginInfo(
@@ -50,24 +68,25 @@ void main()
 )";
 
 AddSubtract::AddSubtract() :
+	shaders( _vertexShaderCode ),
 	inputProjection( 1 ), outputProjection( 4 ), stereo( 0 ), pitch( 0.75f ), roll( 0.5f ), yaw( 0.5f ), fovOut( 0.5 ), fovIn( 0.5 ),
-	mirrorRadius( 0.5f ), projDistance( 0.5f ), projLift( 0.5f ), mirrorProjFov( 0.12347f ), projTilt( 0.52751f ), domeRadius( 0.0101f )
+	mirrorRadius( 0.5f ), projDistance( 0.5f ), projLift( 0.5f ), mirrorProjFov( 0.12347f ), projTilt( 0.52751f ), domeRadius( 0.0101f ),
+	lutMode( false ), fastTrig( false ), meshMode( false ), meshTolerance( 0.1f ), exportRequested( false ),
+	frontCenterX( 0.5f ), frontCenterY( 0.5f ), frontRadius( 0.5f ), frontFov( 0.4f ), backCenterX( 0.5f ), backCenterY( 0.5f ), backRadius( 0.5f ),
+	backFov( 0.4f ), seamFeather( 0.5f )
 {
 	SetMinInputs( 1 );
 	SetMaxInputs( 1 );
 
-	SetOptionParamInfo( PT_INPUT_PROJECTION, "InputProjection", 4, inputProjection );
-	SetParamElementInfo( PT_INPUT_PROJECTION, 0, "Equirectangular", 0 );
-	SetParamElementInfo( PT_INPUT_PROJECTION, 1, "Fisheye", 1 );
-	SetParamElementInfo( PT_INPUT_PROJECTION, 2, "Flat", 2 );
-	SetParamElementInfo( PT_INPUT_PROJECTION, 3, "Cubemap", 3 );
-
-	SetOptionParamInfo( PT_OUTPUT_PROJECTION, "OutputProjection", 5, outputProjection );
-	SetParamElementInfo( PT_OUTPUT_PROJECTION, 0, "Equirectangular", 0 );
-	SetParamElementInfo( PT_OUTPUT_PROJECTION, 1, "Fisheye", 1 );
-	SetParamElementInfo( PT_OUTPUT_PROJECTION, 2, "Flat", 2 );
-	SetParamElementInfo( PT_OUTPUT_PROJECTION, 3, "Cubemap", 3 );
-	SetParamElementInfo( PT_OUTPUT_PROJECTION, 4, "MirrorDome", 4 );
+	// The projection options come from Engine/ProjectionRegistry.h, each one's value is its ProjectionType.
+	auto setProjectionOptions = [this]( unsigned int param, const char* name, bool input, float defaultValue ) {
+		const std::vector< int > options = reprojection::projectionOptions( input, true );
+		SetOptionParamInfo( param, name, unsigned( options.size() ), defaultValue );
+		for( size_t option = 0; option < options.size(); ++option )
+			SetParamElementInfo( param, unsigned( option ), reprojection::projectionInfo( options[ option ] ).label, float( options[ option ] ) );
+	};
+	setProjectionOptions( PT_INPUT_PROJECTION, "InputProjection", true, inputProjection );
+	setProjectionOptions( PT_OUTPUT_PROJECTION, "OutputProjection", false, outputProjection );
 
 	SetOptionParamInfo(  PT_STEREO, "Stereo", 3, stereo );
 	SetParamElementInfo( PT_STEREO, 0, "None", 0 );
@@ -87,6 +106,24 @@ AddSubtract::AddSubtract() :
 	SetParamInfof( PT_PROJ_TILT, "Proj Tilt", FF_TYPE_STANDARD );
 	SetParamInfof( PT_DOME_RADIUS, "Dome Radius", FF_TYPE_STANDARD );
 
+	SetParamInfof( PT_LUT_MODE, "LUT Mode", FF_TYPE_BOOLEAN );
+	SetParamInfof( PT_FAST_TRIG, "Fast Trig", FF_TYPE_BOOLEAN );
+	SetParamInfof( PT_WARP_MESH, "Warp Mesh", FF_TYPE_BOOLEAN );
+	SetParamInfof( PT_MESH_TOLERANCE, "Mesh Tolerance", FF_TYPE_STANDARD );
+	SetFileParamInfo( PT_MESH_FILE, "Mesh File", { "data" }, "" );
+	SetParamInfo( PT_EXPORT_FILE, "Export File", FF_TYPE_TEXT, "" );
+	SetParamInfof( PT_EXPORT_MESH, "Export Mesh", FF_TYPE_EVENT );
+
+	SetParamInfof( PT_FRONT_CENTER_X, "Front Center X", FF_TYPE_STANDARD );
+	SetParamInfof( PT_FRONT_CENTER_Y, "Front Center Y", FF_TYPE_STANDARD );
+	SetParamInfof( PT_FRONT_RADIUS, "Front Radius", FF_TYPE_STANDARD );
+	SetParamInfof( PT_FRONT_FOV, "Front FoV", FF_TYPE_STANDARD );
+	SetParamInfof( PT_BACK_CENTER_X, "Back Center X", FF_TYPE_STANDARD );
+	SetParamInfof( PT_BACK_CENTER_Y, "Back Center Y", FF_TYPE_STANDARD );
+	SetParamInfof( PT_BACK_RADIUS, "Back Radius", FF_TYPE_STANDARD );
+	SetParamInfof( PT_BACK_FOV, "Back FoV", FF_TYPE_STANDARD );
+	SetParamInfof( PT_SEAM_FEATHER, "Seam Feather", FF_TYPE_STANDARD );
+
 	FFGLLog::LogToHost( "Created AddSubtract effect" );
 }
 AddSubtract::~AddSubtract()
@@ -95,7 +132,8 @@ AddSubtract::~AddSubtract()
 
 FFResult AddSubtract::InitGL( const FFGLViewportStruct* vp )
 {
-	if( !shader.Compile( _vertexShaderCode, _fragmentShaderCode ) )
+	//Compile the program for the initial options up front, the other combinations are compiled when first selected.
+	if( !shaders.Get( inputProjection, outputProjection, stereo, fastTrig ? reprojection::PRECISION_FAST : reprojection::PRECISION_EXACT ) )
 	{
 		DeInitGL();
 		return FF_FAIL;
@@ -105,6 +143,36 @@ FFResult AddSubtract::InitGL( const FFGLViewportStruct* vp )
 		DeInitGL();
 		return FF_FAIL;
 	}
+	if( !remapLut.Initialise( _vertexShaderCode ) )
+	{
+		DeInitGL();
+		return FF_FAIL;
+	}
+	if( !tileMesh.Initialise() )
+	{
+		DeInitGL();
+		return FF_FAIL;
+	}
+	if( !warpMesh.Initialise() )
+	{
+		DeInitGL();
+		return FF_FAIL;
+	}
+	if( !frameConstants.Initialise() )
+	{
+		DeInitGL();
+		return FF_FAIL;
+	}
+	if( !inverseMirror.Initialise() )
+	{
+		DeInitGL();
+		return FF_FAIL;
+	}
+	if( !cubeFaces.Initialise() )
+	{
+		DeInitGL();
+		return FF_FAIL;
+	}
 	
 	//Use base-class init as success result so that it retains the viewport.
 	return CFFGLPlugin::InitGL( vp );
@@ -117,48 +185,135 @@ FFResult AddSubtract::ProcessOpenGL( ProcessOpenGLStruct* pGL )
 	if( pGL->inputTextures[ 0 ] == NULL )
 		return FF_FAIL;
 
-	//FFGL requires us to leave the context in a default state on return, so use this scoped binding to help us do that.
-	ScopedShaderBinding shaderBinding( shader.GetGLID() );
+	reprojection::Uniforms uniforms = currentUniforms( *pGL->inputTextures[ 0 ] );
+	if( exportRequested )
+		exportMesh( uniforms );
+	//The input texture's dimension might change each frame and so might the content area.
+	//We're adopting the texture's maxUV using a uniform because that way we dont have to update our vertex buffer each frame.
+	FFGLTexCoords maxCoords = GetMaxGLTexCoords( *pGL->inputTextures[ 0 ] );
+
+	//An imported warp mesh replaces the mirror dome mapping a LUT would be baked from, so it takes precedence.
+	bool importedMesh = warpMesh.HasImport() && outputProjection == reprojection::MIRROR_DOME;
+	//Rebakes in the background when a parameter or the output size changed since the last frame, and keeps drawing
+	//the last finished table meanwhile. Until the first bake is done the frame is drawn per pixel below.
+	if( lutMode && !importedMesh && remapLut.Update( uniforms, currentViewport.width, currentViewport.height ) )
+	{
+		remapLut.Draw( pGL->inputTextures[ 0 ]->Handle, maxCoords, quad );
+		return FF_SUCCESS;
+	}
+
+	FFGLShader* shader = shaders.Get( inputProjection, outputProjection, stereo, uniforms.precision );
+	if( shader == nullptr )
+		return FF_FAIL;
+
+	//Everything that is constant over the frame is computed here once and uploaded as a single uniform block.
+	//With the mirror dome as input that includes its inverse once it is built, see InverseMirrorTexture for the frames before.
+	const reprojection::FrameConstants constants = reprojection::computeFrameConstants( uniforms, false );
+	frameConstants.Upload( constants, maxCoords );
+
 	//The shader's sampler is always bound to sampler index 0 so that's where we need to bind the texture.
 	//Again, we're using the scoped bindings to help us keep the context in a default state.
 	ScopedSamplerActivation activateSampler( 0 );
 	Scoped2DTextureBinding textureBinding( pGL->inputTextures[ 0 ]->Handle );
-	
+	//The inverse mirror table goes next to it, or texture 0 when the input is not the mirror dome.
+	ScopedSamplerActivation activateInverseMirror( InverseMirrorTexture::UNIT );
+	Scoped2DTextureBinding inverseMirrorBinding( inverseMirror.Update( uniforms, constants ) );
+	//With the cube faces as input the shader samples a cube map array built from the input instead of the input itself.
+	bool cubeFacesInput = inputProjection == reprojection::CUBE_FACES;
+	ScopedSamplerActivation activateCubeFaces( CubeFacesTexture::UNIT );
+	ScopedTextureBinding cubeFacesBinding( GL_TEXTURE_CUBE_MAP_ARRAY, cubeFacesInput ? cubeFaces.Update( *pGL->inputTextures[ 0 ], stereo ) : 0 );
+	ScopedSeamlessCubeMaps seamlessCubeMaps( cubeFacesInput );
+	frameConstants.Bind();
 
-	shader.Set( "InputTexture", 0 );
+	//The warp mesh only runs the output projection at its vertices and leaves the per pixel shader to the cells along
+	//the edges of the visible area. Until the mesh for the current output parameters is built the frame is drawn per pixel.
+	//An imported mesh is drawn as is, with no per pixel cells.
+	FFGLShader* meshShader = meshMode || importedMesh ? shaders.Get( inputProjection, outputProjection, stereo, uniforms.precision, true ) : nullptr;
+	if( meshShader != nullptr && warpMesh.Update( uniforms, currentViewport.width, currentViewport.height, currentMeshTolerance() ) )
+	{
+		warpMesh.Draw( meshShader->GetGLID(), shader->GetGLID() );
+	}
+	else
+	{
+		//FFGL requires us to leave the context in a default state on return, so use this scoped binding to help us do that.
+		ScopedShaderBinding shaderBinding( shader->GetGLID() );
+		//Clears the tiles that are transparent for these parameters and only runs the shader on the rest.
+		if( tileMesh.Update( uniforms, currentViewport.width, currentViewport.height ) )
+			tileMesh.Draw();
+		else
+			quad.Draw();
+	}
 
-	//The input texture's dimension might change each frame and so might the content area.
-	//We're adopting the texture's maxUV using a uniform because that way we dont have to update our vertex buffer each frame.
-	FFGLTexCoords maxCoords = GetMaxGLTexCoords( *pGL->inputTextures[ 0 ] );
-	shader.Set( "MaxUV", maxCoords.s, maxCoords.t );
-	//SetParamDisplayName( PT_RED, std::to_string( pGL->inputTextures[ 0 ]->Width ).c_str(), true );
-	glUniform3f( shader.FindUniform( "Rotation" ), (pitch-0.5)*2.0*3.14159265359,
-		                                           (roll -0.5)*2.0*3.14159265359,
-		                                           (yaw  -0.5)*2.0*3.14159265359 );
-	glUniform1f( shader.FindUniform( "fovOut" ), fovOut * 3.14159269359 / 2.0 );
-	glUniform1f( shader.FindUniform( "fovIn" ), fovIn * 3.14159269359 / 2.0 );
-	glUniform1i( shader.FindUniform( "inputProjection" ), inputProjection );
-	glUniform1i( shader.FindUniform( "outputProjection" ), outputProjection );
-	glUniform1i( shader.FindUniform( "stereo" ), stereo );
-	glUniform1i( shader.FindUniform( "width" ), pGL->inputTextures[ 0 ]->Width );
-	glUniform1i( shader.FindUniform( "height" ), pGL->inputTextures[ 0 ]->Height );
+	frameConstants.Unbind();
 
-	// Mirror dome parameters: map from [0,1] slider to physical ranges
-	glUniform1f( shader.FindUniform( "mirrorRadius" ), 0.01f + mirrorRadius * 0.49f );
-	glUniform1f( shader.FindUniform( "projDistance" ), 0.5f + projDistance * 2.5f );
-	glUniform1f( shader.FindUniform( "projLift" ), (projLift - 0.5f) * 4.0f );
-	glUniform1f( shader.FindUniform( "mirrorProjFov" ), 0.02f + mirrorProjFov * 1.03f );
-	glUniform1f( shader.FindUniform( "projTilt" ), (projTilt - 0.5f) * 3.14159265359f );
-	glUniform1f( shader.FindUniform( "domeRadius" ), 0.5f + domeRadius * 49.5f );
+	return FF_SUCCESS;
+}
+reprojection::Uniforms AddSubtract::currentUniforms( const FFGLTextureStruct& inputTexture ) const
+{
+	reprojection::Uniforms uniforms;
+	uniforms.rotation = reprojection::vec3( float( ( pitch - 0.5 ) * 2.0 * 3.14159265359 ),
+											float( ( roll - 0.5 ) * 2.0 * 3.14159265359 ),
+											float( ( yaw - 0.5 ) * 2.0 * 3.14159265359 ) );
+	uniforms.fovOut           = float( fovOut * 3.14159269359 / 2.0 );
+	uniforms.fovIn            = float( fovIn * 3.14159269359 / 2.0 );
+	uniforms.inputProjection  = inputProjection;
+	uniforms.outputProjection = outputProjection;
+	uniforms.stereo           = stereo;
+	uniforms.precision        = fastTrig ? reprojection::PRECISION_FAST : reprojection::PRECISION_EXACT;
+	uniforms.width            = inputTexture.Width;
+	uniforms.height           = inputTexture.Height;
 
-	quad.Draw();
+	// Mirror dome parameters: map from [0,1] slider to physical ranges
+	uniforms.mirrorRadius  = 0.01f + mirrorRadius * 0.49f;
+	uniforms.projDistance  = 0.5f + projDistance * 2.5f;
+	uniforms.projLift      = ( projLift - 0.5f ) * 4.0f;
+	uniforms.mirrorProjFov = 0.02f + mirrorProjFov * 1.03f;
+	uniforms.projTilt      = ( projTilt - 0.5f ) * 3.14159265359f;
+	uniforms.domeRadius    = 0.5f + domeRadius * 49.5f;
 
-	return FF_SUCCESS;
+	// Dual fisheye calibration: centers a quarter of the half frame either way, radius 0.5 to 1.5, FoV 150 to 250 degrees
+	uniforms.frontLens.center = reprojection::vec2( 0.5f + ( frontCenterX - 0.5f ) * 0.5f, 0.5f + ( frontCenterY - 0.5f ) * 0.5f );
+	uniforms.frontLens.radius = 0.5f + frontRadius;
+	uniforms.frontLens.fov    = ( 150.0f + frontFov * 100.0f ) * 3.14159265359f / 180.0f;
+	uniforms.backLens.center  = reprojection::vec2( 0.5f + ( backCenterX - 0.5f ) * 0.5f, 0.5f + ( backCenterY - 0.5f ) * 0.5f );
+	uniforms.backLens.radius  = 0.5f + backRadius;
+	uniforms.backLens.fov     = ( 150.0f + backFov * 100.0f ) * 3.14159265359f / 180.0f;
+	uniforms.seamFeather      = seamFeather * 20.0f * 3.14159265359f / 180.0f;
+	return uniforms;
+}
+void AddSubtract::exportMesh( const reprojection::Uniforms& uniforms )
+{
+	exportRequested = false;
+	if( exportFile.empty() )
+	{
+		FFGLLog::LogToHost( "Set Export File before exporting the warp mesh" );
+		return;
+	}
+	//About one node every 30 pixels of a 1920 wide projector, and square cells.
+	float aspect = float( currentViewport.width ) / float( std::max( currentViewport.height, 1u ) );
+	int columns  = 65;
+	int rows     = std::max( int( std::lround( 64.0f / aspect ) ) + 1, 2 );
+	reprojection::BourkeMesh mesh;
+	reprojection::exportBourkeMesh( uniforms, aspect, columns, rows, mesh );
+	std::string error;
+	if( !reprojection::writeBourkeMesh( exportFile, mesh, error ) )
+		FFGLLog::LogToHost( error.c_str() );
+}
+double AddSubtract::currentMeshTolerance() const
+{
+	// The slider covers 0 to 10 arc minutes, about 4 pixels of an 8K equirectangular frame.
+	return meshTolerance * 10.0 / 60.0 * 3.14159265359 / 180.0;
 }
 FFResult AddSubtract::DeInitGL()
 {
-	shader.FreeGLResources();
+	shaders.Release();
 	quad.Release();
+	remapLut.Release();
+	tileMesh.Release();
+	warpMesh.Release();
+	frameConstants.Release();
+	inverseMirror.Release();
+	cubeFaces.Release();
 
 	return FF_SUCCESS;
 }
@@ -191,6 +346,23 @@ FFResult AddSubtract::SetFloatParameter( unsigned int dwIndex, float value )
 	case PT_FOV_IN:
 		fovIn = value;
 		break;
+	case PT_LUT_MODE:
+		lutMode = value > 0.5f;
+		break;
+	case PT_FAST_TRIG:
+		fastTrig = value > 0.5f;
+		break;
+	case PT_WARP_MESH:
+		meshMode = value > 0.5f;
+		break;
+	case PT_MESH_TOLERANCE:
+		meshTolerance = value;
+		break;
+	case PT_EXPORT_MESH:
+		//Exported on the next frame, which knows the input and output size the mapping depends on.
+		if( value > 0.5f )
+			exportRequested = true;
+		break;
 	case PT_MIRROR_RADIUS:
 		mirrorRadius = value;
 		break;
@@ -209,6 +381,33 @@ FFResult AddSubtract::SetFloatParameter( unsigned int dwIndex, float value )
 	case PT_DOME_RADIUS:
 		domeRadius = value;
 		break;
+	case PT_FRONT_CENTER_X:
+		frontCenterX = value;
+		break;
+	case PT_FRONT_CENTER_Y:
+		frontCenterY = value;
+		break;
+	case PT_FRONT_RADIUS:
+		frontRadius = value;
+		break;
+	case PT_FRONT_FOV:
+		frontFov = value;
+		break;
+	case PT_BACK_CENTER_X:
+		backCenterX = value;
+		break;
+	case PT_BACK_CENTER_Y:
+		backCenterY = value;
+		break;
+	case PT_BACK_RADIUS:
+		backRadius = value;
+		break;
+	case PT_BACK_FOV:
+		backFov = value;
+		break;
+	case PT_SEAM_FEATHER:
+		seamFeather = value;
+		break;
 	default:
 		return FF_FAIL;
 	}
@@ -216,6 +415,48 @@ FFResult AddSubtract::SetFloatParameter( unsigned int dwIndex, float value )
 	return FF_SUCCESS;
 }
 
+FFResult AddSubtract::SetTextParameter( unsigned int index, const char* value )
+{
+	switch( index )
+	{
+	case PT_MESH_FILE:
+	{
+		//An empty path goes back to the analytic ray trace, as does a file that fails to load.
+		meshFile = value != nullptr ? value : "";
+		reprojection::BourkeMesh mesh;
+		std::string error;
+		if( meshFile.empty() )
+			warpMesh.ClearImport();
+		else if( reprojection::readBourkeMesh( meshFile, mesh, error ) )
+			warpMesh.Import( mesh );
+		else
+		{
+			FFGLLog::LogToHost( error.c_str() );
+			warpMesh.ClearImport();
+		}
+		return FF_SUCCESS;
+	}
+	case PT_EXPORT_FILE:
+		exportFile = value != nullptr ? value : "";
+		return FF_SUCCESS;
+	default:
+		return FF_FAIL;
+	}
+}
+
+char* AddSubtract::GetTextParameter( unsigned int index )
+{
+	switch( index )
+	{
+	case PT_MESH_FILE:
+		return const_cast< char* >( meshFile.c_str() );
+	case PT_EXPORT_FILE:
+		return const_cast< char* >( exportFile.c_str() );
+	default:
+		return CFFGLPlugin::GetTextParameter( index );
+	}
+}
+
 float AddSubtract::GetFloatParameter( unsigned int index )
 {
 	switch( index )
@@ -236,6 +477,14 @@ float AddSubtract::GetFloatParameter( unsigned int index )
 		return fovOut;
 	case PT_FOV_IN:
 		return fovIn;
+	case PT_LUT_MODE:
+		return lutMode ? 1.0f : 0.0f;
+	case PT_FAST_TRIG:
+		return fastTrig ? 1.0f : 0.0f;
+	case PT_WARP_MESH:
+		return meshMode ? 1.0f : 0.0f;
+	case PT_MESH_TOLERANCE:
+		return meshTolerance;
 	case PT_MIRROR_RADIUS:
 		return mirrorRadius;
 	case PT_PROJ_DISTANCE:
@@ -248,6 +497,24 @@ float AddSubtract::GetFloatParameter( unsigned int index )
 		return projTilt;
 	case PT_DOME_RADIUS:
 		return domeRadius;
+	case PT_FRONT_CENTER_X:
+		return frontCenterX;
+	case PT_FRONT_CENTER_Y:
+		return frontCenterY;
+	case PT_FRONT_RADIUS:
+		return frontRadius;
+	case PT_FRONT_FOV:
+		return frontFov;
+	case PT_BACK_CENTER_X:
+		return backCenterX;
+	case PT_BACK_CENTER_Y:
+		return backCenterY;
+	case PT_BACK_RADIUS:
+		return backRadius;
+	case PT_BACK_FOV:
+		return backFov;
+	case PT_SEAM_FEATHER:
+		return seamFeather;
 	}
 
 	return 0.0f;
@@ -310,6 +577,36 @@ char* AddSubtract::GetParameterDisplay( unsigned int index )
 	case PT_DOME_RADIUS:
 		printDoubleToResolumeBuffer( displayValueBuffer, 0.5 + domeRadius * 49.5 );
 		return displayValueBuffer;
+	case PT_MESH_TOLERANCE:
+		printDoubleToResolumeBuffer( displayValueBuffer, meshTolerance * 10.0 );
+		return displayValueBuffer;
+	case PT_FRONT_CENTER_X:
+		printDoubleToResolumeBuffer( displayValueBuffer, 0.5 + ( frontCenterX - 0.5 ) * 0.5 );
+		return displayValueBuffer;
+	case PT_FRONT_CENTER_Y:
+		printDoubleToResolumeBuffer( displayValueBuffer, 0.5 + ( frontCenterY - 0.5 ) * 0.5 );
+		return displayValueBuffer;
+	case PT_FRONT_RADIUS:
+		printDoubleToResolumeBuffer( displayValueBuffer, 0.5 + frontRadius );
+		return displayValueBuffer;
+	case PT_FRONT_FOV:
+		printDoubleToResolumeBuffer( displayValueBuffer, 150.0 + frontFov * 100.0 );
+		return displayValueBuffer;
+	case PT_BACK_CENTER_X:
+		printDoubleToResolumeBuffer( displayValueBuffer, 0.5 + ( backCenterX - 0.5 ) * 0.5 );
+		return displayValueBuffer;
+	case PT_BACK_CENTER_Y:
+		printDoubleToResolumeBuffer( displayValueBuffer, 0.5 + ( backCenterY - 0.5 ) * 0.5 );
+		return displayValueBuffer;
+	case PT_BACK_RADIUS:
+		printDoubleToResolumeBuffer( displayValueBuffer, 0.5 + backRadius );
+		return displayValueBuffer;
+	case PT_BACK_FOV:
+		printDoubleToResolumeBuffer( displayValueBuffer, 150.0 + backFov * 100.0 );
+		return displayValueBuffer;
+	case PT_SEAM_FEATHER:
+		printDoubleToResolumeBuffer( displayValueBuffer, seamFeather * 20.0 );
+		return displayValueBuffer;
 	default:
 		return CFFGLPlugin::GetParameterDisplay( index );
 	}
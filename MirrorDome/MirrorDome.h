@@ -1,6 +1,10 @@
 #pragma once
 #include <string>
 #include <FFGLSDK.h>
+#include "../Reprojection/RemapLut.h"
+#include "../Reprojection/ShaderCache.h"
+#include "../Reprojection/TileMesh.h"
+#include "../Reprojection/WarpMesh.h"
 
 class AddSubtract : public CFFGLPlugin
 {
@@ -14,16 +18,40 @@ public:
 	FFResult DeInitGL() override;
 
 	FFResult SetFloatParameter( unsigned int dwIndex, float value ) override;
+	FFResult SetTextParameter( unsigned int index, const char* value ) override;
+	char* GetTextParameter( unsigned int index ) override;
 
 	float GetFloatParameter( unsigned int index ) override;
 	char* GetParameterDisplay( unsigned int index ) override;
 	void printDoubleToResolumeBuffer( char ( &buffer )[ 15 ], double value );
+	// The shader uniforms for the current slider values, mapped to their physical ranges.
+	reprojection::Uniforms currentUniforms( const FFGLTextureStruct& inputTexture ) const;
+	// The Mesh Tolerance slider in radians, the largest angle the warp mesh may be off from the exact direction.
+	double currentMeshTolerance() const;
+	// Writes the mesh the mirror dome parameters give to exportFile in the format of Paul Bourke's tools.
+	void exportMesh( const reprojection::Uniforms& uniforms );
 
 
 private:
-	ffglex::FFGLShader shader;  //!< Utility to help us compile and link some shaders into a program.
+	ShaderCache shaders;        //!< One specialized program per (input, output, stereo) combination, compiled on first use.
 	ffglex::FFGLScreenQuad quad;//!< Utility to help us render a full screen quad.
+	RemapLut remapLut;          //!< Baked mapping used instead of the shader math when lutMode is on.
+	TileMesh tileMesh;          //!< The output tiles that are not fully transparent, drawn instead of quad when there are any.
+	WarpMesh warpMesh;          //!< Adaptive mesh of output directions, drawn instead of the per pixel shader when meshMode is on.
+	FrameConstantsBuffer frameConstants;//!< Uniform buffer holding the shader's FrameConstants block.
+	InverseMirrorTexture inverseMirror;//!< Inverse of the mirror dome, sampled when it is the input projection.
+	CubeFacesTexture cubeFaces;//!< The input's faces as a cube map array, sampled when the input projection is CUBE_FACES.
 	int inputProjection, outputProjection, stereo;
 	float pitch, roll, yaw, fovOut, fovIn;
 	float mirrorRadius, projDistance, projLift, mirrorProjFov, projTilt, domeRadius;
+	bool lutMode;
+	bool fastTrig;//!< Minimax trig instead of the GLSL built-ins, see Engine/FastTrig.h for its error.
+	bool meshMode;
+	float meshTolerance;
+	std::string meshFile;  //!< Imported warp mesh, drawn instead of the mirror dome ray trace while it loads
+	std::string exportFile;//!< Where Export Mesh writes to
+	bool exportRequested;
+	float frontCenterX, frontCenterY, frontRadius, frontFov;//!< Dual fisheye calibration of the lens in the left half
+	float backCenterX, backCenterY, backRadius, backFov;    //!< And of the one in the right half
+	float seamFeather;
 };
@@ -0,0 +1,104 @@
+#pragma once
+#include <FFGLSDK.h>
+#include "../Engine/Projection.h"
+
+// GL side of the CUBE_FACES input projection: the six faces of each eye blitted out of the input strip into a cube map
+// array every frame, which the shader samples on UNIT with the direction itself. The hardware picks the face and,
+// inside a ScopedSeamlessCubeMaps, filters across its edges, so the shader has neither a branch on the face nor any
+// seam handling. The blits stay on the GPU, twelve small ones at most per frame. Faces that are not square in the input
+// are stretched to square, like the CPU side's uv stretches them.
+class CubeFacesTexture
+{
+public:
+	static const GLint UNIT = 2;//!< Texture unit ShaderCache points InputCubeFaces at, after InverseMirrorTexture's 1
+
+	bool Initialise()
+	{
+		glGenTextures( 1, &textureId );
+		glGenFramebuffers( 1, &readFboId );
+		glGenFramebuffers( 1, &drawFboId );
+		return textureId != 0 && readFboId != 0 && drawFboId != 0;
+	}
+	void Release()
+	{
+		if( drawFboId != 0 )
+			glDeleteFramebuffers( 1, &drawFboId );
+		if( readFboId != 0 )
+			glDeleteFramebuffers( 1, &readFboId );
+		if( textureId != 0 )
+			glDeleteTextures( 1, &textureId );
+		drawFboId = readFboId = textureId = 0;
+		faceSize = layers = 0;
+	}
+
+	// Blits the faces out of the content area of input, stacked bottom up in the order of Fragment::cubeFacesUvToDir(),
+	// into one cube of the array per eye of stereo. Returns the texture to bind on UNIT.
+	GLuint Update( const FFGLTextureStruct& input, int stereo )
+	{
+		const int eyes      = stereo == reprojection::STEREO_NONE ? 1 : 2;
+		const int eyeWidth  = int( input.Width ) / ( stereo == reprojection::STEREO_SIDE_BY_SIDE ? 2 : 1 );
+		const int eyeHeight = int( input.Height ) / ( stereo == reprojection::STEREO_OVER_UNDER ? 2 : 1 );
+		const int size      = eyeWidth > 0 ? eyeWidth : 1;
+		ffglex::ScopedTextureBinding textureBinding( GL_TEXTURE_CUBE_MAP_ARRAY, textureId );
+		if( size != faceSize || eyes != layers )
+		{
+			glTexImage3D( GL_TEXTURE_CUBE_MAP_ARRAY, 0, GL_RGBA8, size, size, 6 * eyes, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr );
+			glTexParameteri( GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR );
+			glTexParameteri( GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
+			glTexParameteri( GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_MAX_LEVEL, 0 );
+			faceSize = size;
+			layers   = eyes;
+		}
+
+		GLint previousRead = 0, previousDraw = 0;
+		glGetIntegerv( GL_READ_FRAMEBUFFER_BINDING, &previousRead );
+		glGetIntegerv( GL_DRAW_FRAMEBUFFER_BINDING, &previousDraw );
+		glBindFramebuffer( GL_READ_FRAMEBUFFER, readFboId );
+		glFramebufferTexture2D( GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, input.Handle, 0 );
+		glBindFramebuffer( GL_DRAW_FRAMEBUFFER, drawFboId );
+		for( int eye = 0; eye < eyes; ++eye )
+		{
+			const int x0 = stereo == reprojection::STEREO_SIDE_BY_SIDE ? eye * eyeWidth : 0;
+			const int y0 = stereo == reprojection::STEREO_OVER_UNDER ? eye * eyeHeight : 0;
+			for( int face = 0; face < 6; ++face )
+			{
+				const int top = y0 + face * eyeHeight / 6, bottom = y0 + ( face + 1 ) * eyeHeight / 6;
+				glFramebufferTextureLayer( GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, textureId, 0, eye * 6 + face );
+				glBlitFramebuffer( x0, top, x0 + eyeWidth, bottom, 0, 0, size, size, GL_COLOR_BUFFER_BIT,
+								   bottom - top == size ? GL_NEAREST : GL_LINEAR );
+			}
+		}
+		glFramebufferTextureLayer( GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, 0, 0, 0 );
+		glFramebufferTexture2D( GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0 );
+		glBindFramebuffer( GL_DRAW_FRAMEBUFFER, GLuint( previousDraw ) );
+		glBindFramebuffer( GL_READ_FRAMEBUFFER, GLuint( previousRead ) );
+		return textureId;
+	}
+
+private:
+	GLuint textureId = 0;
+	GLuint readFboId = 0;//!< The input texture
+	GLuint drawFboId = 0;//!< One layer face of textureId at a time
+	int faceSize     = 0;
+	int layers       = 0;//!< Cubes in textureId, one per eye
+};
+
+// GL_TEXTURE_CUBE_MAP_SEAMLESS is context wide state the host expects off, so it is only on while the plugin draws.
+class ScopedSeamlessCubeMaps
+{
+public:
+	explicit ScopedSeamlessCubeMaps( bool enable ) :
+		enabled( enable )
+	{
+		if( enabled )
+			glEnable( GL_TEXTURE_CUBE_MAP_SEAMLESS );
+	}
+	~ScopedSeamlessCubeMaps()
+	{
+		if( enabled )
+			glDisable( GL_TEXTURE_CUBE_MAP_SEAMLESS );
+	}
+
+private:
+	const bool enabled;
+};
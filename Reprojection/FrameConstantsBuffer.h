@@ -0,0 +1,79 @@
+#pragma once
+#include <FFGLSDK.h>
+#include "../Engine/Projection.h"
+
+// The uniform buffer behind the shader's FrameConstants block, shared by both plugins.
+// Upload() packs reprojection::FrameConstants with std140 rules, so the layout below must follow the member
+// order of the block in Shader.h: every mat3 column and every vec3 takes a full vec4 slot.
+class FrameConstantsBuffer
+{
+public:
+	static const GLuint BINDING = 0;//!< Uniform buffer binding point ShaderCache links the block to.
+
+	bool Initialise()
+	{
+		glGenBuffers( 1, &bufferId );
+		if( bufferId == 0 )
+			return false;
+		ffglex::ScopedUBOBinding bufferBinding( bufferId );
+		glBufferData( GL_UNIFORM_BUFFER, sizeof( block ), nullptr, GL_DYNAMIC_DRAW );
+		return true;
+	}
+	void Release()
+	{
+		if( bufferId != 0 )
+			glDeleteBuffers( 1, &bufferId );
+		bufferId = 0;
+	}
+
+	void Upload( const reprojection::FrameConstants& k, FFGLTexCoords maxCoords )
+	{
+		float* p = block;
+		auto vec3 = [&]( reprojection::vec3 v, float w ) {
+			*p++ = v.x;
+			*p++ = v.y;
+			*p++ = v.z;
+			*p++ = w;
+		};
+		auto vec4 = [&]( reprojection::vec4 v ) {
+			*p++ = v.x;
+			*p++ = v.y;
+			*p++ = v.z;
+			*p++ = v.w;
+		};
+		auto mat3 = [&]( const reprojection::mat3& m ) {
+			for( int i = 0; i < 3; ++i )
+				vec3( m.c[ i ], 0.0f );
+		};
+		mat3( k.rotation );
+		vec3( k.projPos, k.halfTan );
+		vec3( k.projForward, k.aspectRatio );
+		vec3( k.projRight, k.fovOut );
+		vec3( k.projUp, k.fovIn );
+		*p++ = maxCoords.s;
+		*p++ = maxCoords.t;
+		*p++ = k.mirrorRadius;
+		*p++ = k.domeRadius;
+		vec4( k.frontLens );
+		vec4( k.backLens );
+		*p++ = k.seamBand.x;
+		*p++ = k.seamBand.y;
+
+		ffglex::ScopedUBOBinding bufferBinding( bufferId );
+		glBufferSubData( GL_UNIFORM_BUFFER, 0, sizeof( block ), block );
+	}
+
+	// FFGL wants the context back in its default state, so pair every Bind() with an Unbind() after drawing.
+	void Bind() const
+	{
+		glBindBufferBase( GL_UNIFORM_BUFFER, BINDING, bufferId );
+	}
+	void Unbind() const
+	{
+		glBindBufferBase( GL_UNIFORM_BUFFER, BINDING, 0 );
+	}
+
+private:
+	GLuint bufferId = 0;
+	float block[ 44 ];//!< mat3 (12 floats) + 4 vec3/float pairs (16) + MaxUV, mirrorRadius, domeRadius (4) + 2 lenses (8) + seamBand, padded (4)
+};
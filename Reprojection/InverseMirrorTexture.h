@@ -0,0 +1,67 @@
+#pragma once
+#include <memory>
+#include <FFGLSDK.h>
+#include "../Engine/InverseMirror.h"
+
+// GL side of the mirror dome input projection: the table of Engine/InverseMirror.h as an RG32F texture, which the
+// shader's dirToMirrorDomeUv() samples on UNIT with linear filtering. A table is built on an AsyncInverseMirror when the
+// mirror parameters change, so ProcessOpenGL never waits the few hundred milliseconds that takes: frames keep sampling
+// the previous table meanwhile, or a single invalid texel that leaves the output transparent before the first one.
+// Only a new table is uploaded, so the frames in between cost nothing here.
+class InverseMirrorTexture
+{
+public:
+	static const GLint UNIT = 1;//!< Texture unit ShaderCache points InverseMirrorTexture at, next to InputTexture's 0
+
+	bool Initialise()
+	{
+		glGenTextures( 1, &textureId );
+		if( textureId == 0 )
+			return false;
+		const float invalid[ 2 ] = { reprojection::INVERSE_MIRROR_INVALID, reprojection::INVERSE_MIRROR_INVALID };
+		upload( 1, invalid );
+		builder.reset( new reprojection::AsyncInverseMirror() );
+		return true;
+	}
+	void Release()
+	{
+		builder.reset();
+		if( textureId != 0 )
+			glDeleteTextures( 1, &textureId );
+		textureId = 0;
+		uploaded.reset();
+	}
+
+	// k must come from computeFrameConstants( uniforms, false ). Uploads the table k carries if it is not the one uploaded
+	// last, or asks the builder for it when k has none yet. Returns the texture to bind on UNIT, or 0 when the input
+	// projection is not the mirror dome and there is nothing to bind.
+	GLuint Update( const reprojection::Uniforms& uniforms, const reprojection::FrameConstants& k )
+	{
+		if( uniforms.inputProjection != reprojection::MIRROR_DOME )
+			return 0;
+		if( !k.inverseMirror )
+			builder->request( uniforms );
+		else if( k.inverseMirror != uploaded )
+		{
+			upload( k.inverseMirror->size, k.inverseMirror->uv.data() );
+			uploaded = k.inverseMirror;
+		}
+		return textureId;
+	}
+
+private:
+	void upload( int size, const float* uv )
+	{
+		ffglex::Scoped2DTextureBinding textureBinding( textureId );
+		glPixelStorei( GL_UNPACK_ALIGNMENT, 4 );
+		glTexImage2D( GL_TEXTURE_2D, 0, GL_RG32F, size, size, 0, GL_RG, GL_FLOAT, uv );
+		glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR );
+		glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
+		glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE );
+		glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE );
+	}
+
+	GLuint textureId = 0;
+	std::shared_ptr< const reprojection::InverseMirrorMap > uploaded;//!< Kept alive so a rebuilt table never compares equal to it
+	std::unique_ptr< reprojection::AsyncInverseMirror > builder;//!< Lives from Initialise() to Release()
+};
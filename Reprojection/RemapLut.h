@@ -0,0 +1,139 @@
+#pragma once
+#include <cstdio>
+#include <memory>
+#include <FFGLSDK.h>
+#include "Shader.h"
+#include "../Engine/AsyncBaker.h"
+#include "../Engine/RemapTable.h"
+
+// GL side of LUT mode, shared by both plugins.
+// Holds the baked output uv -> input uv table as an RG32F texture and draws the input through it. The table of a
+// DUAL_FISHEYE input also holds the second sample of its seam cross fade, uploaded as two more textures.
+// The table is rebaked on the CPU only when the mapping actually changes, i.e. after SetFloatParameter
+// touched a parameter or the viewport / input size changed. Bakes run on an AsyncBaker so ProcessOpenGL never waits
+// for one: frames keep using the last finished table until the next one is ready, see AsyncBaker for how long that
+// can take. The baker keeps the output directions in a RayTable, so while only the rotation or the input side moves,
+// as with an automated yaw, a rebake just reruns the input half of main().
+class RemapLut
+{
+public:
+	bool Initialise( const char* vertexShaderCode )
+	{
+		if( !shader.Compile( vertexShaderCode, _remapFragmentShaderCode ) )
+			return false;
+		ffglex::ScopedShaderBinding shaderBinding( shader.GetGLID() );
+		glUniform1i( shader.FindUniform( "InputTexture" ), 0 );
+		glUniform1i( shader.FindUniform( "RemapTexture" ), 1 );
+		glUniform1i( shader.FindUniform( "SeamUvTexture" ), SEAM_UV_UNIT );
+		glUniform1i( shader.FindUniform( "SeamWeightTexture" ), SEAM_WEIGHT_UNIT );
+		maxUVLocation = shader.FindUniform( "MaxUV" );
+		seamLocation  = shader.FindUniform( "Seam" );
+		glGenTextures( 1, &textureId );
+		glGenTextures( 1, &seamUvTextureId );
+		glGenTextures( 1, &seamWeightTextureId );
+		baker.reset( new reprojection::AsyncBaker( reprojection::detectSimdLevel(), BAKE_THREADS ) );
+		return textureId != 0 && seamUvTextureId != 0 && seamWeightTextureId != 0;
+	}
+	void Release()
+	{
+		if( baker )
+		{
+			reprojection::AsyncBaker::Stats stats = baker->stats();
+			char message[ 256 ];
+			std::snprintf( message, sizeof( message ), "LUT bakes: %llu requested, %llu completed, %llu coalesced, %llu dropped, %.1f ms longest",
+						   static_cast< unsigned long long >( stats.requested ), static_cast< unsigned long long >( stats.completed ),
+						   static_cast< unsigned long long >( stats.coalesced ), static_cast< unsigned long long >( stats.dropped ), stats.maxBakeMs );
+			FFGLLog::LogToHost( message );
+		}
+		baker.reset();
+		shader.FreeGLResources();
+		if( seamWeightTextureId != 0 )
+			glDeleteTextures( 1, &seamWeightTextureId );
+		if( seamUvTextureId != 0 )
+			glDeleteTextures( 1, &seamUvTextureId );
+		if( textureId != 0 )
+			glDeleteTextures( 1, &textureId );
+		textureId = seamUvTextureId = seamWeightTextureId = 0;
+		uploaded                                          = false;
+		requested                                         = false;
+	}
+
+	// Hands the mapping to the baker if it or the output size differs from the last request, and uploads the newest
+	// finished table. Returns false until the first table is uploaded, the caller should draw without the LUT until then.
+	bool Update( const reprojection::Uniforms& uniforms, int width, int height )
+	{
+		if( !requested || requestedWidth != width || requestedHeight != height || !reprojection::sameMapping( uniforms, requestedUniforms ) )
+		{
+			baker->request( uniforms, width, height );
+			requestedUniforms = uniforms;
+			requestedWidth    = width;
+			requestedHeight   = height;
+			requested         = true;
+		}
+
+		if( !baker->take( table ) )
+			return uploaded;
+
+		// A table baked for a different viewport size is still right in uv, just at the wrong resolution, until the next one lands.
+		// One texel per output pixel, so nearest filtering reproduces the baked values exactly.
+		auto upload = [&]( GLuint id, GLint internalFormat, GLenum format, const float* texels ) {
+			ffglex::Scoped2DTextureBinding textureBinding( id );
+			glPixelStorei( GL_UNPACK_ALIGNMENT, 4 );
+			glTexImage2D( GL_TEXTURE_2D, 0, internalFormat, table.width, table.height, 0, format, GL_FLOAT, texels );
+			glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST );
+			glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST );
+			glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE );
+			glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE );
+		};
+		upload( textureId, GL_RG32F, GL_RG, table.uv.data() );
+		seam = !table.seamWeight.empty();
+		if( seam )
+		{
+			upload( seamUvTextureId, GL_RG32F, GL_RG, table.seamUv.data() );
+			upload( seamWeightTextureId, GL_R32F, GL_RED, table.seamWeight.data() );
+		}
+		uploaded = true;
+		return true;
+	}
+
+	void Draw( GLuint inputTexture, FFGLTexCoords maxCoords, ffglex::FFGLScreenQuad& quad )
+	{
+		ffglex::ScopedShaderBinding shaderBinding( shader.GetGLID() );
+		ffglex::ScopedSamplerActivation activateSeamWeightSampler( SEAM_WEIGHT_UNIT );
+		ffglex::Scoped2DTextureBinding seamWeightBinding( seamWeightTextureId );
+		ffglex::ScopedSamplerActivation activateSeamUvSampler( SEAM_UV_UNIT );
+		ffglex::Scoped2DTextureBinding seamUvBinding( seamUvTextureId );
+		ffglex::ScopedSamplerActivation activateRemapSampler( 1 );
+		ffglex::Scoped2DTextureBinding remapBinding( textureId );
+		ffglex::ScopedSamplerActivation activateInputSampler( 0 );
+		ffglex::Scoped2DTextureBinding inputBinding( inputTexture );
+
+		glUniform2f( maxUVLocation, maxCoords.s, maxCoords.t );
+		glUniform1i( seamLocation, seam ? 1 : 0 );
+		quad.Draw();
+	}
+
+private:
+	// Threads per instance's bake, the baker's worker included. A composition can hold dozens of instances, each with
+	// its own baker, so they stay few rather than one per hardware thread; a pool shared by all instances would have
+	// to be torn down in the DLL's static destructors, where joining threads can deadlock.
+	static const int BAKE_THREADS = 2;
+
+	static const GLint SEAM_UV_UNIT     = 2;//!< Texture units after InputTexture's 0 and RemapTexture's 1
+	static const GLint SEAM_WEIGHT_UNIT = 3;
+
+	ffglex::FFGLShader shader;//!< _remapFragmentShaderCode
+	GLint maxUVLocation        = -1;
+	GLint seamLocation         = -1;
+	GLuint textureId           = 0;//!< RG32F copy of table.uv
+	GLuint seamUvTextureId     = 0;//!< RG32F copy of table.seamUv, as of the last table that had a seam
+	GLuint seamWeightTextureId = 0;//!< R32F copy of table.seamWeight, likewise
+	bool seam                  = false;//!< The uploaded table has a seam
+	bool uploaded              = false;
+	reprojection::RemapTable table;//!< The last table taken from baker, the baker bakes the next one into its own
+	std::unique_ptr< reprojection::AsyncBaker > baker;//!< Lives from Initialise() to Release()
+	reprojection::Uniforms requestedUniforms;
+	int requestedWidth  = 0;
+	int requestedHeight = 0;
+	bool requested      = false;
+};
@@ -14,7 +14,19 @@ enum ParamType : FFUInt32
 	PT_ROLL,
 	PT_YAW,
 	PT_FOV_IN,
-	PT_FOV_OUT
+	PT_FOV_OUT,
+	PT_LUT_MODE,
+	PT_FAST_TRIG,
+	PT_FRONT_CENTER_X,
+	PT_FRONT_CENTER_Y,
+	PT_FRONT_RADIUS,
+	PT_FRONT_FOV,
+	PT_BACK_CENTER_X,
+	PT_BACK_CENTER_Y,
+	PT_BACK_RADIUS,
+	PT_BACK_FOV,
+	PT_SEAM_FEATHER,
+	PT_RIG_FILE
 };
 
 static CFFGLPluginInfo PluginInfo(
@@ -45,22 +57,24 @@ void main()
 )";
 
 AddSubtract::AddSubtract() :
-	inputProjection( 0 ), outputProjection( 0 ), stereo( 0 ), pitch( 0.5f ), roll( 0.5f ), yaw( 0.5f ), fovOut( 0.5 ), fovIn( 0.5 )
+	shaders( _vertexShaderCode ),
+	inputProjection( 0 ), outputProjection( 0 ), stereo( 0 ), pitch( 0.5f ), roll( 0.5f ), yaw( 0.5f ), fovOut( 0.5 ), fovIn( 0.5 ), lutMode( false ), fastTrig( false ),
+	frontCenterX( 0.5f ), frontCenterY( 0.5f ), frontRadius( 0.5f ), frontFov( 0.4f ), backCenterX( 0.5f ), backCenterY( 0.5f ), backRadius( 0.5f ),
+	backFov( 0.4f ), seamFeather( 0.5f )
 {
+	//Inputs past the first are only used by a rig, see PT_RIG_FILE.
 	SetMinInputs( 1 );
-	SetMaxInputs( 1 );
+	SetMaxInputs( reprojection::RIG_MAX_CAMERAS );
 
-	SetOptionParamInfo( PT_INPUT_PROJECTION, "InputProjection", 4, inputProjection );
-	SetParamElementInfo( PT_INPUT_PROJECTION, 0, "Equirectangular", 0 );
-	SetParamElementInfo( PT_INPUT_PROJECTION, 1, "Fisheye", 1 );
-	SetParamElementInfo( PT_INPUT_PROJECTION, 2, "Flat", 2 );
-	SetParamElementInfo( PT_INPUT_PROJECTION, 3, "Cubemap", 3 );
-
-	SetOptionParamInfo( PT_OUTPUT_PROJECTION, "OutputProjection", 4, outputProjection );
-	SetParamElementInfo( PT_OUTPUT_PROJECTION, 0, "Equirectangular", 0 );
-	SetParamElementInfo( PT_OUTPUT_PROJECTION, 1, "Fisheye", 1 );
-	SetParamElementInfo( PT_OUTPUT_PROJECTION, 2, "Flat", 2 );
-	SetParamElementInfo( PT_OUTPUT_PROJECTION, 3, "Cubemap", 3 );
+	// The projection options come from Engine/ProjectionRegistry.h, each one's value is its ProjectionType.
+	auto setProjectionOptions = [this]( unsigned int param, const char* name, bool input, float defaultValue ) {
+		const std::vector< int > options = reprojection::projectionOptions( input, false );
+		SetOptionParamInfo( param, name, unsigned( options.size() ), defaultValue );
+		for( size_t option = 0; option < options.size(); ++option )
+			SetParamElementInfo( param, unsigned( option ), reprojection::projectionInfo( options[ option ] ).label, float( options[ option ] ) );
+	};
+	setProjectionOptions( PT_INPUT_PROJECTION, "InputProjection", true, inputProjection );
+	setProjectionOptions( PT_OUTPUT_PROJECTION, "OutputProjection", false, outputProjection );
 
 	SetOptionParamInfo(  PT_STEREO, "Stereo", 3, stereo );
 	SetParamElementInfo( PT_STEREO, 0, "None", 0 );
@@ -73,6 +87,21 @@ AddSubtract::AddSubtract() :
 	SetParamInfof( PT_FOV_OUT, "fov Out", FF_TYPE_STANDARD );
 	SetParamInfof( PT_FOV_IN, "fov In", FF_TYPE_STANDARD );
 
+	SetParamInfof( PT_LUT_MODE, "LUT Mode", FF_TYPE_BOOLEAN );
+	SetParamInfof( PT_FAST_TRIG, "Fast Trig", FF_TYPE_BOOLEAN );
+
+	SetParamInfof( PT_FRONT_CENTER_X, "Front Center X", FF_TYPE_STANDARD );
+	SetParamInfof( PT_FRONT_CENTER_Y, "Front Center Y", FF_TYPE_STANDARD );
+	SetParamInfof( PT_FRONT_RADIUS, "Front Radius", FF_TYPE_STANDARD );
+	SetParamInfof( PT_FRONT_FOV, "Front FoV", FF_TYPE_STANDARD );
+	SetParamInfof( PT_BACK_CENTER_X, "Back Center X", FF_TYPE_STANDARD );
+	SetParamInfof( PT_BACK_CENTER_Y, "Back Center Y", FF_TYPE_STANDARD );
+	SetParamInfof( PT_BACK_RADIUS, "Back Radius", FF_TYPE_STANDARD );
+	SetParamInfof( PT_BACK_FOV, "Back FoV", FF_TYPE_STANDARD );
+	SetParamInfof( PT_SEAM_FEATHER, "Seam Feather", FF_TYPE_STANDARD );
+
+	SetFileParamInfo( PT_RIG_FILE, "Rig File", { "rig", "txt" }, "" );
+
 	FFGLLog::LogToHost( "Created AddSubtract effect" );
 }
 AddSubtract::~AddSubtract()
@@ -81,7 +110,8 @@ AddSubtract::~AddSubtract()
 
 FFResult AddSubtract::InitGL( const FFGLViewportStruct* vp )
 {
-	if( !shader.Compile( _vertexShaderCode, _fragmentShaderCode ) )
+	//Compile the program for the initial options up front, the other combinations are compiled when first selected.
+	if( !shaders.Get( inputProjection, outputProjection, stereo, fastTrig ? reprojection::PRECISION_FAST : reprojection::PRECISION_EXACT ) )
 	{
 		DeInitGL();
 		return FF_FAIL;
@@ -91,6 +121,31 @@ FFResult AddSubtract::InitGL( const FFGLViewportStruct* vp )
 		DeInitGL();
 		return FF_FAIL;
 	}
+	if( !remapLut.Initialise( _vertexShaderCode ) )
+	{
+		DeInitGL();
+		return FF_FAIL;
+	}
+	if( !tileMesh.Initialise() )
+	{
+		DeInitGL();
+		return FF_FAIL;
+	}
+	if( !frameConstants.Initialise() )
+	{
+		DeInitGL();
+		return FF_FAIL;
+	}
+	if( !cubeFaces.Initialise() )
+	{
+		DeInitGL();
+		return FF_FAIL;
+	}
+	if( !rigStitch.Initialise( _vertexShaderCode ) )
+	{
+		DeInitGL();
+		return FF_FAIL;
+	}
 	
 	//Use base-class init as success result so that it retains the viewport.
 	return CFFGLPlugin::InitGL( vp );
@@ -103,41 +158,109 @@ FFResult AddSubtract::ProcessOpenGL( ProcessOpenGLStruct* pGL )
 	if( pGL->inputTextures[ 0 ] == NULL )
 		return FF_FAIL;
 
+	reprojection::Uniforms uniforms = currentUniforms( *pGL->inputTextures[ 0 ] );
+	//The input texture's dimension might change each frame and so might the content area.
+	//We're adopting the texture's maxUV using a uniform because that way we dont have to update our vertex buffer each frame.
+	FFGLTexCoords maxCoords = GetMaxGLTexCoords( *pGL->inputTextures[ 0 ] );
+
+	//With a rig loaded and an input for each of its cameras the inputs are stitched in one pass, with the output
+	//projection, rotation and fov Out as the view. Until the host connects enough inputs, and until the first map is
+	//baked, the first input is reprojected as usual.
+	if( !rig.cameras.empty() && pGL->numInputTextures >= rig.cameras.size() )
+	{
+		GLuint cameraTextures[ reprojection::RIG_MAX_CAMERAS ]         = {};
+		FFGLTexCoords cameraMaxCoords[ reprojection::RIG_MAX_CAMERAS ] = {};
+		bool connected                                                 = true;
+		for( size_t camera = 0; camera < rig.cameras.size(); ++camera )
+		{
+			const FFGLTextureStruct* input = pGL->inputTextures[ camera ];
+			connected                      = input != NULL;
+			if( !connected )
+				break;
+			rig.cameras[ camera ].width  = input->Width;
+			rig.cameras[ camera ].height = input->Height;
+			cameraTextures[ camera ]     = input->Handle;
+			cameraMaxCoords[ camera ]    = GetMaxGLTexCoords( *input );
+		}
+		if( connected && rigStitch.Update( rig, uniforms, currentViewport.width, currentViewport.height ) )
+		{
+			rigStitch.Draw( cameraTextures, cameraMaxCoords, quad );
+			return FF_SUCCESS;
+		}
+	}
+
+	//Rebakes in the background when a parameter or the output size changed since the last frame, and keeps drawing
+	//the last finished table meanwhile. Until the first bake is done the frame is drawn per pixel below.
+	if( lutMode && remapLut.Update( uniforms, currentViewport.width, currentViewport.height ) )
+	{
+		remapLut.Draw( pGL->inputTextures[ 0 ]->Handle, maxCoords, quad );
+		return FF_SUCCESS;
+	}
+
+	FFGLShader* shader = shaders.Get( inputProjection, outputProjection, stereo, uniforms.precision );
+	if( shader == nullptr )
+		return FF_FAIL;
+
+	//Everything that is constant over the frame is computed here once and uploaded as a single uniform block.
+	frameConstants.Upload( reprojection::computeFrameConstants( uniforms ), maxCoords );
+
 	//FFGL requires us to leave the context in a default state on return, so use this scoped binding to help us do that.
-	ScopedShaderBinding shaderBinding( shader.GetGLID() );
+	ScopedShaderBinding shaderBinding( shader->GetGLID() );
 	//The shader's sampler is always bound to sampler index 0 so that's where we need to bind the texture.
 	//Again, we're using the scoped bindings to help us keep the context in a default state.
 	ScopedSamplerActivation activateSampler( 0 );
 	Scoped2DTextureBinding textureBinding( pGL->inputTextures[ 0 ]->Handle );
-	
+	//With the cube faces as input the shader samples a cube map array built from the input instead of the input itself.
+	bool cubeFacesInput = inputProjection == reprojection::CUBE_FACES;
+	ScopedSamplerActivation activateCubeFaces( CubeFacesTexture::UNIT );
+	ScopedTextureBinding cubeFacesBinding( GL_TEXTURE_CUBE_MAP_ARRAY, cubeFacesInput ? cubeFaces.Update( *pGL->inputTextures[ 0 ], stereo ) : 0 );
+	ScopedSeamlessCubeMaps seamlessCubeMaps( cubeFacesInput );
+	frameConstants.Bind();
 
-	shader.Set( "InputTexture", 0 );
+	//Clears the tiles that are transparent for these parameters and only runs the shader on the rest.
+	if( tileMesh.Update( uniforms, currentViewport.width, currentViewport.height ) )
+		tileMesh.Draw();
+	else
+		quad.Draw();
 
-	//The input texture's dimension might change each frame and so might the content area.
-	//We're adopting the texture's maxUV using a uniform because that way we dont have to update our vertex buffer each frame.
-	FFGLTexCoords maxCoords = GetMaxGLTexCoords( *pGL->inputTextures[ 0 ] );
-	shader.Set( "MaxUV", maxCoords.s, maxCoords.t );
-	//SetParamDisplayName( PT_RED, std::to_string( pGL->inputTextures[ 0 ]->Width ).c_str(), true );
-	glUniform3f( shader.FindUniform( "Rotation" ), (pitch-0.5)*2.0*3.14159265359,
-		                                           (roll -0.5)*2.0*3.14159265359,
-		                                           (yaw  -0.5)*2.0*3.14159265359 );
-	glUniform1f( shader.FindUniform( "fovOut" ), fovOut * 3.14159269359 / 2.0 );
-	glUniform1f( shader.FindUniform( "fovIn" ), fovIn * 3.14159269359 / 2.0 );
-	glUniform1i( shader.FindUniform( "inputProjection" ), inputProjection );
-	glUniform1i( shader.FindUniform( "outputProjection" ), outputProjection );
-	glUniform1i( shader.FindUniform( "stereo" ), stereo );
-	glUniform1i( shader.FindUniform( "width" ), pGL->inputTextures[ 0 ]->Width );
-	glUniform1i( shader.FindUniform( "height" ), pGL->inputTextures[ 0 ]->Height );
-
-
-	quad.Draw();
+	frameConstants.Unbind();
 
 	return FF_SUCCESS;
 }
+reprojection::Uniforms AddSubtract::currentUniforms( const FFGLTextureStruct& inputTexture ) const
+{
+	reprojection::Uniforms uniforms;
+	uniforms.rotation = reprojection::vec3( float( ( pitch - 0.5 ) * 2.0 * 3.14159265359 ),
+											float( ( roll - 0.5 ) * 2.0 * 3.14159265359 ),
+											float( ( yaw - 0.5 ) * 2.0 * 3.14159265359 ) );
+	uniforms.fovOut           = float( fovOut * 3.14159269359 / 2.0 );
+	uniforms.fovIn            = float( fovIn * 3.14159269359 / 2.0 );
+	uniforms.inputProjection  = inputProjection;
+	uniforms.outputProjection = outputProjection;
+	uniforms.stereo           = stereo;
+	uniforms.precision        = fastTrig ? reprojection::PRECISION_FAST : reprojection::PRECISION_EXACT;
+	uniforms.width            = inputTexture.Width;
+	uniforms.height           = inputTexture.Height;
+
+	// Dual fisheye calibration: centers a quarter of the half frame either way, radius 0.5 to 1.5, FoV 150 to 250 degrees
+	uniforms.frontLens.center = reprojection::vec2( 0.5f + ( frontCenterX - 0.5f ) * 0.5f, 0.5f + ( frontCenterY - 0.5f ) * 0.5f );
+	uniforms.frontLens.radius = 0.5f + frontRadius;
+	uniforms.frontLens.fov    = ( 150.0f + frontFov * 100.0f ) * 3.14159265359f / 180.0f;
+	uniforms.backLens.center  = reprojection::vec2( 0.5f + ( backCenterX - 0.5f ) * 0.5f, 0.5f + ( backCenterY - 0.5f ) * 0.5f );
+	uniforms.backLens.radius  = 0.5f + backRadius;
+	uniforms.backLens.fov     = ( 150.0f + backFov * 100.0f ) * 3.14159265359f / 180.0f;
+	uniforms.seamFeather      = seamFeather * 20.0f * 3.14159265359f / 180.0f;
+	return uniforms;
+}
 FFResult AddSubtract::DeInitGL()
 {
-	shader.FreeGLResources();
+	shaders.Release();
 	quad.Release();
+	remapLut.Release();
+	tileMesh.Release();
+	frameConstants.Release();
+	cubeFaces.Release();
+	rigStitch.Release();
 
 	return FF_SUCCESS;
 }
@@ -170,6 +293,39 @@ FFResult AddSubtract::SetFloatParameter( unsigned int dwIndex, float value )
 	case PT_FOV_IN:
 		fovIn = value;
 		break;
+	case PT_LUT_MODE:
+		lutMode = value > 0.5f;
+		break;
+	case PT_FAST_TRIG:
+		fastTrig = value > 0.5f;
+		break;
+	case PT_FRONT_CENTER_X:
+		frontCenterX = value;
+		break;
+	case PT_FRONT_CENTER_Y:
+		frontCenterY = value;
+		break;
+	case PT_FRONT_RADIUS:
+		frontRadius = value;
+		break;
+	case PT_FRONT_FOV:
+		frontFov = value;
+		break;
+	case PT_BACK_CENTER_X:
+		backCenterX = value;
+		break;
+	case PT_BACK_CENTER_Y:
+		backCenterY = value;
+		break;
+	case PT_BACK_RADIUS:
+		backRadius = value;
+		break;
+	case PT_BACK_FOV:
+		backFov = value;
+		break;
+	case PT_SEAM_FEATHER:
+		seamFeather = value;
+		break;
 	default:
 		return FF_FAIL;
 	}
@@ -177,6 +333,37 @@ FFResult AddSubtract::SetFloatParameter( unsigned int dwIndex, float value )
 	return FF_SUCCESS;
 }
 
+FFResult AddSubtract::SetTextParameter( unsigned int index, const char* value )
+{
+	switch( index )
+	{
+	case PT_RIG_FILE:
+	{
+		//An empty path goes back to reprojecting the first input, as does a file that fails to load.
+		rigFile = value != nullptr ? value : "";
+		std::string error;
+		if( rigFile.empty() )
+			rig = reprojection::Rig();
+		else if( !reprojection::readRig( rigFile, rig, error ) )
+			FFGLLog::LogToHost( error.c_str() );
+		return FF_SUCCESS;
+	}
+	default:
+		return FF_FAIL;
+	}
+}
+
+char* AddSubtract::GetTextParameter( unsigned int index )
+{
+	switch( index )
+	{
+	case PT_RIG_FILE:
+		return const_cast< char* >( rigFile.c_str() );
+	default:
+		return CFFGLPlugin::GetTextParameter( index );
+	}
+}
+
 float AddSubtract::GetFloatParameter( unsigned int index )
 {
 	switch( index )
@@ -197,6 +384,28 @@ float AddSubtract::GetFloatParameter( unsigned int index )
 		return fovOut;
 	case PT_FOV_IN:
 		return fovIn;
+	case PT_LUT_MODE:
+		return lutMode ? 1.0f : 0.0f;
+	case PT_FAST_TRIG:
+		return fastTrig ? 1.0f : 0.0f;
+	case PT_FRONT_CENTER_X:
+		return frontCenterX;
+	case PT_FRONT_CENTER_Y:
+		return frontCenterY;
+	case PT_FRONT_RADIUS:
+		return frontRadius;
+	case PT_FRONT_FOV:
+		return frontFov;
+	case PT_BACK_CENTER_X:
+		return backCenterX;
+	case PT_BACK_CENTER_Y:
+		return backCenterY;
+	case PT_BACK_RADIUS:
+		return backRadius;
+	case PT_BACK_FOV:
+		return backFov;
+	case PT_SEAM_FEATHER:
+		return seamFeather;
 	}
 
 	return 0.0f;
@@ -241,6 +450,33 @@ char* AddSubtract::GetParameterDisplay( unsigned int index )
 	case PT_FOV_IN:
 		printDoubleToResolumeBuffer( displayValueBuffer, fovIn );
 		return displayValueBuffer;
+	case PT_FRONT_CENTER_X:
+		printDoubleToResolumeBuffer( displayValueBuffer, 0.5 + ( frontCenterX - 0.5 ) * 0.5 );
+		return displayValueBuffer;
+	case PT_FRONT_CENTER_Y:
+		printDoubleToResolumeBuffer( displayValueBuffer, 0.5 + ( frontCenterY - 0.5 ) * 0.5 );
+		return displayValueBuffer;
+	case PT_FRONT_RADIUS:
+		printDoubleToResolumeBuffer( displayValueBuffer, 0.5 + frontRadius );
+		return displayValueBuffer;
+	case PT_FRONT_FOV:
+		printDoubleToResolumeBuffer( displayValueBuffer, 150.0 + frontFov * 100.0 );
+		return displayValueBuffer;
+	case PT_BACK_CENTER_X:
+		printDoubleToResolumeBuffer( displayValueBuffer, 0.5 + ( backCenterX - 0.5 ) * 0.5 );
+		return displayValueBuffer;
+	case PT_BACK_CENTER_Y:
+		printDoubleToResolumeBuffer( displayValueBuffer, 0.5 + ( backCenterY - 0.5 ) * 0.5 );
+		return displayValueBuffer;
+	case PT_BACK_RADIUS:
+		printDoubleToResolumeBuffer( displayValueBuffer, 0.5 + backRadius );
+		return displayValueBuffer;
+	case PT_BACK_FOV:
+		printDoubleToResolumeBuffer( displayValueBuffer, 150.0 + backFov * 100.0 );
+		return displayValueBuffer;
+	case PT_SEAM_FEATHER:
+		printDoubleToResolumeBuffer( displayValueBuffer, seamFeather * 20.0 );
+		return displayValueBuffer;
 	default:
 		return CFFGLPlugin::GetParameterDisplay( index );
 	}
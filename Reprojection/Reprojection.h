@@ -1,6 +1,10 @@
 #pragma once
 #include <string>
 #include <FFGLSDK.h>
+#include "RemapLut.h"
+#include "RigStitch.h"
+#include "ShaderCache.h"
+#include "TileMesh.h"
 
 class AddSubtract : public CFFGLPlugin
 {
@@ -14,15 +18,31 @@ public:
 	FFResult DeInitGL() override;
 
 	FFResult SetFloatParameter( unsigned int dwIndex, float value ) override;
+	FFResult SetTextParameter( unsigned int index, const char* value ) override;
+	char* GetTextParameter( unsigned int index ) override;
 
 	float GetFloatParameter( unsigned int index ) override;
 	char* GetParameterDisplay( unsigned int index ) override;
 	void printDoubleToResolumeBuffer( char ( &buffer )[ 15 ], double value );
+	// The shader uniforms for the current slider values, mapped to their physical ranges.
+	reprojection::Uniforms currentUniforms( const FFGLTextureStruct& inputTexture ) const;
 
 
 private:
-	ffglex::FFGLShader shader;  //!< Utility to help us compile and link some shaders into a program.
+	ShaderCache shaders;        //!< One specialized program per (input, output, stereo) combination, compiled on first use.
 	ffglex::FFGLScreenQuad quad;//!< Utility to help us render a full screen quad.
+	RemapLut remapLut;          //!< Baked mapping used instead of the shader math when lutMode is on.
+	TileMesh tileMesh;          //!< The output tiles that are not fully transparent, drawn instead of quad when there are any.
+	FrameConstantsBuffer frameConstants;//!< Uniform buffer holding the shader's FrameConstants block.
+	CubeFacesTexture cubeFaces;//!< The input's faces as a cube map array, sampled when the input projection is CUBE_FACES.
 	int inputProjection, outputProjection, stereo;
 	float pitch, roll, yaw, fovOut, fovIn;
+	bool lutMode;
+	bool fastTrig;//!< Minimax trig instead of the GLSL built-ins, see Engine/FastTrig.h for its error.
+	float frontCenterX, frontCenterY, frontRadius, frontFov;//!< Dual fisheye calibration of the lens in the left half
+	float backCenterX, backCenterY, backRadius, backFov;    //!< And of the one in the right half
+	float seamFeather;
+	RigStitch rigStitch;         //!< Draws the inputs stitched through the rig instead, once rig has cameras
+	reprojection::Rig rig;       //!< Loaded from rigFile, empty when there is none. The cameras' sizes are updated every frame
+	std::string rigFile;
 };
@@ -0,0 +1,124 @@
+#pragma once
+#include <memory>
+#include <FFGLSDK.h>
+#include "Shader.h"
+#include "../Engine/Rig.h"
+
+// GL side of rig stitching: a rig of up to RIG_MAX_CAMERAS inputs drawn into the output in one pass.
+// The StitchMap of Engine/Rig.h is uploaded as two textures and _stitchFragmentShaderCode samples the cameras through
+// them, so per pixel it is a selection and one or two fetches whatever the projections involved. The map is only
+// rebaked when the rig, the view, an input size or the output size changes, on a StitchBaker so ProcessOpenGL never
+// waits for a bake: frames keep stitching through the last finished map until the next one is ready.
+class RigStitch
+{
+public:
+	bool Initialise( const char* vertexShaderCode )
+	{
+		if( !shader.Compile( vertexShaderCode, _stitchFragmentShaderCode ) )
+			return false;
+		ffglex::ScopedShaderBinding shaderBinding( shader.GetGLID() );
+		const char* cameraSamplers[ reprojection::RIG_MAX_CAMERAS ] = { "Camera0", "Camera1", "Camera2", "Camera3" };
+		for( int camera = 0; camera < reprojection::RIG_MAX_CAMERAS; ++camera )
+			glUniform1i( shader.FindUniform( cameraSamplers[ camera ] ), camera );
+		glUniform1i( shader.FindUniform( "StitchUv" ), UV_UNIT );
+		glUniform1i( shader.FindUniform( "StitchSelection" ), SELECTION_UNIT );
+		maxUVLocation = shader.FindUniform( "MaxUV" );
+		glGenTextures( 1, &uvTextureId );
+		glGenTextures( 1, &selectionTextureId );
+		baker.reset( new reprojection::StitchBaker( BAKE_THREADS ) );
+		return uvTextureId != 0 && selectionTextureId != 0;
+	}
+	void Release()
+	{
+		baker.reset();
+		shader.FreeGLResources();
+		if( selectionTextureId != 0 )
+			glDeleteTextures( 1, &selectionTextureId );
+		if( uvTextureId != 0 )
+			glDeleteTextures( 1, &uvTextureId );
+		uvTextureId = selectionTextureId = 0;
+		uploaded                         = false;
+		requested                        = false;
+	}
+
+	// Hands rig, whose cameras carry the sizes of their inputs, the view and the output size to the baker if they differ
+	// from the last request, and uploads the newest finished map. The view is the output half of the mapping and the
+	// rotation of the whole rig. Returns false until the first map is uploaded, the caller should draw without it until then.
+	bool Update( const reprojection::Rig& rig, const reprojection::Uniforms& view, int width, int height )
+	{
+		if( !requested || requestedWidth != width || requestedHeight != height || !reprojection::sameRig( rig, requestedRig ) ||
+			!reprojection::sameMapping( view, requestedView ) )
+		{
+			baker->request( rig, view, width, height );
+			requestedRig    = rig;
+			requestedView   = view;
+			requestedWidth  = width;
+			requestedHeight = height;
+			requested       = true;
+		}
+
+		if( !baker->take( map ) )
+			return uploaded;
+
+		// One texel per output pixel, so nearest filtering reproduces the baked values exactly.
+		auto upload = [&]( GLuint textureId, GLint internalFormat, GLenum type, const void* pixels ) {
+			ffglex::Scoped2DTextureBinding textureBinding( textureId );
+			glPixelStorei( GL_UNPACK_ALIGNMENT, 4 );
+			glTexImage2D( GL_TEXTURE_2D, 0, internalFormat, map.width, map.height, 0, GL_RGBA, type, pixels );
+			glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST );
+			glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST );
+			glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE );
+			glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE );
+		};
+		upload( uvTextureId, GL_RGBA32F, GL_FLOAT, map.uv.data() );
+		upload( selectionTextureId, GL_RGBA8, GL_UNSIGNED_BYTE, map.selection.data() );
+		uploaded = true;
+		return true;
+	}
+
+	// Draws the stitched output, one input texture and its content area per camera of the rig Update() was given.
+	void Draw( const GLuint ( &inputTextures )[ reprojection::RIG_MAX_CAMERAS ], const FFGLTexCoords ( &maxCoords )[ reprojection::RIG_MAX_CAMERAS ],
+			   ffglex::FFGLScreenQuad& quad )
+	{
+		ffglex::ScopedShaderBinding shaderBinding( shader.GetGLID() );
+		ffglex::ScopedSamplerActivation activateSelectionSampler( SELECTION_UNIT );
+		ffglex::Scoped2DTextureBinding selectionBinding( selectionTextureId );
+		ffglex::ScopedSamplerActivation activateUvSampler( UV_UNIT );
+		ffglex::Scoped2DTextureBinding uvBinding( uvTextureId );
+		ffglex::ScopedSamplerActivation activateCamera3( 3 );
+		ffglex::Scoped2DTextureBinding camera3Binding( inputTextures[ 3 ] );
+		ffglex::ScopedSamplerActivation activateCamera2( 2 );
+		ffglex::Scoped2DTextureBinding camera2Binding( inputTextures[ 2 ] );
+		ffglex::ScopedSamplerActivation activateCamera1( 1 );
+		ffglex::Scoped2DTextureBinding camera1Binding( inputTextures[ 1 ] );
+		ffglex::ScopedSamplerActivation activateCamera0( 0 );
+		ffglex::Scoped2DTextureBinding camera0Binding( inputTextures[ 0 ] );
+
+		GLfloat maxUV[ 2 * reprojection::RIG_MAX_CAMERAS ];
+		for( int camera = 0; camera < reprojection::RIG_MAX_CAMERAS; ++camera )
+		{
+			maxUV[ 2 * camera ]     = maxCoords[ camera ].s;
+			maxUV[ 2 * camera + 1 ] = maxCoords[ camera ].t;
+		}
+		glUniform2fv( maxUVLocation, reprojection::RIG_MAX_CAMERAS, maxUV );
+		quad.Draw();
+	}
+
+private:
+	static const int BAKE_THREADS = 2;//!< Per instance, the baker's worker included, see RemapLut::BAKE_THREADS
+	static const GLint UV_UNIT        = reprojection::RIG_MAX_CAMERAS;//!< Texture units after the cameras' 0 to 3
+	static const GLint SELECTION_UNIT = reprojection::RIG_MAX_CAMERAS + 1;
+
+	ffglex::FFGLShader shader;//!< _stitchFragmentShaderCode
+	GLint maxUVLocation       = -1;
+	GLuint uvTextureId        = 0;//!< RGBA32F copy of map.uv
+	GLuint selectionTextureId = 0;//!< RGBA8 copy of map.selection
+	bool uploaded             = false;
+	reprojection::StitchMap map;//!< The last map taken from baker, the baker bakes the next one into its own
+	std::unique_ptr< reprojection::StitchBaker > baker;//!< Lives from Initialise() to Release()
+	reprojection::Rig requestedRig;
+	reprojection::Uniforms requestedView;
+	int requestedWidth  = 0;
+	int requestedHeight = 0;
+	bool requested      = false;
+};
@@ -1,94 +1,134 @@
 #pragma once
-
-static const char _fragmentShaderCode[] = R"(#version 410 core
+#include <string>
+#include "../Engine/ProjectionRegistry.h"
+
+// The body of the reprojection fragment shader. It is never compiled as is: buildFragmentShader() prefixes it with
+// the #version line and #defines for INPUT_PROJECTION, OUTPUT_PROJECTION, STEREO, PRECISION and WARP_MESH, and with
+// OUTPUT_UV_TO_DIR and INPUT_DIR_TO_UV, the calls of the two projections from their ProjectionTraits, so every
+// (input, output, stereo, precision) combination becomes its own program with no runtime branching on them and only
+// the projection code it uses.
+static const char _fragmentShaderCode[] = R"(
 uniform sampler2D InputTexture;
-uniform vec3 Rotation;
 
 in vec2 uv;
-uniform vec2 MaxUV;
+#if WARP_MESH
+// The unrotated output direction, interpolated between the vertices of the warp mesh, see Reprojection/WarpMesh.h,
+// and the brightness an imported mesh gives them.
+in vec3 meshDir;
+in float meshIntensity;
+#endif
 out vec4 fragColor;
-uniform int inputProjection, outputProjection, stereo, width, height;
-uniform float fovOut, fovIn;
-// Mirror dome parameters (pre-mapped from [0,1] slider in C++ code)
+// Everything that only depends on the parameters, computed once per frame on the CPU by computeFrameConstants()
+// (Engine/Projection.h) instead of once per pixel. Keep the member order in sync with FrameConstantsBuffer.h.
+// Mirror dome parameters (pre-mapped from [0,1] slider in C++ code):
 // mirrorRadius: radius of the spherical mirror (meters)
-// projDistance: distance from projector to mirror center (meters)
-// projLift: height of projector above mirror center (meters)
-// mirrorProjFov: projector field of view in radians
-// projTilt: angle in radians to tilt the projector aim up (+) or down (-)
+// projPos: projector position, (0, -projDistance, projLift) in meters
+// projForward, projRight, projUp: projector basis, aimed at the mirror center and tilted by projTilt
+// halfTan: tan( mirrorProjFov / 2 )
 // domeRadius: radius of the dome hemisphere (meters, range [0.5, 50.0])
-uniform float mirrorRadius, projDistance, projLift, mirrorProjFov, projTilt, domeRadius;
+// Dual fisheye parameters:
+// frontLens, backLens: center, radius and 2 / fov of each lens' image circle
+// seamBand: angles from the front lens axis the cross fade between the lenses runs between
+layout( std140 ) uniform FrameConstants
+{
+	mat3 rotation;           // Rx( pitch ) * Ry( roll ) * Rz( yaw )
+	vec3 projPos;
+	float halfTan;
+	vec3 projForward;
+	float aspectRatio;       // width / height of the input texture
+	vec3 projRight;
+	float fovOut;
+	vec3 projUp;
+	float fovIn;
+	vec2 MaxUV;
+	float mirrorRadius;
+	float domeRadius;
+	vec4 frontLens;
+	vec4 backLens;
+	vec2 seamBand;
+};
 //precision highp float;
 vec4 TRANSPARENT_PIXEL = vec4( 0.0, 0.0, 0.0, 0.0 );
 float PI = 3.141592653589793;
-const int EQUI          = 0;
-const int FISHEYE       = 1;
-const int FLAT          = 2;
-const int CUBEMAP       = 3;
-const int MIRROR_DOME   = 4;
 const int GRIDLINES_OFF = 0;
 const int GRIDLINES_ON  = 1;
 
-const int STEREO_NONE         = 0;
-const int STEREO_OVER_UNDER   = 1;
-const int STEREO_SIDE_BY_SIDE = 2;
 vec2 SET_TO_TRANSPARENT = vec2( -1.0, -1.0 );
 bool isTransparent      = false;// A global flag indicating if the pixel should just set to transparent and return immediately.
-// uniform vec3 InputRotation;
-// A transformation matrix rotating about the x axis by th degrees.
-mat3 Rx( float th )
-{
-	return mat3( 1, 0, 0, 0, cos( th ), -sin( th ), 0, sin( th ), cos( th ) );
-}
-// A transformation matrix rotating about the y axis by th degrees.
-mat3 Ry( float th )
+// The per-pixel trig. PRECISION_FAST swaps the built-ins for the minimax polynomials of Engine/FastTrig.h,
+// keep the coefficients in sync with it. Their error per projection pair is measured by Benchmark/Accuracy.cpp.
+#if PRECISION == PRECISION_FAST
+float trigSin( float x )
 {
-	return mat3( cos( th ), 0, sin( th ), 0, 1, 0, -sin( th ), 0, cos( th ) );
+	// Bring x into [-PI, PI], then fold it into [-PI/2, PI/2] where sin is odd and monotonic.
+	float r = x - 2.0 * PI * floor( x * ( 0.5 / PI ) + 0.5 );
+	r = r > PI / 2.0 ? PI - r : ( r < -PI / 2.0 ? -PI - r : r );
+	float z = r * r;
+	return ( ( ( -1.8363743e-4 * z + 8.3063282e-3 ) * z - 1.6664828e-1 ) * z + 9.9999660e-1 ) * r;
 }
-// A transformation matrix rotating about the z axis by th degrees.
-mat3 Rz( float th )
+float trigCos( float x )
 {
-	return mat3( cos( th ), -sin( th ), 0, sin( th ), cos( th ), 0, 0, 0, 1 );
+	return trigSin( x + PI / 2.0 );
 }
-// Rotate a point vector by th.x then th.y then th.z, and return the rotated point.
-vec3 rotatePoint( vec3 p, vec3 th )
+float trigTan( float x )
 {
-	return Rx( th.x ) * Ry( th.y ) * Rz( th.z ) * p;
+	return trigSin( x ) / trigCos( x );
 }
-// Convert a 3D point on the unit sphere into latitude and longitude.
-// In more mathy terms we're converting from "Cartesian Coordinates" to "Spherical Coordinates"
-vec2 pointToLatLon( vec3 point )
+float trigAtan( float y, float x )
 {
-	float r = distance( vec3( 0.0, 0.0, 0.0 ), point );
-	vec2 latLon;
-	latLon.x = asin( point.z / r );
-	latLon.y = atan( point.x, point.y );
-	return latLon;
+	vec2 a = abs( vec2( x, y ) );
+	bool steep = a.y > a.x;
+	// Always in [0, 1], and 0 / 0 only when both are 0, which atan maps to 0.
+	float t = a.x == 0.0 && a.y == 0.0 ? 0.0 : ( steep ? a.x / a.y : a.y / a.x );
+	float z = t * t;
+	float r = ( ( ( ( ( ( 6.8120738e-3 * z - 3.3605054e-2 ) * z + 7.9624616e-2 ) * z - 1.3233393e-1 ) * z + 1.9807829e-1 ) * z - 3.331737e-1 ) * z +
+				9.999961e-1 ) * t;
+	r = steep ? PI / 2.0 - r : r;
+	r = x < 0.0 ? PI - r : r;
+	return y < 0.0 ? -r : r;
 }
-// Convert latitude, longitude into a 3d point on the unit-sphere.
-// In more mathy terms we're converting from  "Spherical Coordinates" to "Cartesian Coordinates"
-vec3 latLonToPoint( vec2 latLon )
+float trigAtan( float x )
 {
-	float lat = latLon.x;
-	float lon = latLon.y;
-	vec3 point;
-	point.x = cos( lat ) * sin( lon );
-	point.y = cos( lat ) * cos( lon );
-	point.z = sin( lat );
-	return point;
+	return trigAtan( x, 1.0 );
 }
-// Convert pixel coordinates from an Equirectangular image into latitude/longitude coordinates.
-vec2 equiUvToLatLon( vec2 local_uv )
+#else
+float trigSin( float x ) { return sin( x ); }
+float trigCos( float x ) { return cos( x ); }
+float trigTan( float x ) { return tan( x ); }
+float trigAtan( float y, float x ) { return atan( y, x ); }
+float trigAtan( float x ) { return atan( x ); }
+#endif
+// Every output projection turns its uv into a unit direction (xxxUvToDir) and every input projection turns a
+// direction into its uv (dirToXxxUv), so a pixel only pays for the trig its two projections inherently need.
+// Latitude/longitude only exists on the equirectangular side.
+// X increases from left to right [-1 to 1]
+// Y increases from back to front [-1 to 1]
+// Z increases from bottom to top [-1 to 1]
+#if OUTPUT_PROJECTION == EQUI
+// Convert pixel coordinates from an Equirectangular image into a direction on the unit sphere.
+vec3 equiUvToDir( vec2 local_uv )
 {
-	return vec2( local_uv.y * PI - PI / 2.0,
-				 local_uv.x * 2.0 * PI - PI );
+	float lat = local_uv.y * PI - PI / 2.0;
+	float lon = local_uv.x * 2.0 * PI - PI;
+	vec3 dir;
+	dir.x = trigCos( lat ) * trigSin( lon );
+	dir.y = trigCos( lat ) * trigCos( lon );
+	dir.z = trigSin( lat );
+	return dir;
 }
 
-// Convert latitude, longitude to x, y pixel coordinates on an equirectangular image.
-vec2 latLonToEquiUv( vec2 latLon )
+#endif
+
+#if INPUT_PROJECTION == EQUI
+// Convert a direction to x, y pixel coordinates on an equirectangular image.
+vec2 dirToEquiUv( vec3 dir )
 {
+	// Not asin( dir.z / length( dir ) ), which near the poles turns the rounding of its argument into whole pixels.
+	float lat = trigAtan( dir.z, length( dir.xy ) );
+	float lon = trigAtan( dir.x, dir.y );
 	vec2 local_uv;
-	local_uv.x = ( latLon.y + PI ) / ( 2.0 * PI );
-	local_uv.y = ( latLon.x + PI / 2.0 ) / PI;
+	local_uv.x = ( lon + PI ) / ( 2.0 * PI );
+	local_uv.y = ( lat + PI / 2.0 ) / PI;
 	// Set to transparent if out of bounds
 	if( local_uv.x < -1.0 || local_uv.y < -1.0 || local_uv.x > 1.0 || local_uv.y > 1.0 )
 	{
@@ -99,50 +139,44 @@ vec2 latLonToEquiUv( vec2 latLon )
 	return local_uv;
 }
 
-// Convert  pixel coordinates from an Fisheye image into latitude/longitude coordinates.
-vec2 fisheyeUvToLatLon(vec2 local_uv, float fovOutput) {
+#endif
+
+#if OUTPUT_PROJECTION == FISHEYE
+// Convert pixel coordinates from a Fisheye image into a direction. The fisheye looks along +Y.
+vec3 fisheyeUvToDir( vec2 local_uv, float fovOutput )
+{
 	vec2 pos = 2.0 * local_uv - 1.0;
 	// The distance from the source pixel to the center of the image
-	float r = distance(vec2(0.0,0.0),pos.xy);
+	float r = length( pos );
 	// Don't bother with pixels outside of the fisheye circle
-	if (1.0 < r) {
+	if( 1.0 < r )
+	{
 		isTransparent = true;
-		return SET_TO_TRANSPARENT;
+		return vec3( 0.0, 0.0, 0.0 );
 	}
-	float theta = atan(r, 1.0);
-	r = tan(theta/fovOutput);
-	vec2 latLon;
-	latLon.x = (1.0 - r) * (PI/2.0);
-	// Calculate longitude
-	latLon.y = PI + atan(-pos.x, pos.y);
-      
-	if (latLon.y < 0.0) {
-		latLon.y += 2.0*PI;
-	}
-	vec3 point = latLonToPoint(latLon);
-	point = rotatePoint(point, vec3(PI/2.0, 0.0, 0.0));
-	latLon = pointToLatLon(point);
-	return latLon;
+	// Angle between the direction and the Y axis is (PI/2 - lat), lat being the latitude of the lens' own pole.
+	float lat = ( 1.0 - trigTan( trigAtan( r ) / fovOutput ) ) * ( PI / 2.0 );
+	// pos / r is already the cosine and sine of the angle around the lens axis.
+	vec2 around = r > 0.0 ? pos / r : vec2( 0.0, 0.0 );
+	return vec3( trigCos( lat ) * around.x, trigSin( lat ), trigCos( lat ) * around.y );
 }
 
-// Convert latitude, longitude to x, y pixel coordinates on the source fisheye image.
-vec2 pointToFisheyeUv( vec3 point, float fovIn )
+#endif
+
+#if INPUT_PROJECTION == FISHEYE
+// Convert a direction to x, y pixel coordinates on the source fisheye image. The fisheye looks along +Y.
+vec2 dirToFisheyeUv( vec3 dir, float fovIn )
 {
-	point = rotatePoint( point, vec3( -PI / 2.0, 0.0, 0.0 ) );
+	// Distance of the direction from the lens axis
+	float axisDistance = length( dir.xz );
 	// Phi and theta are flipped depending on where you read about them.
-	float theta = atan( distance( vec2( 0.0, 0.0 ), point.xy ), point.z );
+	float theta = trigAtan( axisDistance, dir.y );
 	// The distance from the source pixel to the center of the image
 	float r = ( 2.0 / PI ) * ( theta / fovIn );
-
-	// phi is the angle of r on the unit circle. See polar coordinates for more details
-	float phi = atan( -point.y, point.x );
-	// Get the position of the source pixel
-	vec2 sourcePixel;
-	sourcePixel.x = r * cos( phi );
-	sourcePixel.y = r * sin( phi );
-	// Normalize the output pixel to be in the range [0,1]
-	sourcePixel += 1.0;
-	sourcePixel /= 2.0;
+	// The angle of the source pixel around the center, as cosine and sine, without calling atan/cos/sin.
+	vec2 around = axisDistance > 0.0 ? dir.xz / axisDistance : vec2( 1.0, 0.0 );
+	// Get the position of the source pixel, normalized to be in the range [0,1]
+	vec2 sourcePixel = ( r * around + 1.0 ) / 2.0;
 	// Don't bother with source pixels outside of the fisheye circle
 	if( 1.0 < r || sourcePixel.x < 0.0 || sourcePixel.y < 0.0 || sourcePixel.x > 1.0 || sourcePixel.y > 1.0 )
 	{
@@ -153,6 +187,9 @@ vec2 pointToFisheyeUv( vec3 point, float fovIn )
 	return sourcePixel;
 }
 
+#endif
+
+#if INPUT_PROJECTION == FLAT || INPUT_PROJECTION == CUBEMAP || INPUT_PROJECTION == EAC || INPUT_PROJECTION == DUAL_FISHEYE
 bool outOfFlatBounds( vec2 xy, float lower, float upper )
 {
 	vec2 lowerBound = vec2( lower, lower );
@@ -160,47 +197,36 @@ bool outOfFlatBounds( vec2 xy, float lower, float upper )
 	return ( any( lessThan( xy, lowerBound ) ) || any( greaterThan( xy, upperBound ) ) );
 }
 
-vec2 flatImageUvToLatLon( vec2 local_uv, float fovOutput )
+#endif
+
+#if OUTPUT_PROJECTION == FLAT
+// The image plane sits at y = 1 / fovOutput, so the direction is just the normalized point on it.
+vec3 flatImageUvToDir( vec2 local_uv, float fovOutput )
 {
 	// Position of the source pixel in uv coordinates in the range [-1,1]
-	vec2 pos          = 2.0 * local_uv - 1.0;
-	float aspectRatio = float( width ) / float( height );
-	vec3 point        = vec3( pos.x * aspectRatio, 1.0 / fovOutput, pos.y );
-	return pointToLatLon( point );
-}
-
-// Convert latitude, longitude into a 3d point on the unit-sphere.
-vec3 flatLatLonToPoint( vec2 latLon )
-{
-	vec3 point = latLonToPoint( latLon );
-	// Get phi of this point, see polar coordinate system for more details.
-	float phi = atan( point.x, -point.y );
-	// With phi, calculate the point on the image plane that is also at the angle phi
-	point.x = sin( phi ) * tan( PI / 2.0 - latLon.x );
-	point.y = cos( phi ) * tan( PI / 2.0 - latLon.x );
-	point.z = 1.0;
-	return point;
+	vec2 pos = 2.0 * local_uv - 1.0;
+	return normalize( vec3( pos.x * aspectRatio, 1.0 / fovOutput, pos.y ) );
 }
 
-vec2 latLonToFlatUv( vec2 latLon, float fovInput )
+#endif
+
+#if INPUT_PROJECTION == FLAT
+// Project a direction onto the image plane at y = 1 and convert it to x, y pixel coordinates.
+vec2 dirToFlatUv( vec3 dir, float fovInput )
 {
-	vec3 point        = rotatePoint( latLonToPoint( latLon ), vec3( -PI / 2.0, 0.0, 0.0 ) );
-	latLon            = pointToLatLon( point );
-	float aspectRatio = float( width ) / float( height );
-	vec2 xyOnImagePlane;
-	vec3 p;
-	if( latLon.x < 0.0 )
+	// Directions behind the image plane never hit it.
+	if( dir.y <= 0.0 )
 	{
 		isTransparent = true;
 		return SET_TO_TRANSPARENT;
 	}
-	// Derive a 3D point on the plane which correlates with the latitude and longitude in the fisheye image.
-	p = flatLatLonToPoint( latLon );
+	// Derive the point on the plane which is hit by the direction.
+	vec2 p = dir.xz / dir.y;
 	p.x /= aspectRatio;
 	// Control the scale with the user's fov input parameter.
-	p.xy *= fovInput;
-	// Position of the source pixel in the source image in the range [-1,1]
-	xyOnImagePlane = p.xy / 2.0 + 0.5;
+	p *= fovInput;
+	// Position of the source pixel in the source image in the range [0,1]
+	vec2 xyOnImagePlane = p / 2.0 + 0.5;
 	if( outOfFlatBounds( xyOnImagePlane, 0.0, 1.0 ) )
 	{
 		isTransparent = true;
@@ -209,6 +235,17 @@ vec2 latLonToFlatUv( vec2 latLon, float fovInput )
 	return xyOnImagePlane;
 }
 
+#endif
+
+#if OUTPUT_PROJECTION == CUBEMAP || OUTPUT_PROJECTION == EAC
+// An EAC face spreads the 90 degrees of its edge evenly: the face coordinates 3 pos.x and 2 pos.y, both in [-1, 1],
+// are angles of +-PI/4 that the point on the cube face is the tangent of. A face is 2/3 of pos wide but 1 high, hence
+// the different scales.
+vec2 equiAngular( vec2 pos )
+{
+	return vec2( trigTan( pos.x * ( 3.0 * PI / 4.0 ) ) / 3.0, trigTan( pos.y * ( PI / 2.0 ) ) / 2.0 );
+}
+
 // Convert a cubemap uv to a 3d point on a unit cube
 vec3 cubemapUvToPoint(vec2 local_uv)
 {
@@ -218,14 +255,13 @@ vec3 cubemapUvToPoint(vec2 local_uv)
 	// Position of the source pixel in uv coordinates in the range [-1,1]
 	vec2 pos = (2.0 * local_uv) - 1.0;
 	vec3 point;
-	float faceDistance = fovOut / 3.0;
 	// Is it a standard cubemap or an EAC?
 	// Link for more details: https://blog.google/products/google-ar-vr/bringing-pixels-front-and-center-vr-video/
-	bool equiAngularCubemap = false;
+	bool equiAngularCubemap = OUTPUT_PROJECTION == EAC;
+	// An EAC face always spans 90 degrees, fovOut would undo its equi-angular warp.
+	float faceDistance = equiAngularCubemap ? 1.0 / 3.0 : fovOut / 3.0;
 	// Remove overlap in the image.
 	float verticalCorrection = 2.0/3.0;
-	// No idea why this was needed, but ~1.15 seems to work and pi / e is really close.
-	float piDividedByE = 1.155727349790921717910093183312696299120851023164415820499;
 	// The faces of the cubemap. To explain I'll define the following:
 	// Let's call +X: "Right"
 	//            -X: "Left"
@@ -237,8 +273,7 @@ vec3 cubemapUvToPoint(vec2 local_uv)
 	if (local_uv.x <= leftBoundary && verticalBoundary <= local_uv.y) {
 		pos += vec2(2.0/3.0, -0.5);
 		if(equiAngularCubemap)  {
-		pos = tan(pos*PI/2.0)/2.0;
-		pos.x *= piDividedByE;
+		pos = equiAngular(pos);
 		}
 		// "Left" face of cube
 		point = vec3(-faceDistance, pos.x, verticalCorrection*pos.y);
@@ -247,8 +282,7 @@ vec3 cubemapUvToPoint(vec2 local_uv)
 	else if (leftBoundary < local_uv.x && local_uv.x <= rightBoundary && verticalBoundary <= local_uv.y) {
 		pos += vec2(0.0, -0.5);
 		if(equiAngularCubemap)  {
-		pos = tan(pos*PI/2.0)/2.0;
-		pos.x *= piDividedByE;
+		pos = equiAngular(pos);
 		}
 		// "Front" face of cube 
 		point = vec3(pos.x, faceDistance, verticalCorrection*pos.y);
@@ -257,8 +291,7 @@ vec3 cubemapUvToPoint(vec2 local_uv)
 	else if (rightBoundary < local_uv.x && verticalBoundary <= local_uv.y) {
 		pos += vec2(-2.0/3.0, -0.5);
 		if(equiAngularCubemap)  {
-		pos = tan(pos*PI/2.0)/2.0;
-		pos.x *= piDividedByE;
+		pos = equiAngular(pos);
 		}
 		// "Right" face of cube
 		point = vec3(faceDistance, -pos.x, verticalCorrection*pos.y);
@@ -268,8 +301,7 @@ vec3 cubemapUvToPoint(vec2 local_uv)
 	else if (local_uv.x <= leftBoundary && local_uv.y < verticalBoundary) {
 		pos += vec2(2.0/3.0, 0.5);
 		if(equiAngularCubemap)  {
-		pos = tan(pos*PI/2.0)/2.0;
-		pos.x *= piDividedByE;
+		pos = equiAngular(pos);
 		}
 		// "Top" face of cube
 		point = vec3(-pos.y*verticalCorrection, -pos.x, faceDistance);
@@ -279,8 +311,7 @@ vec3 cubemapUvToPoint(vec2 local_uv)
 	else if (leftBoundary < local_uv.x && local_uv.x <= rightBoundary && local_uv.y < verticalBoundary) {
 		pos += vec2(0.0, 0.5);
 		if(equiAngularCubemap)  {
-		pos = tan(pos*PI/2.0)/2.0;
-		pos.x *= piDividedByE;
+		pos = equiAngular(pos);
 		}
 		// "Back" face of cube
 		point = vec3(-pos.y*verticalCorrection, -faceDistance, -pos.x);
@@ -290,8 +321,7 @@ vec3 cubemapUvToPoint(vec2 local_uv)
 	else if (rightBoundary < local_uv.x && local_uv.y < verticalBoundary) {
 		pos += vec2(-2.0/3.0, 0.5);
 		if(equiAngularCubemap)  {
-		pos = tan(pos*PI/2.0)/2.0;
-		pos.x *= piDividedByE;
+		pos = equiAngular(pos);
 		}
 		// "Bottom" face of cube
 		point = vec3(-pos.y*verticalCorrection, pos.x, -faceDistance);
@@ -299,40 +329,56 @@ vec3 cubemapUvToPoint(vec2 local_uv)
 	}
 	return point;
 }
-// Convert a cubemap image to Latitude/Longitude Points
-vec2 cubemapUvToLatLon(vec2 local_uv)
+// Convert a cubemap uv to a direction
+vec3 cubemapUvToDir(vec2 local_uv)
 {
-	return pointToLatLon(cubemapUvToPoint(local_uv));
+	return normalize(cubemapUvToPoint(local_uv));
+}
+
+#endif
+
+)" R"( // <- Shader string was too long, needed to break it up
+
+#if OUTPUT_PROJECTION == CUBE_FACES
+// Convert a uv on the strip of six faces stacked bottom up to a direction. Face f is the GL_TEXTURE_CUBE_MAP face
+// POSITIVE_X + f for the direction r = ( x, -z, y ): right, left, down, up, front, back, each upright seen from inside.
+vec3 cubeFacesUvToDir( vec2 local_uv, float fovOutput )
+{
+	int face = min( int( local_uv.y * 6.0 ), 5 );
+	float sc = 2.0 * local_uv.x - 1.0;
+	float tc = 2.0 * ( local_uv.y * 6.0 - float( face ) ) - 1.0;
+	float ma = fovOutput;
+	vec3 r;
+	if( face == 0 )
+		r = vec3( ma, -tc, -sc );
+	else if( face == 1 )
+		r = vec3( -ma, -tc, sc );
+	else if( face == 2 )
+		r = vec3( sc, ma, tc );
+	else if( face == 3 )
+		r = vec3( sc, -ma, -tc );
+	else if( face == 4 )
+		r = vec3( sc, -tc, ma );
+	else
+		r = vec3( -sc, -tc, -ma );
+	return normalize( vec3( r.x, r.z, -r.y ) );
 }
 
-// Convert a uv coordinate in the output image (projector pixel) into lat/lon on the mirror surface.
+#endif
+
+#if OUTPUT_PROJECTION == MIRROR_DOME
+// Convert a uv coordinate in the output image (projector pixel) into the surface normal of the mirror where it's hit.
 // This traces a ray from the projector through the pixel and intersects it with the spherical mirror.
 // Based on Paul Bourke's mirror dome projection approach.
-vec2 mirrorUvToMirrorLatLon(vec2 local_uv)
+vec3 mirrorUvToMirrorNormal(vec2 local_uv)
 {
 	// Mirror is a sphere at the origin with radius mirrorRadius.
 	// Dome is a hemisphere at the origin with radius domeRadius.
-	// Projector is at (0, -projDistance, projLift) aimed at the mirror center.
+	// Projector is at projPos aimed at the mirror center, its tilted basis comes from FrameConstants.
 	vec3 mirrorCenter = vec3(0.0, 0.0, 0.0);
-	vec3 projPos = vec3(0.0, -projDistance, projLift);
-
-	// Projector aims at mirror center, then tilted up/down by projTilt
-	vec3 projForward = normalize(mirrorCenter - projPos);
-
-	// Build projector's local coordinate system
-	vec3 worldUp = vec3(0.0, 0.0, 1.0);
-	vec3 projRight = normalize(cross(projForward, worldUp));
-	vec3 projUp = normalize(cross(projRight, projForward));
-
-	// Apply tilt: rotate projForward around projRight by projTilt angle
-	projForward = normalize(projForward * cos(projTilt) + projUp * sin(projTilt));
-	// Recompute projUp to stay perpendicular to the tilted forward direction
-	projUp = normalize(cross(projRight, projForward));
 
 	// Convert UV [0,1] to pixel position [-1,1] on the projector's image plane
 	vec2 pixelPos = 2.0 * local_uv - 1.0;
-	float aspectRatio = float(width) / float(height);
-	float halfTan = tan(mirrorProjFov / 2.0);
 
 	// Ray direction from projector through this pixel
 	vec3 rayDir = normalize(
@@ -350,7 +396,7 @@ vec2 mirrorUvToMirrorLatLon(vec2 local_uv)
 	if (discriminant < 0.0) {
 		// Ray misses the mirror
 		isTransparent = true;
-		return SET_TO_TRANSPARENT;
+		return vec3(0.0, 0.0, 0.0);
 	}
 
 	// Take the closer intersection (smaller t)
@@ -358,27 +404,24 @@ vec2 mirrorUvToMirrorLatLon(vec2 local_uv)
 	if (t < 0.0) {
 		// Mirror is behind the projector
 		isTransparent = true;
-		return SET_TO_TRANSPARENT;
+		return vec3(0.0, 0.0, 0.0);
 	}
 
 	// Hit point on mirror surface
 	vec3 hitPoint = projPos + t * rayDir;
 
-	// Convert the hit point to a direction from the mirror center, then to lat/lon
-	vec3 mirrorSurfaceDir = normalize(hitPoint - mirrorCenter);
-	return pointToLatLon(mirrorSurfaceDir);
+	// The direction from the mirror center to the hit point is the surface normal
+	return normalize(hitPoint - mirrorCenter);
 }
 
-// Convert a latitude/longitude on the spherical mirror surface to a 3D point on the dome.
+// Convert a normal on the spherical mirror surface to a 3D point on the dome.
 // Reconstructs the incident ray from the projector, reflects it off the mirror, and
 // intersects the reflected ray with the dome hemisphere.
-vec3 mirrorLatLonToDomePoint(vec2 mirrorLatLon)
+vec3 mirrorNormalToDomePoint(vec3 mirrorNormal)
 {
 	vec3 mirrorCenter = vec3(0.0, 0.0, 0.0);
-	vec3 projPos = vec3(0.0, -projDistance, projLift);
 
-	// Reconstruct the hit point on the mirror surface from lat/lon
-	vec3 mirrorNormal = latLonToPoint(mirrorLatLon);
+	// Reconstruct the hit point on the mirror surface from its normal
 	vec3 hitPoint = mirrorCenter + mirrorRadius * mirrorNormal;
 
 	// Incident ray direction (from projector to hit point on mirror)
@@ -419,22 +462,33 @@ vec3 mirrorLatLonToDomePoint(vec2 mirrorLatLon)
 	return domePoint;
 }
 
-// Convert a uv (coordinate in the projector image) to a latitude/longitude on the dome.
-// Chains the full ray trace: projector pixel → mirror hit → reflection → dome point → lat/lon.
-vec2 mirrorDomeUvToLatLon(vec2 local_uv)
+// Convert a uv (coordinate in the projector image) to a direction from the dome center.
+// Chains the full ray trace: projector pixel → mirror hit → reflection → dome point → direction.
+vec3 mirrorDomeUvToDir(vec2 local_uv)
 {
-	vec2 mirrorLatLon = mirrorUvToMirrorLatLon(local_uv);
-	if (isTransparent) return SET_TO_TRANSPARENT;
-	vec3 domePoint = mirrorLatLonToDomePoint(mirrorLatLon);
-	if (isTransparent) return SET_TO_TRANSPARENT;
-	return pointToLatLon(domePoint);
+	vec3 mirrorNormal = mirrorUvToMirrorNormal(local_uv);
+	if (isTransparent) return vec3(0.0, 0.0, 0.0);
+	vec3 domePoint = mirrorNormalToDomePoint(mirrorNormal);
+	if (isTransparent) return vec3(0.0, 0.0, 0.0);
+	return normalize(domePoint);
 }
 
+#endif
+
 )" R"( // <- Shader string was too long, needed to break it up
 
-vec2 pointToCubemapUv( vec3 point, float fovInput )
+#if INPUT_PROJECTION == CUBEMAP || INPUT_PROJECTION == EAC
+// The inverse of equiAngular(): from the tangent on the cube face back to the angle.
+vec2 equiAngularInverse( vec2 pos )
+{
+	return vec2( trigAtan( 3.0 * pos.x ) * ( 4.0 / ( 3.0 * PI ) ), trigAtan( 2.0 * pos.y ) * ( 2.0 / PI ) );
+}
+
+vec2 dirToCubemapUv( vec3 point, float fovInput )
 {
-	float faceDistance = fovInput / 3.0;
+	// An EAC face always spans 90 degrees, see cubemapUvToPoint().
+	bool equiAngularCubemap = INPUT_PROJECTION == EAC;
+	float faceDistance = equiAngularCubemap ? 1.0 / 3.0 : fovInput / 3.0;
 	float verticalCorrection = 2.0 / 3.0;
 	float epsilon = 0.000001;
 	vec2 pos;
@@ -452,6 +506,8 @@ vec2 pointToCubemapUv( vec3 point, float fovInput )
 		{
 			pos.x      = -faceDistance * point.y / point.x;
 			pos.y      = -faceDistance * point.z / ( verticalCorrection * point.x );
+			if( equiAngularCubemap )
+				pos = equiAngularInverse( pos );
 			local_uv.x = ( pos.x + 1.0 / 3.0 ) / 2.0;
 			local_uv.y = ( pos.y + 1.5 ) / 2.0;
 		}
@@ -459,6 +515,8 @@ vec2 pointToCubemapUv( vec3 point, float fovInput )
 		{
 			pos.x      = -faceDistance * point.y / point.x;
 			pos.y      = faceDistance * point.z / ( verticalCorrection * point.x );
+			if( equiAngularCubemap )
+				pos = equiAngularInverse( pos );
 			local_uv.x = ( pos.x + 5.0 / 3.0 ) / 2.0;
 			local_uv.y = ( pos.y + 1.5 ) / 2.0;
 		}
@@ -474,6 +532,8 @@ vec2 pointToCubemapUv( vec3 point, float fovInput )
 		{
 			pos.x      = faceDistance * point.x / point.y;
 			pos.y      = faceDistance * point.z / ( verticalCorrection * point.y );
+			if( equiAngularCubemap )
+				pos = equiAngularInverse( pos );
 			local_uv.x = ( pos.x + 1.0 ) / 2.0;
 			local_uv.y = ( pos.y + 1.5 ) / 2.0;
 		}
@@ -481,6 +541,8 @@ vec2 pointToCubemapUv( vec3 point, float fovInput )
 		{
 			pos.x      = faceDistance * point.z / point.y;
 			pos.y      = faceDistance * point.x / ( verticalCorrection * point.y );
+			if( equiAngularCubemap )
+				pos = equiAngularInverse( pos );
 			local_uv.x = ( pos.x + 1.0 ) / 2.0;
 			local_uv.y = ( pos.y + 0.5 ) / 2.0;
 		}
@@ -496,6 +558,8 @@ vec2 pointToCubemapUv( vec3 point, float fovInput )
 		{
 			pos.x      = -faceDistance * point.y / point.z;
 			pos.y      = -faceDistance * point.x / ( verticalCorrection * point.z );
+			if( equiAngularCubemap )
+				pos = equiAngularInverse( pos );
 			local_uv.x = ( pos.x + 1.0 / 3.0 ) / 2.0;
 			local_uv.y = ( pos.y + 0.5 ) / 2.0;
 		}
@@ -503,6 +567,8 @@ vec2 pointToCubemapUv( vec3 point, float fovInput )
 		{
 			pos.x      = -faceDistance * point.y / point.z;
 			pos.y      = faceDistance * point.x / ( verticalCorrection * point.z );
+			if( equiAngularCubemap )
+				pos = equiAngularInverse( pos );
 			local_uv.x = ( pos.x + 5.0 / 3.0 ) / 2.0;
 			local_uv.y = ( pos.y + 0.5 ) / 2.0;
 		}
@@ -515,12 +581,106 @@ vec2 pointToCubemapUv( vec3 point, float fovInput )
 	}
 	return local_uv;
 }
+#endif
+
+#if INPUT_PROJECTION == MIRROR_DOME
+// The inverse of mirrorDomeUvToDir(), tabulated over the dome master on the CPU, see Engine/InverseMirror.h. Texels the
+// projector cannot reach hold a large negative value, so any filter weight on one makes the fetch negative.
+uniform sampler2D InverseMirrorTexture;
+
+vec2 dirToMirrorDomeUv( vec3 dir )
+{
+	float axisDistance = length( dir.xy );
+	float theta = trigAtan( axisDistance, dir.z );
+	vec2 around = axisDistance > 0.0 ? dir.xy / axisDistance : vec2( 0.0, 0.0 );
+	vec2 domeUv = ( theta / ( PI / 2.0 ) * around + 1.0 ) / 2.0;
+	vec2 sourcePixel = texture( InverseMirrorTexture, domeUv ).xy;
+	// Below the dome's horizon, or a part of the dome the projector does not reach
+	if( dir.z < 0.0 || sourcePixel.x < 0.0 )
+	{
+		isTransparent = true;
+		return SET_TO_TRANSPARENT;
+	}
+	return sourcePixel;
+}
+#endif
+
+#if INPUT_PROJECTION == CUBE_FACES
+// The six faces of each eye, copied out of the input strip every frame, see Reprojection/CubeFacesTexture.h. Layer 1
+// holds the second eye.
+uniform samplerCubeArray InputCubeFaces;
+
+// The lookup vector for InputCubeFaces: dir in the r = ( x, -z, y ) frame of cubeFacesUvToDir(), with the minor
+// components scaled by fovInput so the faces zoom like the CUBEMAP atlas' do. The hardware then picks the face and
+// filters across its edges, no branch on the face here. Only a fovInput above 1 can push a minor component past the
+// major one, which would pick the neighbouring face; those directions are transparent like in dirToCubeFacesUv().
+vec3 cubeFacesLookupDir( vec3 dir, float fovInput )
+{
+	vec3 r = vec3( dir.x, -dir.z, dir.y );
+	vec3 a = abs( r );
+	float ma = max( a.x, max( a.y, a.z ) );
+	vec3 major = step( vec3( ma ), a );
+	vec3 scaled = r * mix( vec3( fovInput ), vec3( 1.0 ), major );
+	if( ma == 0.0 || any( greaterThan( abs( scaled ), vec3( ma ) ) ) )
+		isTransparent = true;
+	return scaled;
+}
+#endif
+
+#if INPUT_PROJECTION == DUAL_FISHEYE
+// The lens dirToDualFisheyeUv() did not return and its weight in the seam cross fade, blended in at the end of main().
+// Starts as SET_TO_TRANSPARENT spelled out, a global initializer has to be a constant expression before GLSL 4.20.
+vec2 seamPixel = vec2( -1.0, -1.0 );
+float seamWeight = 0.0;
+
+// Where the lens whose calibration is lens sees the direction theta radians off its axis, around its axis in the
+// direction around, in the uv of its half of the frame. The equidistant mapping of dirToFisheyeUv() with the lens' own
+// FoV, center and radius.
+vec2 dualFisheyeLensUv( float theta, vec2 around, vec4 lens )
+{
+	return lens.xy + 0.5 * lens.z * ( theta * lens.w ) * around;
+}
+
+// Both lenses from one atan: the back lens sees the direction PI - theta off its axis, with x mirrored since it looks
+// the other way. Where both circles hold it, the lens with the larger weight is returned and the other one goes to
+// seamPixel, so one extra fetch inside the seam band is all the cross fade costs.
+vec2 dirToDualFisheyeUv( vec3 dir )
+{
+	float axisDistance = length( dir.xz );
+	float theta = trigAtan( axisDistance, dir.y );
+	vec2 around = axisDistance > 0.0 ? dir.xz / axisDistance : vec2( 1.0, 0.0 );
+	vec2 front = dualFisheyeLensUv( theta, around, frontLens );
+	vec2 back = dualFisheyeLensUv( PI - theta, vec2( -around.x, around.y ), backLens );
+	bool frontSees = theta * frontLens.w <= 1.0 && !outOfFlatBounds( front, 0.0, 1.0 );
+	bool backSees = ( PI - theta ) * backLens.w <= 1.0 && !outOfFlatBounds( back, 0.0, 1.0 );
+	if( !frontSees && !backSees )
+	{
+		isTransparent = true;
+		return SET_TO_TRANSPARENT;
+	}
+	float frontWeight = !backSees ? 1.0 : ( !frontSees ? 0.0 : 1.0 - smoothstep( seamBand.x, seamBand.y, theta ) );
+	// The front lens fills the left half of the frame, the back lens the right half.
+	front.x = front.x * 0.5;
+	back.x = back.x * 0.5 + 0.5;
+	bool frontFirst = frontWeight >= 0.5;
+	seamPixel = frontFirst ? back : front;
+	seamWeight = frontFirst ? 1.0 - frontWeight : frontWeight;
+	return frontFirst ? front : back;
+}
+#endif
+
+// OUTPUT_UV_TO_DIR of the input only projections: every pixel is transparent.
+vec3 inputOnlyUvToDir()
+{
+	isTransparent = true;
+	return vec3( 0.0 );
+}
 
 void main()
 {
 	vec2 local_uv = uv;
 	bool stereoImageSecondHalf = false;
-	if (stereo == STEREO_OVER_UNDER) {
+#if STEREO == STEREO_OVER_UNDER
 		if (local_uv.y <= 0.5) {
 			local_uv.y = local_uv.y * 2.0;
 		}
@@ -528,8 +688,8 @@ void main()
 			local_uv.y = (local_uv.y - 0.5) * 2.0;
 			stereoImageSecondHalf = true;
 		}
-	}
-    if (stereo == STEREO_SIDE_BY_SIDE) {
+#endif
+#if STEREO == STEREO_SIDE_BY_SIDE
         if (local_uv.x <= 0.5) {
             local_uv.x = local_uv.x * 2.0;
         }
@@ -537,77 +697,203 @@ void main()
             local_uv.x = (local_uv.x - 0.5) * 2.0;
             stereoImageSecondHalf = true;
         }
-    }
-	// Latitude and Longitude of the destination pixel (uv)
-	vec2 latLon;
-	if( outputProjection == EQUI )
+#endif
+	// Direction of the destination pixel (uv) on the unit sphere
+	vec3 dir;
+#if WARP_MESH
+	dir = normalize( meshDir );
+#else
+	dir = OUTPUT_UV_TO_DIR( local_uv );
+#endif
+	if( isTransparent )
 	{
-		latLon = equiUvToLatLon( local_uv );
-	}
-	else if( outputProjection == FISHEYE )
-	{
-		latLon = fisheyeUvToLatLon( local_uv, fovOut );
-	}
-
-	else if( outputProjection == FLAT ) {
-		latLon = flatImageUvToLatLon( local_uv, fovOut );
-	}
-	else if (outputProjection == CUBEMAP) {
-		latLon = cubemapUvToLatLon(local_uv);
-	}
-	else if (outputProjection == MIRROR_DOME) {
-		latLon = mirrorDomeUvToLatLon(local_uv);
+		fragColor = TRANSPARENT_PIXEL;
+		return;
 	}
-	if( latLon == SET_TO_TRANSPARENT )
+	// Rotate the direction based on the user input
+	dir = rotation * dir;
+#if INPUT_PROJECTION == CUBE_FACES
+	// No source pixel: the cube map array is sampled with the direction itself.
+	vec3 lookupDir = cubeFacesLookupDir( dir, fovIn );
+	if( isTransparent )
 	{
 		fragColor = TRANSPARENT_PIXEL;
 		return;
 	}
-	// Create a point on the unit-sphere from the latitude and longitude
-		// X increases from left to right [-1 to 1]
-		// Y increases from bottom to top [-1 to 1]
-		// Z increases from back to front [-1 to 1]
-	vec3 point = latLonToPoint(latLon);
-	// Rotate the point based on the user input in radians
-	point = rotatePoint(point, Rotation.xyz);
-	// Convert back to latitude and longitude
-	latLon = pointToLatLon(point);
-	// Convert back to the normalized pixel coordinate
-	vec2 sourcePixel;
-	if( inputProjection == EQUI )
-		sourcePixel = latLonToEquiUv( latLon );
-	else if( inputProjection == FISHEYE )
-		sourcePixel = pointToFisheyeUv( point, fovIn );
-	else if( inputProjection == FLAT )
-		sourcePixel = latLonToFlatUv( latLon, fovIn );
-	else if( inputProjection == CUBEMAP )
-		sourcePixel = pointToCubemapUv( point, fovIn );
-
-	if( sourcePixel == SET_TO_TRANSPARENT ) {
+	fragColor = texture( InputCubeFaces, vec4( lookupDir, stereoImageSecondHalf ? 1.0 : 0.0 ) );
+#if WARP_MESH
+	fragColor.rgb *= meshIntensity;
+#endif
+	return;
+#endif
+	// Convert to the normalized pixel coordinate
+	vec2 sourcePixel = INPUT_DIR_TO_UV( dir );
+
+	if( isTransparent ) {
 		fragColor = TRANSPARENT_PIXEL;
 		return;
 	}
 	
-	if (stereo == STEREO_OVER_UNDER) {
+#if STEREO == STEREO_OVER_UNDER
 		if (stereoImageSecondHalf) {
 			sourcePixel.y = sourcePixel.y / 2.0 + 0.5;
 		}
 		else {
 			sourcePixel.y = (sourcePixel.y / 2.0);
 		}
-	}
-	else if (stereo == STEREO_SIDE_BY_SIDE) {
+#elif STEREO == STEREO_SIDE_BY_SIDE
         if (stereoImageSecondHalf) {
             sourcePixel.x = sourcePixel.x / 2.0 + 0.5;
         }
         else {
             sourcePixel.x = (sourcePixel.x / 2.0);
         }
-    }
+#endif
 	// Applying the MaxUV after our opterations fixes the "seam" from
 	// https://github.com/DanielArnett/360-VJ/issues/10
 	sourcePixel *= MaxUV;
 	// Set the color of the destination pixel to the color of the source pixel
 	fragColor = texture( InputTexture, sourcePixel );
+#if INPUT_PROJECTION == DUAL_FISHEYE
+	// Inside the seam band, cross fade to the other lens, squeezed into the same stereo half.
+	if( seamWeight > 0.0 )
+	{
+#if STEREO == STEREO_OVER_UNDER
+		seamPixel.y = seamPixel.y / 2.0 + ( stereoImageSecondHalf ? 0.5 : 0.0 );
+#elif STEREO == STEREO_SIDE_BY_SIDE
+		seamPixel.x = seamPixel.x / 2.0 + ( stereoImageSecondHalf ? 0.5 : 0.0 );
+#endif
+		fragColor = mix( fragColor, texture( InputTexture, seamPixel * MaxUV ), seamWeight );
+	}
+#endif
+#if WARP_MESH
+	fragColor.rgb *= meshIntensity;
+#endif
+}
+)";
+
+// Assembles the specialized program for one (input, output, stereo, precision) combination.
+// The projection constants are preprocessor symbols rather than `const int`s so the #if blocks above can test them,
+// one per ProjectionTraits with its ProjectionType value, and the two projections of the program are called through
+// the GLSL their traits give.
+// warpMesh builds the variant that takes the output direction from _meshVertexShaderCode instead of computing it.
+inline std::string buildFragmentShader( int inputProjection, int outputProjection, int stereo, int precision, bool warpMesh = false )
+{
+	std::string projections;
+	for( int projection = 0; projection < reprojection::PROJECTION_COUNT; ++projection )
+		projections += std::string( "#define " ) + reprojection::projectionInfo( projection ).constant + " " + std::to_string( projection ) + "\n";
+	return "#version 410 core\n" + projections +
+		   "#define STEREO_NONE         0\n"
+		   "#define STEREO_OVER_UNDER   1\n"
+		   "#define STEREO_SIDE_BY_SIDE 2\n"
+		   "#define PRECISION_EXACT     0\n"
+		   "#define PRECISION_FAST      1\n"
+		   "#define INPUT_PROJECTION " + std::to_string( inputProjection ) + "\n"
+		   "#define OUTPUT_PROJECTION " + std::to_string( outputProjection ) + "\n"
+		   "#define STEREO " + std::to_string( stereo ) + "\n"
+		   "#define PRECISION " + std::to_string( precision ) + "\n"
+		   "#define WARP_MESH " + std::to_string( warpMesh ? 1 : 0 ) + "\n"
+		   "#define OUTPUT_UV_TO_DIR( local_uv ) " + reprojection::projectionInfo( outputProjection ).glslUvToDir + "\n"
+		   "#define INPUT_DIR_TO_UV( dir ) " + reprojection::projectionInfo( inputProjection ).glslDirToUv + "\n" +
+		   _fragmentShaderCode;
+}
+
+// Vertex shader of the warp mesh: the plugins' one plus the unrotated output direction and the intensity at each
+// vertex, which the rasterizer interpolates for the WARP_MESH fragment shader.
+static const char _meshVertexShaderCode[] = R"(#version 410 core
+
+layout( location = 0 ) in vec4 vPosition;
+layout( location = 1 ) in vec2 vUV;
+layout( location = 2 ) in vec3 vDir;
+layout( location = 3 ) in float vIntensity;
+
+out vec2 uv;
+out vec3 meshDir;
+out float meshIntensity;
+
+void main()
+{
+	gl_Position = vPosition;
+	uv = vUV;
+	meshDir = vDir;
+	meshIntensity = vIntensity;
+}
+)";
+
+// LUT mode: the output uv -> input uv mapping of the shader above has been baked on the CPU into RemapTexture
+// (RG32F, one texel per output pixel, see Engine/RemapTable.h), so each pixel costs a single dependent fetch.
+// Transparent pixels were baked as SET_TO_TRANSPARENT, i.e. a negative coordinate. For a DUAL_FISHEYE input Seam is
+// set and the second sample of the seam cross fade comes from SeamUvTexture (RG32F) and SeamWeightTexture (R32F), so
+// only the pixels inside the seam band pay for a second fetch.
+static const char _remapFragmentShaderCode[] = R"(#version 410 core
+uniform sampler2D InputTexture;
+uniform sampler2D RemapTexture;
+uniform sampler2D SeamUvTexture;
+uniform sampler2D SeamWeightTexture;
+uniform bool Seam;
+uniform vec2 MaxUV;
+
+in vec2 uv;
+out vec4 fragColor;
+
+void main()
+{
+	vec2 sourcePixel = texture( RemapTexture, uv ).xy;
+	if( sourcePixel.x < 0.0 )
+	{
+		fragColor = vec4( 0.0, 0.0, 0.0, 0.0 );
+		return;
+	}
+	fragColor = texture( InputTexture, sourcePixel * MaxUV );
+	if( Seam )
+	{
+		float seamWeight = texture( SeamWeightTexture, uv ).r;
+		if( seamWeight > 0.0 )
+			fragColor = mix( fragColor, texture( InputTexture, texture( SeamUvTexture, uv ).xy * MaxUV ), seamWeight );
+	}
+}
+)";
+
+// Rig stitching: which camera of the rig each output pixel samples, at which uv, and how much of a second camera is
+// mixed in, baked on the CPU into StitchUv (RGBA32F, the uv of both cameras before MaxUV) and StitchSelection (RGBA8,
+// both camera indices and the weight of the second), see Engine/Rig.h. Each pixel costs the two map fetches and one or
+// two fetches of the cameras. Samplers can only be indexed with a dynamically uniform index, so fetch() branches.
+static const char _stitchFragmentShaderCode[] = R"(#version 410 core
+uniform sampler2D Camera0;
+uniform sampler2D Camera1;
+uniform sampler2D Camera2;
+uniform sampler2D Camera3;
+uniform sampler2D StitchUv;
+uniform sampler2D StitchSelection;
+uniform vec2 MaxUV[ 4 ];
+
+in vec2 uv;
+out vec4 fragColor;
+
+// The inputs have no mip levels, and the camera a pixel samples changes from one pixel to the next.
+vec4 fetch( int camera, vec2 cameraUv )
+{
+	if( camera == 0 )
+		return textureLod( Camera0, cameraUv * MaxUV[ 0 ], 0.0 );
+	else if( camera == 1 )
+		return textureLod( Camera1, cameraUv * MaxUV[ 1 ], 0.0 );
+	else if( camera == 2 )
+		return textureLod( Camera2, cameraUv * MaxUV[ 2 ], 0.0 );
+	return textureLod( Camera3, cameraUv * MaxUV[ 3 ], 0.0 );
+}
+
+void main()
+{
+	vec4 selection = texture( StitchSelection, uv );
+	int first      = int( selection.r * 255.0 + 0.5 );
+	if( first >= 4 )
+	{
+		fragColor = vec4( 0.0, 0.0, 0.0, 0.0 );
+		return;
+	}
+	vec4 cameraUv = texture( StitchUv, uv );
+	fragColor     = fetch( first, cameraUv.xy );
+	if( selection.b > 0.0 )
+		fragColor = mix( fragColor, fetch( int( selection.g * 255.0 + 0.5 ), cameraUv.zw ), selection.b );
 }
 )";
@@ -0,0 +1,71 @@
+#pragma once
+#include <map>
+#include <memory>
+#include <FFGLSDK.h>
+#include "Shader.h"
+#include "FrameConstantsBuffer.h"
+#include "InverseMirrorTexture.h"
+#include "CubeFacesTexture.h"
+
+// Per plugin instance cache of the specialized reprojection programs, shared by both plugins.
+// A program is compiled the first time its (input, output, stereo, precision, warp mesh) combination is asked for and
+// kept until Release(), so flipping an option back and forth never recompiles. Its sampler and FrameConstants block are
+// bound once at that point, which leaves nothing to look up by name in ProcessOpenGL.
+class ShaderCache
+{
+public:
+	explicit ShaderCache( const char* vertexShaderCode ) :
+		vertexShaderCode( vertexShaderCode )
+	{
+	}
+
+	// Returns the program for this combination, compiling it on first use. Returns nullptr if it fails to compile, which is
+	// only tried once per combination until Release().
+	// warpMesh selects the variant for WarpMesh's interpolated cells, which pairs with _meshVertexShaderCode.
+	ffglex::FFGLShader* Get( int inputProjection, int outputProjection, int stereo, int precision, bool warpMesh = false )
+	{
+		int key = ( ( ( inputProjection * 16 + outputProjection ) * 4 + stereo ) * 2 + precision ) * 2 + ( warpMesh ? 1 : 0 );
+		auto it = shaders.find( key );
+		if( it != shaders.end() )
+			return it->second.get();
+
+		std::unique_ptr< ffglex::FFGLShader > shader( new ffglex::FFGLShader() );
+		if( !shader->Compile( warpMesh ? _meshVertexShaderCode : vertexShaderCode,
+							  buildFragmentShader( inputProjection, outputProjection, stereo, precision, warpMesh ).c_str() ) )
+		{
+			// The source only depends on the key, so a retry would fail the same way every frame: remember the failure.
+			shader->FreeGLResources();
+			shaders[ key ] = nullptr;
+			return nullptr;
+		}
+		GLuint program    = shader->GetGLID();
+		GLuint blockIndex = glGetUniformBlockIndex( program, "FrameConstants" );
+		if( blockIndex != GL_INVALID_INDEX )
+			glUniformBlockBinding( program, blockIndex, FrameConstantsBuffer::BINDING );
+		ffglex::ScopedShaderBinding shaderBinding( program );
+		glUniform1i( shader->FindUniform( "InputTexture" ), 0 );
+		// Only the mirror dome input has it, see InverseMirrorTexture.h.
+		GLint inverseMirrorLocation = shader->FindUniform( "InverseMirrorTexture" );
+		if( inverseMirrorLocation >= 0 )
+			glUniform1i( inverseMirrorLocation, InverseMirrorTexture::UNIT );
+		// Nor does any but the cube faces input have this one, see CubeFacesTexture.h.
+		GLint cubeFacesLocation = shader->FindUniform( "InputCubeFaces" );
+		if( cubeFacesLocation >= 0 )
+			glUniform1i( cubeFacesLocation, CubeFacesTexture::UNIT );
+		return ( shaders[ key ] = std::move( shader ) ).get();
+	}
+
+	void Release()
+	{
+		for( auto& shader : shaders )
+		{
+			if( shader.second )
+				shader.second->FreeGLResources();
+		}
+		shaders.clear();
+	}
+
+private:
+	const char* vertexShaderCode;
+	std::map< int, std::unique_ptr< ffglex::FFGLShader > > shaders;
+};
@@ -0,0 +1,164 @@
+#pragma once
+#include <algorithm>
+#include <memory>
+#include <vector>
+#include <FFGLSDK.h>
+#include "../Engine/TileCoverage.h"
+
+// GL side of tile classification, shared by both plugins.
+// Holds a triangle list over the output tiles classifyTiles() did not find Empty, so the reprojection shader only runs
+// there and a clear takes care of the rest. The tiles are reclassified when the mapping or the viewport changes, but
+// only once the new mapping held still for a frame: while a slider is dragged every frame has a mapping of its own and
+// classifying each of them would cost more than it saves. The classification runs on an AsyncClassifier, so
+// ProcessOpenGL never waits for it: frames draw the full screen quad until the coverage of their mapping is ready.
+class TileMesh
+{
+public:
+	static const int TILE_SIZE = 64;//!< Output pixels per tile edge
+
+	bool Initialise()
+	{
+		glGenVertexArrays( 1, &vaoId );
+		glGenBuffers( 1, &vboId );
+		if( vaoId == 0 || vboId == 0 )
+			return false;
+		ffglex::ScopedVAOBinding vaoBinding( vaoId );
+		ffglex::ScopedVBOBinding vboBinding( vboId );
+		// The vertex shader's inputs: vPosition, whose z and w default to 0 and 1, and vUV, interleaved.
+		glEnableVertexAttribArray( 0 );
+		glVertexAttribPointer( 0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof( float ), nullptr );
+		glEnableVertexAttribArray( 1 );
+		glVertexAttribPointer( 1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof( float ), reinterpret_cast< const void* >( 2 * sizeof( float ) ) );
+		classifier.reset( new reprojection::AsyncClassifier( TILE_SIZE, reprojection::detectSimdLevel(), CLASSIFY_THREADS ) );
+		return true;
+	}
+	void Release()
+	{
+		classifier.reset();
+		if( vboId != 0 )
+			glDeleteBuffers( 1, &vboId );
+		if( vaoId != 0 )
+			glDeleteVertexArrays( 1, &vaoId );
+		vboId     = 0;
+		vaoId     = 0;
+		built     = false;
+		pending   = false;
+		requested = false;
+	}
+
+	// Asks for the coverage of the mapping and the output size once they differ from the last build and held still since
+	// the previous call, and uploads the mesh of the newest finished coverage. Returns true when Draw() is up to date and
+	// skips at least one tile, otherwise the caller should draw its full screen quad.
+	bool Update( const reprojection::Uniforms& uniforms, int width, int height )
+	{
+		if( !matches( builtUniforms, builtWidth, builtHeight, uniforms, width, height ) &&
+			!( requested && matches( requestedUniforms, requestedWidth, requestedHeight, uniforms, width, height ) ) )
+		{
+			bool settled    = pending && matches( pendingUniforms, pendingWidth, pendingHeight, uniforms, width, height );
+			pendingUniforms = uniforms;
+			pendingWidth    = width;
+			pendingHeight   = height;
+			pending         = true;
+			if( settled )
+			{
+				classifier->request( uniforms, width, height );
+				requestedUniforms = uniforms;
+				requestedWidth    = width;
+				requestedHeight   = height;
+				requested         = true;
+			}
+		}
+
+		if( classifier->take( coverage ) )
+			build();
+		return built && skipsTiles && matches( builtUniforms, builtWidth, builtHeight, uniforms, width, height );
+	}
+
+	// Clears the bound framebuffer to transparent and draws the tiles that are not Empty with the bound program.
+	void Draw() const
+	{
+		glClearColor( 0.0f, 0.0f, 0.0f, 0.0f );
+		glClear( GL_COLOR_BUFFER_BIT );
+		if( vertexCount == 0 )
+			return;
+		ffglex::ScopedVAOBinding vaoBinding( vaoId );
+		glDrawArrays( GL_TRIANGLES, 0, vertexCount );
+	}
+
+private:
+	// Threads per instance's classification, the classifier's worker included, kept few for the same reason as
+	// RemapLut::BAKE_THREADS.
+	static const int CLASSIFY_THREADS = 2;
+
+	static bool matches( const reprojection::Uniforms& a, int aWidth, int aHeight, const reprojection::Uniforms& b, int bWidth, int bHeight )
+	{
+		return aWidth == bWidth && aHeight == bHeight && reprojection::sameMapping( a, b );
+	}
+
+	// Uploads one quad per horizontal run of tiles of coverage that are not Empty, in clip space and output uv.
+	void build()
+	{
+		builtUniforms = coverage.uniforms;
+		builtWidth    = coverage.width;
+		builtHeight   = coverage.height;
+		built         = true;
+		skipsTiles    = coverage.count( reprojection::TileClass::Empty ) > 0;
+		if( !skipsTiles )
+			return;
+
+		const int width  = coverage.width;
+		const int height = coverage.height;
+		vertices.clear();
+		auto vertex = [&]( int x, int y ) {
+			float u = float( x ) / float( width ), v = float( y ) / float( height );
+			vertices.insert( vertices.end(), { u * 2.0f - 1.0f, v * 2.0f - 1.0f, u, v } );
+		};
+		for( int row = 0; row < coverage.rows; ++row )
+		{
+			for( int column = 0; column < coverage.columns; )
+			{
+				if( coverage.at( column, row ) == reprojection::TileClass::Empty )
+				{
+					++column;
+					continue;
+				}
+				int end = column;
+				while( end < coverage.columns && coverage.at( end, row ) != reprojection::TileClass::Empty )
+					++end;
+				int x0 = column * TILE_SIZE, x1 = std::min( end * TILE_SIZE, width );
+				int y0 = row * TILE_SIZE, y1 = std::min( ( row + 1 ) * TILE_SIZE, height );
+				vertex( x0, y0 );
+				vertex( x1, y0 );
+				vertex( x1, y1 );
+				vertex( x0, y0 );
+				vertex( x1, y1 );
+				vertex( x0, y1 );
+				column = end;
+			}
+		}
+		vertexCount = GLsizei( vertices.size() / 4 );
+
+		ffglex::ScopedVBOBinding vboBinding( vboId );
+		glBufferData( GL_ARRAY_BUFFER, GLsizeiptr( vertices.size() * sizeof( float ) ), vertices.data(), GL_STATIC_DRAW );
+	}
+
+	GLuint vaoId        = 0;
+	GLuint vboId        = 0;//!< vertices
+	GLsizei vertexCount = 0;
+	std::vector< float > vertices;//!< x, y, u, v per vertex, two triangles per run of tiles
+	reprojection::TileCoverage coverage;//!< The last coverage taken from classifier
+	std::unique_ptr< reprojection::AsyncClassifier > classifier;//!< Lives from Initialise() to Release()
+	reprojection::Uniforms builtUniforms;//!< Mapping of the mesh, valid while built
+	int builtWidth  = 0;
+	int builtHeight = 0;
+	bool built      = false;
+	bool skipsTiles = false;//!< coverage has Empty tiles, otherwise the full screen quad is just as good
+	reprojection::Uniforms pendingUniforms;//!< Mapping of the previous Update(), requested once a call repeats it
+	int pendingWidth  = 0;
+	int pendingHeight = 0;
+	bool pending      = false;
+	reprojection::Uniforms requestedUniforms;//!< Mapping of the last request to classifier
+	int requestedWidth  = 0;
+	int requestedHeight = 0;
+	bool requested      = false;
+};
@@ -0,0 +1,211 @@
+#pragma once
+#include <vector>
+#include <FFGLSDK.h>
+#include "../Engine/AdaptiveMesh.h"
+#include "../Engine/BourkeMesh.h"
+#include "../Engine/RayTable.h"
+
+// GL side of the adaptive warp mesh, see Engine/AdaptiveMesh.h.
+// The Interpolated cells are drawn as triangles carrying the unrotated output direction at their corners, with the
+// WARP_MESH program, so the output projection only runs at the vertices. The Exact cells along the edges of the
+// visible area are drawn with the regular program, and a clear takes care of the Empty ones. The mesh does not depend
+// on the rotation, so it is only rebuilt when an output parameter, the output size or the tolerance changes, and like
+// TileMesh only once that change held still for a frame.
+// A mesh from a file, see Engine/BourkeMesh.h, replaces the adaptive one for the mirror dome output once Import()ed:
+// its nodes' dome master coordinates become the directions and their intensity scales the color.
+class WarpMesh
+{
+public:
+	bool Initialise()
+	{
+		glGenVertexArrays( 1, &vaoId );
+		glGenBuffers( 1, &vboId );
+		if( vaoId == 0 || vboId == 0 )
+			return false;
+		ffglex::ScopedVAOBinding vaoBinding( vaoId );
+		ffglex::ScopedVBOBinding vboBinding( vboId );
+		// vPosition, vUV, vDir and vIntensity of _meshVertexShaderCode, interleaved. The plugins' vertex shader only reads the first two.
+		const GLsizei stride = FLOATS_PER_VERTEX * sizeof( float );
+		glEnableVertexAttribArray( 0 );
+		glVertexAttribPointer( 0, 2, GL_FLOAT, GL_FALSE, stride, nullptr );
+		glEnableVertexAttribArray( 1 );
+		glVertexAttribPointer( 1, 2, GL_FLOAT, GL_FALSE, stride, reinterpret_cast< const void* >( 2 * sizeof( float ) ) );
+		glEnableVertexAttribArray( 2 );
+		glVertexAttribPointer( 2, 3, GL_FLOAT, GL_FALSE, stride, reinterpret_cast< const void* >( 4 * sizeof( float ) ) );
+		glEnableVertexAttribArray( 3 );
+		glVertexAttribPointer( 3, 1, GL_FLOAT, GL_FALSE, stride, reinterpret_cast< const void* >( 7 * sizeof( float ) ) );
+		return true;
+	}
+	void Release()
+	{
+		if( vboId != 0 )
+			glDeleteBuffers( 1, &vboId );
+		if( vaoId != 0 )
+			glDeleteVertexArrays( 1, &vaoId );
+		vboId         = 0;
+		vaoId         = 0;
+		built         = false;
+		pending       = false;
+		builtImported = false;
+	}
+
+	// Draws imported from now on whenever the output projection is the mirror dome, until ClearImport().
+	void Import( const reprojection::BourkeMesh& mesh )
+	{
+		imported      = mesh;
+		hasImport     = true;
+		builtImported = false;
+	}
+	void ClearImport()
+	{
+		hasImport     = false;
+		builtImported = false;
+	}
+	bool HasImport() const { return hasImport; }
+
+	// Rebuilds and uploads the mesh if the output half of the mapping, the output size or the tolerance differs from the
+	// last build and held still since the previous call. Returns true when Draw() is up to date, otherwise the caller
+	// should draw per pixel.
+	bool Update( const reprojection::Uniforms& uniforms, int width, int height, double toleranceRadians )
+	{
+		if( hasImport && uniforms.outputProjection == reprojection::MIRROR_DOME )
+		{
+			if( !builtImported || importedStereo != uniforms.stereo )
+				uploadImported( uniforms.stereo );
+			return true;
+		}
+		if( builtImported )
+			built = builtImported = false;// The buffer holds the imported mesh
+		if( built && mesh.width == width && mesh.height == height && mesh.tolerance == toleranceRadians &&
+			reprojection::sameRays( uniforms, mesh.uniforms ) )
+			return true;
+
+		bool settled = pending && pendingWidth == width && pendingHeight == height && pendingTolerance == toleranceRadians &&
+					   reprojection::sameRays( uniforms, pendingUniforms );
+		pendingUniforms  = uniforms;
+		pendingWidth     = width;
+		pendingHeight    = height;
+		pendingTolerance = toleranceRadians;
+		pending          = true;
+		if( !settled )
+			return false;
+
+		reprojection::buildAdaptiveMesh( uniforms, width, height, toleranceRadians, mesh );
+		built = true;
+
+		// Each leaf once per eye, the Interpolated ones first so each program draws one range.
+		vertices.clear();
+		int eyes = uniforms.stereo == reprojection::STEREO_NONE ? 1 : 2;
+		auto appendCells = [&]( reprojection::MeshCellKind kind ) {
+			for( const reprojection::MeshCell& cell : mesh.cells )
+			{
+				if( cell.kind != kind )
+					continue;
+				const reprojection::vec2 corners[ 4 ] = { cell.uv0, reprojection::vec2( cell.uv1.x, cell.uv0.y ), cell.uv1,
+														  reprojection::vec2( cell.uv0.x, cell.uv1.y ) };
+				for( int eye = 0; eye < eyes; ++eye )
+				{
+					for( int corner : { 0, 1, 2, 0, 2, 3 } )
+						vertex( uniforms.stereo, eye, corners[ corner ], cell.corners[ corner ], 1.0f );
+				}
+			}
+		};
+		appendCells( reprojection::MeshCellKind::Interpolated );
+		interpolatedCount = GLsizei( vertices.size() / FLOATS_PER_VERTEX );
+		appendCells( reprojection::MeshCellKind::Exact );
+		exactCount = GLsizei( vertices.size() / FLOATS_PER_VERTEX ) - interpolatedCount;
+
+		upload();
+		return true;
+	}
+
+	// Clears the bound framebuffer to transparent, then draws the Interpolated cells with meshProgram, the WARP_MESH
+	// variant, and the Exact ones with pixelProgram. Both read the texture and FrameConstants the caller bound.
+	void Draw( GLuint meshProgram, GLuint pixelProgram ) const
+	{
+		glClearColor( 0.0f, 0.0f, 0.0f, 0.0f );
+		glClear( GL_COLOR_BUFFER_BIT );
+		ffglex::ScopedVAOBinding vaoBinding( vaoId );
+		if( interpolatedCount != 0 )
+		{
+			ffglex::ScopedShaderBinding shaderBinding( meshProgram );
+			glDrawArrays( GL_TRIANGLES, 0, interpolatedCount );
+		}
+		if( exactCount != 0 )
+		{
+			ffglex::ScopedShaderBinding shaderBinding( pixelProgram );
+			glDrawArrays( GL_TRIANGLES, interpolatedCount, exactCount );
+		}
+	}
+
+private:
+	static const int FLOATS_PER_VERTEX = 8;
+
+	// Two triangles per grid cell of the imported mesh whose four nodes all have a positive intensity, once per eye.
+	void uploadImported( int stereo )
+	{
+		vertices.clear();
+		const int columns  = imported.columns;
+		const float aspect = imported.aspect();
+		int eyes           = stereo == reprojection::STEREO_NONE ? 1 : 2;
+		for( int row = 0; row + 1 < imported.rows; ++row )
+		{
+			for( int column = 0; column + 1 < columns; ++column )
+			{
+				const reprojection::BourkeMeshNode* corners[ 4 ] = { &imported.nodes[ row * columns + column ], &imported.nodes[ row * columns + column + 1 ],
+																	 &imported.nodes[ ( row + 1 ) * columns + column + 1 ],
+																	 &imported.nodes[ ( row + 1 ) * columns + column ] };
+				if( corners[ 0 ]->intensity < 0.0f || corners[ 1 ]->intensity < 0.0f || corners[ 2 ]->intensity < 0.0f || corners[ 3 ]->intensity < 0.0f )
+					continue;
+				for( int eye = 0; eye < eyes; ++eye )
+				{
+					for( int corner : { 0, 1, 2, 0, 2, 3 } )
+					{
+						const reprojection::BourkeMeshNode& node = *corners[ corner ];
+						vertex( stereo, eye, reprojection::vec2( ( node.x / aspect + 1.0f ) * 0.5f, ( node.y + 1.0f ) * 0.5f ),
+								reprojection::domeMasterUvToDir( reprojection::vec2( node.u, node.v ) ), node.intensity );
+					}
+				}
+			}
+		}
+		interpolatedCount = GLsizei( vertices.size() / FLOATS_PER_VERTEX );
+		exactCount        = 0;
+		upload();
+		builtImported  = true;
+		importedStereo = stereo;
+	}
+
+	void upload()
+	{
+		ffglex::ScopedVBOBinding vboBinding( vboId );
+		glBufferData( GL_ARRAY_BUFFER, GLsizeiptr( vertices.size() * sizeof( float ) ), vertices.data(), GL_STATIC_DRAW );
+	}
+
+	// Appends the vertex at the stretched uv local_uv of eye, placed in that eye's half of the frame.
+	void vertex( int stereo, int eye, reprojection::vec2 local_uv, reprojection::vec3 dir, float intensity )
+	{
+		reprojection::vec2 uv = local_uv;
+		if( stereo == reprojection::STEREO_OVER_UNDER )
+			uv.y = ( local_uv.y + float( eye ) ) * 0.5f;
+		else if( stereo == reprojection::STEREO_SIDE_BY_SIDE )
+			uv.x = ( local_uv.x + float( eye ) ) * 0.5f;
+		vertices.insert( vertices.end(), { uv.x * 2.0f - 1.0f, uv.y * 2.0f - 1.0f, uv.x, uv.y, dir.x, dir.y, dir.z, intensity } );
+	}
+
+	GLuint vaoId              = 0;
+	GLuint vboId              = 0;//!< vertices
+	GLsizei interpolatedCount = 0;//!< Vertices of the Interpolated cells, first in vboId
+	GLsizei exactCount        = 0;//!< Vertices of the Exact cells, after them
+	std::vector< float > vertices;//!< x, y, u, v, direction, intensity per vertex, two triangles per cell and eye
+	reprojection::AdaptiveMesh mesh;
+	bool built = false;
+	reprojection::BourkeMesh imported;
+	bool hasImport     = false;
+	bool builtImported = false;//!< vboId holds imported for importedStereo, not mesh
+	int importedStereo = reprojection::STEREO_NONE;
+	reprojection::Uniforms pendingUniforms;//!< Mapping of the previous Update(), built once a call repeats it
+	int pendingWidth        = 0;
+	int pendingHeight       = 0;
+	double pendingTolerance = 0.0;
+	bool pending            = false;
+};
@@ -0,0 +1,66 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <utility>
+
+namespace reprojection
+{
+// A fixed capacity FIFO between two pipeline stages. push() blocks while the queue is full and pop() while it is empty,
+// so a stage that runs ahead stalls instead of buffering the whole stream.
+// close() wakes both sides: push() fails from then on, pop() still hands out what is left and fails once it is empty.
+template< class T >
+class BoundedQueue
+{
+public:
+	explicit BoundedQueue( size_t capacity ) :
+		capacity( capacity )
+	{
+	}
+	BoundedQueue( const BoundedQueue& ) = delete;
+	BoundedQueue& operator=( const BoundedQueue& ) = delete;
+
+	bool push( T item )
+	{
+		std::unique_lock< std::mutex > lock( mutex );
+		notFull.wait( lock, [this] { return closed || items.size() < capacity; } );
+		if( closed )
+			return false;
+		items.push_back( std::move( item ) );
+		notEmpty.notify_one();
+		return true;
+	}
+
+	bool pop( T& item )
+	{
+		std::unique_lock< std::mutex > lock( mutex );
+		notEmpty.wait( lock, [this] { return closed || !items.empty(); } );
+		if( items.empty() )
+			return false;
+		item = std::move( items.front() );
+		items.pop_front();
+		notFull.notify_one();
+		return true;
+	}
+
+	void close()
+	{
+		{
+			std::lock_guard< std::mutex > lock( mutex );
+			closed = true;
+		}
+		notFull.notify_all();
+		notEmpty.notify_all();
+	}
+
+private:
+	const size_t capacity;
+	std::mutex mutex;
+	std::condition_variable notFull;
+	std::condition_variable notEmpty;
+	std::deque< T > items;
+	bool closed = false;
+};
+
+}// namespace reprojection
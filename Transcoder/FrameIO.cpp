@@ -0,0 +1,280 @@
+#include "FrameIO.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+namespace reprojection
+{
+namespace
+{
+const char Y4M_MAGIC[]  = "YUV4MPEG2";
+const size_t MAGIC_SIZE = sizeof( Y4M_MAGIC ) - 1;
+const size_t MAX_LINE   = 4096;
+
+// How many luma pixels share a chroma sample, horizontally and vertically.
+void chromaStep( ChromaFormat chroma, int& stepX, int& stepY )
+{
+	stepX = chroma == ChromaFormat::C420 || chroma == ChromaFormat::C422 ? 2 : 1;
+	stepY = chroma == ChromaFormat::C420 ? 2 : 1;
+}
+
+size_t lumaSize( const StreamInfo& info )
+{
+	return size_t( info.width ) * size_t( info.height );
+}
+
+// The size of one chroma plane, 0 for mono.
+size_t chromaSize( const StreamInfo& info, int& chromaWidth, int& chromaHeight )
+{
+	int stepX, stepY;
+	chromaStep( info.chroma, stepX, stepY );
+	chromaWidth  = ( info.width + stepX - 1 ) / stepX;
+	chromaHeight = ( info.height + stepY - 1 ) / stepY;
+	return info.chroma == ChromaFormat::Mono ? 0 : size_t( chromaWidth ) * size_t( chromaHeight );
+}
+
+bool parseChroma( const std::string& value, ChromaFormat& chroma )
+{
+	if( value == "420" || value == "420jpeg" || value == "420paldv" || value == "420mpeg2" )
+		chroma = ChromaFormat::C420;
+	else if( value == "422" )
+		chroma = ChromaFormat::C422;
+	else if( value == "444" )
+		chroma = ChromaFormat::C444;
+	else if( value == "mono" )
+		chroma = ChromaFormat::Mono;
+	else
+		return false;
+	return true;
+}
+
+// Parses the tags after YUV4MPEG2. W, H and C are read, everything is kept in info.tags except W and H.
+bool parseHeader( const std::string& line, StreamInfo& info, std::string& error )
+{
+	info.format = StreamFormat::Y4M;
+	info.width  = 0;
+	info.height = 0;
+	info.chroma = ChromaFormat::C420;// What the format assumes without a C tag
+	info.tags.clear();
+	size_t start = MAGIC_SIZE;
+	while( start < line.size() )
+	{
+		size_t end = line.find( ' ', start + 1 );
+		if( end == std::string::npos )
+			end = line.size();
+		std::string tag = line.substr( start + 1, end - start - 1 );
+		start           = end;
+		if( tag.empty() )
+			continue;
+		std::string value = tag.substr( 1 );
+		if( tag[ 0 ] == 'W' )
+			info.width = std::atoi( value.c_str() );
+		else if( tag[ 0 ] == 'H' )
+			info.height = std::atoi( value.c_str() );
+		else
+		{
+			if( tag[ 0 ] == 'C' && !parseChroma( value, info.chroma ) )
+			{
+				error = "Unsupported Y4M color space C" + value + ", only 8 bit 420, 422, 444 and mono are";
+				return false;
+			}
+			if( tag == "XCOLORRANGE=FULL" )
+				info.fullRange = true;
+			info.tags += " " + tag;
+		}
+	}
+	if( info.width <= 0 || info.height <= 0 )
+	{
+		error = "Y4M header without a valid frame size";
+		return false;
+	}
+	return true;
+}
+
+std::string systemError( const char* what )
+{
+	return std::string( what ) + ": " + std::strerror( errno );
+}
+}// namespace
+
+bool FrameReader::open( FILE* stream, StreamInfo& streamInfo, std::string& error )
+{
+	file = stream;
+	pending.resize( MAGIC_SIZE );
+	pending.resize( std::fread( &pending[ 0 ], 1, MAGIC_SIZE, file ) );
+	if( pending == Y4M_MAGIC )
+	{
+		std::string header;
+		pending.clear();
+		if( !readLine( header, error ) || !parseHeader( Y4M_MAGIC + header, streamInfo, error ) )
+			return false;
+	}
+	else
+	{
+		streamInfo.format = StreamFormat::RawRGBA;
+		if( streamInfo.width <= 0 || streamInfo.height <= 0 )
+		{
+			error = "Raw RGBA input needs a frame size";
+			return false;
+		}
+	}
+	info = streamInfo;
+	return true;
+}
+
+size_t FrameReader::readBytes( void* data, size_t size )
+{
+	size_t fromPending = std::min( size, pending.size() );
+	std::memcpy( data, pending.data(), fromPending );
+	pending.erase( 0, fromPending );
+	return fromPending + std::fread( static_cast< uint8_t* >( data ) + fromPending, 1, size - fromPending, file );
+}
+
+// Reads up to and without the next '\n'. An empty stream gives false with an empty error.
+bool FrameReader::readLine( std::string& line, std::string& error )
+{
+	line.clear();
+	for( int c = std::fgetc( file ); c != '\n'; c = std::fgetc( file ) )
+	{
+		if( c == EOF )
+		{
+			if( !line.empty() )
+				error = "Y4M stream ends in the middle of a header";
+			return false;
+		}
+		if( line.size() == MAX_LINE )
+		{
+			error = "Y4M header longer than 4096 characters";
+			return false;
+		}
+		line += char( c );
+	}
+	return true;
+}
+
+bool FrameReader::read( Image& image, std::string& error )
+{
+	error.clear();
+	if( image.width != info.width || image.height != info.height || image.format != PixelFormat::RGBA8 )
+		image = Image( info.width, info.height, PixelFormat::RGBA8 );
+
+	if( info.format == StreamFormat::RawRGBA )
+	{
+		for( int y = 0; y < info.height; ++y )
+		{
+			size_t read = readBytes( image.row( info.height - 1 - y ), image.rowBytes() );
+			if( read != image.rowBytes() )
+			{
+				if( y != 0 || read != 0 )
+					error = "Raw RGBA stream ends in the middle of a frame";
+				return false;
+			}
+		}
+		return true;
+	}
+
+	std::string frameHeader;
+	if( !readLine( frameHeader, error ) )
+		return false;
+	if( frameHeader.compare( 0, 5, "FRAME" ) != 0 )
+	{
+		error = "Y4M frame without a FRAME header";
+		return false;
+	}
+	int chromaWidth, chromaHeight, stepX, stepY;
+	size_t planeSize = chromaSize( info, chromaWidth, chromaHeight );
+	chromaStep( info.chroma, stepX, stepY );
+	buffer.resize( lumaSize( info ) + 2 * planeSize );
+	if( readBytes( buffer.data(), buffer.size() ) != buffer.size() )
+	{
+		error = "Y4M stream ends in the middle of a frame";
+		return false;
+	}
+
+	const uint8_t* luma = buffer.data();
+	const uint8_t* cb   = luma + lumaSize( info );
+	const uint8_t* cr   = cb + planeSize;
+	for( int y = 0; y < info.height; ++y )
+	{
+		uint8_t* out           = image.row( info.height - 1 - y );
+		const uint8_t* lumaRow = luma + size_t( y ) * size_t( info.width );
+		size_t chromaRow       = size_t( y / stepY ) * size_t( chromaWidth );
+		for( int x = 0; x < info.width; ++x, out += 4 )
+		{
+			out[ 0 ] = lumaRow[ x ];
+			out[ 1 ] = planeSize != 0 ? cb[ chromaRow + size_t( x / stepX ) ] : 128;
+			out[ 2 ] = planeSize != 0 ? cr[ chromaRow + size_t( x / stepX ) ] : 128;
+			out[ 3 ] = 255;
+		}
+	}
+	return true;
+}
+
+bool FrameWriter::open( FILE* stream, const StreamInfo& streamInfo, std::string& error )
+{
+	file = stream;
+	info = streamInfo;
+	if( info.format == StreamFormat::Y4M && std::fprintf( file, "%s W%d H%d%s\n", Y4M_MAGIC, info.width, info.height, info.tags.c_str() ) < 0 )
+	{
+		error = systemError( "Could not write the Y4M header" );
+		return false;
+	}
+	return true;
+}
+
+bool FrameWriter::write( const Image& image, std::string& error )
+{
+	if( info.format == StreamFormat::RawRGBA )
+	{
+		for( int y = 0; y < info.height; ++y )
+		{
+			if( std::fwrite( image.row( info.height - 1 - y ), 1, image.rowBytes(), file ) != image.rowBytes() )
+			{
+				error = systemError( "Could not write a frame" );
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// Transparent output pixels are laid over black, which is code 16 for limited range luma.
+	const int black[ 3 ] = { info.fullRange ? 0 : 16, 128, 128 };
+	auto channel         = [&]( int x, int y, int c ) {
+		const uint8_t* p = image.row( info.height - 1 - y ) + size_t( x ) * 4;
+		return ( p[ c ] * p[ 3 ] + black[ c ] * ( 255 - p[ 3 ] ) + 127 ) / 255;
+	};
+
+	int chromaWidth, chromaHeight, stepX, stepY;
+	size_t planeSize = chromaSize( info, chromaWidth, chromaHeight );
+	chromaStep( info.chroma, stepX, stepY );
+	buffer.resize( lumaSize( info ) + 2 * planeSize );
+	uint8_t* luma = buffer.data();
+	for( int y = 0; y < info.height; ++y )
+		for( int x = 0; x < info.width; ++x )
+			*luma++ = uint8_t( channel( x, y, 0 ) );
+	for( int c = 1; c <= 2 && planeSize != 0; ++c )
+	{
+		uint8_t* chroma = buffer.data() + lumaSize( info ) + ( c - 1 ) * planeSize;
+		for( int cy = 0; cy < chromaHeight; ++cy )
+		{
+			for( int cx = 0; cx < chromaWidth; ++cx )
+			{
+				// Average the block of luma pixels this sample covers, odd sizes give a smaller last block.
+				int sum = 0, count = 0;
+				for( int y = cy * stepY; y < std::min( cy * stepY + stepY, info.height ); ++y )
+					for( int x = cx * stepX; x < std::min( cx * stepX + stepX, info.width ); ++x, ++count )
+						sum += channel( x, y, c );
+				*chroma++ = uint8_t( ( sum + count / 2 ) / count );
+			}
+		}
+	}
+	if( std::fputs( "FRAME\n", file ) < 0 || std::fwrite( buffer.data(), 1, buffer.size(), file ) != buffer.size() )
+	{
+		error = systemError( "Could not write a frame" );
+		return false;
+	}
+	return true;
+}
+
+}// namespace reprojection
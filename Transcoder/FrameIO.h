@@ -0,0 +1,72 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "Image.h"
+
+// Frame sequence streams for ReprojectionTranscode: headerless RGBA8 frames, or YUV4MPEG2 (.y4m) with 8 bit planes.
+// Both store rows top-down, Image stores them bottom-up like a GL texture, so rows are flipped on the way in and out.
+// Y4M frames travel through the engine as RGBA8 images holding ( Y, Cb, Cr, 255 ) at full resolution, so the
+// reprojection never converts colors; chroma is replicated on read and averaged back on write.
+namespace reprojection
+{
+enum class StreamFormat
+{
+	RawRGBA,//!< width x height x 4 bytes per frame, no header
+	Y4M
+};
+
+enum class ChromaFormat
+{
+	C420,//!< Half width, half height chroma planes
+	C422,//!< Half width chroma planes
+	C444,
+	Mono //!< Luma only
+};
+
+struct StreamInfo
+{
+	StreamFormat format = StreamFormat::RawRGBA;
+	int width           = 0;
+	int height          = 0;
+	ChromaFormat chroma = ChromaFormat::C420;
+	bool fullRange      = false;//!< XCOLORRANGE=FULL, decides what black is in Y4M output
+	std::string tags;           //!< Y4M header tags other than W and H, each with its leading space, passed on to the output
+};
+
+class FrameReader
+{
+public:
+	// Takes the stream as Y4M when it starts with a YUV4MPEG2 header, which also sets info's size and chroma format.
+	// Otherwise it is raw RGBA8 and info.width / info.height must already hold the frame size.
+	bool open( FILE* file, StreamInfo& info, std::string& error );
+	// Reads the next frame into an RGBA8 image of the stream's size. Returns false at the end of the stream or on an
+	// error; error stays empty at a clean end.
+	bool read( Image& image, std::string& error );
+
+private:
+	size_t readBytes( void* data, size_t size );
+	bool readLine( std::string& line, std::string& error );
+
+	FILE* file = nullptr;
+	StreamInfo info;
+	std::string pending;//!< Bytes read while looking for a Y4M header that belong to the first raw frame
+	std::vector< uint8_t > buffer;
+};
+
+class FrameWriter
+{
+public:
+	// info describes the output: its format, size and, for Y4M, chroma format, range and header tags.
+	bool open( FILE* file, const StreamInfo& info, std::string& error );
+	// Writes an RGBA8 image of the stream's size. Transparent pixels become black in Y4M, which has no alpha.
+	bool write( const Image& image, std::string& error );
+
+private:
+	FILE* file = nullptr;
+	StreamInfo info;
+	std::vector< uint8_t > buffer;
+};
+
+}// namespace reprojection
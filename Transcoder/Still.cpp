@@ -0,0 +1,266 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include "Engine.h"
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+#ifdef __linux__
+#include <sys/resource.h>
+#endif
+
+// Out-of-core reprojection of a single still too big for memory, such as a 16K x 8K or larger equirectangular.
+// The source is memory mapped, ideally after converting it to the tiled layout of MappedImage with --tile-source, and
+// the output is rendered a band of rows at a time and written out as raw RGBA8 right away. Only the source pages a
+// band's mapping actually touches are ever read, and they are released before the next band, so memory use depends
+// on the band size rather than the image sizes.
+using namespace reprojection;
+
+namespace
+{
+struct Options
+{
+	std::string inputPath;
+	std::string outputPath;
+	std::string tiledPath;//!< Convert the raw input to a tiled file here first
+	int width        = 0;  //!< Raw RGBA input only, tiled files carry their own size
+	int height       = 0;
+	int outputWidth  = 0;//!< 0 keeps the input size
+	int outputHeight = 0;
+	int sourceTile   = 64;
+	int bandHeight   = 256;
+	Uniforms uniforms;
+	SimdLevel level = detectSimdLevel();
+	int threads     = 0;
+	int tileSize    = 64;
+};
+
+void printUsage()
+{
+	std::fprintf( stderr, "Usage: ReprojectionStill [options] --input PATH\n"
+						  "  --input PATH        tiled image, or raw RGBA8 with --size\n"
+						  "  --size WxH          size of raw RGBA8 input\n"
+						  "  --tile-source PATH  convert the raw input to a tiled image at PATH and render from that\n"
+						  "  --source-tile N     tile edge of --tile-source in pixels (default: 64)\n"
+						  "  --output PATH       raw RGBA8 output, rows top-down, - for stdout\n"
+						  "  --output-size WxH   output size (default: the input size)\n"
+						  "  --band N            output rows rendered and written at a time (default: 256)\n"
+						  "  --from NAME         %s (default: equi)\n"
+						  "  --to NAME           %s (default: equi)\n"
+						  "  --stereo NAME       mono, over-under or side-by-side (default: mono)\n"
+						  "  --pitch, --roll, --yaw DEGREES  rotation (default: 0)\n"
+						  "  --fov-in, --fov-out V           the plugins' fov In / fov Out slider, 0 to 1 (default: 0.5)\n"
+						  "  --precision NAME    exact or fast trig (default: exact)\n"
+						  "  --kernel NAME       scalar, avx2 or avx512 (default: the widest this CPU runs)\n"
+						  "  --threads N         render threads, 0 for every hardware thread (default: 0)\n"
+						  "  --tile N            tile edge in pixels (default: 64)\n",
+				  projectionNameList( true ).c_str(), projectionNameList( false ).c_str() );
+}
+
+bool parseName( const char* name, int count, const char* ( *nameOf )( int ), int& value )
+{
+	for( value = 0; value < count; ++value )
+	{
+		if( std::strcmp( name, nameOf( value ) ) == 0 )
+			return true;
+	}
+	return false;
+}
+
+bool parseSize( const char* value, int& width, int& height )
+{
+	return std::sscanf( value, "%dx%d", &width, &height ) == 2 && width > 0 && height > 0;
+}
+
+bool parseKernel( const char* name, SimdLevel& level )
+{
+	for( SimdLevel candidate : { SimdLevel::Scalar, SimdLevel::AVX2, SimdLevel::AVX512 } )
+	{
+		if( std::strcmp( name, simdLevelName( candidate ) ) == 0 && simdLevelSupported( candidate ) )
+		{
+			level = candidate;
+			return true;
+		}
+	}
+	return false;
+}
+
+bool parseOptions( int argc, char** argv, Options& options )
+{
+	Uniforms& uniforms = options.uniforms;
+	double degrees     = PI / 180.0;
+	for( int i = 1; i < argc; ++i )
+	{
+		const char* option = argv[ i ];
+		if( std::strcmp( option, "--help" ) == 0 )
+			return false;
+		if( i + 1 == argc )
+		{
+			std::fprintf( stderr, "Missing value for %s\n", option );
+			return false;
+		}
+		const char* value = argv[ ++i ];
+		bool valid        = true;
+		if( std::strcmp( option, "--input" ) == 0 )
+			options.inputPath = value;
+		else if( std::strcmp( option, "--size" ) == 0 )
+			valid = parseSize( value, options.width, options.height );
+		else if( std::strcmp( option, "--tile-source" ) == 0 )
+			options.tiledPath = value;
+		else if( std::strcmp( option, "--source-tile" ) == 0 )
+			valid = ( options.sourceTile = std::atoi( value ) ) > 0;
+		else if( std::strcmp( option, "--output" ) == 0 )
+			options.outputPath = value;
+		else if( std::strcmp( option, "--output-size" ) == 0 )
+			valid = parseSize( value, options.outputWidth, options.outputHeight );
+		else if( std::strcmp( option, "--band" ) == 0 )
+			valid = ( options.bandHeight = std::atoi( value ) ) > 0;
+		else if( std::strcmp( option, "--from" ) == 0 )
+			valid = parseProjection( value, true, uniforms.inputProjection );
+		else if( std::strcmp( option, "--to" ) == 0 )
+			valid = parseProjection( value, false, uniforms.outputProjection );
+		else if( std::strcmp( option, "--stereo" ) == 0 )
+			valid = parseName( value, STEREO_MODE_COUNT, stereoModeName, uniforms.stereo );
+		else if( std::strcmp( option, "--pitch" ) == 0 )
+			uniforms.rotation.x = float( std::atof( value ) * degrees );
+		else if( std::strcmp( option, "--roll" ) == 0 )
+			uniforms.rotation.y = float( std::atof( value ) * degrees );
+		else if( std::strcmp( option, "--yaw" ) == 0 )
+			uniforms.rotation.z = float( std::atof( value ) * degrees );
+		else if( std::strcmp( option, "--fov-in" ) == 0 )
+			uniforms.fovIn = float( std::atof( value ) * PI / 2.0 );// Same mapping as currentUniforms() in the plugins
+		else if( std::strcmp( option, "--fov-out" ) == 0 )
+			uniforms.fovOut = float( std::atof( value ) * PI / 2.0 );
+		else if( std::strcmp( option, "--precision" ) == 0 )
+			valid = parseName( value, PRECISION_MODE_COUNT, precisionModeName, uniforms.precision );
+		else if( std::strcmp( option, "--kernel" ) == 0 )
+			valid = parseKernel( value, options.level );
+		else if( std::strcmp( option, "--threads" ) == 0 )
+			valid = ( options.threads = std::atoi( value ) ) >= 0;
+		else if( std::strcmp( option, "--tile" ) == 0 )
+			valid = ( options.tileSize = std::atoi( value ) ) > 0;
+		else
+		{
+			std::fprintf( stderr, "Unknown option %s\n", option );
+			return false;
+		}
+		if( !valid )
+		{
+			std::fprintf( stderr, "Invalid value '%s' for %s\n", value, option );
+			return false;
+		}
+	}
+	return !options.inputPath.empty() && ( !options.outputPath.empty() || !options.tiledPath.empty() );
+}
+
+bool tileSource( const Options& options, std::string& error )
+{
+	FILE* raw   = std::fopen( options.inputPath.c_str(), "rb" );
+	FILE* tiled = raw != nullptr ? std::fopen( options.tiledPath.c_str(), "wb" ) : nullptr;
+	bool ok     = tiled != nullptr && options.width > 0 && writeTiledImage( raw, options.width, options.height, options.sourceTile, tiled, error );
+	if( tiled != nullptr && std::fclose( tiled ) != 0 && ok )
+	{
+		error = "Could not write " + options.tiledPath;
+		ok    = false;
+	}
+	if( raw != nullptr )
+		std::fclose( raw );
+	if( !ok && error.empty() )
+		error = options.width > 0 ? "Could not open " + ( raw == nullptr ? options.inputPath : options.tiledPath ) : "--tile-source needs --size";
+	return ok;
+}
+
+}// namespace
+
+int main( int argc, char** argv )
+{
+	Options options;
+	if( !parseOptions( argc, argv, options ) )
+	{
+		printUsage();
+		return 1;
+	}
+
+	std::string error;
+	auto start = std::chrono::steady_clock::now();
+	if( !options.tiledPath.empty() )
+	{
+		if( !tileSource( options, error ) )
+		{
+			std::fprintf( stderr, "%s\n", error.c_str() );
+			return 1;
+		}
+		std::fprintf( stderr, "Tiled %s into %s in %.2f s\n", options.inputPath.c_str(), options.tiledPath.c_str(),
+					  std::chrono::duration< double >( std::chrono::steady_clock::now() - start ).count() );
+		if( options.outputPath.empty() )
+			return 0;
+		options.inputPath = options.tiledPath;
+	}
+
+	MappedImage source;
+	if( !source.open( options.inputPath, options.width, options.height, error ) )
+	{
+		std::fprintf( stderr, "%s\n", error.c_str() );
+		return 1;
+	}
+	int width  = options.outputWidth > 0 ? options.outputWidth : source.width;
+	int height = options.outputWidth > 0 ? options.outputHeight : source.height;
+
+	FILE* output = nullptr;
+	if( options.outputPath == "-" )
+	{
+		output = stdout;
+#ifdef _WIN32
+		_setmode( _fileno( output ), _O_BINARY );
+#endif
+	}
+	else
+	{
+		output = std::fopen( options.outputPath.c_str(), "wb" );
+	}
+	if( output == nullptr )
+	{
+		std::fprintf( stderr, "Could not open %s\n", options.outputPath.c_str() );
+		return 1;
+	}
+
+	Uniforms uniforms = options.uniforms;
+	uniforms.width    = source.width;
+	uniforms.height   = source.height;
+	TileExecutor executor( options.threads, options.tileSize );
+	std::fprintf( stderr, "%dx%d %s (%dx%d tiles) -> %s %dx%d, %d row bands, %s kernel, %d threads\n", source.width, source.height,
+				  projectionName( uniforms.inputProjection ), source.tileWidth, source.tileHeight, projectionName( uniforms.outputProjection ), width,
+				  height, options.bandHeight, simdLevelName( options.level ), executor.threadCount() );
+
+	start   = std::chrono::steady_clock::now();
+	bool ok = renderBands( uniforms, source, width, height, options.bandHeight, executor, options.level, [&]( const Image& band ) {
+		// Bands are bottom-up like every Image, the file is top-down.
+		for( int y = band.height - 1; y >= 0; --y )
+		{
+			if( std::fwrite( band.row( y ), 1, band.rowBytes(), output ) != band.rowBytes() )
+				return false;
+		}
+		return true;
+	} );
+	ok = std::fflush( output ) == 0 && ok;
+	if( output != stdout )
+		ok = std::fclose( output ) == 0 && ok;
+	if( !ok )
+	{
+		std::fprintf( stderr, "Could not write %s\n", options.outputPath.c_str() );
+		return 1;
+	}
+
+	double seconds = std::chrono::duration< double >( std::chrono::steady_clock::now() - start ).count();
+	std::fprintf( stderr, "Rendered in %.2f s, %.1f Mpx/s", seconds, double( width ) * height / seconds / 1e6 );
+#ifdef __linux__
+	rusage usage;
+	if( getrusage( RUSAGE_SELF, &usage ) == 0 )
+		std::fprintf( stderr, ", peak RSS %.1f MiB", usage.ru_maxrss / 1024.0 );
+#endif
+	std::fprintf( stderr, "\n" );
+	return 0;
+}
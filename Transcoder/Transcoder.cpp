@@ -0,0 +1,335 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include "BoundedQueue.h"
+#include "FrameIO.h"
+#include "ProjectionRegistry.h"
+#include "RemapTable.h"
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+// Bulk reprojection of frame sequences with the CPU port of Shader.h.
+// The parameters are fixed for the whole stream, so the mapping is baked into a RemapTable once and every frame is a
+// single fetch per output pixel. Reading, reprojecting and writing run as three pipeline stages on their own threads,
+// handing frames over through bounded queues, so disk and compute overlap: the reader decodes the next frames and the
+// writer encodes the previous ones while every core of the TileExecutor reprojects the current one.
+using namespace reprojection;
+
+namespace
+{
+struct Options
+{
+	std::string inputPath  = "-";
+	std::string outputPath = "-";
+	int width              = 0;//!< Raw RGBA input only, Y4M carries its own size
+	int height             = 0;
+	int outputWidth        = 0;//!< 0 keeps the input size
+	int outputHeight       = 0;
+	Uniforms uniforms;
+	std::string kernel;//!< "reference" or simdLevelName( level ), empty picks the widest level the CPU supports
+	SimdLevel level = SimdLevel::Scalar;
+	int threads     = 0;
+	int tileSize    = 64;
+	int queueDepth  = 3;
+};
+
+// Time a stage spent working rather than waiting on a queue.
+struct StageClock
+{
+	template< class Work >
+	auto time( Work work ) -> decltype( work() )
+	{
+		auto start  = std::chrono::steady_clock::now();
+		auto result = work();
+		seconds += std::chrono::duration< double >( std::chrono::steady_clock::now() - start ).count();
+		return result;
+	}
+	double seconds = 0.0;
+};
+
+typedef std::unique_ptr< Image > FramePtr;
+
+void printUsage()
+{
+	std::fprintf( stderr, "Usage: ReprojectionTranscode [options]\n"
+						  "  --input PATH        raw RGBA8 or YUV4MPEG2 frames, - for stdin (default: -)\n"
+						  "  --output PATH       the reprojected frames in the input's format, - for stdout (default: -)\n"
+						  "  --size WxH          frame size of raw RGBA8 input, Y4M streams carry their own\n"
+						  "  --output-size WxH   frame size of the output (default: the input size)\n"
+						  "  --from NAME         %s (default: equi)\n"
+						  "  --to NAME           %s (default: equi)\n"
+						  "  --stereo NAME       mono, over-under or side-by-side (default: mono)\n"
+						  "  --pitch, --roll, --yaw DEGREES  rotation (default: 0)\n"
+						  "  --fov-in, --fov-out V           the plugins' fov In / fov Out slider, 0 to 1 (default: 0.5)\n"
+						  "  --precision NAME    exact or fast trig (default: exact)\n"
+						  "  --kernel NAME       reference, scalar, avx2 or avx512 kernel for the bake (default: the widest this CPU runs)\n"
+						  "  --threads N         reprojection threads, 0 for every hardware thread (default: 0)\n"
+						  "  --tile N            tile edge in pixels (default: 64)\n"
+						  "  --queue N           frames buffered between two stages (default: 3)\n",
+				  projectionNameList( true ).c_str(), projectionNameList( false ).c_str() );
+}
+
+bool parseName( const char* name, int count, const char* ( *nameOf )( int ), int& value )
+{
+	for( value = 0; value < count; ++value )
+	{
+		if( std::strcmp( name, nameOf( value ) ) == 0 )
+			return true;
+	}
+	return false;
+}
+
+bool parseSize( const char* value, int& width, int& height )
+{
+	return std::sscanf( value, "%dx%d", &width, &height ) == 2 && width > 0 && height > 0;
+}
+
+bool parseKernel( const char* name, Options& options )
+{
+	options.kernel = name;
+	if( options.kernel == "reference" )
+		return true;
+	for( SimdLevel level : { SimdLevel::Scalar, SimdLevel::AVX2, SimdLevel::AVX512 } )
+	{
+		if( options.kernel == simdLevelName( level ) )
+		{
+			if( !simdLevelSupported( level ) )
+				std::fprintf( stderr, "This CPU or build can't run the %s kernel\n", name );
+			options.level = level;
+			return simdLevelSupported( level );
+		}
+	}
+	return false;
+}
+
+bool parseOptions( int argc, char** argv, Options& options )
+{
+	Uniforms& uniforms = options.uniforms;
+	double degrees     = PI / 180.0;
+	for( int i = 1; i < argc; ++i )
+	{
+		const char* option = argv[ i ];
+		if( std::strcmp( option, "--help" ) == 0 )
+			return false;
+		if( i + 1 == argc )
+		{
+			std::fprintf( stderr, "Missing value for %s\n", option );
+			return false;
+		}
+		const char* value = argv[ ++i ];
+		bool valid        = true;
+		if( std::strcmp( option, "--input" ) == 0 )
+			options.inputPath = value;
+		else if( std::strcmp( option, "--output" ) == 0 )
+			options.outputPath = value;
+		else if( std::strcmp( option, "--size" ) == 0 )
+			valid = parseSize( value, options.width, options.height );
+		else if( std::strcmp( option, "--output-size" ) == 0 )
+			valid = parseSize( value, options.outputWidth, options.outputHeight );
+		else if( std::strcmp( option, "--from" ) == 0 )
+			valid = parseProjection( value, true, uniforms.inputProjection );
+		else if( std::strcmp( option, "--to" ) == 0 )
+			valid = parseProjection( value, false, uniforms.outputProjection );
+		else if( std::strcmp( option, "--stereo" ) == 0 )
+			valid = parseName( value, STEREO_MODE_COUNT, stereoModeName, uniforms.stereo );
+		else if( std::strcmp( option, "--pitch" ) == 0 )
+			uniforms.rotation.x = float( std::atof( value ) * degrees );
+		else if( std::strcmp( option, "--roll" ) == 0 )
+			uniforms.rotation.y = float( std::atof( value ) * degrees );
+		else if( std::strcmp( option, "--yaw" ) == 0 )
+			uniforms.rotation.z = float( std::atof( value ) * degrees );
+		else if( std::strcmp( option, "--fov-in" ) == 0 )
+			uniforms.fovIn = float( std::atof( value ) * PI / 2.0 );// Same mapping as currentUniforms() in the plugins
+		else if( std::strcmp( option, "--fov-out" ) == 0 )
+			uniforms.fovOut = float( std::atof( value ) * PI / 2.0 );
+		else if( std::strcmp( option, "--precision" ) == 0 )
+			valid = parseName( value, PRECISION_MODE_COUNT, precisionModeName, uniforms.precision );
+		else if( std::strcmp( option, "--kernel" ) == 0 )
+			valid = parseKernel( value, options );
+		else if( std::strcmp( option, "--threads" ) == 0 )
+			valid = ( options.threads = std::atoi( value ) ) >= 0;
+		else if( std::strcmp( option, "--tile" ) == 0 )
+			valid = ( options.tileSize = std::atoi( value ) ) > 0;
+		else if( std::strcmp( option, "--queue" ) == 0 )
+			valid = ( options.queueDepth = std::atoi( value ) ) > 0;
+		else
+		{
+			std::fprintf( stderr, "Unknown option %s\n", option );
+			return false;
+		}
+		if( !valid )
+		{
+			std::fprintf( stderr, "Invalid value '%s' for %s\n", value, option );
+			return false;
+		}
+	}
+	return true;
+}
+
+FILE* openStream( const std::string& path, bool output )
+{
+	FILE* file = nullptr;
+	if( path == "-" )
+	{
+		file = output ? stdout : stdin;
+#ifdef _WIN32
+		_setmode( _fileno( file ), _O_BINARY );
+#endif
+	}
+	else
+	{
+		file = std::fopen( path.c_str(), output ? "wb" : "rb" );
+	}
+	// Whole frames go through these, so the default buffer of a few kilobytes only adds system calls.
+	if( file != nullptr )
+		std::setvbuf( file, nullptr, _IOFBF, size_t( 1 ) << 20 );
+	return file;
+}
+
+}// namespace
+
+int main( int argc, char** argv )
+{
+	Options options;
+	if( !parseOptions( argc, argv, options ) )
+	{
+		printUsage();
+		return 1;
+	}
+	if( options.kernel.empty() )
+	{
+		options.level  = detectSimdLevel();
+		options.kernel = simdLevelName( options.level );
+	}
+
+	FILE* input  = openStream( options.inputPath, false );
+	FILE* output = input != nullptr ? openStream( options.outputPath, true ) : nullptr;
+	if( input == nullptr || output == nullptr )
+	{
+		std::fprintf( stderr, "Could not open %s\n", input == nullptr ? options.inputPath.c_str() : options.outputPath.c_str() );
+		return 1;
+	}
+
+	std::string error;
+	FrameReader reader;
+	StreamInfo inputInfo;
+	inputInfo.width  = options.width;
+	inputInfo.height = options.height;
+	if( !reader.open( input, inputInfo, error ) )
+	{
+		std::fprintf( stderr, "%s\n", error.c_str() );
+		return 1;
+	}
+	StreamInfo outputInfo = inputInfo;
+	if( options.outputWidth > 0 )
+	{
+		outputInfo.width  = options.outputWidth;
+		outputInfo.height = options.outputHeight;
+	}
+
+	Uniforms uniforms = options.uniforms;
+	uniforms.width    = inputInfo.width;
+	uniforms.height   = inputInfo.height;
+	TileExecutor executor( options.threads, options.tileSize );
+	RemapTable table;
+	auto bakeStart = std::chrono::steady_clock::now();
+	if( options.kernel == "reference" )
+		bakeRemapTable( uniforms, outputInfo.width, outputInfo.height, table, executor );
+	else
+		bakeRemapTable( uniforms, outputInfo.width, outputInfo.height, table, executor, options.level );
+	double bakeSeconds = std::chrono::duration< double >( std::chrono::steady_clock::now() - bakeStart ).count();
+
+	FrameWriter writer;
+	if( !writer.open( output, outputInfo, error ) )
+	{
+		std::fprintf( stderr, "%s\n", error.c_str() );
+		return 1;
+	}
+	std::fprintf( stderr, "%s %dx%d %s -> %s %dx%d, %s kernel, %s trig, %d threads, mapping baked in %.1f ms\n",
+				  inputInfo.format == StreamFormat::Y4M ? "y4m" : "rgba", inputInfo.width, inputInfo.height, projectionName( uniforms.inputProjection ),
+				  projectionName( uniforms.outputProjection ), outputInfo.width, outputInfo.height, options.kernel.c_str(),
+				  precisionModeName( uniforms.precision ), executor.threadCount(), bakeSeconds * 1e3 );
+
+	// Frames circulate between the stages instead of being allocated per frame. Each side owns enough of them for one
+	// frame in each neighbouring stage plus a full queue.
+	size_t depth = size_t( options.queueDepth );
+	BoundedQueue< FramePtr > freeInputs( depth + 2 ), decoded( depth );
+	BoundedQueue< FramePtr > freeOutputs( depth + 2 ), reprojected( depth );
+	for( size_t i = 0; i < depth + 2; ++i )
+	{
+		freeInputs.push( FramePtr( new Image( inputInfo.width, inputInfo.height, PixelFormat::RGBA8 ) ) );
+		freeOutputs.push( FramePtr( new Image( outputInfo.width, outputInfo.height, PixelFormat::RGBA8 ) ) );
+	}
+
+	StageClock readClock, reprojectClock, writeClock;
+	std::string readError, writeError;
+	long long frames = 0;
+	auto start       = std::chrono::steady_clock::now();
+
+	std::thread readStage( [&] {
+		FramePtr frame;
+		while( freeInputs.pop( frame ) )
+		{
+			if( !readClock.time( [&] { return reader.read( *frame, readError ); } ) || !decoded.push( std::move( frame ) ) )
+				break;
+		}
+		decoded.close();
+	} );
+
+	std::thread writeStage( [&] {
+		FramePtr frame;
+		while( reprojected.pop( frame ) )
+		{
+			if( !writeClock.time( [&] { return writer.write( *frame, writeError ); } ) )
+			{
+				// Nothing downstream any more, so stop the other stages too.
+				reprojected.close();
+				freeOutputs.close();
+				decoded.close();
+				freeInputs.close();
+				return;
+			}
+			++frames;
+			freeOutputs.push( std::move( frame ) );
+		}
+	} );
+
+	FramePtr source, destination;
+	while( decoded.pop( source ) && freeOutputs.pop( destination ) )
+	{
+		reprojectClock.time( [&] {
+			renderRemapped( table, *source, *destination, executor );
+			return true;
+		} );
+		freeInputs.push( std::move( source ) );
+		if( !reprojected.push( std::move( destination ) ) )
+			break;
+	}
+	freeInputs.close();
+	reprojected.close();
+	readStage.join();
+	writeStage.join();
+
+	if( writeError.empty() && std::fflush( output ) != 0 )
+		writeError = "Could not write the output";
+	double seconds = std::chrono::duration< double >( std::chrono::steady_clock::now() - start ).count();
+	double pixels  = double( frames ) * outputInfo.width * outputInfo.height;
+	std::fprintf( stderr, "%lld frames in %.2f s, %.2f fps, %.1f Mpx/s; busy: read %.2f s, reproject %.2f s, write %.2f s\n", frames, seconds,
+				  frames / seconds, pixels / seconds / 1e6, readClock.seconds, reprojectClock.seconds, writeClock.seconds );
+	if( !readError.empty() || !writeError.empty() )
+	{
+		std::fprintf( stderr, "%s\n", !writeError.empty() ? writeError.c_str() : readError.c_str() );
+		return 1;
+	}
+	if( output != stdout )
+		std::fclose( output );
+	if( input != stdin )
+		std::fclose( input );
+	return 0;
+}